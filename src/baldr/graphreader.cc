@@ -3,6 +3,7 @@
 #include "incident_singleton.h"
 #include "midgard/encoded.h"
 #include "midgard/logging.h"
+#include "midgard/metrics.h"
 #include "midgard/util.h"
 #include "shortcut_recovery.h"
 
@@ -587,8 +588,11 @@ graph_tile_ptr GraphReader::GetGraphTile(const GraphId& graphid) {
   auto base = graphid.tile_base();
   if (const auto& cached = cache_->Get(base)) {
     // LOG_DEBUG("Memory cache hit " + GraphTile::FileSuffix(base));
+    midgard::metrics::count(midgard::metrics::counter_t::tile_cache_hits);
     return cached;
   }
+  midgard::metrics::count(midgard::metrics::counter_t::tile_cache_misses);
+  tiles_loaded_.fetch_add(1, std::memory_order_relaxed);
 
   // Try getting it from the memmapped tar extract
   if (!tile_extract_->tiles.empty()) {
@@ -1,4 +1,5 @@
 #include "loki/reach.h"
+#include "midgard/metrics.h"
 
 using namespace valhalla::baldr;
 
@@ -51,6 +52,7 @@ directed_reach Reach::operator()(const DirectedEdge* edge,
   directed_reach reach{};
   if (max_reach == 0)
     return reach;
+  midgard::metrics::stage_timer_t timer(midgard::metrics::stage_t::reach);
   max_reach_ = max_reach;
 
   // these are used below to get conservative estimates of forward and reverse reach
@@ -4,6 +4,7 @@
 #include "baldr/tilehierarchy.h"
 #include "loki/reach.h"
 #include "midgard/distanceapproximator.h"
+#include "midgard/metrics.h"
 #include "midgard/util.h"
 
 #include <algorithm>
@@ -861,6 +862,8 @@ Search::~Search() = default;
 
 void Search::search(google::protobuf::RepeatedPtrField<Location>& locations,
                     const cost_ptr_t& costing) {
+  midgard::metrics::stage_timer_t timer(midgard::metrics::stage_t::search);
+
   // we cannot continue without costing
   if (!costing)
     throw std::runtime_error("No costing was provided for edge candidate search");
@@ -2,6 +2,7 @@
 #include "config.h"
 #include "filesystem_utils.h"
 #include "loki/worker.h"
+#include "midgard/metrics.h"
 #include "proto/status.pb.h"
 
 using namespace valhalla::baldr;
@@ -73,6 +74,27 @@ void loki_worker_t::status(Api& request) const {
   status->set_has_timezones(tile && tile->node(0)->timezone() > 0);
   status->set_has_live_traffic(reader->HasLiveTraffic());
   status->set_osm_changeset(tile ? tile->header()->dataset_id() : 0);
+
+  // the latencies and counters of this process, which in valhalla_service runs all of the stages
+  const auto metrics = midgard::metrics::snapshot();
+  for (size_t i = 0; i < midgard::metrics::kStageCount; ++i) {
+    const auto& histogram = metrics.stages[i];
+    if (histogram.count == 0) {
+      continue;
+    }
+    auto* latency = status->add_stage_latencies();
+    latency->set_stage(midgard::metrics::to_string(static_cast<midgard::metrics::stage_t>(i)));
+    latency->set_count(histogram.count);
+    latency->set_mean_ms(histogram.sum / 1e3 / histogram.count);
+    latency->set_p50_ms(histogram.quantile(0.5) / 1e3);
+    latency->set_p90_ms(histogram.quantile(0.9) / 1e3);
+    latency->set_p99_ms(histogram.quantile(0.99) / 1e3);
+    latency->set_max_ms(histogram.max / 1e3);
+  }
+  for (size_t i = 0; i < midgard::metrics::kCounterCount; ++i) {
+    (*status->mutable_counters())[midgard::metrics::to_string(
+        static_cast<midgard::metrics::counter_t>(i))] = metrics.counters[i];
+  }
 }
 } // namespace loki
 } // namespace valhalla
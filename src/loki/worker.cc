@@ -240,7 +240,10 @@ loki_worker_t::loki_worker_t(const boost::property_tree::ptree& config,
       allow_hard_exclusions(config.get<bool>("service_limits.allow_hard_exclusions", false)),
       candidate_query_(*reader,
                        TileHierarchy::levels().back().tiles.TileSize() / 10.0f,
-                       TileHierarchy::levels().back().tiles.TileSize() / 10.0f) {
+                       TileHierarchy::levels().back().tiles.TileSize() / 10.0f,
+                       config.get<size_t>("meili.grid.cache_size"),
+                       config.get<size_t>("meili.grid.cache_memory",
+                                          meili::kDefaultGridCacheMemory)) {
 
   // Keep a string noting which actions we support, throw if one isnt supported
   Options::Action action;
@@ -290,7 +293,7 @@ loki_worker_t::loki_worker_t(const boost::property_tree::ptree& config,
         kv.first == "max_distance_disable_hierarchy_culling" || kv.first == "skadi" ||
         kv.first == "status" || kv.first == "allow_hard_exclusions" ||
         kv.first == "hierarchy_limits" || kv.first == "min_linear_cost_factor" ||
-        kv.first == "max_linear_cost_edges") {
+        kv.first == "max_linear_cost_edges" || kv.first == "budget") {
       continue;
     }
     if (kv.first != "trace" && kv.first != "auto_pedestrian") {
@@ -364,7 +367,6 @@ loki_worker_t::loki_worker_t(const boost::property_tree::ptree& config,
   max_distance_disable_hierarchy_culling =
       config.get<float>("service_limits.max_distance_disable_hierarchy_culling", 0.f);
   allow_hard_exclusions = config.get<bool>("service_limits.allow_hard_exclusions", false);
-  candidate_query_cache_size_ = config.get<size_t>("meili.grid.cache_size");
   mvt_cache_dir_ = config.get<std::string>("loki.service_defaults.mvt_cache_dir", "");
   if (!mvt_cache_dir_.empty() && !std::filesystem::exists(mvt_cache_dir_))
     std::filesystem::create_directory(mvt_cache_dir_);
@@ -379,9 +381,6 @@ void loki_worker_t::cleanup() {
   if (reader->OverCommitted()) {
     reader->Trim();
   }
-  if (candidate_query_.size() > candidate_query_cache_size_) {
-    candidate_query_.Clear();
-  }
 }
 
 void loki_worker_t::set_interrupt(const std::function<void()>* interrupt_function) {
@@ -446,13 +445,18 @@ loki_worker_t::work(const std::list<zmq::message_t>& job,
   // grab the request info and make sure to record any metrics before we are done
   auto& info = *static_cast<prime_server::http_request_info_t*>(request_info);
   LOG_INFO("Got Loki Request " + std::to_string(info.id));
-  Api request;
+  // the request lives on the arena of the worker until cleanup
+  Api& request = arena.request();
   prime_server::worker_t::result_t result{true, {}, ""};
   try {
     // request parsing
     auto http_request =
         prime_server::http_request_t::from_string(static_cast<const char*>(job.front().data()),
                                                   job.front().size());
+    // the latencies and counters of the whole process, which isn't an action
+    if (http_request.path == "/metrics") {
+      return serialize_metrics(info);
+    }
     ParseApi(http_request, request);
     const auto& options = request.options();
 
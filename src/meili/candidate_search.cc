@@ -187,8 +187,11 @@ void IndexBin(const baldr::graph_tile_ptr& tile,
 
 CandidateGridQuery::CandidateGridQuery(baldr::GraphReader& reader,
                                        float cell_width,
-                                       float cell_height)
-    : cell_width_(cell_width), cell_height_(cell_height), reader_(reader) {
+                                       float cell_height,
+                                       size_t max_cache_size,
+                                       size_t max_cache_memory)
+    : cell_width_(cell_width), cell_height_(cell_height), max_cache_size_(max_cache_size),
+      max_cache_memory_(max_cache_memory), reader_(reader) {
   bin_level_ = baldr::TileHierarchy::levels().back().level;
 }
 
@@ -198,11 +201,14 @@ inline const CandidateGridQuery::grid_t*
 CandidateGridQuery::GetGrid(const int32_t bin_id,
                             const Tiles<PointLL>& tiles,
                             const Tiles<PointLL>& bins) const {
-  // Check if the bin is in the cache
+  // Check if the bin is in the cache and mark it as the most recently used
   const auto it = grid_cache_.find(bin_id);
   if (it != grid_cache_.end()) {
-    return &(it->second);
+    ++stats_.hits;
+    lru_.splice(lru_.begin(), lru_, it->second.lru);
+    return it->second.grid.get();
   }
+  ++stats_.misses;
 
   // Not in the cache. Get the tile and Index the bin within the tile.
   int32_t ndiv = tiles.nsubdivisions();
@@ -219,11 +225,30 @@ CandidateGridQuery::GetGrid(const int32_t bin_id,
   int32_t bin_col = rc.second % ndiv;
   int32_t bin_index = (bin_row * ndiv) + bin_col;
 
-  // Insert the bin into the cache and index the bin
-  const auto inserted =
-      grid_cache_.emplace(bin_id, grid_t(tile->BoundingBox(), cell_width_, cell_height_));
-  IndexBin(tile, bin_index, reader_, inserted.first->second);
-  return &(inserted.first->second);
+  // Index the bin and insert it into the cache
+  auto grid = std::make_shared<grid_t>(tile->BoundingBox(), cell_width_, cell_height_);
+  IndexBin(tile, bin_index, reader_, *grid);
+  grid->Compact();
+
+  const auto memory = grid->memory_size();
+  lru_.push_front(bin_id);
+  grid_cache_.emplace(bin_id, CachedGrid{grid, lru_.begin(), memory});
+  ++stats_.grids;
+  stats_.memory += memory;
+  Evict();
+  return grid.get();
+}
+
+void CandidateGridQuery::Evict() const {
+  while (grid_cache_.size() > 1 &&
+         (grid_cache_.size() > max_cache_size_ || stats_.memory > max_cache_memory_)) {
+    const auto it = grid_cache_.find(lru_.back());
+    stats_.memory -= it->second.memory;
+    --stats_.grids;
+    ++stats_.evictions;
+    grid_cache_.erase(it);
+    lru_.pop_back();
+  }
 }
 
 std::unordered_set<baldr::GraphId>
@@ -37,6 +37,9 @@ void Config::Read(const boost::property_tree::ptree& params) {
   transition_cost.Read(params);
   emission_cost.Read(params);
   routing.Read(params);
+
+  ReadParamOptional(concurrency, params, "concurrency");
+  CHECK_THROWS(concurrency > 0, POSITIVE_VALUE_MSG(concurrency, "concurrency"));
 }
 
 void Config::CandidateSearch::Read(const boost::property_tree::ptree& params) {
@@ -53,6 +56,7 @@ void Config::CandidateSearch::Read(const boost::property_tree::ptree& params) {
                POSITIVE_VALUE_MSG(max_search_radius_meters, "max_search_radius"));
 
   ReadParamOptional(cache_size, params, "grid.cache_size");
+  ReadParamOptional(cache_memory, params, "grid.cache_memory");
   ReadParamOptional(grid_size, params, "grid.size");
 }
 
@@ -8,7 +8,10 @@
 #include "midgard/logging.h"
 
 #include <array>
+#include <atomic>
 #include <cmath>
+#include <exception>
+#include <thread>
 
 namespace {
 
@@ -18,6 +21,12 @@ using namespace valhalla::baldr;
 
 constexpr float MAX_ACCUMULATED_COST = 99999999.f;
 
+// Edge lengths are rounded to the meter and candidates are only approximately within the search
+// radius, so a route between two candidates can come out a bit shorter than the straight line
+// between them. We only call two columns independent if they are this much further apart than
+// the longest route the transition cost model is allowed to find between them
+constexpr float kIndependentTraceMargin = 1.25f;
+
 inline float GreatCircleDistanceSquared(const Measurement& left, const Measurement& right) {
   return left.lnglat().DistanceSquared(right.lnglat());
 }
@@ -503,17 +512,18 @@ MapMatcher::MapMatcher(const Config& config,
                        baldr::GraphReader& graphreader,
                        CandidateQuery& candidatequery,
                        const sif::mode_costing_t& mode_costing,
-                       sif::TravelMode travelmode)
+                       sif::TravelMode travelmode,
+                       const std::vector<std::shared_ptr<baldr::GraphReader>>& worker_graphreaders)
     : config_(config), graphreader_(graphreader), candidatequery_(candidatequery),
-      mode_costing_(mode_costing), travelmode_(travelmode), interrupt_(nullptr), vs_(), ts_(vs_),
+      mode_costing_(mode_costing), travelmode_(travelmode), interrupt_(nullptr), vs_(),
       container_(), emission_cost_model_(graphreader_, container_, config_.emission_cost),
       transition_cost_model_(graphreader_,
                              vs_,
-                             ts_,
                              container_,
                              mode_costing_,
                              travelmode_,
-                             config_.transition_cost) {
+                             config_.transition_cost),
+      worker_graphreaders_(worker_graphreaders) {
   vs_.set_emission_cost_model(emission_cost_model_);
   vs_.set_transition_cost_model(transition_cost_model_);
 }
@@ -523,10 +533,7 @@ MapMatcher::~MapMatcher() {
 
 void MapMatcher::Clear() {
   vs_.Clear();
-  // reset cost models because they were possibly replaced by topk
-  vs_.set_emission_cost_model(emission_cost_model_);
-  vs_.set_transition_cost_model(transition_cost_model_);
-  ts_.Clear();
+  removed_states_.clear();
   container_.Clear();
 }
 
@@ -544,7 +551,7 @@ void MapMatcher::RemoveRedundancies(const std::vector<StateId>& result,
     std::unordered_map<StateId, path_t> paths_from_winner;
     for (const auto& right_candidate : container_.column(time + 1)) {
       std::vector<EdgeSegment> edges;
-      if (!ts_.IsRemoved(right_candidate.stateid()) &&
+      if (!IsRemoved(right_candidate.stateid()) &&
           MergeRoute(left_used_candidate, right_candidate, edges, results[time + 1])) {
         paths_from_winner.emplace(right_candidate.stateid(), std::move(edges));
       }
@@ -556,7 +563,7 @@ void MapMatcher::RemoveRedundancies(const std::vector<StateId>& result,
     for (const auto& left_unused_candidate : container_.column(time)) {
       // We cant remove candidates that were used in the result or already removed
       if (left_used_candidate.stateid() == left_unused_candidate.stateid() ||
-          ts_.IsRemoved(left_unused_candidate.stateid())) {
+          IsRemoved(left_unused_candidate.stateid())) {
         continue;
       }
 
@@ -570,7 +577,7 @@ void MapMatcher::RemoveRedundancies(const std::vector<StateId>& result,
       for (const auto& right_candidate : container_.column(time + 1)) {
         // If there is no route its not really unique since we dont need discontinuities
         std::vector<EdgeSegment> edges;
-        if (ts_.IsRemoved(right_candidate.stateid()) ||
+        if (IsRemoved(right_candidate.stateid()) ||
             !MergeRoute(left_unused_candidate, right_candidate, edges, results[time + 1])) {
           continue;
         }
@@ -597,7 +604,7 @@ void MapMatcher::RemoveRedundancies(const std::vector<StateId>& result,
 
     // Clean up the left hand redundancies
     for (const auto& r : redundancies) {
-      ts_.RemoveStateId(r);
+      removed_states_.emplace(r);
       vs_.RemoveStateId(r);
     }
 
@@ -617,85 +624,13 @@ void MapMatcher::RemoveRedundancies(const std::vector<StateId>& result,
 
       // Cleanup the right hand redundancies
       for (const auto& r : redundancies) {
-        ts_.RemoveStateId(r);
+        removed_states_.emplace(r);
         vs_.RemoveStateId(r);
       }
     }
   }
 }
 
-// Mark any sub paths (pairs of candidates between two states) that are redundant with this one
-/*void MapMatcher::RemoveRedundancies(const path_t& path, std::vector<StateId>& state_ids) {
-  // For each state pair
-  for(StateId::Time time = 0; time < state_ids.back().time(); ++time) {
-    // For each left candidate
-    for(const auto& lhs : container_.column(time)) {
-      // If we dont have routes from this state
-      if(!lhs.routed())
-        vs_.transition_cost_model()(lhs.stateid(), StateId(time + 1, 0));
-
-      // For each right candidate
-      for(const auto& rhs : container_.column(time + 1)) {
-
-        // If this is the path we already used skip it
-        if(lhs.stateid() == state_ids[time] && rhs.stateid() == state_ids[time + 1])
-          continue;
-
-        // Get the path for this pair of candidates
-        path_t sub_path(MergeRoute(lhs, rhs));
-
-        // If this is redundant if its empty (because we dont want discontinuities in subsequent
-results
-        // or the first subpath starts the original path or the last subpath ends the original
-path
-or
-        // the intermediate subpath is contained within the original path
-        if(sub_path.edges.empty() ||
-           (time == state_ids.front().time() && sub_path.start_of(path)) ||
-           (time == state_ids.back().time() - 1 && sub_path.end_of(path)) ||
-           sub_path.within(path)) {
-
-          // Swap out the real candidates for the redundant ones
-          auto lid = lhs.stateid(); std::swap(lid, state_ids[time]);
-          auto rid = rhs.stateid(); std::swap(rid, state_ids[time + 1]);
-
-          std::cout << std::endl << "Removing: ";
-          std::cout << R"({"type":"FeatureCollection","features":[)";
-          std::string fsep = "";
-          for(auto s : state_ids) {
-            std::cout << fsep << container_.geojson(s);
-            fsep = ",";
-          }
-          std::cout << R"(]})" << std::endl;
-
-          // Mark them redundant in searching
-          ts_.RemovePath(state_ids);
-          // Swap back the real candidates for the redundant ones
-          std::swap(lid, state_ids[time]);
-          std::swap(rid, state_ids[time + 1]);
-          // TODO: Mark them so we dont consider them again in another pass
-        }
-        else {
-          auto lid = lhs.stateid(); std::swap(lid, state_ids[time]);
-          auto rid = rhs.stateid(); std::swap(rid, state_ids[time + 1]);
-
-          std::cout << std::endl << "Keeping: ";
-          std::cout << R"({"type":"FeatureCollection","features":[)";
-          std::string fsep = "";
-          for(auto s : state_ids) {
-            std::cout << fsep << container_.geojson(s);
-            fsep = ",";
-          }
-          std::cout << R"(]})" << std::endl;
-
-          std::swap(lid, state_ids[time]);
-          std::swap(rid, state_ids[time + 1]);
-        }
-      }
-    }
-  }
-}*/
-
 std::vector<MatchResults> MapMatcher::OfflineMatch(const std::vector<Measurement>& measurements,
                                                    uint32_t k) {
   if (k <= 0) {
@@ -723,6 +658,19 @@ std::vector<MatchResults> MapMatcher::OfflineMatch(const std::vector<Measurement
     throw valhalla_exception_t{443};
   }
 
+  // If the trace falls apart into pieces that can never be connected we can search them
+  // concurrently, they can't have alternates either since we never return those across breaks
+  const auto traces = worker_graphreaders_.size() > 1
+                          ? FindIndependentTraces()
+                          : std::vector<std::pair<StateId::Time, StateId::Time>>{};
+
+  // The alternates come from a search which keeps the k best paths of every state in one forward
+  // pass. It is rebuilt without the redundant states once it runs out of paths, with room to skip
+  // the paths which were tried already
+  std::unique_ptr<KBestViterbiSearch> alternates;
+  uint32_t alternate_rank = 0;
+  std::vector<std::vector<StateId>> tried_paths;
+
   // For k paths
   std::vector<StateId> state_ids;
   state_ids.reserve(container_.size());
@@ -730,41 +678,83 @@ std::vector<MatchResults> MapMatcher::OfflineMatch(const std::vector<Measurement
     // Get the states for the kth best path in reversed order then fix the order
     state_ids.clear();
     double accumulated_cost = 0.f;
-    while (state_ids.size() < container_.size()) {
-      // Get the time at the last column of states
-      const auto time = container_.size() - state_ids.size() - 1;
-      // Find the most probable path
-      std::copy(vs_.SearchPathVS(time, false), vs_.PathEnd(), std::back_inserter(state_ids));
-      // See what the last state was that we reached
-      const auto& winner = vs_.SearchWinner(time);
-      // If we got all the way to the end there were no discontinuities and the cost is a normal value
-      if (winner.IsValid()) {
-        accumulated_cost += vs_.AccumulatedCost(winner);
-      } // We got a discontinuity before reaching the last state
-      else {
-        // TODO need a sane constant cost for invalid state
-        accumulated_cost += MAX_ACCUMULATED_COST;
+    if (best_paths.empty()) {
+      if (traces.size() > 1) {
+        accumulated_cost = SearchIndependentTraces(traces, state_ids);
         found_discontinuity = true;
       }
+      while (state_ids.size() < container_.size()) {
+        // Get the time at the last column of states
+        const auto time = container_.size() - state_ids.size() - 1;
+        // Find the most probable path
+        std::copy(vs_.SearchPathVS(time, false), vs_.PathEnd(), std::back_inserter(state_ids));
+        // See what the last state was that we reached
+        const auto& winner = vs_.SearchWinner(time);
+        // If we got all the way to the end there were no discontinuities and the cost is a normal
+        // value
+        if (winner.IsValid()) {
+          accumulated_cost += vs_.AccumulatedCost(winner);
+        } // We got a discontinuity before reaching the last state
+        else {
+          // TODO need a sane constant cost for invalid state
+          accumulated_cost += MAX_ACCUMULATED_COST;
+          found_discontinuity = true;
+        }
 
-      // if we need to match more we add a penalty for connecting over the discontinuity
-      if (state_ids.size() < container_.size()) {
-        found_discontinuity = true;
-        accumulated_cost += MAX_ACCUMULATED_COST;
+        // if we need to match more we add a penalty for connecting over the discontinuity
+        if (state_ids.size() < container_.size()) {
+          found_discontinuity = true;
+          accumulated_cost += MAX_ACCUMULATED_COST;
+        }
       }
-    }
+      std::reverse(state_ids.begin(), state_ids.end());
+    } else {
+      // Alternates never have discontinuities, take the next one we haven't tried
+      const StateId::Time time = container_.size() - 1;
+      bool rebuilt = false;
+      while (state_ids.empty()) {
+        if (!alternates || alternate_rank == alternates->k()) {
+          if (rebuilt) {
+            break;
+          }
+          const auto alternates_k =
+              static_cast<uint32_t>(tried_paths.size() + k - best_paths.size());
+          alternates = std::make_unique<KBestViterbiSearch>(alternates_k);
+          alternates->set_emission_cost_model(emission_cost_model_);
+          alternates->set_transition_cost_model(transition_cost_model_);
+          for (StateId::Time t = 0; t <= time; ++t) {
+            for (const auto& state : container_.column(t)) {
+              if (!IsRemoved(state.stateid())) {
+                alternates->AddStateId(state.stateid());
+              }
+            }
+          }
+          alternate_rank = 0;
+          rebuilt = true;
+        }
 
-    // we dont return additional paths (alternatives) if the have discontinuities
-    if (!best_paths.empty() && found_discontinuity) {
-      break;
-    }
+        auto path = alternates->SearchPath(time, alternate_rank);
+        if (path.empty()) {
+          break;
+        }
+        accumulated_cost = alternates->PathCost(time, alternate_rank);
+        ++alternate_rank;
+
+        // Skip the paths we tried and the ones through states which turned out to be redundant
+        if (std::find(tried_paths.cbegin(), tried_paths.cend(), path) == tried_paths.cend() &&
+            std::none_of(path.cbegin(), path.cend(),
+                         [this](const StateId& s) { return IsRemoved(s); })) {
+          state_ids = std::move(path);
+        }
+      }
 
-    // Get back the real state ids in order
-    std::vector<StateId> original_state_ids;
-    original_state_ids.reserve(state_ids.size());
-    for (auto s_itr = state_ids.rbegin(); s_itr != state_ids.rend(); ++s_itr) {
-      original_state_ids.push_back(ts_.GetOrigin(*s_itr, *s_itr));
+      // There are no more alternates
+      if (state_ids.empty()) {
+        break;
+      }
     }
+    tried_paths.push_back(state_ids);
+    const auto& original_state_ids = state_ids;
 
     // Get the match result for each of the states
     auto results = FindMatchResults(*this, original_state_ids, graphreader_);
@@ -815,10 +805,6 @@ std::vector<MatchResults> MapMatcher::OfflineMatch(const std::vector<Measurement
     if (!found_discontinuity && best_paths.size() < k) {
       // Remove all the candidates pairs whose paths are redundant with this one
       RemoveRedundancies(original_state_ids, results);
-      // Remove this particular sequence of stateids
-      ts_.RemovePath(state_ids);
-      // Prepare for a fresh search in the next search iteration
-      vs_.ClearSearch();
     }
   }
 
@@ -831,6 +817,133 @@ std::vector<MatchResults> MapMatcher::OfflineMatch(const std::vector<Measurement
   return best_paths;
 }
 
+std::vector<std::pair<StateId::Time, StateId::Time>> MapMatcher::FindIndependentTraces() const {
+  const float sq_max_search_radius = config_.candidate_search.max_search_radius_meters *
+                                     config_.candidate_search.max_search_radius_meters;
+  const auto search_radius = [sq_max_search_radius](const Measurement& measurement) {
+    return std::sqrt(std::min(sq_max_search_radius, std::max(measurement.sq_search_radius(),
+                                                             measurement.sq_gps_accuracy())));
+  };
+  // TransitionCostModel::UpdateRoute never lets a route get longer than this
+  const float max_route_distance =
+      std::ceil(std::max(config_.transition_cost.breakage_distance_meters, 1.f));
+
+  std::vector<std::pair<StateId::Time, StateId::Time>> traces;
+  StateId::Time begin = 0;
+  for (StateId::Time time = 1; time < container_.size(); ++time) {
+    // Both sides need candidates so that the path of each trace ends exactly at its boundary
+    if (container_.column(time - 1).empty() || container_.column(time).empty()) {
+      continue;
+    }
+
+    const auto& left = container_.measurement(time - 1);
+    const auto& right = container_.measurement(time);
+    const auto reachable_distance =
+        (max_route_distance + search_radius(left) + search_radius(right)) * kIndependentTraceMargin;
+    if (GreatCircleDistanceSquared(left, right) > reachable_distance * reachable_distance) {
+      traces.emplace_back(begin, time);
+      begin = time;
+    }
+  }
+  traces.emplace_back(begin, container_.size());
+
+  return traces;
+}
+
+double MapMatcher::SearchIndependentTraces(
+    const std::vector<std::pair<StateId::Time, StateId::Time>>& traces,
+    std::vector<StateId>& state_ids) {
+  // A piece of a trace without discontinuities, in reversed order, and the winner it ends at
+  struct sub_path_t {
+    std::vector<StateId> state_ids;
+    StateId winner;
+    double accumulated_cost;
+  };
+  std::vector<std::vector<sub_path_t>> sub_paths(traces.size());
+
+  // Each thread takes the next trace that nobody has searched yet
+  std::atomic<size_t> next_trace(0);
+  const auto search = [&](baldr::GraphReader& reader) {
+    // A private search whose routes are computed with this threads reader. The columns of the
+    // traces don't overlap so the states each thread writes its routes into don't either
+    ViterbiSearch vs;
+    TransitionCostModel transition_cost_model(reader, vs, container_, mode_costing_, travelmode_,
+                                              config_.transition_cost);
+    vs.set_emission_cost_model(emission_cost_model_);
+    vs.set_transition_cost_model(transition_cost_model);
+
+    for (auto i = next_trace++; i < traces.size(); i = next_trace++) {
+      // the request may have been given up on
+      if (interrupt_) {
+        (*interrupt_)();
+      }
+      const auto& trace = traces[i];
+      vs.Clear();
+      for (auto time = trace.first; time < trace.second; ++time) {
+        for (const auto& state : container_.column(time)) {
+          vs.AddStateId(state.stateid());
+        }
+      }
+
+      // Same as the sequential search in OfflineMatch but bounded by the traces columns
+      StateId::Time found = 0;
+      while (found < trace.second - trace.first) {
+        if (interrupt_) {
+          (*interrupt_)();
+        }
+        const auto time = trace.second - found - 1;
+        sub_path_t sub_path;
+        std::copy(vs.SearchPathVS(time, false), vs.PathEnd(),
+                  std::back_inserter(sub_path.state_ids));
+        sub_path.winner = vs.SearchWinner(time);
+        sub_path.accumulated_cost =
+            sub_path.winner.IsValid() ? vs.AccumulatedCost(sub_path.winner) : 0.;
+        found += sub_path.state_ids.size();
+        sub_paths[i].push_back(std::move(sub_path));
+      }
+    }
+  };
+
+  // Search the traces, if any thread fails we stop handing out work and rethrow its error
+  std::vector<std::thread> threads;
+  std::vector<std::exception_ptr> errors(std::min(worker_graphreaders_.size(), traces.size()));
+  threads.reserve(errors.size());
+  for (size_t i = 0; i < errors.size(); ++i) {
+    threads.emplace_back([&, i]() {
+      try {
+        search(*worker_graphreaders_[i]);
+      } catch (...) {
+        errors[i] = std::current_exception();
+        next_trace = traces.size();
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (const auto& error : errors) {
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+
+  // Stitch the pieces together from the back, accumulating costs in the same order as OfflineMatch
+  double accumulated_cost = 0.f;
+  for (auto trace = sub_paths.crbegin(); trace != sub_paths.crend(); ++trace) {
+    for (const auto& sub_path : *trace) {
+      std::copy(sub_path.state_ids.cbegin(), sub_path.state_ids.cend(),
+                std::back_inserter(state_ids));
+      accumulated_cost +=
+          sub_path.winner.IsValid() ? sub_path.accumulated_cost : MAX_ACCUMULATED_COST;
+      if (state_ids.size() < container_.size()) {
+        accumulated_cost += MAX_ACCUMULATED_COST;
+      }
+    }
+  }
+
+  return accumulated_cost;
+}
+
 std::unordered_map<StateId::Time, std::vector<Measurement>>
 MapMatcher::AppendMeasurements(const std::vector<Measurement>& measurements) {
   const float sq_max_search_radius = config_.candidate_search.max_search_radius_meters *
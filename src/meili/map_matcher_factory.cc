@@ -27,7 +27,18 @@ MapMatcherFactory::MapMatcherFactory(const boost::property_tree::ptree& root,
   candidatequery_ =
       std::make_shared<CandidateGridQuery>(*graphreader_,
                                            local_tile_size() / config_.candidate_search.grid_size,
-                                           local_tile_size() / config_.candidate_search.grid_size);
+                                           local_tile_size() / config_.candidate_search.grid_size,
+                                           config_.candidate_search.cache_size,
+                                           config_.candidate_search.cache_memory);
+
+  // tiles are loaded from several threads at once so each of them needs its own reader
+  if (config_.concurrency > 1) {
+    worker_graphreaders_.reserve(config_.concurrency);
+    for (uint32_t i = 0; i < config_.concurrency; ++i) {
+      worker_graphreaders_.push_back(
+          std::make_shared<baldr::GraphReader>(root.get_child("mjolnir")));
+    }
+  }
 }
 
 MapMatcherFactory::~MapMatcherFactory() {
@@ -43,7 +54,8 @@ MapMatcher* MapMatcherFactory::Create(const Options& options) {
   mode_costing_[static_cast<uint32_t>(mode)] = cost;
 
   // TODO investigate exception safety
-  return new MapMatcher(config, *graphreader_, *candidatequery_, mode_costing_, mode);
+  return new MapMatcher(config, *graphreader_, *candidatequery_, mode_costing_, mode,
+                        worker_graphreaders_);
 }
 
 Config MapMatcherFactory::MergeConfig(const Options& options) const {
@@ -78,14 +90,19 @@ void MapMatcherFactory::ClearFullCache() {
   if (graphreader_->OverCommitted()) {
     graphreader_->Trim();
   }
-
-  if (candidatequery_->size() > config_.candidate_search.cache_size) {
-    candidatequery_->Clear();
+  for (auto& worker_graphreader : worker_graphreaders_) {
+    if (worker_graphreader->OverCommitted()) {
+      worker_graphreader->Trim();
+    }
   }
+  // the grids only hold graph ids, they stay valid and are evicted by the candidate query itself
 }
 
 void MapMatcherFactory::ClearCache() {
   graphreader_->Clear();
+  for (auto& worker_graphreader : worker_graphreaders_) {
+    worker_graphreader->Clear();
+  }
   candidatequery_->Clear();
 }
 
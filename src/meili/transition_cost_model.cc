@@ -13,7 +13,6 @@ namespace meili {
 
 TransitionCostModel::TransitionCostModel(baldr::GraphReader& graphreader,
                                          const IViterbiSearch& vs,
-                                         const TopKSearch& ts,
                                          const StateContainer& container,
                                          const sif::mode_costing_t& mode_costing,
                                          const sif::TravelMode travelmode,
@@ -22,7 +21,7 @@ TransitionCostModel::TransitionCostModel(baldr::GraphReader& graphreader,
                                          float max_route_distance_factor,
                                          float max_route_time_factor,
                                          float turn_penalty_factor)
-    : graphreader_(graphreader), vs_(vs), ts_(ts), container_(container), mode_costing_(mode_costing),
+    : graphreader_(graphreader), vs_(vs), container_(container), mode_costing_(mode_costing),
       travelmode_(travelmode), beta_(beta), inv_beta_(1.f / beta_),
       breakage_distance_(breakage_distance), max_route_distance_factor_(max_route_distance_factor),
       max_route_time_factor_(max_route_time_factor),
@@ -44,14 +43,12 @@ TransitionCostModel::TransitionCostModel(baldr::GraphReader& graphreader,
 
 TransitionCostModel::TransitionCostModel(baldr::GraphReader& graphreader,
                                          const IViterbiSearch& vs,
-                                         const TopKSearch& ts,
                                          const StateContainer& container,
                                          const sif::mode_costing_t& mode_costing,
                                          const sif::TravelMode travelmode,
                                          const Config::TransitionCost& config)
     : TransitionCostModel(graphreader,
                           vs,
-                          ts,
                           container,
                           mode_costing,
                           travelmode,
@@ -93,9 +90,7 @@ void TransitionCostModel::UpdateRoute(const StateId& lhs, const StateId& rhs) co
   const Label* edgelabel = nullptr;
   const auto& prev_stateid = vs_.Predecessor(left.stateid());
   if (prev_stateid.IsValid()) {
-    const auto& original_prev_stateid = ts_.GetOrigin(prev_stateid);
-    const auto& prev_state =
-        container_.state(original_prev_stateid.IsValid() ? original_prev_stateid : prev_stateid);
+    const auto& prev_state = container_.state(prev_stateid);
     if (!prev_state.routed()) {
       // When ViterbiSearch calls this method, the left state is
       // guaranteed to be optimal, its predecessor is therefore
@@ -2,6 +2,7 @@
 
 #include <algorithm>
 #include <string>
+#include <tuple>
 
 namespace valhalla {
 namespace meili {
@@ -617,5 +618,236 @@ constexpr bool ViterbiSearch::IsInvalidCost(double cost) {
   return cost < 0.f;
 }
 
+KBestViterbiSearch::KBestViterbiSearch(uint32_t k) : k_(k) {
+  if (k_ == 0) {
+    throw std::invalid_argument("expect k to be positive");
+  }
+}
+
+KBestViterbiSearch::~KBestViterbiSearch() {
+  Clear();
+}
+
+void KBestViterbiSearch::Clear() {
+  IViterbiSearch::Clear();
+  states_by_time.clear();
+  ClearSearch();
+}
+
+void KBestViterbiSearch::ClearSearch() {
+  labels_by_time_.clear();
+  ranked_labels_by_time_.clear();
+  winner_by_time.clear();
+}
+
+bool KBestViterbiSearch::AddStateId(const StateId& stateid) {
+  if (!IViterbiSearch::AddStateId(stateid)) {
+    return false;
+  }
+
+  if (states_by_time.size() <= stateid.time()) {
+    states_by_time.resize(stateid.time() + 1);
+  }
+
+  states_by_time[stateid.time()].push_back(stateid);
+
+  return true;
+}
+
+bool KBestViterbiSearch::RemoveStateId(const StateId& stateid) {
+  if (!IViterbiSearch::RemoveStateId(stateid)) {
+    return false;
+  }
+
+  auto& column = states_by_time[stateid.time()];
+  const auto it = std::find(column.begin(), column.end(), stateid);
+  if (it == column.end()) {
+    throw std::logic_error("the state must exist in the column");
+  }
+  column.erase(it);
+
+  return true;
+}
+
+StateId KBestViterbiSearch::SearchWinner(StateId::Time time) {
+  if (states_by_time.size() <= time) {
+    return {};
+  }
+
+  if (time < winner_by_time.size()) {
+    return winner_by_time[time];
+  }
+
+  ForwardTo(time);
+  for (StateId::Time t = winner_by_time.size(); t <= time; ++t) {
+    const auto& ranked = RankedLabels(t);
+    winner_by_time.push_back(ranked.empty() ? StateId() : states_by_time[t][ranked.front().first]);
+  }
+
+  return winner_by_time[time];
+}
+
+StateId KBestViterbiSearch::Predecessor(const StateId& stateid) const {
+  const auto* label = GetLabel(stateid);
+  if (!label || label->predecessor == kNoPredecessor) {
+    return {};
+  }
+  return states_by_time[stateid.time() - 1][label->predecessor];
+}
+
+double KBestViterbiSearch::AccumulatedCost(const StateId& stateid) const {
+  const auto* label = GetLabel(stateid);
+  return label ? label->costsofar : -1.f;
+}
+
+std::vector<StateId> KBestViterbiSearch::SearchPath(StateId::Time time, uint32_t rank) {
+  if (states_by_time.size() <= time || k_ <= rank) {
+    return {};
+  }
+
+  ForwardTo(time);
+  const auto& ranked = RankedLabels(time);
+  if (ranked.size() <= rank) {
+    return {};
+  }
+
+  // Follow the predecessors back to the first state
+  std::vector<StateId> path(time + 1);
+  auto [index, label_rank] = ranked[rank];
+  for (auto t = static_cast<int64_t>(time); 0 <= t; --t) {
+    path[t] = states_by_time[t][index];
+    const auto& label = labels_by_time_[t][index][label_rank];
+    index = label.predecessor;
+    label_rank = label.predecessor_rank;
+  }
+
+  return path;
+}
+
+double KBestViterbiSearch::PathCost(StateId::Time time, uint32_t rank) {
+  if (states_by_time.size() <= time || k_ <= rank) {
+    return -1.f;
+  }
+
+  ForwardTo(time);
+  const auto& ranked = RankedLabels(time);
+  if (ranked.size() <= rank) {
+    return -1.f;
+  }
+  const auto [index, label_rank] = ranked[rank];
+  return labels_by_time_[time][index][label_rank].costsofar;
+}
+
+void KBestViterbiSearch::ForwardTo(StateId::Time target) {
+  const auto by_cost = [](const Label& a, const Label& b) {
+    return std::tie(a.costsofar, a.predecessor, a.predecessor_rank) <
+           std::tie(b.costsofar, b.predecessor, b.predecessor_rank);
+  };
+
+  for (StateId::Time time = labels_by_time_.size(); time <= target; ++time) {
+    const auto& column = states_by_time[time];
+    std::vector<std::vector<Label>> labels(column.size());
+
+    std::vector<float> emission_costs(column.size());
+    for (size_t i = 0; i < column.size(); ++i) {
+      emission_costs[i] = EmissionCost(column[i]);
+    }
+
+    if (time == 0) {
+      for (size_t i = 0; i < column.size(); ++i) {
+        if (0.f <= emission_costs[i]) {
+          labels[i].push_back({emission_costs[i], kNoPredecessor, 0});
+        }
+      }
+      labels_by_time_.push_back(std::move(labels));
+      continue;
+    }
+
+    // Extend every label of the previous column to the states it can transition to, only states
+    // with a valid emission cost can be reached
+    const auto& prev_column = states_by_time[time - 1];
+    const auto& prev_labels = labels_by_time_[time - 1];
+    for (uint32_t p = 0; p < prev_column.size(); ++p) {
+      if (prev_labels[p].empty()) {
+        continue;
+      }
+      for (size_t i = 0; i < column.size(); ++i) {
+        if (emission_costs[i] < 0.f) {
+          continue;
+        }
+        const auto transition_cost = TransitionCost(prev_column[p], column[i]);
+        if (transition_cost < 0.f) {
+          continue;
+        }
+        for (uint32_t r = 0; r < prev_labels[p].size(); ++r) {
+          labels[i].push_back({CostSofar(prev_labels[p][r].costsofar, transition_cost,
+                                         emission_costs[i]),
+                               p, r});
+        }
+      }
+    }
+
+    // Keep the best k of them
+    for (auto& state_labels : labels) {
+      if (k_ < state_labels.size()) {
+        std::partial_sort(state_labels.begin(), state_labels.begin() + k_, state_labels.end(),
+                          by_cost);
+        state_labels.resize(k_);
+      } else {
+        std::sort(state_labels.begin(), state_labels.end(), by_cost);
+      }
+    }
+
+    labels_by_time_.push_back(std::move(labels));
+  }
+}
+
+const std::vector<KBestViterbiSearch::LabelRef>&
+KBestViterbiSearch::RankedLabels(StateId::Time time) {
+  if (ranked_labels_by_time_.size() <= time) {
+    ranked_labels_by_time_.resize(time + 1);
+  }
+
+  auto& ranked = ranked_labels_by_time_[time];
+  if (!ranked.empty()) {
+    return ranked;
+  }
+
+  const auto& labels = labels_by_time_[time];
+  for (uint32_t i = 0; i < labels.size(); ++i) {
+    for (uint32_t r = 0; r < labels[i].size(); ++r) {
+      ranked.emplace_back(i, r);
+    }
+  }
+
+  // The k best labels of the column are the k best paths ending at it
+  const auto by_cost = [&labels](const LabelRef& a, const LabelRef& b) {
+    const auto& la = labels[a.first][a.second];
+    const auto& lb = labels[b.first][b.second];
+    return std::tie(la.costsofar, a) < std::tie(lb.costsofar, b);
+  };
+  if (k_ < ranked.size()) {
+    std::partial_sort(ranked.begin(), ranked.begin() + k_, ranked.end(), by_cost);
+    ranked.resize(k_);
+  } else {
+    std::sort(ranked.begin(), ranked.end(), by_cost);
+  }
+
+  return ranked;
+}
+
+const KBestViterbiSearch::Label* KBestViterbiSearch::GetLabel(const StateId& stateid) const {
+  if (!stateid.IsValid() || labels_by_time_.size() <= stateid.time()) {
+    return nullptr;
+  }
+  const auto& column = states_by_time[stateid.time()];
+  const auto it = std::find(column.begin(), column.end(), stateid);
+  if (it == column.end()) {
+    return nullptr;
+  }
+  const auto& labels = labels_by_time_[stateid.time()][it - column.begin()];
+  return labels.empty() ? nullptr : &labels.front();
+}
+
 } // namespace meili
 } // namespace valhalla
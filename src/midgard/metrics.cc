@@ -0,0 +1,233 @@
+#include "midgard/metrics.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+using namespace valhalla::midgard::metrics;
+
+// the le buckets of the prometheus histograms are the powers of two from 16us to about a minute
+constexpr uint32_t kFirstBoundBits = 4;
+constexpr uint32_t kLastBoundBits = 26;
+
+// what a single thread records, only that thread ever writes to it
+struct shard_t {
+  struct stage_counts_t {
+    std::atomic<uint64_t> count{0};
+    std::atomic<uint64_t> sum{0};
+    std::atomic<uint64_t> max{0};
+    std::array<std::atomic<uint64_t>, histogram_t::kBuckets> buckets{};
+  };
+  std::array<stage_counts_t, kStageCount> stages;
+  std::array<std::atomic<uint64_t>, kCounterCount> counters{};
+};
+
+// there is a single writer so there is no need for a read modify write, the atomic only keeps the
+// snapshots from reading torn values
+inline void add(std::atomic<uint64_t>& value, uint64_t n) {
+  value.store(value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+// adds what a shard recorded to a snapshot
+void fold(const shard_t& shard, snapshot_t& snapshot) {
+  for (size_t s = 0; s < kStageCount; ++s) {
+    const auto& from = shard.stages[s];
+    auto& to = snapshot.stages[s];
+    to.count += from.count.load(std::memory_order_relaxed);
+    to.sum += from.sum.load(std::memory_order_relaxed);
+    to.max = std::max(to.max, from.max.load(std::memory_order_relaxed));
+    for (size_t b = 0; b < histogram_t::kBuckets; ++b) {
+      to.buckets[b] += from.buckets[b].load(std::memory_order_relaxed);
+    }
+  }
+  for (size_t c = 0; c < kCounterCount; ++c) {
+    snapshot.counters[c] += shard.counters[c].load(std::memory_order_relaxed);
+  }
+}
+
+struct registry_t {
+  std::mutex lock;
+  std::vector<const shard_t*> shards;
+  // what the threads that are gone recorded
+  snapshot_t retired;
+};
+
+// never destroyed, threads may still record while the process exits
+registry_t& registry() {
+  static auto* registry = new registry_t;
+  return *registry;
+}
+
+// the shard of a thread, folded into the retired total when the thread exits
+struct local_shard_t {
+  ~local_shard_t() {
+    if (!shard) {
+      return;
+    }
+    auto& all = registry();
+    std::lock_guard<std::mutex> lock(all.lock);
+    fold(*shard, all.retired);
+    all.shards.erase(std::find(all.shards.begin(), all.shards.end(), shard.get()));
+  }
+  std::unique_ptr<shard_t> shard;
+};
+
+thread_local local_shard_t local_shard;
+
+shard_t& shard() {
+  // the first time a thread records it registers its shard
+  if (!local_shard.shard) {
+    local_shard.shard = std::make_unique<shard_t>();
+    auto& all = registry();
+    std::lock_guard<std::mutex> lock(all.lock);
+    all.shards.push_back(local_shard.shard.get());
+  }
+  return *local_shard.shard;
+}
+
+const std::array<std::string, kStageCount> kStageNames{
+    "parse", "search", "reach", "path", "trip_leg", "maneuvers", "narrative", "serialize",
+};
+
+const std::array<std::string, kCounterCount> kCounterNames{
+    "tile_cache_hits",
+    "tile_cache_misses",
+    "labels_settled",
+};
+
+const std::array<std::string, kCounterCount> kCounterHelp{
+    "Graph tiles found in the cache of a graph reader",
+    "Graph tiles not found in the cache of a graph reader",
+    "Edge labels settled by the path algorithms",
+};
+
+} // namespace
+
+namespace valhalla {
+namespace midgard {
+namespace metrics {
+
+const std::string& to_string(stage_t stage) {
+  return kStageNames[static_cast<size_t>(stage)];
+}
+
+const std::string& to_string(counter_t counter) {
+  return kCounterNames[static_cast<size_t>(counter)];
+}
+
+size_t histogram_t::bucket(uint64_t value) {
+  value = std::min<uint64_t>(value, (uint64_t(1) << kMaxBits) - 1);
+  if (value < kSubBuckets) {
+    return value;
+  }
+  // which power of two and which of its sub buckets
+  const uint32_t magnitude = std::bit_width(value) - 1;
+  return (magnitude - kSubBits + 1) * kSubBuckets + (value >> (magnitude - kSubBits)) - kSubBuckets;
+}
+
+uint64_t histogram_t::lower_bound(size_t bucket) {
+  if (bucket < kSubBuckets) {
+    return bucket;
+  }
+  const uint32_t magnitude = bucket / kSubBuckets + kSubBits - 1;
+  return (kSubBuckets + bucket % kSubBuckets) << (magnitude - kSubBits);
+}
+
+uint64_t histogram_t::upper_bound(size_t bucket) {
+  if (bucket < kSubBuckets) {
+    return bucket;
+  }
+  const uint32_t magnitude = bucket / kSubBuckets + kSubBits - 1;
+  return lower_bound(bucket) + (uint64_t(1) << (magnitude - kSubBits)) - 1;
+}
+
+uint64_t histogram_t::quantile(double q) const {
+  if (count == 0) {
+    return 0;
+  }
+  const auto rank =
+      std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(std::clamp(q, 0.0, 1.0) * count)));
+  uint64_t seen = 0;
+  for (size_t i = 0; i < buckets.size(); ++i) {
+    seen += buckets[i];
+    if (seen >= rank) {
+      return std::min(upper_bound(i), max);
+    }
+  }
+  return max;
+}
+
+uint64_t histogram_t::below(uint64_t bound) const {
+  uint64_t total = 0;
+  for (size_t i = 0; i < buckets.size() && upper_bound(i) < bound; ++i) {
+    total += buckets[i];
+  }
+  return total;
+}
+
+void record(stage_t stage, std::chrono::steady_clock::duration elapsed) {
+  const auto micros = static_cast<uint64_t>(
+      std::max<int64_t>(0, std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count()));
+  auto& counts = shard().stages[static_cast<size_t>(stage)];
+  add(counts.count, 1);
+  add(counts.sum, micros);
+  add(counts.buckets[histogram_t::bucket(micros)], 1);
+  if (micros > counts.max.load(std::memory_order_relaxed)) {
+    counts.max.store(micros, std::memory_order_relaxed);
+  }
+}
+
+void count(counter_t counter, uint64_t n) {
+  add(shard().counters[static_cast<size_t>(counter)], n);
+}
+
+snapshot_t snapshot() {
+  auto& all = registry();
+  std::lock_guard<std::mutex> lock(all.lock);
+  snapshot_t snapshot = all.retired;
+  for (const auto* shard : all.shards) {
+    fold(*shard, snapshot);
+  }
+  return snapshot;
+}
+
+std::string to_prometheus(const snapshot_t& snapshot) {
+  std::string text;
+  text += "# HELP valhalla_stage_latency_seconds How long the stages of the requests took\n";
+  text += "# TYPE valhalla_stage_latency_seconds histogram\n";
+  for (size_t s = 0; s < kStageCount; ++s) {
+    const auto& histogram = snapshot.stages[s];
+    const auto labels = "{stage=\"" + kStageNames[s] + "\"";
+    // microseconds have 6 decimals as seconds, the buckets are read at different times than the
+    // count so none is let past it
+    for (uint32_t bits = kFirstBoundBits; bits <= kLastBoundBits; ++bits) {
+      const uint64_t bound = uint64_t(1) << bits;
+      text += "valhalla_stage_latency_seconds_bucket" + labels + ",le=\"" +
+              std::to_string(bound / 1e6) + "\"} " +
+              std::to_string(std::min(histogram.below(bound), histogram.count)) + "\n";
+    }
+    text += "valhalla_stage_latency_seconds_bucket" + labels + ",le=\"+Inf\"} " +
+            std::to_string(histogram.count) + "\n";
+    text += "valhalla_stage_latency_seconds_sum" + labels + "} " +
+            std::to_string(histogram.sum / 1e6) + "\n";
+    text += "valhalla_stage_latency_seconds_count" + labels + "} " +
+            std::to_string(histogram.count) + "\n";
+  }
+  for (size_t c = 0; c < kCounterCount; ++c) {
+    const auto name = "valhalla_" + kCounterNames[c] + "_total";
+    text += "# HELP " + name + " " + kCounterHelp[c] + "\n";
+    text += "# TYPE " + name + " counter\n";
+    text += name + " " + std::to_string(snapshot.counters[c]) + "\n";
+  }
+  return text;
+}
+
+} // namespace metrics
+} // namespace midgard
+} // namespace valhalla
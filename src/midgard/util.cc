@@ -301,6 +301,14 @@ bool memory_status::supported() {
   return stat("/proc/self/status", &s) == 0;
 }
 
+bool memory_status::reset_peak() {
+  // writing 5 to clear_refs resets the peak rss of the process, see proc(5)
+  std::ofstream file("/proc/self/clear_refs");
+  file << "5";
+  file.flush();
+  return static_cast<bool>(file);
+}
+
 std::ostream& operator<<(std::ostream& stream, const memory_status& s) {
   for (const auto& metric : s.metrics) {
     stream << metric.first << ": " << metric.second.first << metric.second.second << std::endl;
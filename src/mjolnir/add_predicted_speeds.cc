@@ -4,15 +4,15 @@
 #include "baldr/predictedspeeds.h"
 #include "midgard/util.h"
 #include "mjolnir/graphtilebuilder.h"
+#include "mjolnir/tilescheduler.h"
 
 #include <boost/property_tree/ptree.hpp>
 #include <boost/tokenizer.hpp>
 
+#include <atomic>
 #include <filesystem>
 #include <fstream>
-#include <future>
 #include <iomanip>
-#include <random>
 #include <sstream>
 #include <thread>
 #include <unordered_map>
@@ -220,29 +220,31 @@ void UpdateTile(const std::string& tile_dir,
  * <quadtreeID>.freeflow.csv. (e.g., 1202021.constrained.csv and 1202021.freeflow.csv)
  */
 void UpdateTiles(const std::string& tile_dir,
-                 std::vector<std::pair<GraphId, std::vector<std::string>>>::const_iterator tile_start,
-                 std::vector<std::pair<GraphId, std::vector<std::string>>>::const_iterator tile_end,
-                 std::promise<TrafficStats>& result) {
+                 const std::unordered_map<GraphId, std::vector<std::string>>& traffic_tiles,
+                 TileScheduler& scheduler,
+                 size_t worker,
+                 std::atomic<size_t>& finished,
+                 TrafficStats& result) {
 
   std::stringstream thread_name;
   thread_name << std::this_thread::get_id();
 
-  // Iterate through the tiles and parse them
-  [[maybe_unused]] size_t total = tile_end - tile_start;
-  [[maybe_unused]] double count = 0;
+  // Iterate through the tiles handed to us and parse them
+  [[maybe_unused]] double total = traffic_tiles.size();
   TrafficStats stat{};
-  for (; tile_start != tile_end; ++tile_start) {
-    LOG_INFO(thread_name.str() + " parsing traffic data for " + std::to_string(tile_start->first));
-    auto traffic = ParseTrafficFile(tile_start->second, stat);
-    LOG_INFO(thread_name.str() + " add traffic data to " + std::to_string(tile_start->first));
-    UpdateTile(tile_dir, tile_start->first, traffic, stat);
-    LOG_INFO(thread_name.str() + " finished " + std::to_string(tile_start->first) + "(" +
-             std::to_string(++count / total * 100.0) + ")");
+  GraphId tile_id;
+  while (scheduler.Next(worker, tile_id)) {
+    LOG_INFO(thread_name.str() + " parsing traffic data for " + std::to_string(tile_id));
+    auto traffic = ParseTrafficFile(traffic_tiles.at(tile_id), stat);
+    LOG_INFO(thread_name.str() + " add traffic data to " + std::to_string(tile_id));
+    UpdateTile(tile_dir, tile_id, traffic, stat);
+    LOG_INFO(thread_name.str() + " finished " + std::to_string(tile_id) + "(" +
+             std::to_string(++finished / total * 100.0) + ")");
   }
 
-  result.set_value(stat);
+  result = stat;
 }
-std::vector<std::pair<GraphId, std::vector<std::string>>>
+std::unordered_map<GraphId, std::vector<std::string>>
 PrepareTrafficTiles(const std::filesystem::path& traffic_tile_dir) {
   std::unordered_map<GraphId, std::vector<std::string>> files_per_tile;
   for (std::filesystem::recursive_directory_iterator i(traffic_tile_dir), end; i != end; ++i) {
@@ -259,13 +261,7 @@ PrepareTrafficTiles(const std::filesystem::path& traffic_tile_dir) {
     }
   }
 
-  std::vector<std::pair<GraphId, std::vector<std::string>>> traffic_tiles(files_per_tile.begin(),
-                                                                          files_per_tile.end());
-
-  std::random_device rd;
-  std::shuffle(traffic_tiles.begin(), traffic_tiles.end(), std::mt19937(rd()));
-
-  return traffic_tiles;
+  return files_per_tile;
 }
 
 void GenerateSummary(const boost::property_tree::ptree& config) {
@@ -367,36 +363,34 @@ void ProcessTrafficTiles(const std::string& tile_dir,
                          const bool summary,
                          const boost::property_tree::ptree& config) {
 
-  std::vector<std::shared_ptr<std::thread>> threads(config.get<uint32_t>("mjolnir.concurrency"));
-  std::list<std::promise<TrafficStats>> results;
   auto traffic_tiles = PrepareTrafficTiles(traffic_tile_dir);
   LOG_INFO("Parsing speeds from " + std::to_string(traffic_tiles.size()) + " tiles.");
-  size_t floor = traffic_tiles.size() / threads.size();
-  size_t at_ceiling = traffic_tiles.size() - (threads.size() * floor);
-  auto tile_end = traffic_tiles.begin();
 
-  // Distribute work across threads
-  for (size_t i = 0; i < threads.size(); ++i) {
-    auto tile_start = tile_end;
-    tile_end += (i < at_ceiling ? floor + 1 : floor);
-    results.emplace_back();
-    threads[i] = std::make_shared<std::thread>(UpdateTiles, tile_dir, tile_start, tile_end,
-                                               std::ref(results.back()));
+  // Parsing the traffic files takes the most time, so the tiles with the most traffic data go first
+  std::vector<std::pair<GraphId, uint64_t>> tiles;
+  for (const auto& [tile_id, files] : traffic_tiles) {
+    uint64_t size = 0;
+    for (const auto& file : files) {
+      std::error_code ec;
+      auto file_size = std::filesystem::file_size(file, ec);
+      size += ec ? 0 : file_size;
+    }
+    tiles.emplace_back(tile_id, size);
   }
+  TileScheduler scheduler("predicted traffic", std::move(tiles),
+                          config.get<uint32_t>("mjolnir.concurrency"));
 
-  // Wait for threads to complete
-  for (auto& thread : threads)
-    thread->join();
+  // Distribute work across threads
+  std::vector<TrafficStats> results(scheduler.concurrency());
+  std::atomic<size_t> finished(0);
+  scheduler.Run([&](size_t worker) {
+    UpdateTiles(tile_dir, traffic_tiles, scheduler, worker, finished, results[worker]);
+  });
 
   // Aggregate thread results
   TrafficStats final_stats{};
-  for (auto& result : results) {
-    try {
-      auto thread_stats = result.get_future().get();
-      final_stats += thread_stats;
-    } catch (std::exception& e) {
-      // TODO: throw further up the chain?
-    }
+  for (const auto& thread_stats : results) {
+    final_stats += thread_stats;
   }
   // Log processing results
   LOG_INFO("Parsed " + std::to_string(final_stats.constrained_count) +
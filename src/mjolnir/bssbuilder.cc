@@ -10,6 +10,7 @@
 #include "midgard/util.h"
 #include "mjolnir/graphtilebuilder.h"
 #include "mjolnir/osmdata.h"
+#include "mjolnir/tilescheduler.h"
 #include "scoped_timer.h"
 
 #include <boost/property_tree/ptree.hpp>
@@ -354,26 +355,27 @@ void add_bss_nodes_and_edges(GraphTileBuilder& tilebuilder_local,
 
 void project_and_add_bss_nodes(const boost::property_tree::ptree& pt,
                                std::mutex& lock,
-                               bss_by_tile_t::const_iterator tile_start,
-                               bss_by_tile_t::const_iterator tile_end,
+                               const bss_by_tile_t& bss_by_tile,
+                               TileScheduler& scheduler,
+                               size_t worker,
                                const OSMData& osm_data,
                                std::vector<BSSConnection>& all) {
 
   GraphReader reader_local_level(pt);
-  for (; tile_start != tile_end; ++tile_start) {
+  GraphId tile_id;
+  while (scheduler.Next(worker, tile_id)) {
 
     graph_tile_ptr local_tile = nullptr;
     std::unique_ptr<GraphTileBuilder> tilebuilder_local = nullptr;
     {
       std::lock_guard<std::mutex> l(lock);
 
-      auto tile_id = tile_start->first;
       local_tile = reader_local_level.GetGraphTile(tile_id);
       tilebuilder_local =
           std::make_unique<GraphTileBuilder>(reader_local_level.tile_dir(), tile_id, true);
     }
 
-    auto new_connections = project(*local_tile, tile_start->second);
+    auto new_connections = project(*local_tile, bss_by_tile.at(tile_id));
     add_bss_nodes_and_edges(*tilebuilder_local, *local_tile, osm_data, lock, new_connections);
     {
       std::lock_guard<std::mutex> l{lock};
@@ -506,23 +508,24 @@ void create_edges(GraphTileBuilder& tilebuilder_local,
 void create_edges_from_way_node(
     const boost::property_tree::ptree& pt,
     std::mutex& lock,
-    std::unordered_map<GraphId, std::vector<BSSConnection>>::const_iterator tile_start,
-    std::unordered_map<GraphId, std::vector<BSSConnection>>::const_iterator tile_end) {
+    const std::unordered_map<GraphId, std::vector<BSSConnection>>& connections_by_tile,
+    TileScheduler& scheduler,
+    size_t worker) {
 
   GraphReader reader_local_level(pt);
-  for (; tile_start != tile_end; ++tile_start) {
+  GraphId tile_id;
+  while (scheduler.Next(worker, tile_id)) {
 
     graph_tile_ptr local_tile = nullptr;
     std::unique_ptr<GraphTileBuilder> tilebuilder_local = nullptr;
     {
       std::lock_guard<std::mutex> l(lock);
 
-      auto tile_id = tile_start->first;
       local_tile = reader_local_level.GetGraphTile(tile_id);
       tilebuilder_local =
           std::make_unique<GraphTileBuilder>(reader_local_level.tile_dir(), tile_id, true);
     }
-    create_edges(*tilebuilder_local, *local_tile, lock, tile_start->second);
+    create_edges(*tilebuilder_local, *local_tile, lock, connections_by_tile.at(tile_id));
   }
 }
 
@@ -624,7 +627,15 @@ void BssBuilder::Build(const boost::property_tree::ptree& pt,
   size_t nb_threads =
       std::max(static_cast<uint32_t>(1),
                pt.get<uint32_t>("mjolnir.concurrency", std::thread::hardware_concurrency()));
-  std::vector<std::shared_ptr<std::thread>> threads(nb_threads);
+
+  // Largest tiles first, so that the threads finish at about the same time
+  const auto tiles_by_size = [&reader](const auto& by_tile) {
+    std::vector<std::pair<GraphId, uint64_t>> tiles;
+    for (const auto& tile : by_tile) {
+      tiles.emplace_back(tile.first, TileScheduler::TileSize(reader.tile_dir(), tile.first));
+    }
+    return tiles;
+  };
 
   // An atomic object we can use to do the synchronization
   std::mutex lock;
@@ -636,27 +647,11 @@ void BssBuilder::Build(const boost::property_tree::ptree& pt,
 
   std::vector<BSSConnection> all;
   {
-    size_t floor = bss_by_tile.size() / threads.size();
-    size_t at_ceiling = bss_by_tile.size() - (threads.size() * floor);
-    bss_by_tile_t::const_iterator tile_start, tile_end = bss_by_tile.begin();
-
-    for (size_t i = 0; i < threads.size(); ++i) {
-      // Figure out how many this thread will work on (either ceiling or floor)
-      size_t tile_count = (i < at_ceiling ? floor + 1 : floor);
-      // Where the range begins
-      tile_start = tile_end;
-      // Where the range ends
-      std::advance(tile_end, tile_count);
-      // Make the thread
-      threads[i] =
-          std::make_shared<std::thread>(project_and_add_bss_nodes, std::cref(pt.get_child("mjolnir")),
-                                        std::ref(lock), tile_start, tile_end, std::cref(osmdata),
-                                        std::ref(all));
-    }
-
-    for (auto& thread : threads) {
-      thread->join();
-    }
+    TileScheduler scheduler("bss stations", tiles_by_size(bss_by_tile), nb_threads);
+    scheduler.Run([&](size_t worker) {
+      project_and_add_bss_nodes(pt.get_child("mjolnir"), lock, bss_by_tile, scheduler, worker,
+                                osmdata, all);
+    });
   }
 
   // the collection is sorted so that the search will be much faster later.
@@ -680,27 +675,10 @@ void BssBuilder::Build(const boost::property_tree::ptree& pt,
   }
 
   {
-    size_t floor = map.size() / threads.size();
-    size_t at_ceiling = map.size() - (threads.size() * floor);
-    std::unordered_map<GraphId, std::vector<BSSConnection>>::const_iterator tile_start,
-        tile_end = map.begin();
-
-    for (size_t i = 0; i < threads.size(); ++i) {
-      // Figure out how many this thread will work on (either ceiling or floor)
-      size_t tile_count = (i < at_ceiling ? floor + 1 : floor);
-      // Where the range begins
-      tile_start = tile_end;
-      // Where the range ends
-      std::advance(tile_end, tile_count);
-      // Make the thread
-      threads[i] = std::make_shared<std::thread>(create_edges_from_way_node,
-                                                 std::cref(pt.get_child("mjolnir")), std::ref(lock),
-                                                 tile_start, tile_end);
-    }
-
-    for (auto& thread : threads) {
-      thread->join();
-    }
+    TileScheduler scheduler("bss edges", tiles_by_size(map), nb_threads);
+    scheduler.Run([&](size_t worker) {
+      create_edges_from_way_node(pt.get_child("mjolnir"), lock, map, scheduler, worker);
+    });
   }
 }
 
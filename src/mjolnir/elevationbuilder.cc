@@ -7,6 +7,7 @@
 #include "midgard/pointll.h"
 #include "midgard/util.h"
 #include "mjolnir/graphtilebuilder.h"
+#include "mjolnir/tilescheduler.h"
 #include "mjolnir/util.h"
 #include "scoped_timer.h"
 #include "skadi/sample.h"
@@ -15,7 +16,6 @@
 #include <boost/property_tree/ptree.hpp>
 
 #include <filesystem>
-#include <random>
 #include <thread>
 #include <utility>
 
@@ -274,10 +274,11 @@ void add_elevations_to_single_tile(GraphReader& graphreader,
 }
 
 /**
- * Adds elevation to a set of tiles. Each thread pulls a tile of the queue
+ * Adds elevation to a set of tiles. Each thread takes tiles from the scheduler
  */
 void add_elevations_to_multiple_tiles(const boost::property_tree::ptree& pt,
-                                      std::deque<GraphId>& tilequeue,
+                                      TileScheduler& scheduler,
+                                      size_t worker,
                                       std::mutex& lock,
                                       const std::unique_ptr<valhalla::skadi::sample>& sample) {
   // Local Graphreader
@@ -289,17 +290,8 @@ void add_elevations_to_multiple_tiles(const boost::property_tree::ptree& pt,
   cache_t geo_attribute_cache;
 
   // Check for more tiles
-  while (true) {
-    lock.lock();
-    if (tilequeue.empty()) {
-      lock.unlock();
-      break;
-    }
-    // Get the next tile Id
-    GraphId tile_id = tilequeue.front();
-    tilequeue.pop_front();
-    lock.unlock();
-
+  GraphId tile_id;
+  while (scheduler.Next(worker, tile_id)) {
     add_elevations_to_single_tile(graphreader, lock, geo_attribute_cache, sample, tile_id);
   }
 }
@@ -307,14 +299,11 @@ void add_elevations_to_multiple_tiles(const boost::property_tree::ptree& pt,
 std::deque<GraphId> get_tile_ids(const boost::property_tree::ptree& pt) {
   std::deque<GraphId> tilequeue;
   GraphReader reader(pt.get_child("mjolnir"));
-  // Create a randomized queue of tiles (at all levels) to work from
+  // Create a queue of tiles (at all levels) to work from
   auto tileset = reader.GetTileSet();
   for (const auto& id : tileset)
     tilequeue.emplace_back(id);
 
-  std::random_device rd;
-  std::shuffle(tilequeue.begin(), tilequeue.end(), std::mt19937(rd()));
-
   return tilequeue;
 }
 
@@ -341,19 +330,20 @@ void ElevationBuilder::Build(const boost::property_tree::ptree& pt,
   if (tile_ids.empty())
     tile_ids = get_tile_ids(pt);
 
-  std::vector<std::shared_ptr<std::thread>> threads(nthreads);
+  // Largest tiles first, so that the threads finish at about the same time
+  const auto tile_dir = pt.get<std::string>("mjolnir.tile_dir");
+  std::vector<std::pair<GraphId, uint64_t>> tiles;
+  for (const auto& tile_id : tile_ids) {
+    tiles.emplace_back(tile_id, TileScheduler::TileSize(tile_dir, tile_id));
+  }
 
   LOG_INFO("Adding elevation to " + std::to_string(tile_ids.size()) + " tiles with " +
            std::to_string(nthreads) + " threads...");
   std::mutex lock;
-  for (auto& thread : threads) {
-    thread = std::make_shared<std::thread>(add_elevations_to_multiple_tiles, std::cref(pt),
-                                           std::ref(tile_ids), std::ref(lock), std::ref(sample));
-  }
-
-  for (auto& thread : threads) {
-    thread->join();
-  }
+  TileScheduler scheduler("elevation", std::move(tiles), nthreads);
+  scheduler.Run([&](size_t worker) {
+    add_elevations_to_multiple_tiles(pt, scheduler, worker, lock, sample);
+  });
 
   LOG_INFO("Finished");
 }
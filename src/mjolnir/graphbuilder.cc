@@ -24,7 +24,9 @@
 #include <boost/format.hpp>
 #include <boost/property_tree/ptree.hpp>
 
+#include <algorithm>
 #include <filesystem>
+#include <format>
 #include <future>
 #include <memory>
 #include <thread>
@@ -36,26 +38,65 @@ using namespace valhalla::mjolnir;
 
 namespace {
 
+// Rough number of bytes it takes to build a tile per node (duplicates included) in it: the nodes,
+// edges and way nodes paged in from the sequences plus the tile builder's copy of all of it
+constexpr size_t kBuildBytesPerNode = 1024;
+
+// Number of elements each thread may sort in memory at once so that all threads together stay
+// within the memory budget. The stable sort needs a scratch buffer as large as what it sorts, so
+// each thread gets half of its share. Without a budget the sequence splits its default between the
+// threads. Below a MB per thread the merge of the many sorted runs would cost more than the memory
+// it saves
+template <typename T> size_t sort_buffer_size(size_t max_memory, unsigned int concurrency) {
+  if (max_memory == 0) {
+    return 0;
+  }
+  return std::clamp<size_t>(max_memory / concurrency / 2 / sizeof(T), 1024 * 1024 / sizeof(T),
+                            sequence<T>::sort_buffer_size);
+}
+
+// Current and peak resident set size for logging, empty if the os cant tell us
+std::string resident_memory() {
+  if (!memory_status::supported()) {
+    return "";
+  }
+  memory_status status({"VmRSS", "VmHWM"});
+  std::string usage;
+  for (const auto& [name, label] : {std::pair{"VmRSS", "RSS"}, std::pair{"VmHWM", "peak RSS"}}) {
+    auto metric = status.metrics.find(name);
+    if (metric != status.metrics.end()) {
+      usage += std::format("{}{} {:.1f}{}", usage.empty() ? "" : ", ", label,
+                           metric->second.first, metric->second.second);
+    }
+  }
+  return usage;
+}
+
 /**
  * we need the nodes to be sorted by graphid and then by osmid to make a set of tiles
  * we also need to then update the edges that pointed to them
  */
-std::map<GraphId, size_t> SortGraph(const std::string& nodes_file, const std::string& edges_file) {
+std::map<GraphId, size_t> SortGraph(const std::string& nodes_file,
+                                    const std::string& edges_file,
+                                    unsigned int concurrency,
+                                    size_t max_memory) {
   LOG_INFO("Sorting graph...");
 
   // Sort nodes by graphid then by grid within the tile. This sorts nodes geo-spatially which
   // helps performance by improving memory coherence.
   sequence<Node> nodes(nodes_file, false);
-  nodes.sort([](const Node& a, const Node& b) {
-    if (a.graph_id == b.graph_id) {
-      if (a.grid_id == b.grid_id) {
-        return a.node.osmid_ < b.node.osmid_;
-      } else {
-        return a.grid_id < b.grid_id;
-      }
-    }
-    return a.graph_id < b.graph_id;
-  });
+  nodes.sort(
+      [](const Node& a, const Node& b) {
+        if (a.graph_id == b.graph_id) {
+          if (a.grid_id == b.grid_id) {
+            return a.node.osmid_ < b.node.osmid_;
+          } else {
+            return a.grid_id < b.grid_id;
+          }
+        }
+        return a.graph_id < b.graph_id;
+      },
+      sort_buffer_size<Node>(max_memory, concurrency), concurrency);
 
   // run through the sorted nodes, going back to the edges they reference and updating each edge
   // to point to the first (out of the duplicates) nodes index. at the end of this there will be
@@ -118,8 +159,8 @@ std::map<GraphId, size_t> SortGraph(const std::string& nodes_file, const std::st
   auto cmp = [](const std::pair<uint32_t, uint32_t>& a, const std::pair<uint32_t, uint32_t>& b) {
     return a.first < b.first;
   };
-  starts->sort(cmp);
-  ends->sort(cmp);
+  starts->sort(cmp, sort_buffer_size<std::pair<uint32_t, uint32_t>>(max_memory, 1));
+  ends->sort(cmp, sort_buffer_size<std::pair<uint32_t, uint32_t>>(max_memory, 1));
 
   sequence<Edge> edges(edges_file, false);
 
@@ -1379,6 +1420,7 @@ void BuildLocalTiles(const unsigned int thread_count,
                      const std::string& linguistic_node_file,
                      const std::map<GraphId, size_t>& tiles,
                      const std::string& tile_dir,
+                     const size_t max_memory,
                      DataQuality& stats,
                      const boost::property_tree::ptree& pt) {
   SCOPED_TIMER();
@@ -1388,39 +1430,73 @@ void BuildLocalTiles(const unsigned int thread_count,
 
   const auto ferry_speeds = ComputeFerrySpeeds(ways_file, way_nodes_file);
 
-  LOG_INFO("Building " + std::to_string(tiles.size()) + " tiles with " +
-           std::to_string(thread_count) + " threads...");
-
-  // A place to hold worker threads and their results, be they exceptions or otherwise
-  std::vector<std::shared_ptr<std::thread>> threads(thread_count);
+  // Split the tiles into batches of neighbouring tiles which are estimated to fit into the memory
+  // budget. Every batch gets its own set of threads so that the pages of the node, edge and way
+  // files which a batch mapped in are released again before the next batch starts. Tiles which
+  // are not rebuilt are left out of the tiles, so the nodes of a tile are counted in the node
+  // file, where they follow its first node, rather than up to the next tile
+  std::vector<std::queue<std::pair<GraphId, size_t>>> batches(1);
+  size_t batch_memory = 0;
+  {
+    sequence<Node> nodes(nodes_file, false);
+    for (const auto& tile : tiles) {
+      size_t low = tile.second, high = nodes.size();
+      while (low < high) {
+        const size_t mid = low + (high - low) / 2;
+        if ((*nodes[mid]).graph_id.tile_base() == tile.first) {
+          low = mid + 1;
+        } else {
+          high = mid;
+        }
+      }
+      const size_t tile_memory = (low - tile.second) * kBuildBytesPerNode;
+      if (max_memory && !batches.back().empty() && batch_memory + tile_memory > max_memory) {
+        batches.emplace_back();
+        batch_memory = 0;
+      }
+      batches.back().emplace(tile);
+      batch_memory += tile_memory;
+    }
+  }
 
-  // Hold the results (DataQuality/stats) for the threads
-  std::vector<std::promise<DataQuality>> results(threads.size());
+  LOG_INFO("Building " + std::to_string(tiles.size()) + " tiles in " +
+           std::to_string(batches.size()) + " batches with " + std::to_string(thread_count) +
+           " threads...");
 
-  // Divvy up the work
-  std::queue<std::pair<GraphId, size_t>> tile_queue;
+  // Hold the results (DataQuality/stats) for the threads of all the batches
+  std::vector<std::promise<DataQuality>> results;
+  results.reserve(batches.size() * thread_count);
   std::mutex tile_lock;
-  for (auto id : tiles) {
-    tile_queue.emplace(id);
-  }
+  for (size_t batch = 0; batch < batches.size(); ++batch) {
+    auto& tile_queue = batches[batch];
+
+    // A place to hold worker threads and their results, be they exceptions or otherwise
+    std::vector<std::shared_ptr<std::thread>> threads(
+        std::min<size_t>(thread_count, tile_queue.size()));
+
+    // Atomically pass around stats info
+    for (auto& thread : threads) {
+      // Make the thread
+      results.emplace_back();
+      thread = std::make_shared<std::thread>(
+          BuildTileSet, std::cref(ways_file), std::cref(way_nodes_file), std::cref(nodes_file),
+          std::cref(edges_file), std::cref(complex_from_restriction_file),
+          std::cref(complex_to_restriction_file), std::cref(linguistic_node_file),
+          std::cref(tile_dir), std::cref(osmdata), std::ref(tile_queue), std::ref(tile_lock),
+          tile_creation_date, std::cref(ferry_speeds), std::cref(pt.get_child("mjolnir")),
+          std::ref(results.back()));
+    }
 
-  // Atomically pass around stats info
-  for (size_t i = 0; i < threads.size(); ++i) {
-    // Make the thread
-    threads[i] =
-        std::make_shared<std::thread>(BuildTileSet, std::cref(ways_file), std::cref(way_nodes_file),
-                                      std::cref(nodes_file), std::cref(edges_file),
-                                      std::cref(complex_from_restriction_file),
-                                      std::cref(complex_to_restriction_file),
-                                      std::cref(linguistic_node_file), std::cref(tile_dir),
-                                      std::cref(osmdata), std::ref(tile_queue), std::ref(tile_lock),
-                                      tile_creation_date, std::cref(ferry_speeds),
-                                      std::cref(pt.get_child("mjolnir")), std::ref(results[i]));
-  }
+    // Join all the threads to wait for them to finish up their work
+    for (auto& thread : threads) {
+      thread->join();
+    }
 
-  // Join all the threads to wait for them to finish up their work
-  for (auto& thread : threads) {
-    thread->join();
+    if (max_memory) {
+      auto usage = resident_memory();
+      LOG_INFO("Finished batch " + std::to_string(batch + 1) + " of " +
+               std::to_string(batches.size()) + (usage.empty() ? "" : ", " + usage));
+    }
   }
 
   LOG_INFO("Finished");
@@ -1498,7 +1574,10 @@ std::map<GraphId, size_t> GraphBuilder::BuildEdges(const boost::property_tree::p
       },
       pt.get<bool>("mjolnir.data_processing.infer_turn_channels", true));
 
-  return SortGraph(nodes_file, edges_file);
+  return SortGraph(nodes_file, edges_file,
+                   std::max(1u, pt.get<unsigned int>("mjolnir.concurrency",
+                                                     std::thread::hardware_concurrency())),
+                   pt.get<size_t>("mjolnir.max_memory", 0));
 }
 
 // Build the graph from the input
@@ -1542,9 +1621,12 @@ void GraphBuilder::Build(const boost::property_tree::ptree& pt,
 
   auto tile_dir = pt.get<std::string>("mjolnir.tile_dir");
 
+  // Bound the memory used for building the tiles to this many bytes, 0 meaning there is no bound
+  const size_t max_memory = pt.get<size_t>("mjolnir.max_memory", 0);
+
   BuildLocalTiles(threads, osmdata, ways_file, way_nodes_file, nodes_file, edges_file,
                   complex_from_restriction_file, complex_to_restriction_file, linguistic_node_file,
-                  tiles, tile_dir, stats, pt);
+                  tiles, tile_dir, max_memory, stats, pt);
   stats.LogStatistics();
 }
 
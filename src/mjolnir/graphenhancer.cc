@@ -16,6 +16,7 @@
 #include "mjolnir/countryaccess.h"
 #include "mjolnir/graphtilebuilder.h"
 #include "mjolnir/osmaccess.h"
+#include "mjolnir/tilescheduler.h"
 #include "mjolnir/util.h"
 #include "scoped_timer.h"
 #include "speed_assigner.h"
@@ -24,13 +25,8 @@
 
 #include <cstdint>
 #include <functional>
-#include <future>
 #include <limits>
-#include <list>
 #include <memory>
-#include <mutex>
-#include <queue>
-#include <random>
 #include <set>
 #include <stdexcept>
 #include <thread>
@@ -958,9 +954,9 @@ void enhance(const boost::property_tree::ptree& pt,
              const OSMData& osmdata,
              const std::string& access_file,
              const boost::property_tree::ptree& hierarchy_properties,
-             std::queue<GraphId>& tilequeue,
-             std::mutex& lock, // guards `tilequeue`
-             std::promise<enhancer_stats>& result) {
+             TileScheduler& scheduler,
+             size_t worker,
+             enhancer_stats& result) {
 
   auto less_than = [](const OSMAccess& a, const OSMAccess& b) { return a.way_id() < b.way_id(); };
   sequence<OSMAccess> access_tags(access_file, false);
@@ -996,19 +992,9 @@ void enhance(const boost::property_tree::ptree& pt,
   enhancer_stats stats{std::numeric_limits<float>::min(), 0, 0, 0, 0, 0, 0, {}};
   const TileLevel& tile_level = TileHierarchy::levels().back();
 
-  // Iterate through the tiles in the queue and perform enhancements
-  while (true) {
-    // Get the next tile Id from the queue and get writeable and readable
-    // tile. Lock while we access the tile queue and get the tile.
-    lock.lock();
-    if (tilequeue.empty()) {
-      lock.unlock();
-      break;
-    }
-    GraphId tile_id = tilequeue.front();
-    tilequeue.pop();
-    lock.unlock();
-
+  // Iterate through the tiles handed to us and perform enhancements
+  GraphId tile_id;
+  while (scheduler.Next(worker, tile_id)) {
     // Get a readable tile.If the tile is empty, skip it. Empty tiles are
     // added where ways go through a tile but no end not is within the tile.
     // This allows creation of connectivity maps using the tile set,
@@ -1392,7 +1378,7 @@ void enhance(const boost::property_tree::ptree& pt,
   }
 
   // Send back the statistics
-  result.set_value(stats);
+  result = stats;
 }
 
 } // namespace
@@ -1403,58 +1389,37 @@ namespace mjolnir {
 // Enhance the local level of the graph
 void GraphEnhancer::Enhance(const boost::property_tree::ptree& pt,
                             const OSMData& osmdata,
-                            const std::string& access_file) {
+                            const std::string& access_file,
+                            const std::unordered_set<GraphId>& tiles) {
   SCOPED_TIMER();
   LOG_INFO("Enhancing local graph...");
 
-  // A place to hold worker threads and their results, exceptions or otherwise
-  std::vector<std::shared_ptr<std::thread>> threads(
-      std::max(static_cast<unsigned int>(1),
-               pt.get<unsigned int>("mjolnir.concurrency", std::thread::hardware_concurrency())));
-
-  // A place to hold the results of those threads, exceptions or otherwise
-  std::list<std::promise<enhancer_stats>> results;
-
-  // Create a randomized queue of tiles to work from
-  std::deque<GraphId> tempqueue;
+  // Largest tiles first, so that the threads finish at about the same time
   boost::property_tree::ptree hierarchy_properties = pt.get_child("mjolnir");
   auto local_level = TileHierarchy::levels().back().level;
   GraphReader reader(hierarchy_properties);
-  auto local_tiles = reader.GetTileSet(local_level);
-  for (const auto& tile_id : local_tiles) {
-    tempqueue.emplace_back(tile_id);
-  }
-  std::random_device rd;
-  std::shuffle(tempqueue.begin(), tempqueue.end(), std::mt19937(rd()));
-  std::queue<GraphId> tilequeue(tempqueue);
-
-  // An atomic object we can use to do the synchronization
-  std::mutex lock;
-
-  // Start the threads
-  for (auto& thread : threads) {
-    results.emplace_back();
-    thread =
-        std::make_shared<std::thread>(enhance, std::cref(hierarchy_properties), std::cref(osmdata),
-                                      std::cref(access_file), std::ref(hierarchy_properties),
-                                      std::ref(tilequeue), std::ref(lock), std::ref(results.back()));
-  }
-
-  // Wait for them to finish up their work
-  for (auto& thread : threads) {
-    thread->join();
+  std::vector<std::pair<GraphId, uint64_t>> local_tiles;
+  for (const auto& tile_id : reader.GetTileSet(local_level)) {
+    if (tiles.empty() || tiles.count(tile_id)) {
+      local_tiles.emplace_back(tile_id, TileScheduler::TileSize(reader.tile_dir(), tile_id));
+    }
   }
+  TileScheduler scheduler("enhance", std::move(local_tiles),
+                          std::max(static_cast<unsigned int>(1),
+                                   pt.get<unsigned int>("mjolnir.concurrency",
+                                                        std::thread::hardware_concurrency())));
+
+  // A place to hold the results of the threads
+  std::vector<enhancer_stats> results(scheduler.concurrency());
+  scheduler.Run([&](size_t worker) {
+    enhance(hierarchy_properties, osmdata, access_file, hierarchy_properties, scheduler, worker,
+            results[worker]);
+  });
 
   // Check all of the outcomes, to see about maximum density (km/km2)
   enhancer_stats stats{std::numeric_limits<float>::min(), 0, 0, 0, 0, 0, 0, {0}};
-  for (auto& result : results) {
-    // If something bad went down this will rethrow it
-    try {
-      auto thread_stats = result.get_future().get();
-      stats(thread_stats);
-    } catch (std::exception& e) {
-      // TODO: throw further up the chain?
-    }
+  for (const auto& thread_stats : results) {
+    stats(thread_stats);
   }
 
   LOG_INFO("Finished with max_density " + std::to_string(stats.max_density));
@@ -1471,5 +1436,60 @@ void GraphEnhancer::Enhance(const boost::property_tree::ptree& pt,
 #endif
 }
 
+// Get the local tiles whose enhanced attributes depend on the given tiles and nodes
+std::unordered_set<GraphId>
+GraphEnhancer::GetDependentTiles(GraphReader& reader,
+                                 const std::unordered_set<GraphId>& tiles,
+                                 const std::vector<GraphId>& nodes) {
+  const auto& tiling = TileHierarchy::levels().back().tiles;
+  const auto local_level = TileHierarchy::levels().back().level;
+  std::unordered_set<GraphId> dependent = tiles;
+
+  // The density of a node counts the edges within the density radius of it. Widen each tile the
+  // way BuildDensityIndex does, using the latitude closest to the pole to stay conservative
+  for (const auto& tile_id : tiles) {
+    const auto tile_bbox = tiling.TileBounds(tile_id.tileid());
+    const float lat = std::min<float>(std::max(std::fabs(tile_bbox.minpt().lat()),
+                                        std::fabs(tile_bbox.maxpt().lat())) +
+                                   kDensityLatDeg + DensityCellId::kSizeDeg,
+                               89.f);
+    const float density_lng_deg = kDensityLatDeg / cosf(kRadPerDeg * lat);
+    const AABB2<PointLL> bbox(tile_bbox.minpt().lng() - (density_lng_deg + DensityCellId::kSizeDeg),
+                              tile_bbox.minpt().lat() - (kDensityLatDeg + DensityCellId::kSizeDeg),
+                              tile_bbox.maxpt().lng() + (density_lng_deg + DensityCellId::kSizeDeg),
+                              tile_bbox.maxpt().lat() + (kDensityLatDeg + DensityCellId::kSizeDeg));
+    for (const auto& id : TileHierarchy::GetGraphIds(bbox, local_level)) {
+      dependent.insert(id);
+    }
+  }
+
+  // IsNotThruEdge expands at most kMaxNoThruTries nodes from the end of an edge and never follows
+  // roads above tertiary, so only the edges of nodes that close to a changed node can change.
+  // Every edge has an opposing edge, so expanding the same roads from the changed nodes finds them
+  std::unordered_set<GraphId> visited(nodes.begin(), nodes.end());
+  std::vector<GraphId> expand(visited.begin(), visited.end());
+  graph_tile_ptr tile;
+  for (uint32_t n = 0; n <= kMaxNoThruTries && !expand.empty(); n++) {
+    std::vector<GraphId> next;
+    for (const auto& node_id : expand) {
+      if (!reader.GetGraphTile(node_id, tile)) {
+        continue;
+      }
+      dependent.insert(node_id.tile_base());
+      const NodeInfo* node = tile->node(node_id);
+      for (const auto& edge : tile->GetDirectedEdges(node)) {
+        dependent.insert(edge.endnode().tile_base());
+        if (edge.classification() >= baldr::RoadClass::kTertiary &&
+            visited.insert(edge.endnode()).second) {
+          next.push_back(edge.endnode());
+        }
+      }
+    }
+    expand = std::move(next);
+  }
+
+  return dependent;
+}
+
 } // namespace mjolnir
 } // namespace valhalla
@@ -49,6 +49,17 @@ std::vector<ComplexRestrictionBuilder> DeserializeRestrictions(char* restriction
   return builders;
 }
 
+// Tiles are rewritten multiple times during building. Since threads may read tiles while they're
+// being written, and tile directories may share unchanged tiles through hard links, tiles are
+// never written in place but to a temp file which is then renamed over the tile
+std::filesystem::path TempTileFile(const std::filesystem::path& filename) {
+  std::filesystem::path tmp_filename = filename;
+  std::ostringstream suffix;
+  suffix << "_" << std::this_thread::get_id() << ".tmp";
+  tmp_filename += suffix.str();
+  return tmp_filename;
+}
+
 } // namespace
 
 // Constructor given an existing tile. This is used to read in the tile
@@ -272,16 +283,8 @@ void GraphTileBuilder::StoreTileData() {
     std::filesystem::create_directories(filename.parent_path());
   }
 
-  // Tiles are rewritten multiple times during building. Since threads may read tiles while they're
-  // being written, we use atomic "write to temp file + rename" to avoid partial reads.
-  std::filesystem::path tmp_filename = filename;
-  {
-    std::ostringstream suffix;
-    suffix << "_" << std::this_thread::get_id() << ".tmp";
-    tmp_filename += suffix.str();
-  }
-
   // Open file and truncate
+  auto tmp_filename = TempTileFile(filename);
   std::stringstream in_mem;
   std::ofstream file(tmp_filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
   if (file.is_open()) {
@@ -466,7 +469,8 @@ void GraphTileBuilder::Update(const std::vector<NodeInfo>& nodes,
   }
 
   // Open file. Truncate so we replace the contents.
-  std::ofstream file(filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+  auto tmp_filename = TempTileFile(filename);
+  std::ofstream file(tmp_filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
   if (file.is_open()) {
     // Write the header
     file.write(reinterpret_cast<const char*>(header_), sizeof(GraphTileHeader));
@@ -496,6 +500,8 @@ void GraphTileBuilder::Update(const std::vector<NodeInfo>& nodes,
     auto end = reinterpret_cast<const char*>(header()) + header()->end_offset();
     file.write(begin, end - begin);
     file.close();
+
+    std::filesystem::rename(tmp_filename, filename);
   } else {
     throw std::runtime_error("GraphTileBuilder::Update - Failed to open file " + filename.string());
   }
@@ -1226,7 +1232,8 @@ void GraphTileBuilder::AddBins(const std::string& tile_dir,
   if (!std::filesystem::exists(filename.parent_path())) {
     std::filesystem::create_directories(filename.parent_path());
   }
-  std::ofstream file(filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+  auto tmp_filename = TempTileFile(filename);
+  std::ofstream file(tmp_filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
   // open it
   if (file.is_open()) {
     // new header
@@ -1244,6 +1251,8 @@ void GraphTileBuilder::AddBins(const std::string& tile_dir,
     begin = reinterpret_cast<const char*>(last_bin.data() + last_bin.size());
     end = reinterpret_cast<const char*>(tile->header()) + tile->header()->end_offset();
     file.write(begin, end - begin);
+    file.close();
+    std::filesystem::rename(tmp_filename, filename);
   } // failed
   else {
     throw std::runtime_error("Failed to open file " + filename.string());
@@ -1301,7 +1310,8 @@ void GraphTileBuilder::UpdatePredictedSpeeds(const std::vector<DirectedEdge>& di
     std::filesystem::create_directories(filename.parent_path());
 
   // Open file and truncate
-  std::ofstream file(filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+  auto tmp_filename = TempTileFile(filename);
+  std::ofstream file(tmp_filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
   if (file.is_open()) {
     // Write a new header - add the offset to predicted speed data and the profile count.
     // Update the end offset (shift by the amount of predicted speed data added).
@@ -1343,6 +1353,7 @@ void GraphTileBuilder::UpdatePredictedSpeeds(const std::vector<DirectedEdge>& di
 
     // Close the file
     file.close();
+    std::filesystem::rename(tmp_filename, filename);
   }
 }
 
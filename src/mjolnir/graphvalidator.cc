@@ -8,6 +8,7 @@
 #include "midgard/logging.h"
 #include "midgard/pointll.h"
 #include "mjolnir/graphtilebuilder.h"
+#include "mjolnir/tilescheduler.h"
 #include "mjolnir/util.h"
 #include "scoped_timer.h"
 
@@ -15,15 +16,14 @@
 #include <boost/property_tree/ptree.hpp>
 
 #include <algorithm>
-#include <deque>
+#include <chrono>
+#include <format>
 #include <future>
-#include <list>
+#include <memory>
 #include <mutex>
-#include <random>
 #include <set>
 #include <string>
 #include <thread>
-#include <tuple>
 #include <utility>
 #include <vector>
 
@@ -253,12 +253,26 @@ uint32_t GetOpposingEdgeIndex(const GraphId& startnode,
 }
 
 using tweeners_t = GraphTileBuilder::tweeners_t;
-void validate(
-    const boost::property_tree::ptree& pt,
-    std::deque<GraphId>& tilequeue,
-    std::mutex& lock,
-    std::promise<std::tuple<std::vector<uint32_t>, std::vector<std::vector<float>>, tweeners_t>>&
-        result) {
+using seconds_t = std::chrono::duration<double>;
+
+// What a thread of the validation pass hands back
+struct validate_result_t {
+  std::vector<uint32_t> duplicates;
+  std::vector<std::vector<float>> densities;
+  // edges binned to tiles they pass through (dont start or end in), split into one shard per
+  // thread of the binning pass by the tile they have to go to
+  std::vector<tweeners_t> tweeners;
+  // time spent validating nodes and edges (mostly finding opposing edges), binning edges and
+  // writing tiles
+  seconds_t opposing{}, binning{}, writing{};
+};
+
+void validate(const boost::property_tree::ptree& pt,
+              TileScheduler& scheduler,
+              size_t worker,
+              std::mutex& lock,
+              validate_result_t& result) {
+  using clock = std::chrono::steady_clock;
   // Our local copy of edges binned to tiles that they pass through (dont start or end in)
   tweeners_t tweeners;
   // Local Graphreader
@@ -277,17 +291,8 @@ void validate(
   std::set<uint32_t> problem_ways;
 
   // Check for more tiles
-  while (true) {
-    lock.lock();
-    if (tilequeue.empty()) {
-      lock.unlock();
-      break;
-    }
-    // Get the next tile Id
-    GraphId tile_id = tilequeue.front();
-    tilequeue.pop_front();
-    lock.unlock();
-
+  GraphId tile_id;
+  while (scheduler.Next(worker, tile_id)) {
     // Point tiles to the set we need for current level
     const auto& tiles = tile_id.level() == TileHierarchy::GetTransitLevel().level
                             ? TileHierarchy::levels().back().tiles
@@ -307,6 +312,23 @@ void validate(
     graph_tile_ptr tile = graph_reader.GetGraphTile(tile_id);
     lock.unlock();
 
+    // The tiles the edges of this tile end in. An edge mostly ends in the same few neighbours as
+    // the edges before it, so each of them is only looked up (under the lock) once per tile
+    std::vector<graph_tile_ptr> end_tiles{tile};
+    const auto end_tile = [&](const GraphId& end_node) {
+      for (const auto& t : end_tiles) {
+        if (t && t->id() == end_node.tile_base()) {
+          return t;
+        }
+      }
+      lock.lock();
+      auto t = graph_reader.GetGraphTile(end_node);
+      lock.unlock();
+      end_tiles.push_back(t);
+      return t;
+    };
+    const auto opposing_start = clock::now();
+
     // Iterate through the nodes and the directed edges
     uint32_t dupcount = 0;
     float roadlength = 0.0f;
@@ -380,9 +402,7 @@ void validate(
           directededge.set_leaves_tile(true);
 
           // Get the end node tile
-          lock.lock();
-          endnode_tile = graph_reader.GetGraphTile(directededge.endnode());
-          lock.unlock();
+          endnode_tile = end_tile(directededge.endnode());
           // make sure this is set to false as access tag logic could of set this to true.
         } else {
           directededge.set_leaves_tile(false);
@@ -440,6 +460,9 @@ void validate(
       nodes.emplace_back(std::move(nodeinfo));
     }
 
+    const auto binning_start = clock::now();
+    result.opposing += binning_start - opposing_start;
+
     // Add density to return class. Approximate the tile area square km
     AABB2<PointLL> bb = tiles.TileBounds(tileid);
     float area = ((bb.maxy() - bb.miny()) * kMetersPerDegreeLat * kKmPerMeter) *
@@ -461,6 +484,8 @@ void validate(
 
     // Bin the edges
     auto bins = GraphTileBuilder::BinEdges(tile, tweeners);
+    const auto writing_start = clock::now();
+    result.binning += writing_start - binning_start;
 
     // Write the new tile
     lock.lock();
@@ -483,6 +508,7 @@ void validate(
       graph_reader.Trim();
     }
     lock.unlock();
+    result.writing += clock::now() - writing_start;
 
     build_stats::get().increment(build_stats::kCountNodes, nodes.size());
     build_stats::get().increment(build_stats::kCountEdges, directededges.size());
@@ -496,46 +522,51 @@ void validate(
         LOG_INFO("Problem Way: " + std::to_string(w));
       }*/
 
-  // Fill promise with return data
-  result.set_value(std::make_tuple(std::move(duplicates), std::move(densities), std::move(tweeners)));
+  // Fill in the return data, each shard of the tweeners is only ever touched by one thread of
+  // the binning pass
+  result.duplicates = std::move(duplicates);
+  result.densities = std::move(densities);
+  result.tweeners.resize(result.tweeners.empty() ? 1 : result.tweeners.size());
+  for (auto& t : tweeners) {
+    result.tweeners[std::hash<GraphId>{}(t.first) % result.tweeners.size()].emplace(std::move(t));
+  }
 }
 
 // take tweeners from different tiles' perspectives and merge into a single tweener
 // per tile that needs to update its bins
-void merge(const tweeners_t& in, tweeners_t& out) {
-  for (const auto& t : in) {
+void merge(tweeners_t&& in, tweeners_t& out) {
+  for (auto& t : in) {
     // shove it in
-    auto inserted = out.insert(t);
+    auto inserted = out.try_emplace(t.first);
+    auto& bins = inserted.first->second;
     // had this tile already
-    if (!inserted.second) {
+    if (inserted.second) {
+      bins = std::move(t.second);
+    } else {
       // so have to merge
       for (size_t c = 0; c < kBinCount; ++c) {
-        auto& bin = inserted.first->second[c];
-        bin.insert(bin.end(), t.second[c].cbegin(), t.second[c].cend());
+        bins[c].insert(bins[c].end(), t.second[c].cbegin(), t.second[c].cend());
       }
     }
   }
+  in.clear();
 }
 
-// crack open tiles and bin edges that pass through them but dont end or begin in them
+// crack open tiles and bin edges that pass through them but dont end or begin in them. this
+// thread owns one shard of every validation thread's tweeners so it needs no lock
 void bin_tweeners(const std::string& tile_dir,
-                  tweeners_t::iterator& start,
-                  const tweeners_t::iterator& end,
+                  std::vector<validate_result_t>& results,
+                  size_t shard,
                   uint64_t dataset_id,
-                  uint64_t checksum,
-                  std::mutex& lock) {
-  // go while we have tiles to update
-  while (true) {
-    lock.lock();
-    if (start == end) {
-      lock.unlock();
-      break;
-    }
-    // grab this tile and its extra bin edges
-    auto& tile_bin = *start;
-    ++start;
-    lock.unlock();
+                  uint64_t checksum) {
+  // gather the tweeners of our shard
+  tweeners_t tweeners;
+  for (auto& result : results) {
+    merge(std::move(result.tweeners[shard]), tweeners);
+  }
 
+  // go while we have tiles to update
+  for (auto& tile_bin : tweeners) {
     // some tiles are just there because edges' shapes passes through them (no edges/nodes, just bins)
     // if that's the case we need to make a tile to store the spatial index (binned edges) there
     auto tile = GraphTile::Create(tile_dir, tile_bin.first);
@@ -569,79 +600,82 @@ void GraphValidator::Validate(const boost::property_tree::ptree& pt) {
   auto hierarchy_properties = pt.get_child("mjolnir");
   std::string tile_dir = hierarchy_properties.get<std::string>("tile_dir");
 
-  // Create a randomized queue of tiles (at all levels) to work from
-  std::deque<GraphId> tilequeue;
+  // Order the tiles (at all levels) largest first, so that the threads finish at about the same
+  // time
+  std::vector<std::pair<GraphId, uint64_t>> tiles;
   GraphReader reader(pt.get_child("mjolnir"));
   auto tileset = reader.GetTileSet();
   for (const auto& id : tileset) {
-    tilequeue.emplace_back(id);
+    tiles.emplace_back(id, TileScheduler::TileSize(tile_dir, id));
   }
   // log before creating empty tiles
-  build_stats::get().increment(build_stats::kCountTiles, tilequeue.size());
-
-  // fixed seed for reproducible tile build
-  std::shuffle(tilequeue.begin(), tilequeue.end(), std::mt19937(3));
+  build_stats::get().increment(build_stats::kCountTiles, tiles.size());
 
   // Remember what the dataset id is in case we have to make some tiles
-  graph_tile_ptr first_tile = GraphTile::Create(tile_dir, *tilequeue.begin());
-  assert(tilequeue.size() && first_tile);
+  assert(tiles.size());
+  graph_tile_ptr first_tile = GraphTile::Create(tile_dir, *tileset.begin());
+  assert(first_tile);
   auto dataset_id = first_tile->header()->dataset_id();
   auto checksum = first_tile->header()->checksum();
 
   // An mutex we can use to do the synchronization
   std::mutex lock;
 
-  // Setup threads
-  std::vector<std::shared_ptr<std::thread>> threads(
-      std::max(static_cast<unsigned int>(1),
-               pt.get<unsigned int>("mjolnir.concurrency", std::thread::hardware_concurrency())));
-
-  // Setup promises
-  std::list<
-      std::promise<std::tuple<std::vector<uint32_t>, std::vector<std::vector<float>>, tweeners_t>>>
-      results;
-
-  // Spawn the threads
-  for (auto& thread : threads) {
-    results.emplace_back();
-    thread = std::make_shared<std::thread>(validate, std::cref(pt), std::ref(tilequeue),
-                                           std::ref(lock), std::ref(results.back()));
+  // Validate the tiles on all threads
+  TileScheduler scheduler("validate", std::move(tiles),
+                          std::max(static_cast<unsigned int>(1),
+                                   pt.get<unsigned int>("mjolnir.concurrency",
+                                                        std::thread::hardware_concurrency())));
+  std::vector<validate_result_t> results(scheduler.concurrency());
+  for (auto& result : results) {
+    result.tweeners.resize(scheduler.concurrency());
   }
+  scheduler.Run([&](size_t worker) {
+    validate(pt, scheduler, worker, lock, results[worker]);
+  });
 
-  // Wait for threads to finish
-  for (auto& thread : threads) {
-    thread->join();
-  }
-  // Get the promise from the future
+  // Gather the results of the threads
   std::vector<uint32_t> duplicates(TileHierarchy::levels().size(), 0);
   std::vector<std::vector<float>> densities(3);
-  tweeners_t tweeners;
-  for (auto& result : results) {
-    auto data = result.get_future().get();
+  seconds_t opposing{}, binning{}, writing{};
+  for (auto& data : results) {
     // Total up duplicates for each level
     for (uint8_t i = 0; i < TileHierarchy::levels().size(); ++i) {
-      duplicates[i] += std::get<0>(data)[i];
-      for (auto& d : std::get<1>(data)[i]) {
+      duplicates[i] += data.duplicates[i];
+      for (auto& d : data.densities[i]) {
         densities[i].push_back(d);
       }
     }
-    // keep track of tweeners
-    merge(std::get<2>(data), tweeners);
+    opposing += data.opposing;
+    binning += data.binning;
+    writing += data.writing;
   }
   LOG_INFO("Finished");
+  LOG_INFO(std::format("Thread time spent validating edges {:.2f}s, binning edges {:.2f}s, "
+                       "writing tiles {:.2f}s",
+                       opposing.count(), binning.count(), writing.count()));
 
-  // run a pass to add the edges that binned to tweener tiles
+  // run a pass to add the edges that binned to tweener tiles, one thread per shard
   LOG_INFO("Binning inter-tile edges...");
-  auto start = tweeners.begin();
-  auto end = tweeners.end();
-  for (auto& thread : threads) {
-    thread = std::make_shared<std::thread>(bin_tweeners, std::cref(tile_dir), std::ref(start),
-                                           std::cref(end), dataset_id, checksum, std::ref(lock));
+  const auto binning_start = std::chrono::steady_clock::now();
+  std::vector<std::shared_ptr<std::thread>> threads(scheduler.concurrency());
+  std::vector<std::promise<void>> binned(threads.size());
+  for (size_t shard = 0; shard < threads.size(); ++shard) {
+    threads[shard] = std::make_shared<std::thread>([&, shard]() {
+      try {
+        bin_tweeners(tile_dir, results, shard, dataset_id, checksum);
+        binned[shard].set_value();
+      } catch (...) { binned[shard].set_exception(std::current_exception()); }
+    });
   }
   for (auto& thread : threads) {
     thread->join();
   }
-  LOG_INFO("Finished");
+  for (auto& result : binned) {
+    result.get_future().get();
+  }
+  LOG_INFO(std::format("Finished binning inter-tile edges in {:.2f}s",
+                       seconds_t(std::chrono::steady_clock::now() - binning_start).count()));
 
   // print dupcount and find densities
   for (uint8_t level = 0; level < TileHierarchy::levels().size(); level++) {
@@ -8,12 +8,18 @@
 #include "midgard/pointll.h"
 #include "midgard/sequence.h"
 #include "mjolnir/graphtilebuilder.h"
+#include "mjolnir/tilescheduler.h"
 #include "scoped_timer.h"
 
 #include <boost/property_tree/ptree.hpp>
 
+#include <atomic>
 #include <filesystem>
+#include <functional>
+#include <future>
+#include <memory>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -71,24 +77,29 @@ bool AddUpwardTransition(const GraphId& node, GraphTileBuilder* tilebuilder) {
   }
 }
 
-void SortSequences(const std::string& new_to_old_file, const std::string& old_to_new_file) {
+void SortSequences(const std::string& new_to_old_file,
+                   const std::string& old_to_new_file,
+                   unsigned int concurrency) {
   SCOPED_TIMER();
   // Sort the new nodes. Sort so highway level is first
   sequence<std::pair<GraphId, GraphId>> new_to_old(new_to_old_file, false);
-  new_to_old.sort([](const std::pair<GraphId, GraphId>& a, const std::pair<GraphId, GraphId>& b) {
-    if (a.first.level() == b.first.level()) {
-      if (a.first.tileid() == b.first.tileid()) {
-        return a.first.id() < b.first.id();
-      }
-      return a.first.tileid() < b.first.tileid();
-    }
-    return a.first.level() < b.first.level();
-  });
+  new_to_old.sort(
+      [](const std::pair<GraphId, GraphId>& a, const std::pair<GraphId, GraphId>& b) {
+        if (a.first.level() == b.first.level()) {
+          if (a.first.tileid() == b.first.tileid()) {
+            return a.first.id() < b.first.id();
+          }
+          return a.first.tileid() < b.first.tileid();
+        }
+        return a.first.level() < b.first.level();
+      },
+      0, concurrency);
 
   // Sort old to new by node Id
   sequence<OldToNewNodes> old_to_new(old_to_new_file, false);
-  old_to_new.sort(
-      [](const OldToNewNodes& a, const OldToNewNodes& b) { return a.node_id < b.node_id; });
+  old_to_new.sort([](const OldToNewNodes& a,
+                     const OldToNewNodes& b) { return a.node_id < b.node_id; },
+                  0, concurrency);
 }
 
 // Convenience method to find the node association.
@@ -105,17 +116,39 @@ OldToNewNodes find_nodes(sequence<OldToNewNodes>& old_to_new, const GraphId& nod
   }
 }
 
-// Form tiles in the new level.
-void FormTilesInNewLevel(GraphReader& reader,
-                         const std::string& new_to_old_file,
-                         const std::string& old_to_new_file) {
-  SCOPED_TIMER();
-  // Use the sequence that associate new nodes to old nodes
-  sequence<std::pair<GraphId, GraphId>> new_to_old(new_to_old_file, false);
+// Run the worker on the given number of threads. If any of them fails its exception is rethrown
+// once all of them are done
+void RunThreads(unsigned int concurrency, const std::function<void()>& worker) {
+  std::vector<std::shared_ptr<std::thread>> threads(std::max(1u, concurrency));
+  std::vector<std::promise<void>> results(threads.size());
+  for (size_t i = 0; i < threads.size(); ++i) {
+    threads[i] = std::make_shared<std::thread>([&worker, &result = results[i]]() {
+      try {
+        worker();
+        result.set_value();
+      } catch (...) { result.set_exception(std::current_exception()); }
+    });
+  }
+  for (auto& thread : threads) {
+    thread->join();
+  }
+  for (auto& result : results) {
+    result.get_future().get();
+  }
+}
 
-  // Use the sorted sequence that associates old nodes to new nodes
-  sequence<OldToNewNodes> old_to_new(old_to_new_file, false);
+// The range of new nodes (in the sorted new to old sequence) which make up a new tile
+struct NewTileRange {
+  GraphId tile_id;
+  size_t begin;
+  size_t end;
+};
 
+// Form one tile in the new level from its range of new nodes
+void FormTileInNewLevel(GraphReader& reader,
+                        sequence<std::pair<GraphId, GraphId>>& new_to_old,
+                        sequence<OldToNewNodes>& old_to_new,
+                        const NewTileRange& range) {
   // lambda to indicate whether a directed edge should be included
   auto include_edge = [&old_to_new](const DirectedEdge* directededge, const GraphId& base_node,
                                     const uint8_t current_level) {
@@ -143,42 +176,24 @@ void FormTilesInNewLevel(GraphReader& reader,
     }
   };
 
-  // Iterate through the new nodes. They have been sorted by level so that
-  // highway level is done first.
-  reader.Clear();
+  // New tilebuilder for the tile
   bool added = false;
-  uint8_t current_level = std::numeric_limits<uint8_t>::max();
-  GraphId tile_id;
+  const GraphId& tile_id = range.tile_id;
+  const uint8_t current_level = tile_id.level();
   std::hash<std::string> hasher;
-  PointLL base_ll;
-  GraphTileBuilder* tilebuilder = nullptr;
-  for (auto new_node = new_to_old.begin(); new_node != new_to_old.end(); new_node++) {
-    // Get the node - check if a new tile
-    GraphId nodea = (*new_node).first;
-    if (nodea.tile_base() != tile_id) {
-      // Store the prior tile
-      if (tilebuilder != nullptr) {
-        tilebuilder->StoreTileData();
-        delete tilebuilder;
-      }
+  std::unique_ptr<GraphTileBuilder> tilebuilder(
+      new GraphTileBuilder(reader.tile_dir(), tile_id, false));
 
-      // New tilebuilder for the next tile. Update current level.
-      tile_id = nodea.tile_base();
-      tilebuilder = new GraphTileBuilder(reader.tile_dir(), tile_id, false);
-      current_level = nodea.level();
+  // Set the base ll for this tile
+  PointLL base_ll = TileHierarchy::get_tiling(current_level).Base(tile_id.tileid());
+  tilebuilder->header_builder().set_base_ll(base_ll);
 
-      // Set the base ll for this tile
-      base_ll = TileHierarchy::get_tiling(current_level).Base(tile_id.tileid());
-      tilebuilder->header_builder().set_base_ll(base_ll);
-
-      // Check if we need to clear the base/local tile cache
-      if (reader.OverCommitted()) {
-        reader.Trim();
-      }
-    }
+  for (size_t new_node_index = range.begin; new_node_index < range.end; ++new_node_index) {
+    const auto new_node = *new_to_old[new_node_index];
+    GraphId nodea = new_node.first;
 
     // Get the node in the base level
-    GraphId base_node = (*new_node).second;
+    GraphId base_node = new_node.second;
     graph_tile_ptr tile = reader.GetGraphTile(base_node);
     if (tile == nullptr) {
       LOG_ERROR("Base tile is null? ");
@@ -315,14 +330,14 @@ void FormTilesInNewLevel(GraphReader& reader,
     uint32_t index = tilebuilder->transitions().size();
     auto new_nodes = find_nodes(old_to_new, base_node);
     if (current_level == 0) {
-      AddDownwardTransition(new_nodes.arterial_node, tilebuilder);
-      AddDownwardTransition(new_nodes.local_node, tilebuilder);
+      AddDownwardTransition(new_nodes.arterial_node, tilebuilder.get());
+      AddDownwardTransition(new_nodes.local_node, tilebuilder.get());
     } else if (current_level == 1) {
-      AddUpwardTransition(new_nodes.highway_node, tilebuilder);
-      AddDownwardTransition(new_nodes.local_node, tilebuilder);
+      AddUpwardTransition(new_nodes.highway_node, tilebuilder.get());
+      AddDownwardTransition(new_nodes.local_node, tilebuilder.get());
     } else if (current_level == 2) {
-      AddUpwardTransition(new_nodes.highway_node, tilebuilder);
-      AddUpwardTransition(new_nodes.arterial_node, tilebuilder);
+      AddUpwardTransition(new_nodes.highway_node, tilebuilder.get());
+      AddUpwardTransition(new_nodes.arterial_node, tilebuilder.get());
     } else {
       throw std::logic_error("current_level was never set");
     }
@@ -348,11 +363,110 @@ void FormTilesInNewLevel(GraphReader& reader,
     }
   }
 
-  // Delete the tile builder
-  if (tilebuilder != nullptr) {
-    tilebuilder->StoreTileData();
-    delete tilebuilder;
+  tilebuilder->StoreTileData();
+}
+
+// Form tiles in the new level. Every new tile is built from its own range of new nodes so the
+// tiles are independent of each other and can be formed concurrently
+void FormTilesInNewLevel(const boost::property_tree::ptree& pt,
+                         const std::string& new_to_old_file,
+                         const std::string& old_to_new_file,
+                         unsigned int concurrency) {
+  SCOPED_TIMER();
+  // Find the range of new nodes of every tile. They have been sorted by level so that highway
+  // level is done first
+  std::unordered_map<GraphId, NewTileRange> hierarchy_tiles, local_tiles;
+  {
+    sequence<std::pair<GraphId, GraphId>> new_to_old(new_to_old_file, false);
+    size_t index = 0;
+    NewTileRange* range = nullptr;
+    for (auto new_node = new_to_old.begin(); new_node != new_to_old.end(); ++new_node, ++index) {
+      const GraphId tile_id = (*new_node).first.tile_base();
+      auto& tiles = tile_id.level() == TileHierarchy::levels().back().level ? local_tiles
+                                                                             : hierarchy_tiles;
+      if (!range || range->tile_id != tile_id) {
+        range = &tiles.emplace(tile_id, NewTileRange{tile_id, index, index}).first->second;
+      }
+      range->end = index + 1;
+    }
+  }
+
+  // A new local tile replaces the base tile it is formed from, so every base tile must have been
+  // read by the highway and arterial levels before the local level is formed. The tiles with the
+  // most new nodes go first
+  for (const auto* ranges : {&hierarchy_tiles, &local_tiles}) {
+    std::vector<std::pair<GraphId, uint64_t>> tiles;
+    for (const auto& [tile_id, range] : *ranges) {
+      tiles.emplace_back(tile_id, range.end - range.begin);
+    }
+    TileScheduler scheduler(ranges == &local_tiles ? "hierarchy local level" : "hierarchy levels",
+                            std::move(tiles), concurrency);
+    scheduler.Run([&](size_t worker) {
+      GraphReader reader(pt.get_child("mjolnir"));
+      sequence<std::pair<GraphId, GraphId>> new_to_old(new_to_old_file, false);
+      sequence<OldToNewNodes> old_to_new(old_to_new_file, false);
+      GraphId tile_id;
+      while (scheduler.Next(worker, tile_id)) {
+        FormTileInNewLevel(reader, new_to_old, old_to_new, ranges->at(tile_id));
+
+        // Check if we need to clear the base/local tile cache
+        if (reader.OverCommitted()) {
+          reader.Trim();
+        }
+      }
+    });
+  }
+}
+
+// The levels a base node exists on along with the new tiles it goes to on the hierarchy levels
+struct NodeLevels {
+  int32_t highway_tile;
+  int32_t arterial_tile;
+  uint32_t density;
+  bool levels[3];
+};
+
+// Find the levels of the nodes of a base tile
+std::vector<NodeLevels> GetNodeLevels(GraphReader& reader, const GraphId& base_tile_id) {
+  // Get the graph tile. Skip if no tile exists or no nodes exist in the tile.
+  graph_tile_ptr tile = reader.GetGraphTile(base_tile_id);
+  if (!tile) {
+    return {};
+  }
+
+  // Hierarchy level information
+  const auto& arterial_level = TileHierarchy::levels()[1];
+  const auto& highway_level = TileHierarchy::levels()[0];
+
+  // Iterate through the nodes. Add nodes to the new level when
+  // best road class <= the new level classification cutoff
+  uint32_t nodecount = tile->header()->nodecount();
+  std::vector<NodeLevels> node_levels(nodecount);
+  GraphId edgeid = base_tile_id;
+  PointLL base_ll = tile->header()->base_ll();
+  const NodeInfo* nodeinfo = tile->node(base_tile_id);
+  for (uint32_t i = 0; i < nodecount; i++, nodeinfo++) {
+    // Iterate through the edges to see which levels this node exists.
+    auto& levels = node_levels[i].levels;
+    levels[0] = levels[1] = levels[2] = false;
+    for (uint32_t j = 0; j < nodeinfo->edge_count(); j++, ++edgeid) {
+      // Update the flag for the level of this edge (skip transit
+      // connection edges)
+      const DirectedEdge* directededge = tile->directededge(edgeid);
+      if (directededge->bss_connection()) {
+        // Despite the road class, Bike Share Stations' connections are always at local level
+        levels[2] = true;
+      } else if (directededge->use() != Use::kTransitConnection &&
+                 directededge->use() != Use::kEgressConnection &&
+                 directededge->use() != Use::kPlatformConnection) {
+        levels[get_hierarchy_level(directededge)] = true;
+      }
+    }
+    node_levels[i].highway_tile = highway_level.tiles.TileId(nodeinfo->latlng(base_ll));
+    node_levels[i].arterial_tile = arterial_level.tiles.TileId(nodeinfo->latlng(base_ll));
+    node_levels[i].density = nodeinfo->density();
   }
+  return node_levels;
 }
 
 /**
@@ -361,10 +475,14 @@ void FormTilesInNewLevel(GraphReader& reader,
  * associations go both ways: from the "old" nodes on the base/local level
  * to new nodes (using a mapping in memory) and from new nodes to old nodes
  * using a sequence (file).
+ *
+ * The base tiles are read concurrently in batches. New node Ids are handed out in the order of
+ * the base tiles, like a single thread would, so they don't depend on the concurrency.
  */
-void CreateNodeAssociations(GraphReader& reader,
+void CreateNodeAssociations(const boost::property_tree::ptree& pt,
                             const std::string& new_to_old_file,
-                            const std::string& old_to_new_file) {
+                            const std::string& old_to_new_file,
+                            unsigned int concurrency) {
   SCOPED_TIMER();
   // Map of tiles vs. count of nodes. Used to construct new node Ids.
   std::unordered_map<GraphId, uint32_t> new_nodes;
@@ -390,83 +508,76 @@ void CreateNodeAssociations(GraphReader& reader,
   sequence<OldToNewNodes> old_to_new(old_to_new_file, true);
 
   // Hierarchy level information
-  const auto& arterial_level = TileHierarchy::levels()[1];
-  uint32_t al = static_cast<uint32_t>(arterial_level.level);
-  const auto& highway_level = TileHierarchy::levels()[0];
-  uint32_t hl = static_cast<uint32_t>(highway_level.level);
-
-  // Iterate through all tiles in the local level
-  auto local_tiles = reader.GetTileSet();
-  for (const auto& base_tile_id : local_tiles) {
-    // We keep all transit data inside the transit hierarchy
-    if (base_tile_id.level() == TileHierarchy::GetTransitLevel().level) {
-      continue;
-    }
-
-    // Get the graph tile. Skip if no tile exists or no nodes exist in the tile.
-    graph_tile_ptr tile = reader.GetGraphTile(base_tile_id);
-    if (!tile) {
-      continue;
+  uint32_t al = static_cast<uint32_t>(TileHierarchy::levels()[1].level);
+  uint32_t hl = static_cast<uint32_t>(TileHierarchy::levels()[0].level);
+
+  // Iterate through all tiles in the local level. We keep all transit data inside the transit
+  // hierarchy
+  std::vector<GraphId> local_tiles;
+  {
+    GraphReader reader(pt.get_child("mjolnir"));
+    for (const auto& base_tile_id : reader.GetTileSet()) {
+      if (base_tile_id.level() != TileHierarchy::GetTransitLevel().level) {
+        local_tiles.push_back(base_tile_id);
+      }
     }
+  }
 
-    // Iterate through the nodes. Add nodes to the new level when
-    // best road class <= the new level classification cutoff
-    bool levels[3];
-    uint32_t nodecount = tile->header()->nodecount();
-    GraphId basenode = base_tile_id;
-    GraphId edgeid = base_tile_id;
-    PointLL base_ll = tile->header()->base_ll();
-    const NodeInfo* nodeinfo = tile->node(basenode);
-    for (uint32_t i = 0; i < nodecount; i++, nodeinfo++, ++basenode) {
-      // Iterate through the edges to see which levels this node exists.
-      levels[0] = levels[1] = levels[2] = false;
-      for (uint32_t j = 0; j < nodeinfo->edge_count(); j++, ++edgeid) {
-        // Update the flag for the level of this edge (skip transit
-        // connection edges)
-        const DirectedEdge* directededge = tile->directededge(edgeid);
-        if (directededge->bss_connection()) {
-          // Despite the road class, Bike Share Stations' connections are always at local level
-          levels[2] = true;
-        } else if (directededge->use() != Use::kTransitConnection &&
-                   directededge->use() != Use::kEgressConnection &&
-                   directededge->use() != Use::kPlatformConnection) {
-          levels[get_hierarchy_level(directededge)] = true;
+  // The batches are too short to be worth a TileScheduler, which would also log every one of them.
+  // Base tiles are cheap to read compared to forming tiles, so they are just taken in order
+  const size_t batch_size = std::max(1u, concurrency) * 16;
+  std::vector<std::vector<NodeLevels>> batch_levels;
+  for (size_t batch = 0; batch < local_tiles.size(); batch += batch_size) {
+    // Find the levels of the nodes of the tiles in this batch
+    const size_t batch_end = std::min(local_tiles.size(), batch + batch_size);
+    batch_levels.assign(batch_end - batch, {});
+    std::atomic<size_t> next(batch);
+    RunThreads(concurrency, [&]() {
+      GraphReader reader(pt.get_child("mjolnir"));
+      for (size_t i = next++; i < batch_end; i = next++) {
+        batch_levels[i - batch] = GetNodeLevels(reader, local_tiles[i]);
+        // Check if we need to clear the tile cache
+        if (reader.OverCommitted()) {
+          reader.Trim();
         }
       }
+    });
+
+    // Associate new nodes to base nodes and base node to new nodes in tile order
+    for (size_t i = batch; i < batch_end; ++i) {
+      const auto& base_tile_id = local_tiles[i];
+      GraphId basenode = base_tile_id;
+      for (const auto& node_levels : batch_levels[i - batch]) {
+        const auto& levels = node_levels.levels;
+        GraphId highway_node, arterial_node, local_node;
+        if (levels[0]) {
+          // New node is on the highway level. Associate back to base/local node
+          GraphId new_tile(node_levels.highway_tile, hl, 0);
+          highway_node = get_new_node(new_tile);
+          new_to_old.push_back(std::make_pair(highway_node, basenode));
+        }
+        if (levels[1]) {
+          // New node is on the arterial level. Associate back to base/local node
+          GraphId new_tile(node_levels.arterial_tile, al, 0);
+          arterial_node = get_new_node(new_tile);
+          new_to_old.push_back(std::make_pair(arterial_node, basenode));
+        }
+        if (levels[2]) {
+          // New node is on the local level. Associate back to base/local node
+          local_node = get_new_node(base_tile_id);
+          new_to_old.push_back(std::make_pair(local_node, basenode));
+        }
 
-      // Associate new nodes to base nodes and base node to new nodes
-      GraphId highway_node, arterial_node, local_node;
-      if (levels[0]) {
-        // New node is on the highway level. Associate back to base/local node
-        GraphId new_tile(highway_level.tiles.TileId(nodeinfo->latlng(base_ll)), hl, 0);
-        highway_node = get_new_node(new_tile);
-        new_to_old.push_back(std::make_pair(highway_node, basenode));
-      }
-      if (levels[1]) {
-        // New node is on the arterial level. Associate back to base/local node
-        GraphId new_tile(arterial_level.tiles.TileId(nodeinfo->latlng(base_ll)), al, 0);
-        arterial_node = get_new_node(new_tile);
-        new_to_old.push_back(std::make_pair(arterial_node, basenode));
-      }
-      if (levels[2]) {
-        // New node is on the local level. Associate back to base/local node
-        local_node = get_new_node(base_tile_id);
-        new_to_old.push_back(std::make_pair(local_node, basenode));
-      }
+        if (!levels[0] && !levels[1] && !levels[2]) {
+          LOG_ERROR("No valid level for this node!");
+        }
 
-      if (!levels[0] && !levels[1] && !levels[2]) {
-        LOG_ERROR("No valid level for this node!");
+        // Associate the old node to the new node(s). Entries in the tuple
+        // that are invalid nodes indicate no node exists in the new level.
+        OldToNewNodes assoc(basenode, highway_node, arterial_node, local_node, node_levels.density);
+        old_to_new.push_back(assoc);
+        ++basenode;
       }
-
-      // Associate the old node to the new node(s). Entries in the tuple
-      // that are invalid nodes indicate no node exists in the new level.
-      OldToNewNodes assoc(basenode, highway_node, arterial_node, local_node, nodeinfo->density());
-      old_to_new.push_back(assoc);
-    }
-
-    // Check if we need to clear the tile cache
-    if (reader.OverCommitted()) {
-      reader.Trim();
     }
   }
 }
@@ -474,58 +585,77 @@ void CreateNodeAssociations(GraphReader& reader,
 /**
  * Update end nodes of transit connection directed edges.
  */
-void UpdateTransitConnections(GraphReader& reader, const std::string& old_to_new_file) {
+void UpdateTransitConnections(const boost::property_tree::ptree& pt,
+                              const std::string& old_to_new_file,
+                              unsigned int concurrency) {
   SCOPED_TIMER();
-  // Use the sorted sequence that associates old nodes to new nodes
-  sequence<OldToNewNodes> old_to_new(old_to_new_file, false);
-
   uint8_t transit_level = TileHierarchy::GetTransitLevel().level;
-  auto transit_tiles = reader.GetTileSet(transit_level);
-  for (const auto& tile_id : transit_tiles) {
-    // Skip if no nodes exist in the tile
-    graph_tile_ptr tile = reader.GetGraphTile(tile_id);
-    if (!tile) {
-      continue;
+  std::vector<std::pair<GraphId, uint64_t>> transit_tiles;
+  {
+    GraphReader reader(pt.get_child("mjolnir"));
+    for (const auto& tile_id : reader.GetTileSet(transit_level)) {
+      transit_tiles.emplace_back(tile_id, TileScheduler::TileSize(reader.tile_dir(), tile_id));
     }
+  }
+
+  // Every transit tile is updated on its own, largest first
+  TileScheduler scheduler("transit connections", std::move(transit_tiles), concurrency);
+  scheduler.Run([&](size_t worker) {
+    GraphReader reader(pt.get_child("mjolnir"));
+    // Use the sorted sequence that associates old nodes to new nodes
+    sequence<OldToNewNodes> old_to_new(old_to_new_file, false);
+    GraphId tile_id;
+    while (scheduler.Next(worker, tile_id)) {
+      // Skip if no nodes exist in the tile
+      graph_tile_ptr tile = reader.GetGraphTile(tile_id);
+      if (!tile) {
+        continue;
+      }
 
-    // Create a new tile builder
-    GraphTileBuilder tilebuilder(reader.tile_dir(), tile_id, false);
-
-    // Update end nodes of transit connection directed edges
-    std::vector<NodeInfo> nodes;
-    std::vector<DirectedEdge> directededges;
-    for (uint32_t i = 0; i < tilebuilder.header()->nodecount(); i++) {
-      NodeInfo nodeinfo = tilebuilder.node(i);
-      uint32_t idx = nodeinfo.edge_index();
-      for (uint32_t j = 0; j < nodeinfo.edge_count(); j++, idx++) {
-        DirectedEdge directededge = tilebuilder.directededge(idx);
-
-        // Update the end node of any transit connection edge
-        if (directededge.use() == Use::kTransitConnection) {
-          // Get the updated end node
-          auto f = find_nodes(old_to_new, directededge.endnode());
-          GraphId new_end_node;
-          if (f.local_node.is_valid()) {
-            new_end_node = f.local_node;
-          } else if (f.arterial_node.is_valid()) {
-            new_end_node = f.arterial_node;
-          } else if (f.highway_node.is_valid()) {
-            new_end_node = f.highway_node;
-          } else {
-            LOG_ERROR("Transit Connection does not connect to valid node");
+      // Create a new tile builder
+      GraphTileBuilder tilebuilder(reader.tile_dir(), tile_id, false);
+
+      // Update end nodes of transit connection directed edges
+      std::vector<NodeInfo> nodes;
+      std::vector<DirectedEdge> directededges;
+      for (uint32_t i = 0; i < tilebuilder.header()->nodecount(); i++) {
+        NodeInfo nodeinfo = tilebuilder.node(i);
+        uint32_t idx = nodeinfo.edge_index();
+        for (uint32_t j = 0; j < nodeinfo.edge_count(); j++, idx++) {
+          DirectedEdge directededge = tilebuilder.directededge(idx);
+
+          // Update the end node of any transit connection edge
+          if (directededge.use() == Use::kTransitConnection) {
+            // Get the updated end node
+            auto f = find_nodes(old_to_new, directededge.endnode());
+            GraphId new_end_node;
+            if (f.local_node.is_valid()) {
+              new_end_node = f.local_node;
+            } else if (f.arterial_node.is_valid()) {
+              new_end_node = f.arterial_node;
+            } else if (f.highway_node.is_valid()) {
+              new_end_node = f.highway_node;
+            } else {
+              LOG_ERROR("Transit Connection does not connect to valid node");
+            }
+            directededge.set_endnode(new_end_node);
           }
-          directededge.set_endnode(new_end_node);
+
+          // Add the directed edge to the local list
+          directededges.emplace_back(std::move(directededge));
         }
 
-        // Add the directed edge to the local list
-        directededges.emplace_back(std::move(directededge));
+        // Add the node to the local list
+        nodes.emplace_back(std::move(nodeinfo));
       }
+      tilebuilder.Update(nodes, directededges);
 
-      // Add the node to the local list
-      nodes.emplace_back(std::move(nodeinfo));
+      // Check if we need to clear the tile cache
+      if (reader.OverCommitted()) {
+        reader.Trim();
+      }
     }
-    tilebuilder.Update(nodes, directededges);
-  }
+  });
 }
 
 // Remove any base tiles that no longer have any data (nodes and edges
@@ -568,27 +698,25 @@ namespace mjolnir {
 void HierarchyBuilder::Build(const boost::property_tree::ptree& pt,
                              const std::string& new_to_old_file,
                              const std::string& old_to_new_file) {
-
-  // TODO: thread this. Might be more possible now that we don't create
-  // shortcuts in the HierarchyBuilder
-
   SCOPED_TIMER();
-  // Construct GraphReader
   LOG_INFO("HierarchyBuilder");
-  GraphReader reader(pt.get_child("mjolnir"));
+  unsigned int concurrency =
+      std::max(static_cast<unsigned int>(1),
+               pt.get<unsigned int>("mjolnir.concurrency", std::thread::hardware_concurrency()));
 
   // Association of old nodes to new nodes
-  CreateNodeAssociations(reader, new_to_old_file, old_to_new_file);
+  CreateNodeAssociations(pt, new_to_old_file, old_to_new_file, concurrency);
 
   // Sort the sequences
-  SortSequences(new_to_old_file, old_to_new_file);
+  SortSequences(new_to_old_file, old_to_new_file, concurrency);
 
   // Iterate through the hierarchy (from highway down to local) and build
   // new tiles
-  FormTilesInNewLevel(reader, new_to_old_file, old_to_new_file);
+  FormTilesInNewLevel(pt, new_to_old_file, old_to_new_file, concurrency);
 
   // Remove any base tiles that no longer have any data (nodes and edges
   // only exist on arterial and highway levels)
+  GraphReader reader(pt.get_child("mjolnir"));
   RemoveUnusedLocalTiles(reader.tile_dir(), old_to_new_file);
 
   // Update the end nodes to all transit connections in the transit hierarchy
@@ -596,7 +724,7 @@ void HierarchyBuilder::Build(const boost::property_tree::ptree& pt,
   auto transit_dir = hierarchy_properties.get_optional<std::string>("transit_dir");
   if (transit_dir && std::filesystem::exists(*transit_dir) &&
       std::filesystem::is_directory(*transit_dir)) {
-    UpdateTransitConnections(reader, old_to_new_file);
+    UpdateTransitConnections(pt, old_to_new_file, concurrency);
   }
 
   LOG_INFO("Done HierarchyBuilder");
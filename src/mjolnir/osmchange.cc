@@ -0,0 +1,241 @@
+#include "mjolnir/osmchange.h"
+#include "baldr/graphreader.h"
+#include "baldr/tilehierarchy.h"
+#include "midgard/logging.h"
+#include "midgard/sequence.h"
+#include "mjolnir/graphenhancer.h"
+#include "mjolnir/osmdata.h"
+#include "mjolnir/osmway.h"
+
+#include <boost/property_tree/ptree.hpp>
+#ifdef HAVE_EXPAT
+#include <osmium/io/xml_input.hpp>
+#endif
+#include <osmium/osm/entity_bits.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+
+using namespace valhalla::baldr;
+using namespace valhalla::midgard;
+
+namespace {
+
+// What the tiles from before the changes say about the changes
+struct TileScan {
+  // tiles with edges of changed ways
+  std::unordered_set<GraphId> changed;
+  // the tiles the edges of each tile end in
+  std::unordered_map<GraphId, std::unordered_set<GraphId>> neighbors;
+  // nodes of edges of changed ways and nodes where changed ways now run through
+  std::vector<GraphId> nodes;
+};
+
+// Key of a location at the 1e-7 degree precision of both the OSM data and the tiles
+uint64_t LocationKey(const PointLL& ll) {
+  return (static_cast<uint64_t>(std::round((ll.lng() + 180) * 1e7)) << 32) |
+         static_cast<uint64_t>(std::round((ll.lat() + 90) * 1e7));
+}
+
+} // namespace
+
+namespace valhalla {
+namespace mjolnir {
+
+OSMChange OSMChange::Read(const std::vector<std::string>& change_files) {
+#ifndef HAVE_EXPAT
+  if (!change_files.empty()) {
+    throw std::runtime_error("Reading OSM change files requires valhalla to be built with expat");
+  }
+  return {};
+#else
+  OSMChange change;
+  for (const auto& file : change_files) {
+    LOG_INFO("Reading changes from " + file);
+    osmium::io::Reader reader(file, osmium::osm_entity_bits::node | osmium::osm_entity_bits::way |
+                                        osmium::osm_entity_bits::relation);
+    while (const osmium::memory::Buffer buffer = reader.read()) {
+      for (const auto& item : buffer) {
+        switch (item.type()) {
+          case osmium::item_type::node: {
+            // deleted nodes have no location but the ways they were removed from are changed too
+            const auto& node = static_cast<const osmium::Node&>(item);
+            change.nodes.insert(node.id());
+            if (node.location().valid()) {
+              change.node_locations.emplace_back(node.location().lon(), node.location().lat());
+            }
+            break;
+          }
+          case osmium::item_type::way:
+            change.ways.insert(static_cast<const osmium::Way&>(item).id());
+            break;
+          case osmium::item_type::relation:
+            // relations change the refs and restrictions of their member ways
+            for (const auto& member : static_cast<const osmium::Relation&>(item).members()) {
+              if (member.type() == osmium::item_type::way) {
+                change.ways.insert(member.ref());
+              }
+            }
+            break;
+          default:
+            break;
+        }
+      }
+    }
+    reader.close(); // Explicit close to get an exception in case of an error.
+  }
+  LOG_INFO("Found " + std::to_string(change.ways.size()) + " changed ways and " +
+           std::to_string(change.nodes.size()) + " changed nodes");
+  return change;
+#endif
+}
+
+std::unordered_set<GraphId> OSMChange::GetAffectedTiles(const std::string& tile_dir,
+                                                        const std::string& ways_file,
+                                                        const std::string& way_nodes_file,
+                                                        unsigned int concurrency) const {
+  const auto local_level = TileHierarchy::levels().back().level;
+  std::unordered_set<GraphId> tiles;
+
+  // The tiles of the changed nodes
+  for (const auto& ll : node_locations) {
+    tiles.insert(TileHierarchy::GetGraphId(ll, local_level));
+  }
+
+  // A node which moves changes the shape and length of the edges of every way using it, so those
+  // ways are changed too. Remember where the changed ways run through now, the nodes of the tiles
+  // from before the changes at those locations are where the changes connect to the old graph
+  std::unordered_set<uint64_t> changed_ways = ways;
+  std::unordered_set<uint64_t> locations;
+  {
+    sequence<OSMWayNode> way_nodes(way_nodes_file, false);
+    std::unordered_set<uint32_t> node_way_indices;
+    if (!nodes.empty()) {
+      for (const auto& way_node : way_nodes) {
+        if (nodes.count(way_node.node.osmid_)) {
+          node_way_indices.insert(way_node.way_index);
+        }
+      }
+    }
+
+    std::unordered_set<uint32_t> way_indices;
+    sequence<OSMWay> osm_ways(ways_file, false);
+    uint32_t way_index = 0;
+    for (const auto& way : osm_ways) {
+      if (changed_ways.count(way.way_id()) || node_way_indices.count(way_index)) {
+        way_indices.insert(way_index);
+        changed_ways.insert(way.way_id());
+      }
+      ++way_index;
+    }
+
+    for (const auto& way_node : way_nodes) {
+      auto ll = way_node.node.latlng();
+      if (way_indices.count(way_node.way_index) && ll.IsValid()) {
+        tiles.insert(TileHierarchy::GetGraphId(ll, local_level));
+        locations.insert(LocationKey(ll));
+      }
+    }
+  }
+
+  // The tiles the changed ways ran through before, along with the neighbors of every tile
+  boost::property_tree::ptree reader_pt;
+  reader_pt.put("tile_dir", tile_dir);
+  std::deque<GraphId> queue;
+  {
+    GraphReader reader(reader_pt);
+    auto tile_set = reader.GetTileSet(local_level);
+    queue.assign(tile_set.begin(), tile_set.end());
+  }
+  std::mutex lock;
+
+  std::vector<std::shared_ptr<std::thread>> threads(std::max(1u, concurrency));
+  std::vector<std::promise<TileScan>> results(threads.size());
+  for (size_t i = 0; i < threads.size(); ++i) {
+    threads[i] = std::make_shared<std::thread>([&reader_pt, &queue, &lock, &changed_ways,
+                                                &locations, &result = results[i]]() {
+      try {
+        GraphReader reader(reader_pt);
+        TileScan scan;
+        while (true) {
+          GraphId tile_id;
+          {
+            std::lock_guard<std::mutex> guard(lock);
+            if (queue.empty()) {
+              break;
+            }
+            tile_id = queue.front();
+            queue.pop_front();
+          }
+
+          auto tile = reader.GetGraphTile(tile_id);
+          auto& neighbors = scan.neighbors[tile_id];
+          for (uint32_t i = 0; i < tile->header()->nodecount(); ++i) {
+            const NodeInfo* node = tile->node(i);
+            GraphId node_id(tile_id.tileid(), tile_id.level(), i);
+            if (locations.count(LocationKey(node->latlng(tile->header()->base_ll())))) {
+              scan.nodes.push_back(node_id);
+            }
+            for (const auto& edge : tile->GetDirectedEdges(node)) {
+              auto end_tile = edge.endnode().tile_base();
+              if (end_tile != tile_id) {
+                neighbors.insert(end_tile);
+              }
+              if (changed_ways.count(tile->edgeinfo(&edge).wayid())) {
+                scan.changed.insert(tile_id);
+                scan.changed.insert(end_tile);
+                scan.nodes.push_back(node_id);
+                scan.nodes.push_back(edge.endnode());
+              }
+            }
+          }
+
+          if (reader.OverCommitted()) {
+            reader.Trim();
+          }
+        }
+        result.set_value(std::move(scan));
+      } catch (...) { result.set_exception(std::current_exception()); }
+    });
+  }
+  for (auto& thread : threads) {
+    thread->join();
+  }
+
+  std::unordered_map<GraphId, std::unordered_set<GraphId>> neighbors;
+  std::vector<GraphId> changed_nodes;
+  for (auto& result : results) {
+    auto scan = result.get_future().get();
+    tiles.insert(scan.changed.begin(), scan.changed.end());
+    neighbors.merge(scan.neighbors);
+    changed_nodes.insert(changed_nodes.end(), scan.nodes.begin(), scan.nodes.end());
+  }
+
+  // The enhancer looks beyond the tile it enhances, so the tiles within its reach change too
+  std::unordered_set<GraphId> affected;
+  {
+    GraphReader reader(reader_pt);
+    affected = GraphEnhancer::GetDependentTiles(reader, tiles, changed_nodes);
+  }
+
+  // Edges into the tiles with changed content have to be rebuilt with the new ids of their end
+  // nodes. Every edge has an opposing edge, so those are the edges of the tiles they lead to
+  for (const auto& tile_id : tiles) {
+    auto found = neighbors.find(tile_id);
+    if (found != neighbors.end()) {
+      affected.insert(found->second.begin(), found->second.end());
+    }
+  }
+  LOG_INFO("Changes affect " + std::to_string(affected.size()) + " local tiles");
+  return affected;
+}
+
+} // namespace mjolnir
+} // namespace valhalla
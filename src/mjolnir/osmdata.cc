@@ -11,7 +11,6 @@
 #include <sstream>
 
 using namespace valhalla::mjolnir;
-using valhalla::baldr::ConditionalSpeedLimit;
 
 namespace {
 
@@ -31,15 +30,6 @@ const std::string language_file = "osmdata_language_file.bin";
 const std::string conditional_speed_limit_file = "osmdata_conditional_speed_limit_file.bin";
 
 // Data structures to assist writing and reading data
-struct TempRestriction {
-  uint64_t way_id;
-  OSMRestriction restriction;
-  TempRestriction() : way_id(0), restriction(OSMRestriction()) {
-  }
-  TempRestriction(const uint64_t w, const OSMRestriction& r) : way_id(w), restriction(r) {
-  }
-};
-
 struct TempWayRef {
   uint64_t way_id;
   uint32_t name_index;
@@ -49,64 +39,6 @@ struct TempWayRef {
   }
 };
 
-struct BikeRelation {
-  uint64_t way_id;
-  OSMBike relation;
-  BikeRelation() : way_id(0), relation(OSMBike()) {
-  }
-  BikeRelation(const uint64_t w, const OSMBike& r) : way_id(w), relation(r) {
-  }
-};
-
-struct TempAccessRestriction {
-  uint64_t way_id;
-  OSMAccessRestriction restriction;
-  TempAccessRestriction() : way_id(0), restriction(OSMAccessRestriction()) {
-  }
-  TempAccessRestriction(const uint64_t w, const OSMAccessRestriction& r) : way_id(w), restriction(r) {
-  }
-};
-
-struct TempLaneConnectivity {
-  uint64_t way_id;
-  OSMLaneConnectivity lane;
-  TempLaneConnectivity() : way_id(0), lane(OSMLaneConnectivity()) {
-  }
-  TempLaneConnectivity(const uint64_t w, const OSMLaneConnectivity& l) : way_id(w), lane(l) {
-  }
-};
-
-struct TempLinguistic {
-  uint64_t way_id;
-  OSMLinguistic linguistic;
-  TempLinguistic() : way_id(0), linguistic(OSMLinguistic()) {
-  }
-  TempLinguistic(const uint64_t w, const OSMLinguistic& l) : way_id(w), linguistic(l) {
-  }
-};
-
-bool write_restrictions(const std::string& filename, const RestrictionsMultiMap& res_map) {
-  // Open file and truncate
-  std::ofstream file(filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
-  if (!file.is_open()) {
-    LOG_ERROR("write_restrictions failed to open output file: " + filename);
-    return false;
-  }
-
-  // Convert the multi map into a vector of TempRestriction
-  std::vector<TempRestriction> res;
-  for (auto it = res_map.cbegin(); it != res_map.cend(); ++it) {
-    res.emplace_back(it->first, it->second);
-  }
-
-  // Write the count and then the via ids
-  uint32_t sz = res.size();
-  file.write(reinterpret_cast<const char*>(&sz), sizeof(uint32_t));
-  file.write(reinterpret_cast<const char*>(res.data()), res.size() * sizeof(TempRestriction));
-  file.close();
-  return true;
-}
-
 bool write_viaset(const std::string& filename, const ViaSet& via_set) {
   // Open file and truncate
   std::ofstream file(filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
@@ -131,53 +63,6 @@ bool write_viaset(const std::string& filename, const ViaSet& via_set) {
   return true;
 }
 
-bool write_access_restrictions(const std::string& filename,
-                               const AccessRestrictionsMultiMap& access_map) {
-  // Open file and truncate
-  std::ofstream file(filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
-  if (!file.is_open()) {
-    LOG_ERROR("write_access_restrictions failed to open output file: " + filename);
-    return false;
-  }
-
-  // Convert the multi map into a vector of TempAccessRestriction
-  std::vector<TempAccessRestriction> res;
-  for (auto it = access_map.cbegin(); it != access_map.cend(); ++it) {
-    res.emplace_back(it->first, it->second);
-  }
-
-  // Write the count and then the via ids
-  uint32_t sz = res.size();
-  file.write(reinterpret_cast<const char*>(&sz), sizeof(uint32_t));
-  file.write(reinterpret_cast<const char*>(res.data()), res.size() * sizeof(TempAccessRestriction));
-  file.close();
-  return true;
-}
-
-bool write_bike_relations(const std::string& filename, const BikeMultiMap& bike_relations) {
-  // Open file and truncate
-  std::stringstream in_mem;
-  std::ofstream file(filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
-  if (!file.is_open()) {
-    LOG_ERROR("write_bike_relations failed to open output file: " + filename);
-    return false;
-  }
-
-  // Create a vector of bike relations from the multimap
-  std::vector<BikeRelation> relations;
-  for (auto it = bike_relations.cbegin(); it != bike_relations.cend(); ++it) {
-    relations.emplace_back(it->first, it->second);
-  }
-
-  // Write the count and then the bike relations
-  uint32_t sz = relations.size();
-  file.write(reinterpret_cast<const char*>(&sz), sizeof(uint32_t));
-  file.write(reinterpret_cast<const char*>(relations.data()),
-             relations.size() * sizeof(BikeRelation));
-  file.close();
-  return true;
-}
-
 bool write_way_refs(const std::string& filename, const OSMStringMap& way_refs) {
   // Open file and truncate
   std::ofstream file(filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
@@ -264,93 +149,6 @@ bool write_unique_names(const std::string& filename, const UniqueNames& names) {
   return true;
 }
 
-bool write_lane_connectivity(const std::string& filename,
-                             const OSMLaneConnectivityMultiMap& lane_map) {
-  // Open file and truncate
-  std::ofstream file(filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
-  if (!file.is_open()) {
-    LOG_ERROR("write_lane_connectivity failed to open output file: " + filename);
-    return false;
-  }
-
-  // Convert the multi map into a vector of TempLaneConnectivity
-  std::vector<TempLaneConnectivity> lanes;
-  for (auto it = lane_map.cbegin(); it != lane_map.cend(); ++it) {
-    lanes.emplace_back(it->first, it->second);
-  }
-
-  // Write the count and then the via ids
-  uint32_t sz = lanes.size();
-  file.write(reinterpret_cast<const char*>(&sz), sizeof(uint32_t));
-  file.write(reinterpret_cast<const char*>(lanes.data()),
-             lanes.size() * sizeof(TempLaneConnectivity));
-  file.close();
-  return true;
-  return true;
-}
-
-bool write_linguistic(const std::string& filename, const LinguisticMultiMap& ling_map) {
-  // Open file and truncate
-  std::ofstream file(filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
-  if (!file.is_open()) {
-    LOG_ERROR("write_linguistic failed to open output file: " + filename);
-    return false;
-  }
-
-  // Convert the multi map into a vector of TempLinguistic
-  std::vector<TempLinguistic> ling;
-  for (auto it = ling_map.cbegin(); it != ling_map.cend(); ++it) {
-    ling.emplace_back(it->first, it->second);
-  }
-
-  // Write the count and then the via ids
-  uint32_t sz = ling.size();
-  file.write(reinterpret_cast<const char*>(&sz), sizeof(uint32_t));
-  file.write(reinterpret_cast<const char*>(ling.data()), ling.size() * sizeof(TempLinguistic));
-  file.close();
-  return true;
-}
-
-bool write_conditional_speed_limits(const std::string& filename,
-                                    const ConditionalSpeedLimitsMultiMap& speed_map) {
-  // Open file and truncate
-  std::ofstream file(filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
-  if (!file.is_open()) {
-    LOG_ERROR("write_linguistic failed to open output file: " + filename);
-    return false;
-  }
-
-  uint32_t sz = speed_map.size();
-  file.write(reinterpret_cast<const char*>(&sz), sizeof(uint32_t));
-  for (const std::pair<const uint64_t, ConditionalSpeedLimit>& sp : speed_map) {
-    file.write(reinterpret_cast<const char*>(&sp), sizeof(sp));
-  }
-  file.close();
-  return true;
-}
-
-bool read_restrictions(const std::string& filename, RestrictionsMultiMap& res_map) {
-  // Open file and truncate
-  std::ifstream file(filename, std::ios::in | std::ios::binary);
-  if (!file.is_open()) {
-    LOG_ERROR("read_restrictions failed to open input file: " + filename);
-    return false;
-  }
-
-  // Read the count and then the temporary restriction list
-  uint32_t count = 0;
-  file.read(reinterpret_cast<char*>(&count), sizeof(uint32_t));
-  std::vector<TempRestriction> access_res(count);
-  file.read(reinterpret_cast<char*>(access_res.data()), count * sizeof(TempRestriction));
-  file.close();
-
-  // Iterate through the temporary restriction list and add to the restriction multi-map
-  for (const auto& r : access_res) {
-    res_map.insert({r.way_id, r.restriction});
-  }
-  return true;
-}
-
 bool read_viaset(const std::string& filename, ViaSet& via_set) {
   // Open file and truncate
   std::ifstream file(filename, std::ios::in | std::ios::binary);
@@ -373,50 +171,6 @@ bool read_viaset(const std::string& filename, ViaSet& via_set) {
   return true;
 }
 
-bool read_access_restrictions(const std::string& filename, AccessRestrictionsMultiMap& access_map) {
-  // Open file and truncate
-  std::ifstream file(filename, std::ios::in | std::ios::binary);
-  if (!file.is_open()) {
-    LOG_ERROR("read_access_restrictions failed to open input file: " + filename);
-    return false;
-  }
-
-  // Read the count and then the temporary access restriction list
-  uint32_t count = 0;
-  file.read(reinterpret_cast<char*>(&count), sizeof(uint32_t));
-  std::vector<TempAccessRestriction> access_res(count);
-  file.read(reinterpret_cast<char*>(access_res.data()), count * sizeof(TempAccessRestriction));
-  file.close();
-
-  // Iterate through the temporary access restriction list and add to the restriction multi-map
-  for (const auto& r : access_res) {
-    access_map.insert({r.way_id, r.restriction});
-  }
-  return true;
-}
-
-bool read_bike_relations(const std::string& filename, BikeMultiMap& bike_relations) {
-  // Open file and truncate
-  std::ifstream file(filename, std::ios::in | std::ios::binary);
-  if (!file.is_open()) {
-    LOG_ERROR("read_bike_relations failed to open input file: " + filename);
-    return false;
-  }
-
-  // Read the count and then the bike relations list
-  uint32_t count = 0;
-  file.read(reinterpret_cast<char*>(&count), sizeof(uint32_t));
-  std::vector<BikeRelation> rel(count);
-  file.read(reinterpret_cast<char*>(rel.data()), count * sizeof(BikeRelation));
-  file.close();
-
-  // Iterate through the temporary bike relations list and add to the bike relations multi-map
-  for (const auto& r : rel) {
-    bike_relations.insert({r.way_id, r.relation});
-  }
-  return true;
-}
-
 bool read_way_refs(const std::string& filename, OSMStringMap& way_refs) {
   // Open file and truncate
   std::ifstream file(filename, std::ios::in | std::ios::binary);
@@ -502,72 +256,6 @@ bool read_unique_names(const std::string& filename, UniqueNames& names) {
   return true;
 }
 
-bool read_lane_connectivity(const std::string& filename, OSMLaneConnectivityMultiMap& lane_map) {
-  // Open file and truncate
-  std::ifstream file(filename, std::ios::in | std::ios::binary);
-  if (!file.is_open()) {
-    LOG_ERROR("read_lane_connectivity failed to open input file: " + filename);
-    return false;
-  }
-
-  // Read the count and then the temporary lane connectivity list
-  uint32_t count = 0;
-  file.read(reinterpret_cast<char*>(&count), sizeof(uint32_t));
-  std::vector<TempLaneConnectivity> lanes(count);
-  file.read(reinterpret_cast<char*>(lanes.data()), count * sizeof(TempLaneConnectivity));
-  file.close();
-
-  // Iterate through the temporary lane connectivity list and add to the lane connectivity multi-map
-  for (const auto& l : lanes) {
-    lane_map.insert({l.way_id, l.lane});
-  }
-  return true;
-}
-
-bool read_linguistic(const std::string& filename, LinguisticMultiMap& ling_map) {
-  // Open file and truncate
-  std::ifstream file(filename, std::ios::in | std::ios::binary);
-  if (!file.is_open()) {
-    LOG_ERROR("read_linguistic failed to open input file: " + filename);
-    return false;
-  }
-
-  // Read the count and then the temporary access restriction list
-  uint32_t count = 0;
-  file.read(reinterpret_cast<char*>(&count), sizeof(uint32_t));
-  std::vector<TempLinguistic> ling(count);
-  file.read(reinterpret_cast<char*>(ling.data()), count * sizeof(TempLinguistic));
-  file.close();
-
-  // Iterate through the temporary access restriction list and add to the restriction multi-map
-  for (const auto& l : ling) {
-    ling_map.insert({l.way_id, l.linguistic});
-  }
-  return true;
-}
-
-bool read_conditional_speed_limits(const std::string& filename,
-                                   ConditionalSpeedLimitsMultiMap& speed_map) {
-  // Open file and truncate
-  std::ifstream file(filename, std::ios::in | std::ios::binary);
-  if (!file.is_open()) {
-    LOG_ERROR("read_conditional_speed_limits failed to open input file: " + filename);
-    return false;
-  }
-
-  // Read the count and following conditional speed limits
-  uint32_t count = 0;
-  file.read(reinterpret_cast<char*>(&count), sizeof(uint32_t));
-  speed_map.reserve(count);
-  while (count--) {
-    std::pair<uint64_t, ConditionalSpeedLimit> sp = {{}, {}};
-    file.read(reinterpret_cast<char*>(&sp), sizeof(sp));
-    speed_map.emplace(std::move(sp));
-  }
-  file.close();
-  return true;
-}
-
 } // namespace
 
 namespace valhalla {
@@ -600,18 +288,18 @@ bool OSMData::write_to_temp_files(const std::string& tile_dir) {
 
   // Write the rest of OSMData
   bool status =
-      write_restrictions(tile_dir + restrictions_file, restrictions) &&
+      restrictions.write(tile_dir + restrictions_file) &&
       write_viaset(tile_dir + viaset_file, via_set) &&
-      write_access_restrictions(tile_dir + access_restrictions_file, access_restrictions) &&
-      write_bike_relations(tile_dir + bike_relations_file, bike_relations) &&
+      access_restrictions.write(tile_dir + access_restrictions_file) &&
+      bike_relations.write(tile_dir + bike_relations_file) &&
       write_way_refs(tile_dir + way_ref_file, way_ref) &&
       write_way_refs(tile_dir + way_ref_rev_file, way_ref_rev) &&
       write_node_names(tile_dir + node_names_file, node_names) &&
       write_unique_names(tile_dir + unique_names_file, name_offset_map) &&
-      write_lane_connectivity(tile_dir + lane_connectivity_file, lane_connectivity_map) &&
-      write_linguistic(tile_dir + pronunciation_file, pronunciations) &&
-      write_linguistic(tile_dir + language_file, langs) &&
-      write_conditional_speed_limits(tile_dir + conditional_speed_limit_file, conditional_speeds);
+      lane_connectivity_map.write(tile_dir + lane_connectivity_file) &&
+      pronunciations.write(tile_dir + pronunciation_file) &&
+      langs.write(tile_dir + language_file) &&
+      conditional_speeds.write(tile_dir + conditional_speed_limit_file);
   LOG_INFO("Done");
   return status;
 }
@@ -648,23 +336,34 @@ bool OSMData::read_from_temp_files(const std::string& tile_dir) {
 
   // Read the other data
   bool status =
-      read_restrictions(tile_directory + restrictions_file, restrictions) &&
+      restrictions.map(tile_directory + restrictions_file) &&
       read_viaset(tile_directory + viaset_file, via_set) &&
-      read_access_restrictions(tile_directory + access_restrictions_file, access_restrictions) &&
-      read_bike_relations(tile_directory + bike_relations_file, bike_relations) &&
+      access_restrictions.map(tile_directory + access_restrictions_file) &&
+      bike_relations.map(tile_directory + bike_relations_file) &&
       read_way_refs(tile_directory + way_ref_file, way_ref) &&
       read_way_refs(tile_directory + way_ref_rev_file, way_ref_rev) &&
       read_node_names(tile_directory + node_names_file, node_names) &&
       read_unique_names(tile_directory + unique_names_file, name_offset_map) &&
-      read_lane_connectivity(tile_directory + lane_connectivity_file, lane_connectivity_map) &&
-      read_linguistic(tile_directory + pronunciation_file, pronunciations) &&
-      read_linguistic(tile_directory + language_file, langs) &&
-      read_conditional_speed_limits(tile_directory + lane_connectivity_file, conditional_speeds);
+      lane_connectivity_map.map(tile_directory + lane_connectivity_file) &&
+      pronunciations.map(tile_directory + pronunciation_file) &&
+      langs.map(tile_directory + language_file) &&
+      conditional_speeds.map(tile_directory + conditional_speed_limit_file);
   LOG_INFO("Done");
   initialized = status;
   return status;
 }
 
+// Sort the multimaps filled while parsing so that they can be looked up
+void OSMData::sort_maps() {
+  restrictions.sort();
+  access_restrictions.sort();
+  bike_relations.sort();
+  lane_connectivity_map.sort();
+  pronunciations.sort();
+  langs.sort();
+  conditional_speeds.sort();
+}
+
 // Read OSMData from temporary files
 bool OSMData::read_from_unique_names_file(const std::string& tile_dir) {
   SCOPED_TIMER();
@@ -24,6 +24,12 @@
 #include <osmium/io/xml_input.hpp>
 #endif
 
+#include <chrono>
+#include <filesystem>
+#include <format>
+#include <functional>
+#include <future>
+#include <memory>
 #include <thread>
 #include <utility>
 
@@ -33,17 +39,163 @@ using namespace valhalla::mjolnir;
 
 namespace {
 
-// Limits number of Lua workers in `PBFGraphParser::ParseWays()`.
+// Limits number of Lua workers in each of the `PBFGraphParser` passes.
 // Increase this number if downstream processing can handle more.
 constexpr size_t kMaxLuaConcurrency = 8;
-// Number of OSM pbf buffers per Lua worker in `PBFGraphParser::ParseWays()`.
+// Number of OSM pbf buffers per Lua worker in each of the `PBFGraphParser` passes.
 constexpr size_t kOsmBuffersPerLua = 4;
-// Number of processed OSM pbf buffers (buffer has many ways) per Lua worker. That one should be
-// reasonably big because `PBFGraphParser::ParseWays()` keeps original order of OSM ways and this
-// buffer allows Lua workers not to stuck if next needed buffer takes more time than others.
+// Number of processed OSM pbf buffers (buffer has many objects) per Lua worker. That one should be
+// reasonably big because the `PBFGraphParser` passes keep the original order of OSM objects and
+// this buffer allows Lua workers not to stuck if next needed buffer takes more time than others.
 constexpr size_t kWaysChunksPerLua = 8;
 constexpr char kExceptDestinationRestrictionFlag = '~';
 
+using seconds_t = std::chrono::duration<double>;
+
+// A function transforming a whole osmium buffer, made once for every Lua worker
+template <typename result_t>
+using buffer_transform_t = std::function<result_t(const osmium::memory::Buffer&)>;
+
+// Asymmetric multithreading (in data flow order):
+// - osmium::thread::pool for parsing PBF file
+// - 1 thread to feed the Lua transform pool and guarantee the order of the osmium buffers
+// - `lua_concurrency` threads transforming whole buffers, each with its own `make_transform()`
+// - current thread for handing the transformed buffers to `consume` in the order of the file
+// Any exception thrown along the way is rethrown once all of the threads are done.
+template <typename result_t>
+void parse_in_parallel(const std::string& file,
+                       osmium::osm_entity_bits::type entities,
+                       size_t lua_concurrency,
+                       const std::function<buffer_transform_t<result_t>()>& make_transform,
+                       const std::function<void(result_t&)>& consume) {
+  // These two queues maintains the order of processed buffers by holding futures that correspond
+  // to the promises sent to the Lua workers. Lua workers take that promises and corresponding
+  // osmium buffers, process them and set the value of the promise.
+  osmium::thread::Queue<std::future<result_t>> results_queue(lua_concurrency * kWaysChunksPerLua);
+  osmium::thread::Queue<std::pair<osmium::memory::Buffer, std::promise<result_t>>> buffer_queue(
+      lua_concurrency * kOsmBuffersPerLua);
+
+  // Single reader thread that guarantees the order of buffers via future/promise magic.
+  std::exception_ptr reader_error;
+  std::thread reader_thread([&] {
+    try {
+      osmium::io::Reader reader(file, entities);
+      while (osmium::memory::Buffer buffer = reader.read()) {
+        std::promise<result_t> promise;
+        results_queue.push(promise.get_future()); // Blocks if queue is full.
+        buffer_queue.push(std::make_pair(std::move(buffer), std::move(promise)));
+      }
+      reader.close(); // Explicit close to get an exception in case of an error.
+    } catch (...) { reader_error = std::current_exception(); }
+
+    // Send stop signals to all threads.
+    results_queue.push({});
+    for (size_t i = 0; i < lua_concurrency; ++i) {
+      buffer_queue.push({});
+    }
+  });
+
+  // Thread pool for Lua processing. Workers keep draining the queue after a failure so that the
+  // reader never blocks on a full queue.
+  std::vector<std::thread> lua_pool;
+  lua_pool.reserve(lua_concurrency);
+  for (size_t i = 0; i < lua_concurrency; ++i) {
+    lua_pool.emplace_back(std::thread([&make_transform, &buffer_queue] {
+      buffer_transform_t<result_t> transform;
+      std::exception_ptr error;
+      try {
+        transform = make_transform();
+      } catch (...) { error = std::current_exception(); }
+
+      while (true) {
+        std::pair<osmium::memory::Buffer, std::promise<result_t>> buffer_promise;
+        buffer_queue.wait_and_pop(buffer_promise);
+        if (!buffer_promise.first) {
+          break; // End of the queue
+        }
+
+        try {
+          if (error) {
+            std::rethrow_exception(error);
+          }
+          buffer_promise.second.set_value(transform(buffer_promise.first));
+        } catch (...) { buffer_promise.second.set_exception(std::current_exception()); }
+      }
+    }));
+  }
+
+  std::exception_ptr error;
+  while (true) {
+    std::future<result_t> future;
+    results_queue.wait_and_pop(future);
+    if (!future.valid()) {
+      break; // End of the queue
+    }
+
+    try {
+      result_t transformed = future.get();
+      if (!error) {
+        consume(transformed);
+      }
+    } catch (...) {
+      if (!error) {
+        error = std::current_exception();
+      }
+    }
+  }
+
+  reader_thread.join();
+  for (auto& t : lua_pool) {
+    t.join();
+  }
+  if (reader_error) {
+    std::rethrow_exception(reader_error);
+  }
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+// Looks up ids in a sorted sequence of ids. The nodes of a pbf are sorted by id and every Lua
+// worker gets its buffers in the order of the file, so the ids one worker asks about only ever
+// grow. The cursor gallops forward from the last id found instead of searching all of the ids
+// every time, and only falls back to searching from the start if the ids do go backwards
+class sorted_ids_cursor {
+public:
+  explicit sorted_ids_cursor(const std::string& file) : ids_(file, false, 0) {
+  }
+
+  // Whether the sorted ids contain the id
+  bool contains(const uint64_t id) {
+    size_t low = pos_, high = ids_.size();
+    if (low > 0 && *ids_[low - 1] >= id) {
+      low = 0;
+    } else {
+      for (size_t step = 1; low + step < high; step *= 2) {
+        if (*ids_[low + step] >= id) {
+          high = low + step + 1;
+          break;
+        }
+        low += step;
+      }
+    }
+    while (low < high) {
+      const size_t mid = low + (high - low) / 2;
+      if (*ids_[mid] < id) {
+        low = mid + 1;
+      } else {
+        high = mid;
+      }
+    }
+    pos_ = low;
+    return low < ids_.size() && *ids_[low] == id;
+  }
+
+private:
+  sequence<uint64_t> ids_;
+  size_t pos_ = 0;
+};
+
 // Convenience method to get a number from a string. Uses try/catch in case
 // to_int throws an exception
 int get_number(std::string_view tag, const std::string& value) { // NOLINT
@@ -162,7 +314,7 @@ private:
 // Construct PBFGraphParser based on properties file and input PBF extract
 struct graph_parser {
   graph_parser(const boost::property_tree::ptree& pt, OSMData& osmdata)
-      : lua_(get_lua(pt)), osmdata_(osmdata) {
+      : osmdata_(osmdata) {
     current_way_node_index_ = last_node_ = last_way_ = last_relation_ = 0;
 
     highway_cutoff_rc_ = RoadClass::kPrimary;
@@ -184,9 +336,6 @@ struct graph_parser {
     use_rest_area_ = pt.get<bool>("data_processing.use_rest_area", false);
     use_admin_db_ = pt.get<bool>("data_processing.use_admin_db", true);
 
-    empty_node_tags_ = lua_.Transform(OSMType::kNode, 0, {});
-    empty_relation_tags_ = lua_.Transform(OSMType::kRelation, 0, {});
-
     tag_handlers_["driving_side"] = [this]() {
       if (!use_admin_db_) {
         way_.set_drive_on_right(tag_.second == "right" ? true : false);
@@ -1990,20 +2139,75 @@ struct graph_parser {
     return std::string(lua_graph_lua, lua_graph_lua + lua_graph_lua_len);
   }
 
+  // Intermediate structure that represents transformed (by Lua) osm node
+  struct Node {
+    uint64_t osmid;
+    double lng;
+    double lat;
+    Tags tags;
+  };
+
+  // The transformed nodes of one osmium buffer, along with what is needed to check the order and
+  // changesets of all of the nodes in the buffer including the ones which were not kept
+  struct Nodes {
+    std::vector<Node> nodes;
+    size_t count = 0;
+    uint64_t first_id = 0;
+    uint64_t last_id = 0;
+    uint64_t max_changeset_id = 0;
+    bool sorted = true;
+
+    void track(const osmium::Node& node) {
+      const uint64_t osmid = node.id();
+      sorted = sorted && (count == 0 || last_id <= osmid);
+      first_id = count++ == 0 ? osmid : first_id;
+      last_id = osmid;
+      max_changeset_id = std::max(max_changeset_id, static_cast<uint64_t>(node.changeset()));
+    }
+  };
+
+  // Transform the node if `keep` says it is needed. Don't bother calling Lua if there are no OSM
+  // tags to process.
+  template <typename keep_t>
+  static void transform_node(const osmium::Node& node,
+                             LuaTagTransform& lua,
+                             const Tags& empty_node_tags,
+                             const keep_t& keep,
+                             Nodes& transformed) {
+    transformed.track(node);
+    if (!keep(node)) {
+      return;
+    }
+    transformed.nodes.emplace_back(
+        Node{static_cast<uint64_t>(node.id()), node.location().lon(), node.location().lat(),
+             node.tags().empty() ? empty_node_tags
+                                 : lua.Transform(OSMType::kNode, node.id(), node.tags())});
+  }
+
+  // Check the order of the nodes of a buffer and hand the ones kept to the handler
+  template <typename handler_t> void nodes(const Nodes& transformed, const handler_t& handler) {
+    // unsorted extracts are just plain nasty, so they can bugger off!
+    if (transformed.count && (!transformed.sorted || transformed.first_id < last_node_)) {
+      throw std::runtime_error("Detected unsorted input data");
+    }
+    changeset(transformed.max_changeset_id);
+    for (const auto& node : transformed.nodes) {
+      handler(node);
+    }
+    last_node_ = std::max(last_node_, transformed.last_id);
+  }
+
   // Handle bike share stations separately
-  void bss_node(const osmium::Node& node) {
-    const uint64_t osmid = node.id();
+  void bss_node(const Node& node) {
+    const uint64_t osmid = node.osmid;
     // unsorted extracts are just plain nasty, so they can bugger off!
     if (osmid < last_node_) {
       throw std::runtime_error("Detected unsorted input data");
     }
     last_node_ = osmid;
 
-    // Get tags - do't bother with Lua callout if the taglist is empty
-    const Tags tags = node.tags().empty() ? empty_node_tags_
-                                          : lua_.Transform(OSMType::kNode, node.id(), node.tags());
-
     // bail if there is nothing bike related
+    const Tags& tags = node.tags;
     Tags::const_iterator found = tags.find("amenity");
     if (found == tags.end() || found->second != "bicycle_rental") {
       return;
@@ -2011,7 +2215,7 @@ struct graph_parser {
 
     // Create a new node and set its attributes
     OSMNode n{osmid};
-    n.set_latlng(node.location().lon(), node.location().lat());
+    n.set_latlng(node.lng, node.lat);
     n.set_type(NodeType::kBikeShare);
     valhalla::BikeShareStationInfo bss_info;
 
@@ -2042,10 +2246,8 @@ struct graph_parser {
     bss_nodes_->push_back({n, bss_info_index});
   }
 
-  void node(const osmium::Node& node) {
-    changeset(node.changeset());
-
-    const uint64_t osmid = node.id();
+  void node(const Node& node) {
+    const uint64_t osmid = node.osmid;
     // unsorted extracts are just plain nasty, so they can bugger off!
     if (osmid < last_node_) {
       throw std::runtime_error("Detected unsorted input data");
@@ -2075,10 +2277,7 @@ struct graph_parser {
       return;
     }
 
-    // Get tags if not already available.  Don't bother calling Lua if there
-    // are no OSM tags to process.
-    const Tags tags =
-        node.tags().empty() ? empty_node_tags_ : lua_.Transform(OSMType::kNode, osmid, node.tags());
+    const Tags& tags = node.tags;
 
     const auto highway = tags.find("highway");
     bool is_highway_junction = ((highway != tags.end()) && (highway->second == "motorway_junction"));
@@ -2102,7 +2301,7 @@ struct graph_parser {
     OSMNode n;
     OSMNodeLinguistic linguistics;
     n.set_id(osmid);
-    n.set_latlng(node.location().lon(), node.location().lat());
+    n.set_latlng(node.lng, node.lat);
     bool intersection = false;
     if (is_highway_junction) {
       n.set_type(NodeType::kMotorWayJunction);
@@ -3816,10 +4015,48 @@ struct graph_parser {
     ways_->push_back(way_);
   }
 
-  void relation(const osmium::Relation& relation) {
-    changeset(relation.changeset());
+  // Intermediate structure that represents a member of a transformed osm relation
+  struct Member {
+    osmium::item_type member_type;
+    uint64_t member_id;
+    std::string role;
+  };
 
-    const uint64_t osmid = relation.id();
+  // Intermediate structure that represents transformed (by Lua) osm relation
+  struct Relation {
+    uint64_t osmid;
+    uint64_t changeset_id;
+    Tags tags;
+    std::vector<Member> members;
+  };
+
+  static void transform_relation(const osmium::Relation& relation,
+                                 LuaTagTransform& lua,
+                                 const Tags& empty_relation_tags,
+                                 std::vector<Relation>& transformed) {
+    // Relations without tags suitable for routing are still needed to check the order and
+    // changesets of the input
+    auto& r = transformed.emplace_back(
+        Relation{static_cast<uint64_t>(relation.id()), relation.changeset(),
+                 relation.tags().empty()
+                     ? empty_relation_tags
+                     : lua.Transform(OSMType::kRelation, relation.id(), relation.tags()),
+                 {}});
+    if (r.tags.empty()) {
+      return;
+    }
+
+    r.members.reserve(relation.members().size());
+    for (const auto& member : relation.members()) {
+      r.members.push_back(
+          Member{member.type(), static_cast<uint64_t>(member.ref()), std::string(member.role())});
+    }
+  }
+
+  void relation(const Relation& relation) {
+    changeset(relation.changeset_id);
+
+    const uint64_t osmid = relation.osmid;
     // unsorted extracts are just plain nasty, so they can bugger off!
     if (osmid < last_relation_) {
       throw std::runtime_error("Detected unsorted input data");
@@ -3827,9 +4064,7 @@ struct graph_parser {
     last_relation_ = osmid;
 
     // Get tags
-    const Tags tags = relation.tags().empty()
-                          ? empty_relation_tags_
-                          : lua_.Transform(OSMType::kRelation, osmid, relation.tags());
+    const Tags& tags = relation.tags;
     if (tags.empty()) {
       return;
     }
@@ -4009,18 +4244,7 @@ struct graph_parser {
         special_network = true;
     }
 
-    // Convert into a vector of helper structs to simplify processing by using
-    // `std::string_view` for `role` instead of original `const char*`.
-    struct Member {
-      osmium::item_type member_type;
-      uint64_t member_id;
-      std::string_view role;
-    };
-    std::vector<Member> members;
-    members.reserve(relation.members().size());
-    for (const auto& member : relation.members()) {
-      members.push_back(Member{member.type(), static_cast<uint64_t>(member.ref()), member.role()});
-    }
+    const auto& members = relation.members;
 
     if (isBicycle && isRoute && !network.empty()) {
       OSMBike bike;
@@ -5057,9 +5281,6 @@ struct graph_parser {
   // Road class assignment needs to be set to the highway cutoff for ferries and auto trains.
   RoadClass highway_cutoff_rc_;
 
-  // Lua Tag Transformation class
-  LuaTagTransform lua_;
-
   // Pointer to all the OSM data (for use by callbacks)
   OSMData& osmdata_;
 
@@ -5089,10 +5310,6 @@ struct graph_parser {
   // used to set "culdesac" labels to loop roads correctly
   culdesac_processor culdesac_processor_;
 
-  // empty objects initialized with defaults to use when no tags are present on objects
-  Tags empty_node_tags_;
-  Tags empty_relation_tags_;
-
   uint32_t get_pronunciation_index(const uint8_t type, const uint8_t alpha) {
     auto itr = pronunciationMap.find(std::make_pair(type, alpha));
     if (itr != pronunciationMap.end()) {
@@ -5126,13 +5343,9 @@ OSMData PBFGraphParser::ParseWays(const boost::property_tree::ptree& pt,
   graph_parser parser(pt, osmdata);
   const auto lua_script = graph_parser::get_lua(pt);
 
-  // Asymmetric multithreading (in data flow order):
-  // - osmium::thread::pool for parsing PBF file
-  // - 1 thread to feed the lua transform pool and guarantee the order of ways
-  // - `lua_concurrency` threads for lua transform, no more than `kMaxLuaConcurrency`
-  // - current thread for working with OSMData in `graph_parser::way()`
-  // None of them will saturate the full CPU core, so total count can be bigger than
-  // `std::thread::hardware_concurrency()` or "concurrency" parameter.
+  // Lua transforms whole buffers of ways in parallel, `graph_parser::way()` works with OSMData on
+  // the current thread (see `parse_in_parallel()`). None of them will saturate the full CPU core,
+  // so total count can be bigger than `std::thread::hardware_concurrency()` or "concurrency".
   const size_t concurrency =
       std::max(static_cast<size_t>(1),
                pt.get<size_t>("concurrency", std::thread::hardware_concurrency()));
@@ -5146,77 +5359,28 @@ OSMData PBFGraphParser::ParseWays(const boost::property_tree::ptree& pt,
   // Parse the ways and find all node Ids needed (those that are part of a
   // way's node list. Iterate through each pbf input file.
   LOG_INFO("Parsing ways...");
+  using Ways = std::vector<graph_parser::Way>;
   for (auto& file : input_files) {
     parser.current_way_node_index_ = parser.last_node_ = parser.last_way_ = parser.last_relation_ = 0;
-
-    // These two queues maintains the order of processed ways by holding futures that correspond
-    // to the promises sent to the Lua workers. Lua workers take that promises and corresponding
-    // osmium buffers, process them and set the value of the promise.
-    using Ways = std::vector<graph_parser::Way>;
-    osmium::thread::Queue<std::future<Ways>> ways_queue(lua_concurrency * kWaysChunksPerLua);
-    osmium::thread::Queue<std::pair<osmium::memory::Buffer, std::promise<Ways>>> buffer_queue(
-        lua_concurrency * kOsmBuffersPerLua);
-
-    // Single reader thread that guarantees the order of ways via future/promise magic.
-    std::thread reader_thread([&file, &ways_queue, &buffer_queue, lua_concurrency] {
-      osmium::io::Reader reader(file, osmium::osm_entity_bits::way);
-      while (osmium::memory::Buffer buffer = reader.read()) {
-        std::promise<Ways> promise;
-        ways_queue.push(promise.get_future()); // Blocks if queue is full.
-        buffer_queue.push(std::make_pair(std::move(buffer), std::move(promise)));
-      }
-
-      // Send stop signals to all threads.
-      ways_queue.push({});
-      for (size_t i = 0; i < lua_concurrency; ++i) {
-        buffer_queue.push({});
-      }
-
-      reader.close(); // Explicit close to get an exception in case of an error.
-    });
-
-    // Thread pool for Lua processing.
-    std::vector<std::thread> lua_pool;
-    lua_pool.reserve(lua_concurrency);
-    for (size_t i = 0; i < lua_concurrency; ++i) {
-      lua_pool.emplace_back(std::thread([&lua_script, &buffer_queue] {
-        LuaTagTransform lua(lua_script);
-        const Tags empty_way_tags = lua.Transform(OSMType::kWay, 0, {});
-
-        while (true) {
-          std::pair<osmium::memory::Buffer, std::promise<Ways>> buffer_promise;
-          buffer_queue.wait_and_pop(buffer_promise);
-          if (!buffer_promise.first) {
-            break; // End of the queue
-          }
-
-          Ways transformed;
-          for (const osmium::memory::Item& item : buffer_promise.first) {
-            graph_parser::transform_way(static_cast<const osmium::Way&>(item), lua, empty_way_tags,
-                                        transformed);
+    parse_in_parallel<Ways>(
+        file, osmium::osm_entity_bits::way, lua_concurrency,
+        [&lua_script]() -> buffer_transform_t<Ways> {
+          auto lua = std::make_shared<LuaTagTransform>(lua_script);
+          auto empty_way_tags = std::make_shared<const Tags>(lua->Transform(OSMType::kWay, 0, {}));
+          return [lua, empty_way_tags](const osmium::memory::Buffer& buffer) {
+            Ways transformed;
+            for (const osmium::memory::Item& item : buffer) {
+              graph_parser::transform_way(static_cast<const osmium::Way&>(item), *lua,
+                                          *empty_way_tags, transformed);
+            }
+            return transformed;
+          };
+        },
+        [&parser](Ways& transformed) {
+          for (const auto& way : transformed) {
+            parser.way(way);
           }
-          buffer_promise.second.set_value(std::move(transformed));
-        }
-      }));
-    }
-
-    while (true) {
-      std::future<Ways> future;
-      ways_queue.wait_and_pop(future);
-      if (!future.valid()) {
-        break; // End of the queue
-      }
-
-      Ways transformed = future.get();
-      for (const auto& way : transformed) {
-        parser.way(way);
-      }
-    }
-
-    reader_thread.join();
-    for (auto& t : lua_pool) {
-      t.join();
-    }
+        });
   }
 
   // Clarifies types of loop roads and saves fixed ways.
@@ -5231,9 +5395,13 @@ OSMData PBFGraphParser::ParseWays(const boost::property_tree::ptree& pt,
   LOG_INFO("Sorting osm access tags by way id...");
   {
     sequence<OSMAccess> access(access_file, false);
-    access.sort([](const OSMAccess& a, const OSMAccess& b) { return a.way_id() < b.way_id(); });
+    access.sort([](const OSMAccess& a, const OSMAccess& b) { return a.way_id() < b.way_id(); },
+                0, static_cast<unsigned int>(concurrency));
   }
 
+  // sort the restrictions, linguistics etc. by way id so that they can be looked up
+  osmdata.sort_maps();
+
   LOG_INFO("Finished");
 
   // Return OSM data
@@ -5246,16 +5414,15 @@ void PBFGraphParser::ParseRelations(const boost::property_tree::ptree& pt,
                                     const std::string& complex_restriction_from_file,
                                     const std::string& complex_restriction_to_file,
                                     OSMData& osmdata) {
-  // TODO: option 1: each one threads makes an osmdata and we splice them together at the end
-  // option 2: synchronize around adding things to a single osmdata. will have to test to see
-  // which is the least expensive (memory and speed). leaning towards option 2
-  //  unsigned int threads =
-  //      std::max(static_cast<unsigned int>(1),
-  //               pt.get<unsigned int>("concurrency", std::thread::hardware_concurrency()));
-
   // Create OSM data. Set the member pointer so that the parsing callback methods can use it.
   SCOPED_TIMER();
   graph_parser parser(pt, osmdata);
+  const auto lua_script = graph_parser::get_lua(pt);
+  const size_t lua_concurrency =
+      std::clamp(std::max(static_cast<size_t>(1),
+                          pt.get<size_t>("concurrency", std::thread::hardware_concurrency())) -
+                     1,
+                 static_cast<size_t>(1), kMaxLuaConcurrency);
 
   // Read the OSMData to files if not initialized.
   if (!osmdata.initialized)
@@ -5267,19 +5434,36 @@ void PBFGraphParser::ParseRelations(const boost::property_tree::ptree& pt,
                new sequence<OSMRestriction>(complex_restriction_from_file, true),
                new sequence<OSMRestriction>(complex_restriction_to_file, true), nullptr, nullptr);
 
-  // Parse relations.
+  // Parse relations. Lua transforms whole buffers of relations in parallel while OSMData is
+  // only ever touched on this thread, in the order of the file.
   LOG_INFO("Parsing relations...");
+  const auto relations_start = std::chrono::steady_clock::now();
+  using Relations = std::vector<graph_parser::Relation>;
   for (auto& file : input_files) {
     parser.current_way_node_index_ = parser.last_node_ = parser.last_way_ = parser.last_relation_ = 0;
-
-    osmium::io::Reader reader(file, osmium::osm_entity_bits::relation);
-    while (const osmium::memory::Buffer buffer = reader.read()) {
-      for (const osmium::memory::Item& item : buffer) {
-        parser.relation(static_cast<const osmium::Relation&>(item));
-      }
-    }
-    reader.close(); // Explicit close to get an exception in case of an error.
+    parse_in_parallel<Relations>(
+        file, osmium::osm_entity_bits::relation, lua_concurrency,
+        [&lua_script]() -> buffer_transform_t<Relations> {
+          auto lua = std::make_shared<LuaTagTransform>(lua_script);
+          auto empty_relation_tags =
+              std::make_shared<const Tags>(lua->Transform(OSMType::kRelation, 0, {}));
+          return [lua, empty_relation_tags](const osmium::memory::Buffer& buffer) {
+            Relations transformed;
+            for (const osmium::memory::Item& item : buffer) {
+              graph_parser::transform_relation(static_cast<const osmium::Relation&>(item), *lua,
+                                               *empty_relation_tags, transformed);
+            }
+            return transformed;
+          };
+        },
+        [&parser](Relations& transformed) {
+          for (const auto& relation : transformed) {
+            parser.relation(relation);
+          }
+        });
   }
+  LOG_INFO(std::format("Parsed relations in {:.2f}s",
+                       seconds_t(std::chrono::steady_clock::now() - relations_start).count()));
   LOG_INFO("Finished with " + std::to_string(osmdata.restrictions.size()) +
            " simple turn restrictions");
   LOG_INFO("Finished with " + std::to_string(osmdata.lane_connectivity_map.size()) +
@@ -5287,20 +5471,28 @@ void PBFGraphParser::ParseRelations(const boost::property_tree::ptree& pt,
 
   parser.reset(nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr);
 
+  // sort the restrictions, bike networks etc. by way id so that they can be looked up
+  osmdata.sort_maps();
+
+  const unsigned int concurrency =
+      std::max(1u, pt.get<unsigned int>("concurrency", std::thread::hardware_concurrency()));
+
   // Sort complex restrictions. Keep this scoped so the file handles are closed when done sorting.
   LOG_INFO("Sorting complex restrictions by from id...");
   {
     sequence<OSMRestriction> complex_restrictions_from(complex_restriction_from_file, false);
-    complex_restrictions_from.sort(
-        [](const OSMRestriction& a, const OSMRestriction& b) { return a < b; });
+    complex_restrictions_from.sort([](const OSMRestriction& a,
+                                      const OSMRestriction& b) { return a < b; },
+                                   0, concurrency);
   }
 
   // Sort complex restrictions. Keep this scoped so the file handles are closed when done sorting.
   LOG_INFO("Sorting complex restrictions by to id...");
   {
     sequence<OSMRestriction> complex_restrictions_to(complex_restriction_to_file, false);
-    complex_restrictions_to.sort(
-        [](const OSMRestriction& a, const OSMRestriction& b) { return a < b; });
+    complex_restrictions_to.sort([](const OSMRestriction& a,
+                                    const OSMRestriction& b) { return a < b; },
+                                 0, concurrency);
   }
   LOG_INFO("Finished");
 }
@@ -5311,16 +5503,32 @@ void PBFGraphParser::ParseNodes(const boost::property_tree::ptree& pt,
                                 const std::string& bss_nodes_file,
                                 const std::string& linguistic_node_file,
                                 OSMData& osmdata) {
-  // TODO: option 1: each one threads makes an osmdata and we splice them together at the end
-  // option 2: synchronize around adding things to a single osmdata. will have to test to see
-  // which is the least expensive (memory and speed). leaning towards option 2
-  //  unsigned int threads =
-  //      std::max(static_cast<unsigned int>(1),
-  //               pt.get<unsigned int>("concurrency", std::thread::hardware_concurrency()));
-
   // Create OSM data. Set the member pointer so that the parsing callback methods can use it.
   SCOPED_TIMER();
   graph_parser parser(pt, osmdata);
+  const auto lua_script = graph_parser::get_lua(pt);
+  const unsigned int concurrency =
+      std::max(1u, pt.get<unsigned int>("concurrency", std::thread::hardware_concurrency()));
+  const size_t lua_concurrency = std::clamp(static_cast<size_t>(concurrency) - 1,
+                                            static_cast<size_t>(1), kMaxLuaConcurrency);
+
+  // Makes the Lua workers of a nodes pass, transforming only the nodes `make_keep()` asks for
+  using Nodes = graph_parser::Nodes;
+  const auto make_transform = [&lua_script](const auto& make_keep) {
+    return [&lua_script, make_keep]() -> buffer_transform_t<Nodes> {
+      auto lua = std::make_shared<LuaTagTransform>(lua_script);
+      auto empty_node_tags = std::make_shared<const Tags>(lua->Transform(OSMType::kNode, 0, {}));
+      auto keep = make_keep();
+      return [lua, empty_node_tags, keep](const osmium::memory::Buffer& buffer) {
+        Nodes transformed;
+        for (const osmium::memory::Item& item : buffer) {
+          graph_parser::transform_node(static_cast<const osmium::Node&>(item), *lua,
+                                       *empty_node_tags, *keep, transformed);
+        }
+        return transformed;
+      };
+    };
+  };
 
   // Read the OSMData to files if not initialized.
   if (!osmdata.initialized)
@@ -5330,7 +5538,13 @@ void PBFGraphParser::ParseNodes(const boost::property_tree::ptree& pt,
 
   if (pt.get<bool>("import_bike_share_stations", false)) {
     LOG_INFO("Parsing bss nodes...");
+    const auto bss_start = std::chrono::steady_clock::now();
 
+    // only nodes with tags can be bike share stations
+    const auto make_keep = [] {
+      const auto keep = [](const osmium::Node& node) { return !node.tags().empty(); };
+      return std::make_shared<const decltype(keep)>(keep);
+    };
     bool create = true;
     for (auto& file : input_files) {
       parser.current_way_node_index_ = parser.last_node_ = parser.last_way_ = parser.last_relation_ =
@@ -5340,16 +5554,16 @@ void PBFGraphParser::ParseNodes(const boost::property_tree::ptree& pt,
                    new sequence<OSMBSSNode>(bss_nodes_file, create), nullptr);
       create = false;
 
-      osmium::io::Reader reader(file, osmium::osm_entity_bits::node);
-      while (const osmium::memory::Buffer buffer = reader.read()) {
-        for (const osmium::memory::Item& item : buffer) {
-          parser.bss_node(static_cast<const osmium::Node&>(item));
-        }
-      }
-      reader.close(); // Explicit close to get an exception in case of an error.
+      parse_in_parallel<Nodes>(file, osmium::osm_entity_bits::node, lua_concurrency,
+                               make_transform(make_keep), [&parser](Nodes& transformed) {
+                                 parser.nodes(transformed,
+                                              [&parser](const auto& n) { parser.bss_node(n); });
+                               });
     }
     // Since the sequence must be flushed before reading it...
     parser.reset(nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr);
+    LOG_INFO(std::format("Parsed bss nodes in {:.2f}s",
+                         seconds_t(std::chrono::steady_clock::now() - bss_start).count()));
     LOG_INFO("Found " + std::to_string(sequence<OSMBSSNode>{bss_nodes_file, false}.size()) +
              " bss nodes...");
   }
@@ -5357,18 +5571,40 @@ void PBFGraphParser::ParseNodes(const boost::property_tree::ptree& pt,
 
   // we need to sort the refs so that we can easily (sequentially) update them
   // during node processing, we use memory mapping here because otherwise we aren't
-  // using much mem, the scoping makes sure to let it go when done sorting
+  // using much mem, the scoping makes sure to let it go when done sorting. the distinct
+  // node ids are written to their own file so the Lua workers can skip the nodes no way uses
+  // without sharing the way nodes with the parser
+  const std::string node_ids_file = way_nodes_file + ".ids";
   LOG_INFO("Sorting osm way node references by node id...");
   {
     sequence<OSMWayNode> way_nodes(way_nodes_file, false);
-    way_nodes.sort(
-        [](const OSMWayNode& a, const OSMWayNode& b) { return a.node.osmid_ < b.node.osmid_; });
+    way_nodes.sort([](const OSMWayNode& a,
+                      const OSMWayNode& b) { return a.node.osmid_ < b.node.osmid_; },
+                   0, concurrency);
+
+    sequence<uint64_t> node_ids(node_ids_file, true);
+    uint64_t last_id = 0;
+    for (const auto& way_node : way_nodes) {
+      const uint64_t osmid = way_node.node.osmid_;
+      if (node_ids.size() == 0 || osmid != last_id) {
+        node_ids.push_back(osmid);
+      }
+      last_id = osmid;
+    }
   }
 
   // Parse node in all the input files. Skip any that are not marked from
   // being used in a way.
   // TODO: we know how many knows we expect, stop early once we have that many
   LOG_INFO("Parsing nodes...");
+  const auto nodes_start = std::chrono::steady_clock::now();
+  const auto make_keep = [&node_ids_file] {
+    auto node_ids = std::make_shared<sorted_ids_cursor>(node_ids_file);
+    const auto keep = [node_ids](const osmium::Node& node) {
+      return node_ids->contains(static_cast<uint64_t>(node.id()));
+    };
+    return std::make_shared<const decltype(keep)>(keep);
+  };
   for (auto& file : input_files) {
     // each time we parse nodes we have to run through the way nodes file from the beginning because
     // because osm node ids are only sorted at the single pbf file level
@@ -5376,14 +5612,15 @@ void PBFGraphParser::ParseNodes(const boost::property_tree::ptree& pt,
                  nullptr, new sequence<OSMNodeLinguistic>(linguistic_node_file, true));
     parser.current_way_node_index_ = parser.last_node_ = parser.last_way_ = parser.last_relation_ = 0;
 
-    osmium::io::Reader reader(file, osmium::osm_entity_bits::node);
-    while (const osmium::memory::Buffer buffer = reader.read()) {
-      for (const osmium::memory::Item& item : buffer) {
-        parser.node(static_cast<const osmium::Node&>(item));
-      }
-    }
-    reader.close(); // Explicit close to get an exception in case of an error.
+    parse_in_parallel<Nodes>(file, osmium::osm_entity_bits::node, lua_concurrency,
+                             make_transform(make_keep), [&parser](Nodes& transformed) {
+                               parser.nodes(transformed,
+                                            [&parser](const auto& n) { parser.node(n); });
+                             });
   }
+  std::filesystem::remove(node_ids_file);
+  LOG_INFO(std::format("Parsed nodes in {:.2f}s",
+                       seconds_t(std::chrono::steady_clock::now() - nodes_start).count()));
   uint64_t max_osm_id = parser.last_node_;
   parser.reset(nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr);
   LOG_INFO("Finished with " + std::to_string(osmdata.osm_node_count) +
@@ -5394,13 +5631,15 @@ void PBFGraphParser::ParseNodes(const boost::property_tree::ptree& pt,
   LOG_INFO("Sorting osm way node references by way index and node shape index...");
   {
     sequence<OSMWayNode> way_nodes(way_nodes_file, false);
-    way_nodes.sort([](const OSMWayNode& a, const OSMWayNode& b) {
-      if (a.way_index == b.way_index) {
-        // TODO: if its equal we have screwed something up, should we check and throw here?
-        return a.way_shape_node_index < b.way_shape_node_index;
-      }
-      return a.way_index < b.way_index;
-    });
+    way_nodes.sort(
+        [](const OSMWayNode& a, const OSMWayNode& b) {
+          if (a.way_index == b.way_index) {
+            // TODO: if its equal we have screwed something up, should we check and throw here?
+            return a.way_shape_node_index < b.way_shape_node_index;
+          }
+          return a.way_index < b.way_index;
+        },
+        0, concurrency);
   }
 
   // Some OSM extracts do not have changeset Ids. For these set the max changeset Id
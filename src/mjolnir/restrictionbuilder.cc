@@ -10,14 +10,12 @@
 #include "mjolnir/complexrestrictionbuilder.h"
 #include "mjolnir/graphtilebuilder.h"
 #include "mjolnir/osmrestriction.h"
+#include "mjolnir/tilescheduler.h"
 #include "mjolnir/util.h"
 #include "scoped_timer.h"
 
 #include <boost/property_tree/ptree.hpp>
 
-#include <future>
-#include <queue>
-#include <random>
 #include <thread>
 #include <unordered_set>
 
@@ -327,26 +325,21 @@ void HandleOnlyRestrictionProperties(const std::vector<Result>& results,
 void build(const std::string& complex_restriction_from_file,
            const std::string& complex_restriction_to_file,
            const boost::property_tree::ptree& hierarchy_properties,
-           std::queue<GraphId>& tilequeue,
+           TileScheduler& scheduler,
+           size_t worker,
            std::mutex& lock,
-           std::promise<Result>& result) {
+           Result& result) {
   sequence<OSMRestriction> complex_restrictions_from(complex_restriction_from_file, false);
   sequence<OSMRestriction> complex_restrictions_to(complex_restriction_to_file, false);
 
   GraphReader reader(hierarchy_properties);
   Result stats;
 
-  // Iterate through the tiles in the queue and perform enhancements
-  while (true) {
-    // Get the next tile Id from the queue and get writeable and readable
-    // tile. Lock while we access the tile queue and get the tile.
+  // Iterate through the tiles handed to us and perform enhancements
+  GraphId tile_id;
+  while (scheduler.Next(worker, tile_id)) {
+    // Get writeable and readable tile. Lock while we get the tile.
     lock.lock();
-    if (tilequeue.empty()) {
-      lock.unlock();
-      break;
-    }
-    GraphId tile_id = tilequeue.front();
-    tilequeue.pop();
 
     // Get a readable tile. If the tile is empty, skip it. Empty tiles are
     // added where ways go through a tile but no end not is within the tile.
@@ -721,7 +714,7 @@ void build(const std::string& complex_restriction_from_file,
   }
 
   // Send back the statistics
-  result.set_value(stats);
+  result = std::move(stats);
 }
 
 } // namespace
@@ -738,49 +731,32 @@ void RestrictionBuilder::Build(const boost::property_tree::ptree& pt,
   boost::property_tree::ptree hierarchy_properties = pt.get_child("mjolnir");
   GraphReader reader(hierarchy_properties);
   for (auto tl = TileHierarchy::levels().rbegin(); tl != TileHierarchy::levels().rend(); ++tl) {
-    // Create a randomized queue of tiles to work from
-    std::deque<GraphId> tempqueue;
+    // Largest tiles first, so that the threads finish at about the same time
+    std::vector<std::pair<GraphId, uint64_t>> tiles;
     auto level_tiles = reader.GetTileSet(tl->level);
     for (const auto& tile_id : level_tiles) {
-      tempqueue.emplace_back(tile_id);
+      tiles.emplace_back(tile_id, TileScheduler::TileSize(reader.tile_dir(), tile_id));
     }
-    std::random_device rd;
-    std::shuffle(tempqueue.begin(), tempqueue.end(), std::mt19937(rd()));
-    std::queue<GraphId> tilequeue(tempqueue);
+    TileScheduler scheduler("restrictions level " + std::to_string(tl->level), std::move(tiles),
+                            std::max(static_cast<unsigned int>(1),
+                                     pt.get<unsigned int>("mjolnir.concurrency",
+                                                          std::thread::hardware_concurrency())));
 
     // An atomic object we can use to do the synchronization
     std::mutex lock;
-    // A place to hold worker threads and their results, exceptions or otherwise
-
-    std::vector<std::shared_ptr<std::thread>> threads(
-        std::max(static_cast<unsigned int>(1),
-                 pt.get<unsigned int>("mjolnir.concurrency", std::thread::hardware_concurrency())));
     // Hold the results (DataQuality/stats) for the threads
-    std::vector<std::promise<Result>> promises(threads.size());
+    std::vector<Result> results(scheduler.concurrency());
 
-    // Start the threads
+    // Run the threads, if something bad went down this will rethrow it
     LOG_INFO("Adding complex turn restrictions at level " + std::to_string(tl->level));
-    for (size_t i = 0; i < threads.size(); ++i) {
-      threads[i] = std::make_shared<std::thread>(build, std::cref(complex_from_restrictions_file),
-                                                 std::cref(complex_to_restrictions_file),
-                                                 std::cref(hierarchy_properties), std::ref(tilequeue),
-                                                 std::ref(lock), std::ref(promises[i]));
-    }
-
-    // Wait for them to finish up their work
-    for (auto& thread : threads) {
-      thread->join();
-    }
-
-    std::vector<Result> results;
-    for (auto& p : promises) {
-      // If something bad went down this will rethrow it
-      try {
-        results.push_back(p.get_future().get());
-      } catch (const std::exception& e) {
-        LOG_ERROR(e.what());
-        throw e;
-      }
+    try {
+      scheduler.Run([&](size_t worker) {
+        build(complex_from_restrictions_file, complex_to_restrictions_file, hierarchy_properties,
+              scheduler, worker, lock, results[worker]);
+      });
+    } catch (const std::exception& e) {
+      LOG_ERROR(e.what());
+      throw;
     }
 
     HandleOnlyRestrictionProperties(results, hierarchy_properties);
@@ -8,6 +8,7 @@
 #include "midgard/logging.h"
 #include "midgard/pointll.h"
 #include "mjolnir/graphtilebuilder.h"
+#include "mjolnir/tilescheduler.h"
 #include "mjolnir/util.h"
 #include "scoped_timer.h"
 #include "sif/osrm_car_duration.h"
@@ -17,7 +18,11 @@
 #include <boost/format.hpp>
 #endif
 
+#include <algorithm>
+#include <filesystem>
+#include <memory>
 #include <string>
+#include <thread>
 #include <tuple>
 #include <utility>
 #include <vector>
@@ -600,162 +605,258 @@ std::pair<uint32_t, uint32_t> AddShortcutEdges(GraphReader& reader,
   return {shortcut_count, total_edge_count};
 }
 
-// Form shortcuts for tiles in this level.
+// Form shortcuts for one tile and write it to the tile directory. The reader must see the tiles
+// of the level as they were before any shortcuts were added to them.
 // Returns {shortcut_count, total_edge_count, exceeded_max_count}.
-std::tuple<uint32_t, uint32_t, uint32_t> FormShortcuts(GraphReader& reader, const TileLevel& level) {
-  // Iterate through the tiles at this level (TODO - can we mark the tiles
-  // the tiles that shortcuts end within?)
-  reader.Clear();
+std::tuple<uint32_t, uint32_t, uint32_t>
+FormTileShortcuts(GraphReader& reader, const std::string& tile_dir, const GraphId& tile_id) {
   bool added = false;
   uint32_t shortcut_count = 0;
   uint32_t total_edge_count = 0;
   uint32_t exceeded_max_count = 0;
-  uint32_t ntiles = level.tiles.TileCount();
-  uint32_t tile_level = (uint32_t)level.level;
-  graph_tile_ptr tile;
-  for (uint32_t tileid = 0; tileid < ntiles; tileid++) {
-    // Get the graph tile. Skip if no tile exists (common case)
-    tile = reader.GetGraphTile(GraphId(tileid, tile_level, 0));
-    if (!tile) {
-      continue;
+  uint32_t tileid = tile_id.tileid();
+  uint32_t tile_level = tile_id.level();
+  graph_tile_ptr tile = reader.GetGraphTile(tile_id);
+  if (!tile) {
+    return {shortcut_count, total_edge_count, exceeded_max_count};
+  }
+
+  // Create GraphTileBuilder for the new tile
+  GraphId new_tile(tileid, tile_level, 0);
+  GraphTileBuilder tilebuilder(tile_dir, new_tile, false);
+
+  // Since the old tile is not serialized we must copy any data that is not
+  // dependent on edge Id into the new builders (e.g., node transitions)
+  if (tile->header()->transitioncount() > 0) {
+    for (uint32_t i = 0; i < tile->header()->transitioncount(); ++i) {
+      tilebuilder.transitions().emplace_back(std::move(*(tile->transition(i))));
     }
+  }
 
-    // Create GraphTileBuilder for the new tile
-    GraphId new_tile(tileid, tile_level, 0);
-    GraphTileBuilder tilebuilder(reader.tile_dir(), new_tile, false);
+  // Iterate through the nodes in the tile
+  GraphId node_id(tileid, tile_level, 0);
+  for (uint32_t n = 0; n < tile->header()->nodecount(); n++, ++node_id) {
+    // Get the node info, copy node index and count from old tile
+    NodeInfo nodeinfo = *(tile->node(node_id));
+    uint32_t old_edge_index = nodeinfo.edge_index();
+    uint32_t old_edge_count = nodeinfo.edge_count();
+
+    // Update node information
+    const auto& admin = tile->admininfo(nodeinfo.admin_index());
+    nodeinfo.set_edge_index(tilebuilder.directededges().size());
+    nodeinfo.set_admin_index(tilebuilder.AddAdmin(admin.country_text(), admin.state_text(),
+                                                  admin.country_iso(), admin.state_iso()));
+
+    // Current edge count
+    size_t edge_count = tilebuilder.directededges().size();
+
+    // Add shortcut edges first.
+    std::unordered_map<uint32_t, uint32_t> shortcuts;
+    auto stats = AddShortcutEdges(reader, tile, tilebuilder, node_id, old_edge_index,
+                                  old_edge_count, shortcuts);
+    shortcut_count += stats.first;
+    total_edge_count += stats.second;
+    if (stats.first > kMaxShortcutsFromNode) {
+      ++exceeded_max_count;
+    }
 
-    // Since the old tile is not serialized we must copy any data that is not
-    // dependent on edge Id into the new builders (e.g., node transitions)
-    if (tile->header()->transitioncount() > 0) {
-      for (uint32_t i = 0; i < tile->header()->transitioncount(); ++i) {
-        tilebuilder.transitions().emplace_back(std::move(*(tile->transition(i))));
+    // Copy the rest of the directed edges from this node
+    GraphId edgeid(tileid, tile_level, old_edge_index);
+    for (uint32_t i = 0; i < old_edge_count; i++, ++edgeid) {
+      // Copy the directed edge information and update end node,
+      // edge data offset, and opp_index
+      const DirectedEdge* directededge = tile->directededge(edgeid);
+      DirectedEdge newedge = *directededge;
+
+      // Get signs from the base directed edge
+      if (directededge->sign()) {
+        std::vector<SignInfo> signs = tile->GetSigns(edgeid.id());
+        if (signs.size() == 0) {
+          LOG_ERROR("Base edge should have signs, but none found");
+        }
+        tilebuilder.AddSigns(tilebuilder.directededges().size(), signs);
       }
-    }
 
-    // Iterate through the nodes in the tile
-    GraphId node_id(tileid, tile_level, 0);
-    for (uint32_t n = 0; n < tile->header()->nodecount(); n++, ++node_id) {
-      // Get the node info, copy node index and count from old tile
-      NodeInfo nodeinfo = *(tile->node(node_id));
-      uint32_t old_edge_index = nodeinfo.edge_index();
-      uint32_t old_edge_count = nodeinfo.edge_count();
-
-      // Update node information
-      const auto& admin = tile->admininfo(nodeinfo.admin_index());
-      nodeinfo.set_edge_index(tilebuilder.directededges().size());
-      nodeinfo.set_admin_index(tilebuilder.AddAdmin(admin.country_text(), admin.state_text(),
-                                                    admin.country_iso(), admin.state_iso()));
-
-      // Current edge count
-      size_t edge_count = tilebuilder.directededges().size();
-
-      // Add shortcut edges first.
-      std::unordered_map<uint32_t, uint32_t> shortcuts;
-      auto stats = AddShortcutEdges(reader, tile, tilebuilder, node_id, old_edge_index,
-                                    old_edge_count, shortcuts);
-      shortcut_count += stats.first;
-      total_edge_count += stats.second;
-      if (stats.first > kMaxShortcutsFromNode) {
-        ++exceeded_max_count;
+      // Get turn lanes from the base directed edge
+      if (directededge->turnlanes()) {
+        uint32_t offset = tile->turnlanes_offset(edgeid.id());
+        tilebuilder.AddTurnLanes(tilebuilder.directededges().size(), tile->GetName(offset));
       }
 
-      // Copy the rest of the directed edges from this node
-      GraphId edgeid(tileid, tile_level, old_edge_index);
-      for (uint32_t i = 0; i < old_edge_count; i++, ++edgeid) {
-        // Copy the directed edge information and update end node,
-        // edge data offset, and opp_index
-        const DirectedEdge* directededge = tile->directededge(edgeid);
-        DirectedEdge newedge = *directededge;
-
-        // Get signs from the base directed edge
-        if (directededge->sign()) {
-          std::vector<SignInfo> signs = tile->GetSigns(edgeid.id());
-          if (signs.size() == 0) {
-            LOG_ERROR("Base edge should have signs, but none found");
-          }
-          tilebuilder.AddSigns(tilebuilder.directededges().size(), signs);
+      // Get access restrictions from the base directed edge. Add these to
+      // the list of access restrictions in the new tile. Update the
+      // edge index in the restriction to be the current directed edge Id
+      if (directededge->access_restriction()) {
+        auto restrictions = tile->GetAccessRestrictions(edgeid.id()).first;
+        for (const auto& res : restrictions) {
+          tilebuilder.AddAccessRestriction(AccessRestriction(tilebuilder.directededges().size(),
+                                                             res.type(), res.modes(), res.value(),
+                                                             res.except_destination()));
         }
+      }
 
-        // Get turn lanes from the base directed edge
-        if (directededge->turnlanes()) {
-          uint32_t offset = tile->turnlanes_offset(edgeid.id());
-          tilebuilder.AddTurnLanes(tilebuilder.directededges().size(), tile->GetName(offset));
-        }
+      // Copy lane connectivity
+      if (directededge->laneconnectivity()) {
+        tilebuilder.CopyLaneConnectivityFromTile(tile, edgeid.id());
+      }
 
-        // Get access restrictions from the base directed edge. Add these to
-        // the list of access restrictions in the new tile. Update the
-        // edge index in the restriction to be the current directed edge Id
-        if (directededge->access_restriction()) {
-          auto restrictions = tile->GetAccessRestrictions(edgeid.id()).first;
-          for (const auto& res : restrictions) {
-            tilebuilder.AddAccessRestriction(AccessRestriction(tilebuilder.directededges().size(),
-                                                               res.type(), res.modes(), res.value(),
-                                                               res.except_destination()));
-          }
-        }
+      // Names can be different in the forward and backward direction
+      bool diff_names = tilebuilder.OpposingEdgeInfoDiffers(tile, directededge);
 
-        // Copy lane connectivity
-        if (directededge->laneconnectivity()) {
-          tilebuilder.CopyLaneConnectivityFromTile(tile, edgeid.id());
-        }
+      // Get edge info, shape, and names from the old tile and add
+      // to the new. Use prior edgeinfo offset as the key to make sure
+      // edges that have the same end nodes are differentiated (this
+      // should be a valid key since tile sizes aren't changed)
+      auto edgeinfo = tile->edgeinfo(directededge);
+      uint32_t edge_info_offset =
+          tilebuilder.AddEdgeInfo(directededge->edgeinfo_offset(), node_id, directededge->endnode(),
+                                  edgeinfo.wayid(), edgeinfo.mean_elevation(),
+                                  edgeinfo.bike_network(), edgeinfo.speed_limit(),
+                                  edgeinfo.encoded_shape(), edgeinfo.GetNames(),
+                                  edgeinfo.GetTaggedValues(), edgeinfo.GetLinguisticTaggedValues(),
+                                  edgeinfo.GetTypes(), added, diff_names);
 
-        // Names can be different in the forward and backward direction
-        bool diff_names = tilebuilder.OpposingEdgeInfoDiffers(tile, directededge);
-
-        // Get edge info, shape, and names from the old tile and add
-        // to the new. Use prior edgeinfo offset as the key to make sure
-        // edges that have the same end nodes are differentiated (this
-        // should be a valid key since tile sizes aren't changed)
-        auto edgeinfo = tile->edgeinfo(directededge);
-        uint32_t edge_info_offset =
-            tilebuilder.AddEdgeInfo(directededge->edgeinfo_offset(), node_id, directededge->endnode(),
-                                    edgeinfo.wayid(), edgeinfo.mean_elevation(),
-                                    edgeinfo.bike_network(), edgeinfo.speed_limit(),
-                                    edgeinfo.encoded_shape(), edgeinfo.GetNames(),
-                                    edgeinfo.GetTaggedValues(), edgeinfo.GetLinguisticTaggedValues(),
-                                    edgeinfo.GetTypes(), added, diff_names);
-
-        newedge.set_edgeinfo_offset(edge_info_offset);
-
-        // Set the superseded mask - this is the shortcut mask that supersedes this edge
-        // (outbound from the node). Do not set (keep as 0) if maximum number of shortcuts
-        // from a node has been exceeded.
-        auto s = shortcuts.find(i);
-        uint32_t superseded_idx = (s != shortcuts.end()) ? s->second : 0;
-        if (superseded_idx <= kMaxShortcutsFromNode) {
-          newedge.set_superseded(superseded_idx);
-        }
+      newedge.set_edgeinfo_offset(edge_info_offset);
 
-        // Add directed edge
-        tilebuilder.directededges().emplace_back(std::move(newedge));
+      // Set the superseded mask - this is the shortcut mask that supersedes this edge
+      // (outbound from the node). Do not set (keep as 0) if maximum number of shortcuts
+      // from a node has been exceeded.
+      auto s = shortcuts.find(i);
+      uint32_t superseded_idx = (s != shortcuts.end()) ? s->second : 0;
+      if (superseded_idx <= kMaxShortcutsFromNode) {
+        newedge.set_superseded(superseded_idx);
       }
 
-      // Set the edge count for the new node
-      nodeinfo.set_edge_count(tilebuilder.directededges().size() - edge_count);
+      // Add directed edge
+      tilebuilder.directededges().emplace_back(std::move(newedge));
+    }
 
-      // Get named signs from the base node
-      if (nodeinfo.named_intersection()) {
+    // Set the edge count for the new node
+    nodeinfo.set_edge_count(tilebuilder.directededges().size() - edge_count);
 
-        std::vector<SignInfo> signs = tile->GetSigns(n, true);
-        if (signs.size() == 0) {
-          LOG_ERROR("Base node should have signs, but none found");
-        }
-        tilebuilder.AddSigns(tilebuilder.nodes().size(), signs);
+    // Get named signs from the base node
+    if (nodeinfo.named_intersection()) {
+
+      std::vector<SignInfo> signs = tile->GetSigns(n, true);
+      if (signs.size() == 0) {
+        LOG_ERROR("Base node should have signs, but none found");
       }
-      tilebuilder.nodes().emplace_back(std::move(nodeinfo));
+      tilebuilder.AddSigns(tilebuilder.nodes().size(), signs);
     }
+    tilebuilder.nodes().emplace_back(std::move(nodeinfo));
+  }
 
-    // Store the new tile
-    tilebuilder.StoreTileData();
-    LOG_DEBUG((boost::format("ShortcutBuilder created tile %1%: %2% bytes") % tile %
-               tilebuilder.header_builder().end_offset())
-                  .str());
+  // Store the new tile
+  tilebuilder.StoreTileData();
+  LOG_DEBUG((boost::format("ShortcutBuilder created tile %1%: %2% bytes") % tile %
+             tilebuilder.header_builder().end_offset())
+                .str());
+  return {shortcut_count, total_edge_count, exceeded_max_count};
+}
+
+// The snapshot directory goes next to the tile directory rather than into it, so that nothing
+// which walks the tile directory comes across the snapshot tiles
+std::filesystem::path SnapshotDir(const std::string& tile_dir) {
+  std::filesystem::path dir{tile_dir};
+  if (!dir.has_filename()) {
+    dir = dir.parent_path();
+  }
+  return dir.parent_path() / (dir.filename().string() + "_shortcut_snapshot");
+}
+
+// Link (or copy if the file system does not support links) the tiles of a level into a snapshot
+// directory. Shortcuts are formed against the snapshot so that no thread ever sees a tile which
+// has already been rewritten with shortcuts, regardless of the order in which tiles get done
+void SnapshotLevel(const std::string& tile_dir,
+                   const std::filesystem::path& snapshot_dir,
+                   const TileLevel& level) {
+  std::filesystem::remove_all(snapshot_dir);
+  std::filesystem::path level_dir{tile_dir};
+  level_dir.append(std::to_string(level.level));
+  if (!std::filesystem::is_directory(level_dir)) {
+    return;
+  }
+  for (std::filesystem::recursive_directory_iterator i(level_dir), end; i != end; ++i) {
+    if (!i->is_regular_file()) {
+      continue;
+    }
+    // skip anything that isnt a tile, like temp files of a tile being written
+    try {
+      GraphTile::GetTileId(i->path().string());
+    } catch (...) { continue; }
+
+    auto link = snapshot_dir / std::filesystem::relative(i->path(), tile_dir);
+    std::filesystem::create_directories(link.parent_path());
+    std::error_code ec;
+    std::filesystem::create_hard_link(i->path(), link, ec);
+    if (ec) {
+      std::filesystem::copy_file(i->path(), link);
+    }
+  }
+}
 
-    // Check if we need to clear the tile cache.
-    if (reader.OverCommitted()) {
-      reader.Trim();
+// Form shortcuts for tiles in this level. Every shortcut is owned by the tile of the node it
+// starts at, so each tile is only ever written by the one thread forming shortcuts for it, while
+// contractions that cross into neighboring tiles only read the snapshot of those tiles. This makes
+// the result independent of the number of threads and of the order in which tiles are done.
+// Returns {shortcut_count, total_edge_count, exceeded_max_count}.
+std::tuple<uint32_t, uint32_t, uint32_t> FormShortcuts(const boost::property_tree::ptree& pt,
+                                                       const TileLevel& level,
+                                                       unsigned int concurrency) {
+  // Snapshot the tiles of the level before any of them get rewritten
+  auto tile_dir = pt.get<std::string>("mjolnir.tile_dir");
+  auto snapshot_dir = SnapshotDir(tile_dir);
+  SnapshotLevel(tile_dir, snapshot_dir, level);
+
+  // Readers of the snapshot
+  auto snapshot_pt = pt.get_child("mjolnir");
+  snapshot_pt.put("tile_dir", snapshot_dir.string());
+  snapshot_pt.erase("tile_extract");
+
+  // Largest tiles first, so that the threads finish at about the same time
+  std::vector<std::pair<GraphId, uint64_t>> tiles;
+  {
+    GraphReader reader(snapshot_pt);
+    for (const auto& tile_id : reader.GetTileSet(level.level)) {
+      tiles.emplace_back(tile_id, TileScheduler::TileSize(snapshot_dir.string(), tile_id));
     }
   }
+  TileScheduler scheduler("shortcuts level " + std::to_string(level.level), std::move(tiles),
+                          concurrency);
+
+  // Each thread forms the shortcuts of the tiles it is handed until there are none left
+  std::vector<std::tuple<uint32_t, uint32_t, uint32_t>> stats(scheduler.concurrency(), {0, 0, 0});
+  try {
+    scheduler.Run([&](size_t worker) {
+      GraphReader reader(snapshot_pt);
+      GraphId tile_id;
+      while (scheduler.Next(worker, tile_id)) {
+        auto [sc_count, edge_count, exceeded_max] = FormTileShortcuts(reader, tile_dir, tile_id);
+        std::get<0>(stats[worker]) += sc_count;
+        std::get<1>(stats[worker]) += edge_count;
+        std::get<2>(stats[worker]) += exceeded_max;
+
+        // Check if we need to clear the tile cache.
+        if (reader.OverCommitted()) {
+          reader.Trim();
+        }
+      }
+    });
+  } catch (...) {
+    std::filesystem::remove_all(snapshot_dir);
+    throw;
+  }
+  std::filesystem::remove_all(snapshot_dir);
+
+  // Sum up the stats of all threads
+  uint32_t shortcut_count = 0;
+  uint32_t total_edge_count = 0;
+  uint32_t exceeded_max_count = 0;
+  for (const auto& [sc_count, edge_count, exceeded_max] : stats) {
+    shortcut_count += sc_count;
+    total_edge_count += edge_count;
+    exceeded_max_count += exceeded_max;
+  }
   return {shortcut_count, total_edge_count, exceeded_max_count};
 }
 
@@ -768,14 +869,13 @@ namespace mjolnir {
 // only connect to 2 edges on the hierarchy level, and have compatible
 // attributes. Shortcut edges are inserted before regular edges.
 void ShortcutBuilder::Build(const boost::property_tree::ptree& pt) {
-
-  // TODO: thread this. would need to make sure we dont make shortcuts
-  // across tile boundaries so that we are only messing with one tile
-  // in one thread at a time
-
   SCOPED_TIMER();
-  // Get GraphReader
-  GraphReader reader(pt.get_child("mjolnir"));
+  unsigned int concurrency =
+      std::max(static_cast<unsigned int>(1),
+               pt.get<unsigned int>("mjolnir.concurrency", std::thread::hardware_concurrency()));
+
+  // A build which was interrupted while forming shortcuts may have left its snapshot behind
+  std::filesystem::remove_all(SnapshotDir(pt.get<std::string>("mjolnir.tile_dir")));
 
   uint32_t total_exceeded_max = 0;
   auto tile_level = TileHierarchy::levels().rbegin();
@@ -783,7 +883,7 @@ void ShortcutBuilder::Build(const boost::property_tree::ptree& pt) {
   for (; tile_level != TileHierarchy::levels().rend(); ++tile_level) {
     // Create shortcuts on this level
     LOG_INFO("Creating shortcuts on level " + std::to_string(tile_level->level));
-    auto [sc_count, edge_count, exceeded_max] = FormShortcuts(reader, *tile_level);
+    auto [sc_count, edge_count, exceeded_max] = FormShortcuts(pt, *tile_level, concurrency);
     [[maybe_unused]] uint32_t avg = sc_count ? (edge_count / sc_count) : 0;
     LOG_INFO("Finished with " + std::to_string(sc_count) + " shortcuts superseding " +
              std::to_string(edge_count) + " edges, average ~" + std::to_string(avg) +
@@ -0,0 +1,130 @@
+#include "mjolnir/tilescheduler.h"
+#include "baldr/graphtile.h"
+#include "midgard/logging.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <format>
+#include <future>
+#include <memory>
+#include <thread>
+
+using namespace valhalla::baldr;
+
+namespace valhalla {
+namespace mjolnir {
+
+TileScheduler::TileScheduler(std::string stage,
+                             std::vector<std::pair<GraphId, uint64_t>> tiles,
+                             unsigned int concurrency)
+    : stage_(std::move(stage)), workers_(std::max(1u, concurrency)) {
+  // largest first, ties broken by id so that the order doesn't depend on the input
+  std::sort(tiles.begin(), tiles.end(), [](const auto& a, const auto& b) {
+    return a.second != b.second ? a.second > b.second : a.first < b.first;
+  });
+  for (size_t i = 0; i < tiles.size(); ++i) {
+    workers_[i % workers_.size()].tiles.push_back(tiles[i].first);
+  }
+}
+
+bool TileScheduler::Next(size_t worker, GraphId& tile) {
+  auto& self = workers_[worker];
+  Finish(self);
+
+  // our own tiles first, the largest is at the front
+  {
+    std::lock_guard<std::mutex> guard(self.lock);
+    if (!self.tiles.empty()) {
+      tile = self.tiles.front();
+      self.tiles.pop_front();
+      self.current = tile;
+      self.start = clock::now();
+      self.working = true;
+      return true;
+    }
+  }
+
+  // then the smallest of another thread which still has some
+  for (size_t i = 1; i < workers_.size(); ++i) {
+    auto& victim = workers_[(worker + i) % workers_.size()];
+    std::lock_guard<std::mutex> guard(victim.lock);
+    if (!victim.tiles.empty()) {
+      tile = victim.tiles.back();
+      victim.tiles.pop_back();
+      self.current = tile;
+      self.start = clock::now();
+      self.working = true;
+      return true;
+    }
+  }
+  return false;
+}
+
+void TileScheduler::Finish(Worker& worker) {
+  if (!worker.working) {
+    return;
+  }
+  const auto took = clock::now() - worker.start;
+  worker.busy += took;
+  if (took > worker.longest) {
+    worker.longest = took;
+    worker.longest_tile = worker.current;
+  }
+  ++worker.count;
+  worker.working = false;
+}
+
+void TileScheduler::Run(const std::function<void(size_t worker)>& worker) {
+  const auto start = clock::now();
+  std::vector<std::shared_ptr<std::thread>> threads(workers_.size());
+  std::vector<std::promise<void>> results(threads.size());
+  for (size_t i = 0; i < threads.size(); ++i) {
+    threads[i] = std::make_shared<std::thread>([this, &worker, &result = results[i], i]() {
+      try {
+        worker(i);
+        Finish(workers_[i]);
+        result.set_value();
+      } catch (...) { result.set_exception(std::current_exception()); }
+    });
+  }
+  for (auto& thread : threads) {
+    thread->join();
+  }
+  const std::chrono::duration<double> wall = clock::now() - start;
+
+  // utilization is the share of the thread time spent on tiles. the critical path is the longest
+  // tile, no schedule can finish the stage any sooner
+  size_t count = 0;
+  std::chrono::duration<double> busy{}, longest{};
+  GraphId longest_tile;
+  for (const auto& w : workers_) {
+    count += w.count;
+    busy += w.busy;
+    if (w.longest > longest) {
+      longest = w.longest;
+      longest_tile = w.longest_tile;
+    }
+  }
+  if (count && wall.count() > 0) {
+    LOG_INFO(std::format("[{}] {} tiles on {} threads in {:.2f}s, utilization {:.1f}%, critical "
+                         "path {:.2f}s ({})",
+                         stage_, count, workers_.size(), wall.count(),
+                         100.0 * busy.count() / (wall.count() * workers_.size()), longest.count(),
+                         std::to_string(longest_tile)));
+  }
+
+  for (auto& result : results) {
+    result.get_future().get();
+  }
+}
+
+uint64_t TileScheduler::TileSize(const std::string& tile_dir, const GraphId& tile) {
+  std::error_code ec;
+  auto size = std::filesystem::file_size(std::filesystem::path(tile_dir) /
+                                             GraphTile::FileSuffix(tile.tile_base()),
+                                         ec);
+  return ec ? 0 : size;
+}
+
+} // namespace mjolnir
+} // namespace valhalla
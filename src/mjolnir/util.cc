@@ -5,6 +5,7 @@
 #include "baldr/rapidjson_utils.h"
 #include "baldr/tilehierarchy.h"
 #include "midgard/logging.h"
+#include "midgard/util.h"
 #include "mjolnir/bssbuilder.h"
 #include "mjolnir/elevationbuilder.h"
 #include "mjolnir/graphbuilder.h"
@@ -12,6 +13,7 @@
 #include "mjolnir/graphfilter.h"
 #include "mjolnir/graphvalidator.h"
 #include "mjolnir/hierarchybuilder.h"
+#include "mjolnir/osmchange.h"
 #include "mjolnir/pbfgraphparser.h"
 #include "mjolnir/restrictionbuilder.h"
 #include "mjolnir/shortcutbuilder.h"
@@ -20,13 +22,18 @@
 
 #include <boost/algorithm/string/constants.hpp>
 #include <boost/algorithm/string/split.hpp>
+#include <ankerl/unordered_dense.h>
 #include <boost/property_tree/ptree.hpp>
 #include <cpp-statsd-client/StatsdClient.hpp>
 #include <openssl/evp.h>
 
+#include <chrono>
 #include <filesystem>
 #include <format>
+#include <fstream>
+#include <future>
 #include <regex>
+#include <thread>
 
 using boost::property_tree::ptree;
 using namespace valhalla::baldr;
@@ -41,6 +48,7 @@ const std::string way_nodes_file = "way_nodes.bin";
 const std::string nodes_file = "nodes.bin";
 const std::string edges_file = "edges.bin";
 const std::string tile_manifest_file = "tile_manifest.json";
+const std::string build_manifest_file = "build_manifest.json";
 const std::string access_file = "access.bin";
 const std::string bss_nodes_file = "bss_nodes.bin";
 const std::string linguistic_node_file = "linguistics_node.bin";
@@ -49,56 +57,209 @@ const std::string cr_to_file = "complex_to_restrictions.bin";
 const std::string new_to_old_file = "new_nodes_to_old_nodes.bin";
 const std::string old_to_new_file = "old_nodes_to_new_nodes.bin";
 
+// Builds the MD5 digest of some bytes and rolls it into a uint64. Uses openssl's API which can
+// build the digest from byte chunks to save memory
+class md5_checksum {
+public:
+  md5_checksum() : ctx_(EVP_MD_CTX_new()) {
+    if (!ctx_ || EVP_DigestInit_ex(ctx_, EVP_md5(), nullptr) != 1) {
+      EVP_MD_CTX_free(ctx_);
+      throw std::runtime_error("EVP_DigestInit_ex failed");
+    }
+  }
+  md5_checksum(const md5_checksum&) = delete;
+  md5_checksum& operator=(const md5_checksum&) = delete;
+  ~md5_checksum() {
+    EVP_MD_CTX_free(ctx_);
+  }
+
+  void update(const char* data, size_t size) {
+    if (EVP_DigestUpdate(ctx_, data, size) != 1) {
+      throw std::runtime_error("EVP_DigestUpdate failed");
+    }
+  }
+
+  uint64_t get() {
+    std::array<unsigned char, 16> digest{};
+    unsigned int out_len = 0;
+    if (EVP_DigestFinal_ex(ctx_, digest.data(), &out_len) != 1 || out_len != digest.size()) {
+      throw std::runtime_error("EVP_DigestFinal_ex failed");
+    }
+
+    // roll the 128 bit digest into a uint64
+    uint64_t lo = 0, hi = 0;
+    for (int i = 0; i < 8; ++i) {
+      lo = (lo << 8) | digest[i];
+      hi = (hi << 8) | digest[8 + i];
+    }
+
+    std::hash<uint64_t> hasher;
+    return lo ^ (hasher(hi) + 0x9e3779b97f4a7c15ull + (lo << 12) + (lo >> 4));
+  }
+
+private:
+  EVP_MD_CTX* ctx_;
+};
+
 uint64_t get_pbf_checksum(std::vector<std::string> paths, const std::string& tile_dir) {
   std::sort(paths.begin(), paths.end());
 
-  // uses openssl's API which can build the digest from byte chunks to save memory
-  EVP_MD_CTX* ctx = EVP_MD_CTX_new();
-  std::array<unsigned char, 16> digest{};
-  try {
-    EVP_DigestInit_ex(ctx, EVP_md5(), nullptr);
-
-    std::vector<char> buffer(1 << 26); // 64 MiB
+  md5_checksum checksum;
+  std::vector<char> buffer(1 << 26); // 64 MiB
+  for (const auto& p : paths) {
+    std::ifstream in(p, std::ios::binary);
+    if (!in) {
+      throw std::runtime_error("Failed to open: " + p);
+    }
 
-    for (const auto& p : paths) {
-      std::ifstream in(p, std::ios::binary);
-      if (!in) {
-        throw std::runtime_error("Failed to open: " + p);
+    while (in) {
+      in.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+      std::streamsize got = in.gcount();
+      if (got > 0) {
+        checksum.update(buffer.data(), static_cast<size_t>(got));
       }
+    }
+  }
 
-      while (in) {
-        in.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
-        std::streamsize got = in.gcount();
-        if (got > 0) {
-          if (EVP_DigestUpdate(ctx, buffer.data(), static_cast<size_t>(got)) != 1) {
-            throw std::runtime_error("EVP_DigestUpdate failed");
-          }
-        }
-      }
+  return checksum.get();
+}
+
+// The size and last write time of a tile file, along with the hash of its contents if asked. The
+// hash only has to notice a tile which changed since the manifest was written, so a fast
+// non-cryptographic one does
+BuildManifest::TileChecksum get_tile_checksum(const std::filesystem::path& file, bool contents) {
+  BuildManifest::TileChecksum tile{0, std::filesystem::file_size(file),
+                                   std::filesystem::last_write_time(file)
+                                       .time_since_epoch()
+                                       .count()};
+  if (contents) {
+    std::ifstream in(file, std::ios::binary);
+    std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    if (!in.eof() || bytes.size() != tile.size) {
+      throw std::runtime_error("Failed to read: " + file.string());
     }
+    tile.checksum = ankerl::unordered_dense::hash<std::string_view>{}(bytes);
+  }
+  return tile;
+}
 
-    unsigned int out_len = 0;
-    if (EVP_DigestFinal_ex(ctx, digest.data(), &out_len) != 1 || out_len != digest.size()) {
-      throw std::runtime_error("EVP_DigestFinal_ex failed");
+// Checksum every tile of the tile directory. The size and last write time are a fast pre-check:
+// the checksums of the tiles which still have the size and last write time they had before are
+// reused rather than read again
+std::map<GraphId, BuildManifest::TileChecksum>
+checksum_tiles(const std::string& tile_dir,
+               const std::map<GraphId, BuildManifest::TileChecksum>& previous,
+               unsigned int concurrency) {
+  auto levels = TileHierarchy::levels();
+  levels.push_back(TileHierarchy::GetTransitLevel());
+
+  std::map<GraphId, BuildManifest::TileChecksum> tiles;
+  std::vector<std::pair<GraphId, std::filesystem::path>> changed;
+  for (const auto& level : levels) {
+    const auto level_dir = std::filesystem::path(tile_dir) / std::to_string(level.level);
+    if (!std::filesystem::is_directory(level_dir)) {
+      continue;
+    }
+    for (std::filesystem::recursive_directory_iterator i(level_dir), end; i != end; ++i) {
+      if (!i->is_regular_file()) {
+        continue;
+      }
+      GraphId tile_id;
+      try {
+        tile_id = GraphTile::GetTileId(i->path().string());
+      } catch (...) { continue; }
+
+      auto tile = get_tile_checksum(i->path(), false);
+      auto found = previous.find(tile_id);
+      if (found != previous.end() && found->second.size == tile.size &&
+          found->second.mtime == tile.mtime) {
+        tiles.emplace(tile_id, found->second);
+      } else {
+        changed.emplace_back(tile_id, i->path());
+      }
     }
-  } catch (...) {
-    EVP_MD_CTX_free(ctx);
-    throw;
   }
 
-  EVP_MD_CTX_free(ctx);
+  // Read the tiles which changed in parallel
+  std::vector<BuildManifest::TileChecksum> checksums(changed.size());
+  std::atomic<size_t> next(0);
+  std::vector<std::shared_ptr<std::thread>> threads(
+      std::max(1u, std::min(concurrency, static_cast<unsigned int>(changed.size()))));
+  std::vector<std::promise<void>> results(threads.size());
+  for (size_t i = 0; i < threads.size(); ++i) {
+    threads[i].reset(new std::thread([&changed, &checksums, &next](std::promise<void>& result) {
+      try {
+        for (size_t j = next++; j < changed.size(); j = next++) {
+          checksums[j] = get_tile_checksum(changed[j].second, true);
+        }
+        result.set_value();
+      } catch (...) { result.set_exception(std::current_exception()); }
+    }, std::ref(results[i])));
+  }
+  for (auto& thread : threads) {
+    thread->join();
+  }
+  for (auto& result : results) {
+    result.get_future().get();
+  }
 
-  // roll the 128 bit digest into a uint64
-  uint64_t lo = 0, hi = 0;
-  for (int i = 0; i < 8; ++i) {
-    lo = (lo << 8) | digest[i];
-    hi = (hi << 8) | digest[8 + i];
+  for (size_t i = 0; i < changed.size(); ++i) {
+    tiles.emplace(changed[i].first, checksums[i]);
   }
+  return tiles;
+}
 
-  std::hash<uint64_t> hasher;
-  uint64_t checksum = lo ^ (hasher(hi) + 0x9e3779b97f4a7c15ull + (lo << 12) + (lo >> 4));
+// Replace the local level tiles of one tile directory with those of another. Tiles are hard linked
+// rather than copied where the file system allows it, which is safe because tiles are only ever
+// replaced through a rename and never written in place. Tiles which were not rebuilt for the
+// current input still carry the checksum and dataset id of an older one, so if OSM data is given
+// those are set from it in the header of every tile, which is the only part written
+void CopyLocalTiles(const std::string& from_dir,
+                    const std::string& to_dir,
+                    const OSMData* osmdata = nullptr) {
+  const auto level = std::to_string(TileHierarchy::levels().back().level);
+  const auto from_level_dir = std::filesystem::path(from_dir) / level;
+  const auto to_level_dir = std::filesystem::path(to_dir) / level;
+  // unlink the old tiles first so the headers below are not set on tiles linked from to_dir
+  std::filesystem::remove_all(to_level_dir);
+  if (!std::filesystem::is_directory(from_level_dir)) {
+    return;
+  }
 
-  return checksum;
+  for (std::filesystem::recursive_directory_iterator i(from_level_dir), end; i != end; ++i) {
+    if (!i->is_regular_file()) {
+      continue;
+    }
+    try {
+      GraphTile::GetTileId(i->path().string());
+    } catch (...) { continue; }
+
+    if (osmdata) {
+      std::fstream tile(i->path(), std::ios::in | std::ios::out | std::ios::binary);
+      GraphTileHeader header;
+      if (!tile.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+        throw std::runtime_error("Invalid tile " + i->path().string());
+      }
+      if (header.checksum() != osmdata->pbf_checksum_ ||
+          header.dataset_id() != osmdata->max_changeset_id_) {
+        header.set_checksum(osmdata->pbf_checksum_);
+        header.set_dataset_id(osmdata->max_changeset_id_);
+        tile.seekp(0);
+        if (!tile.write(reinterpret_cast<const char*>(&header), sizeof(header))) {
+          throw std::runtime_error("Failed to write " + i->path().string());
+        }
+      }
+    }
+
+    auto to_file = to_level_dir / i->path().lexically_relative(from_level_dir);
+    std::filesystem::create_directories(to_file.parent_path());
+    std::error_code ec;
+    std::filesystem::create_hard_link(i->path(), to_file, ec);
+    if (ec) {
+      // e.g. the directories are on different file systems
+      std::filesystem::copy_file(i->path(), to_file);
+    }
+  }
 }
 
 /**
@@ -631,7 +792,8 @@ void ProcessEdgeTransitions(const uint32_t idx,
 bool build_tile_set(const boost::property_tree::ptree& original_config,
                     const std::vector<std::string>& input_files,
                     const BuildStage start_stage,
-                    const BuildStage end_stage) {
+                    const BuildStage end_stage,
+                    const std::vector<std::string>& change_files) {
   SCOPED_TIMER();
   auto remove_temp_file = [](const std::string& fname) {
     if (std::filesystem::exists(fname)) {
@@ -656,6 +818,29 @@ bool build_tile_set(const boost::property_tree::ptree& original_config,
     tile_dir.push_back(std::filesystem::path::preferred_separator);
   }
 
+  // Enhanced local tiles are kept in the incremental directory, so that later builds only have
+  // to rebuild the local tiles affected by OSM changes rather than all of them
+  auto incremental_dir = config.get<std::string>("mjolnir.incremental_dir", "");
+  if (!change_files.empty()) {
+    if (incremental_dir.empty()) {
+      throw std::runtime_error(
+          "Updating tiles from OSM change files requires mjolnir.incremental_dir");
+    }
+    if (build_stage_order(start_stage) > build_stage_order(BuildStage::kBuild) ||
+        build_stage_order(end_stage) < build_stage_order(BuildStage::kEnhance)) {
+      throw std::runtime_error(
+          "Updating tiles from OSM change files has to run the build and enhance stages");
+    }
+  }
+  auto incremental_config = config;
+  incremental_config.put("mjolnir.tile_dir", incremental_dir);
+
+  // Whether the stage is within the stages to run, in the order they run in
+  const auto runs = [start = build_stage_order(start_stage),
+                     end = build_stage_order(end_stage)](BuildStage stage) {
+    return start <= build_stage_order(stage) && build_stage_order(stage) <= end;
+  };
+
   // During the initialize stage the tile directory will be purged (if it already exists)
   // and will be created if it does not already exist
   if (start_stage == BuildStage::kInitialize) {
@@ -680,8 +865,53 @@ bool build_tile_set(const boost::property_tree::ptree& original_config,
     std::filesystem::create_directories(tile_dir);
   }
 
+  // Record the progress of the build in the tile directory after every stage, so that it can be
+  // resumed if it gets interrupted. The stages which run again are no longer complete
+  const std::string build_manifest = tile_dir + build_manifest_file;
+  BuildManifest manifest;
+  if (start_stage != BuildStage::kInitialize && std::filesystem::exists(build_manifest)) {
+    manifest = BuildManifest::ReadFromFile(build_manifest);
+  }
+  std::erase_if(manifest.stages, [start_stage](const auto& stage) {
+    return build_stage_order(stage.first) >= build_stage_order(start_stage);
+  });
+  const unsigned int concurrency =
+      std::max(1u, config.get<unsigned int>("mjolnir.concurrency",
+                                            std::thread::hardware_concurrency()));
+  auto stage_start = std::chrono::steady_clock::now();
+  bool peak_reset = memory_status::supported() && memory_status::reset_peak();
+
   // Snapshot for per-stage delta reporting
-  auto log_stage = [&config](BuildStage stage) { build_stats::get().log_stage(stage, config); };
+  auto log_stage = [&](BuildStage stage) {
+    build_stats::get().log_stage(stage, config);
+    if (build_stage_order(stage) < build_stage_order(start_stage)) {
+      return;
+    }
+
+    const auto now = std::chrono::steady_clock::now();
+    manifest.stages.emplace_back(stage, std::chrono::duration_cast<std::chrono::seconds>(
+                                            now - stage_start)
+                                            .count());
+    if (build_stage_order(stage) >= build_stage_order(BuildStage::kBuild)) {
+      manifest.tiles = checksum_tiles(tile_dir, manifest.tiles, concurrency);
+    }
+    manifest.LogToFile(build_manifest);
+
+    // Report the peak memory of the stage and start over for the next one. If the peak can not be
+    // reset it covers every stage so far rather than this one, so it is not reported then
+    if (memory_status::supported()) {
+      if (stage != BuildStage::kInitialize && peak_reset) {
+        memory_status status({"VmHWM"});
+        auto peak = status.metrics.find("VmHWM");
+        if (peak != status.metrics.end()) {
+          LOG_INFO(std::format("[{}] peak RSS {:.1f}{}", to_string(stage), peak->second.first,
+                               peak->second.second));
+        }
+      }
+      peak_reset = memory_status::reset_peak();
+    }
+    stage_start = std::chrono::steady_clock::now();
+  };
   // nothing to report, but logic only works correctly if every stage is logged
   log_stage(BuildStage::kInitialize);
 
@@ -703,11 +933,12 @@ bool build_tile_set(const boost::property_tree::ptree& original_config,
   OSMData osm_data{0};
 
   // Parse the ways
-  if (start_stage <= BuildStage::kParseWays && BuildStage::kParseWays <= end_stage) {
+  if (runs(BuildStage::kParseWays)) {
     // Read the OSM protocol buffer file. Callbacks for ways are defined within the PBFParser class
     osm_data = PBFGraphParser::ParseWays(config.get_child("mjolnir"), input_files, ways_bin,
                                          way_nodes_bin, access_bin);
     osm_data.pbf_checksum_ = get_pbf_checksum(input_files, tile_dir);
+    manifest.input_checksum = osm_data.pbf_checksum_;
 
     // Write the OSMData to files if the end stage is less than enhancing
     if (end_stage <= BuildStage::kEnhance) {
@@ -717,7 +948,7 @@ bool build_tile_set(const boost::property_tree::ptree& original_config,
   }
 
   // Parse OSM data
-  if (start_stage <= BuildStage::kParseRelations && BuildStage::kParseRelations <= end_stage) {
+  if (runs(BuildStage::kParseRelations)) {
 
     // Read the OSM protocol buffer file. Callbacks for relations are defined within the PBFParser
     // class
@@ -732,7 +963,7 @@ bool build_tile_set(const boost::property_tree::ptree& original_config,
   }
 
   // Parse OSM data
-  if (start_stage <= BuildStage::kParseNodes && BuildStage::kParseNodes <= end_stage) {
+  if (runs(BuildStage::kParseNodes)) {
     // Read the OSM protocol buffer file. Callbacks for nodes
     // are defined within the PBFParser class
     PBFGraphParser::ParseNodes(config.get_child("mjolnir"), input_files, way_nodes_bin, bss_nodes_bin,
@@ -747,7 +978,8 @@ bool build_tile_set(const boost::property_tree::ptree& original_config,
 
   // Construct edges
   std::map<baldr::GraphId, size_t> tiles;
-  if (start_stage <= BuildStage::kConstructEdges && BuildStage::kConstructEdges <= end_stage) {
+  std::unordered_set<baldr::GraphId> affected_tiles;
+  if (runs(BuildStage::kConstructEdges)) {
 
     // Read OSMData from files if construct edges is the first stage
     if (start_stage == BuildStage::kConstructEdges)
@@ -761,7 +993,7 @@ bool build_tile_set(const boost::property_tree::ptree& original_config,
   }
 
   // Build Valhalla routing tiles
-  if (start_stage <= BuildStage::kBuild && BuildStage::kBuild <= end_stage) {
+  if (runs(BuildStage::kBuild)) {
     if (start_stage == BuildStage::kBuild) {
       // Read OSMData from files if building tiles is the first stage
       osm_data.read_from_temp_files(tile_dir);
@@ -776,37 +1008,70 @@ bool build_tile_set(const boost::property_tree::ptree& original_config,
     }
 
     // Build the graph using the OSMNodes and OSMWays from the parser
-    GraphBuilder::Build(config, osm_data, ways_bin, way_nodes_bin, nodes_bin, edges_bin, cr_from_bin,
-                        cr_to_bin, linguistic_node_bin, tiles);
+    if (change_files.empty()) {
+      GraphBuilder::Build(config, osm_data, ways_bin, way_nodes_bin, nodes_bin, edges_bin,
+                          cr_from_bin, cr_to_bin, linguistic_node_bin, tiles);
+    } else {
+      // Only rebuild the local tiles the changes affect, on top of the incremental directory
+      affected_tiles = OSMChange::Read(change_files)
+                           .GetAffectedTiles(incremental_dir, ways_bin, way_nodes_bin, concurrency);
+      std::unordered_set<GraphId> rebuilt_tiles;
+      for (auto tile = tiles.begin(); tile != tiles.end();) {
+        if (affected_tiles.count(tile->first.tile_base())) {
+          rebuilt_tiles.insert(tile->first.tile_base());
+          ++tile;
+        } else {
+          tile = tiles.erase(tile);
+        }
+      }
+
+      // Tiles which no longer have any nodes are gone
+      for (const auto& tile_id : affected_tiles) {
+        if (!rebuilt_tiles.count(tile_id)) {
+          std::filesystem::remove(std::filesystem::path(incremental_dir) /
+                                  GraphTile::FileSuffix(tile_id));
+        }
+      }
+      GraphBuilder::Build(incremental_config, osm_data, ways_bin, way_nodes_bin, nodes_bin,
+                          edges_bin, cr_from_bin, cr_to_bin, linguistic_node_bin, tiles);
+    }
     log_stage(BuildStage::kBuild);
   }
 
   // Enhance the local level of the graph. This adds information to the local
   // level that is usable across all levels (density, administrative
   // information (and country based attribution), edge transition logic, etc.
-  if (start_stage <= BuildStage::kEnhance && BuildStage::kEnhance <= end_stage) {
+  if (runs(BuildStage::kEnhance)) {
     // Read OSMData names from file if enhancing tiles is the first stage
     if (start_stage == BuildStage::kEnhance) {
       osm_data.read_from_unique_names_file(tile_dir);
     }
-    GraphEnhancer::Enhance(config, osm_data, access_bin);
+    if (change_files.empty()) {
+      GraphEnhancer::Enhance(config, osm_data, access_bin);
+      if (!incremental_dir.empty()) {
+        CopyLocalTiles(tile_dir, incremental_dir);
+      }
+    } else {
+      GraphEnhancer::Enhance(incremental_config, osm_data, access_bin, affected_tiles);
+      CopyLocalTiles(incremental_dir, tile_dir, &osm_data);
+    }
     log_stage(BuildStage::kEnhance);
   }
 
   // Perform optional edge filtering (remove edges and nodes for specific access modes)
-  if (start_stage <= BuildStage::kFilter && BuildStage::kFilter <= end_stage) {
+  if (runs(BuildStage::kFilter)) {
     GraphFilter::Filter(config);
     log_stage(BuildStage::kFilter);
   }
 
   // Add transit
-  if (start_stage <= BuildStage::kTransit && BuildStage::kTransit <= end_stage) {
+  if (runs(BuildStage::kTransit)) {
     TransitBuilder::Build(config);
     log_stage(BuildStage::kTransit);
   }
 
   // Build bike share stations
-  if (start_stage <= BuildStage::kBss && BuildStage::kBss <= end_stage) {
+  if (runs(BuildStage::kBss)) {
     if (start_stage == BuildStage::kBss) {
       osm_data.read_from_unique_names_file(tile_dir);
     }
@@ -818,7 +1083,7 @@ bool build_tile_set(const boost::property_tree::ptree& original_config,
   // (directed edges) are formed between nodes at adjacent levels.
   auto build_hierarchy = config.get<bool>("mjolnir.hierarchy", true);
   if (build_hierarchy) {
-    if (start_stage <= BuildStage::kHierarchy && BuildStage::kHierarchy <= end_stage) {
+    if (runs(BuildStage::kHierarchy)) {
       HierarchyBuilder::Build(config, new_to_old_bin, old_to_new_bin);
       log_stage(BuildStage::kHierarchy);
     }
@@ -827,7 +1092,7 @@ bool build_tile_set(const boost::property_tree::ptree& original_config,
     // applied if hierarchies are also generated.
     auto build_shortcuts = config.get<bool>("mjolnir.shortcuts", true);
     if (build_shortcuts) {
-      if (start_stage <= BuildStage::kShortcuts && BuildStage::kShortcuts <= end_stage) {
+      if (runs(BuildStage::kShortcuts)) {
         ShortcutBuilder::Build(config);
         log_stage(BuildStage::kShortcuts);
       }
@@ -839,7 +1104,7 @@ bool build_tile_set(const boost::property_tree::ptree& original_config,
   }
 
   // Add elevation to the tiles
-  if (start_stage <= BuildStage::kElevation && BuildStage::kElevation <= end_stage) {
+  if (runs(BuildStage::kElevation)) {
     ElevationBuilder::Build(config);
     log_stage(BuildStage::kElevation);
   }
@@ -848,19 +1113,19 @@ bool build_tile_set(const boost::property_tree::ptree& original_config,
   // ComplexRestrictions must be done after elevation. The reason is that building
   // elevation into the tiles reads each tile and serializes the data to "builders"
   // within the tile. However, there is no serialization currently available for complex restrictions.
-  if (start_stage <= BuildStage::kRestrictions && BuildStage::kRestrictions <= end_stage) {
+  if (runs(BuildStage::kRestrictions)) {
     RestrictionBuilder::Build(config, cr_from_bin, cr_to_bin);
     log_stage(BuildStage::kRestrictions);
   }
 
   // Validate the graph and add information that cannot be added until full graph is formed.
-  if (start_stage <= BuildStage::kValidate && BuildStage::kValidate <= end_stage) {
+  if (runs(BuildStage::kValidate)) {
     GraphValidator::Validate(config);
     log_stage(BuildStage::kValidate);
   }
 
   // Cleanup bin files
-  if (start_stage <= BuildStage::kCleanup && BuildStage::kCleanup <= end_stage) {
+  if (runs(BuildStage::kCleanup)) {
     LOG_INFO("Cleaning up temporary *.bin files within " + tile_dir);
     remove_temp_file(ways_bin);
     remove_temp_file(way_nodes_bin);
@@ -874,6 +1139,8 @@ bool build_tile_set(const boost::property_tree::ptree& original_config,
     remove_temp_file(new_to_old_bin);
     remove_temp_file(old_to_new_bin);
     remove_temp_file(tile_manifest);
+    // let go of the OSMData files mapped by earlier stages before removing them
+    osm_data = OSMData{};
     OSMData::cleanup_temp_files(tile_dir);
     log_stage(BuildStage::kCleanup);
   }
@@ -921,6 +1188,129 @@ TileManifest TileManifest::ReadFromFile(const std::string& filename) {
   return TileManifest{tileset};
 }
 
+std::string BuildManifest::ToString() const {
+  rapidjson::writer_wrapper_t writer(4096);
+  writer.start_object();
+  writer("input_checksum", input_checksum);
+  writer.start_array("stages");
+  for (const auto& stage : stages) {
+    writer.start_object();
+    writer("stage", to_string(stage.first));
+    writer("seconds", stage.second);
+    writer.end_object();
+  }
+  writer.end_array();
+  writer.start_array("tiles");
+  for (const auto& tile : tiles) {
+    writer.start_object();
+    writer.start_object("graphid");
+    tile.first.json(writer);
+    writer.end_object();
+    writer("checksum", tile.second.checksum);
+    writer("size", tile.second.size);
+    writer("mtime", tile.second.mtime);
+    writer.end_object();
+  }
+  writer.end_array();
+  writer.end_object();
+  return writer.get_buffer();
+}
+
+void BuildManifest::LogToFile(const std::string& filename) const {
+  const std::string tmp_filename = filename + ".tmp";
+  std::ofstream handle;
+  handle.open(tmp_filename);
+  handle << ToString();
+  handle.close();
+  if (!handle) {
+    throw std::runtime_error("Failed to write build manifest " + tmp_filename);
+  }
+  std::filesystem::rename(tmp_filename, filename);
+}
+
+BuildManifest BuildManifest::ReadFromFile(const std::string& filename) {
+  ptree json;
+  rapidjson::read_json(filename, json);
+  LOG_INFO("Reading build manifest from " + filename);
+  BuildManifest manifest;
+  manifest.input_checksum = json.get<uint64_t>("input_checksum", 0);
+  const ptree empty;
+  for (const auto& stage : json.get_child("stages", empty)) {
+    manifest.stages.emplace_back(string_to_buildstage(stage.second.get<std::string>("stage")),
+                                 stage.second.get<uint64_t>("seconds"));
+  }
+  for (const auto& tile : json.get_child("tiles", empty)) {
+    const baldr::GraphId id(tile.second.get<uint64_t>("graphid.value"));
+    manifest.tiles.emplace(id, TileChecksum{tile.second.get<uint64_t>("checksum", 0),
+                                            tile.second.get<uint64_t>("size"),
+                                            tile.second.get<int64_t>("mtime")});
+  }
+  return manifest;
+}
+
+std::optional<BuildStage> resume_stage(const boost::property_tree::ptree& config,
+                                       const std::vector<std::string>& input_files) {
+  std::filesystem::path tile_dir(config.get<std::string>("mjolnir.tile_dir"));
+  const auto build_manifest = tile_dir / build_manifest_file;
+  if (!std::filesystem::exists(build_manifest)) {
+    LOG_INFO("No build manifest found in " + tile_dir.string() + ", starting the build over");
+    return BuildStage::kInitialize;
+  }
+
+  const auto manifest = BuildManifest::ReadFromFile(build_manifest.string());
+  if (manifest.stages.empty()) {
+    return BuildStage::kInitialize;
+  }
+  if (!input_files.empty() && manifest.input_checksum != 0 &&
+      get_pbf_checksum(input_files, tile_dir.string()) != manifest.input_checksum) {
+    LOG_WARN("The input files changed since the last build, starting the build over");
+    return BuildStage::kInitialize;
+  }
+
+  const auto last_stage = manifest.stages.back().first;
+  LOG_INFO("Last completed stage = " + to_string(last_stage));
+  if (last_stage == BuildStage::kInvalid) {
+    return BuildStage::kInitialize;
+  }
+
+  // The stage which was interrupted may have rewritten some of the tiles already. Only the tiles
+  // whose size or last write time changed are read, and those still match if their contents do
+  if (build_stage_order(last_stage) >= build_stage_order(BuildStage::kBuild) &&
+      last_stage != BuildStage::kCleanup) {
+    const unsigned int concurrency =
+        std::max(1u, config.get<unsigned int>("mjolnir.concurrency",
+                                              std::thread::hardware_concurrency()));
+    const auto tiles = checksum_tiles(tile_dir.string(), manifest.tiles, concurrency);
+    const auto same = [](const auto& a, const auto& b) {
+      return a.first == b.first && a.second.checksum == b.second.checksum &&
+             a.second.size == b.second.size;
+    };
+    if (!std::equal(tiles.begin(), tiles.end(), manifest.tiles.begin(), manifest.tiles.end(),
+                    same)) {
+      const bool edges_constructed =
+          std::any_of(manifest.stages.begin(), manifest.stages.end(), [](const auto& stage) {
+            return stage.first == BuildStage::kConstructEdges;
+          });
+      LOG_WARN("The tiles differ from the ones " + to_string(last_stage) +
+               " left, rebuilding them");
+      return edges_constructed ? BuildStage::kBuild : BuildStage::kInitialize;
+    }
+  }
+
+  // The stage which runs after the last completed one, skipping the ones the config turns off
+  const bool hierarchy = config.get<bool>("mjolnir.hierarchy", true);
+  const bool shortcuts = hierarchy && config.get<bool>("mjolnir.shortcuts", true);
+  for (auto stage = kBuildStageOrder.begin() + build_stage_order(last_stage) + 1;
+       stage != kBuildStageOrder.end(); ++stage) {
+    if ((*stage == BuildStage::kHierarchy && !hierarchy) ||
+        (*stage == BuildStage::kShortcuts && !shortcuts)) {
+      continue;
+    }
+    return *stage;
+  }
+  return std::nullopt;
+}
+
 void build_stats::record_timing(const std::string& key, uint64_t seconds) {
   std::lock_guard<std::mutex> lock(timings_mutex_);
   pending_timings_.emplace_back(key, seconds);
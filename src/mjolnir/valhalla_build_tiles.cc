@@ -15,9 +15,8 @@ using namespace valhalla::mjolnir;
 // List the build stages
 void list_stages() {
   std::cout << "Build stage strings (in order)" << std::endl;
-  for (int i = static_cast<int>(BuildStage::kInitialize); i <= static_cast<int>(BuildStage::kCleanup);
-       ++i) {
-    std::cout << "    " << to_string(static_cast<BuildStage>(i)) << std::endl;
+  for (const auto stage : kBuildStageOrder) {
+    std::cout << "    " << to_string(stage) << std::endl;
   }
 }
 
@@ -25,6 +24,7 @@ int main(int argc, char** argv) {
   const auto program = std::filesystem::path(__FILE__).stem().string();
   // args
   std::vector<std::string> input_files;
+  std::vector<std::string> change_files;
   BuildStage start_stage = BuildStage::kInitialize;
   BuildStage end_stage = BuildStage::kCleanup;
   boost::property_tree::ptree config;
@@ -47,6 +47,11 @@ int main(int argc, char** argv) {
       ("i,inline-config", "Inline JSON config", cxxopts::value<std::string>())
       ("s,start", "Starting stage of the build pipeline", cxxopts::value<std::string>()->default_value("initialize"))
       ("e,end", "End stage of the build pipeline", cxxopts::value<std::string>()->default_value("cleanup"))
+      ("r,resume", "Resume an interrupted build after the last stage the build manifest of the "
+                   "tile directory records as completed")
+      ("changes", "OSM change file(s) already applied to the input file(s). Only the local tiles "
+                  "they affect are rebuilt on top of mjolnir.incremental_dir",
+                  cxxopts::value<std::vector<std::string>>(change_files))
       ("input_files", "positional arguments", cxxopts::value<std::vector<std::string>>(input_files))
       ("j,concurrency", "Number of threads to use. Defaults to all threads.", cxxopts::value<uint32_t>());
     // clang-format on
@@ -74,8 +79,22 @@ int main(int argc, char** argv) {
     }
     LOG_INFO("Start stage = {} End stage = {}", to_string(start_stage), to_string(end_stage));
 
+    // Pick up where the last build of the tile directory left off
+    if (result.count("resume")) {
+      if (result.count("start")) {
+        throw cxxopts::exceptions::exception("Resuming a build and a starting stage are exclusive");
+      }
+      const auto resume = resume_stage(config, input_files);
+      if (!resume || build_stage_order(*resume) > build_stage_order(end_stage)) {
+        LOG_INFO("Nothing left to build");
+        return EXIT_SUCCESS;
+      }
+      start_stage = *resume;
+      LOG_INFO("Resuming at stage = {}", to_string(start_stage));
+    }
+
     // Make sure start stage < end stage
-    if (static_cast<int>(start_stage) > static_cast<int>(end_stage)) {
+    if (build_stage_order(start_stage) > build_stage_order(end_stage)) {
       list_stages();
       throw cxxopts::exceptions::exception(
           "Starting build stage is after ending build stage in pipeline, see above");
@@ -95,7 +114,7 @@ int main(int argc, char** argv) {
   }
 
   // Build some tiles!
-  if (build_tile_set(config, input_files, start_stage, end_stage)) {
+  if (build_tile_set(config, input_files, start_stage, end_stage, change_files)) {
     return EXIT_SUCCESS;
   } else {
     return EXIT_FAILURE;
@@ -8,6 +8,14 @@
 #include "proto/directions.pb.h"
 #include "proto/options.pb.h"
 
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
 namespace {
 // Minimum edge length to verify heading (~3 feet)
 constexpr auto kMinEdgeLength = 0.001f;
@@ -17,47 +25,191 @@ constexpr auto kMinEdgeLength = 0.001f;
 namespace valhalla {
 namespace odin {
 
+DirectionsContent DirectionsContent::FromOptions(const Options& options) {
+  DirectionsContent content;
+  switch (options.format()) {
+    // only the shape of the trip
+    case Options::gpx:
+      content.maneuvers = false;
+      break;
+    // the voice instructions are opt in, the lanes are always part of the intersections
+    case Options::osrm:
+      content.verbal_instructions = options.voice_instructions();
+      break;
+    // the lanes are opt in
+    case Options::json:
+      content.turn_lanes = options.turn_lanes();
+      break;
+    // the narrative comes with the directions and the lanes with the trip, which the maneuvers
+    // also update. without a selection a route gets the directions
+    case Options::pbf: {
+      const auto& selection = options.pbf_field_selector();
+      const bool directions = !options.has_pbf_field_selector() || selection.directions();
+      content.maneuvers = directions || selection.trip();
+      content.instructions = directions;
+      content.turn_lanes = selection.trip();
+      break;
+    }
+    default:
+      break;
+  }
+
+  if (options.directions_type() == DirectionsType::none) {
+    content.maneuvers = false;
+  } else if (options.directions_type() == DirectionsType::maneuvers) {
+    content.instructions = false;
+  }
+  content.instructions = content.instructions && content.maneuvers;
+  content.verbal_instructions = content.verbal_instructions && content.instructions;
+  content.turn_lanes = content.turn_lanes && content.maneuvers;
+  return content;
+}
+
+std::string_view DirectionsContent::level() const {
+  if (verbal_instructions) {
+    return "verbal";
+  }
+  if (instructions) {
+    return "instructions";
+  }
+  return maneuvers ? "maneuvers" : "none";
+}
+
 // Returns the trip directions based on the specified directions options
 // and trip path. This method calls ManeuversBuilder::Build and
-// NarrativeBuilder::Build to form the maneuver list. This method
-// calls PopulateDirectionsLeg to transform the maneuver list into the
-// trip directions.
-void DirectionsBuilder::Build(Api& api, const MarkupFormatter& markup_formatter) {
-  const auto& options = api.options();
+// NarrativeBuilder::Build to form the maneuver list, as far as the content
+// asks for it. This method calls PopulateDirectionsLeg to transform the
+// maneuver list into the trip directions.
+void DirectionsBuilder::Build(Api& api,
+                              const MarkupFormatter& markup_formatter,
+                              const DirectionsContent& content,
+                              DirectionsThreads* threads) {
+  // lay out the directions of all the legs up front so that they keep their order no matter in
+  // which order they are filled in
+  std::vector<std::pair<TripLeg*, DirectionsLeg*>> legs;
   for (auto& trip_route : *api.mutable_trip()->mutable_routes()) {
     auto& directions_route = *api.mutable_directions()->mutable_routes()->Add();
     for (auto& trip_path : *trip_route.mutable_legs()) {
-      auto& trip_directions = *directions_route.mutable_legs()->Add();
+      legs.emplace_back(&trip_path, directions_route.mutable_legs()->Add());
+    }
+  }
+
+  const auto& options = api.options();
+  if (!threads || threads->size() == 0 || legs.size() <= 1) {
+    for (auto& leg : legs) {
+      BuildLeg(options, markup_formatter, content, *leg.first, *leg.second);
+    }
+    return;
+  }
+
+  // the threads take the legs in order. once a leg fails no legs after it are taken, but every
+  // leg before it still is, so that the failure of the first leg that fails is rethrown, the same
+  // one the sequential build would have thrown
+  std::atomic<size_t> next{0};
+  std::atomic<size_t> first_failed{legs.size()};
+  std::vector<std::exception_ptr> failures(legs.size());
+  threads->Run([&]() {
+    for (size_t i = next++; i < first_failed; i = next++) {
+      try {
+        BuildLeg(options, markup_formatter, content, *legs[i].first, *legs[i].second);
+      } catch (...) {
+        failures[i] = std::current_exception();
+        size_t failed = first_failed;
+        while (i < failed && !first_failed.compare_exchange_weak(failed, i)) {
+        }
+      }
+    }
+  });
+  for (const auto& failure : failures) {
+    if (failure) {
+      std::rethrow_exception(failure);
+    }
+  }
+}
 
-      // Validate trip path node list
-      if (trip_path.node_size() < 1) {
-        throw valhalla_exception_t{210};
+DirectionsThreads::DirectionsThreads(unsigned int count) {
+  threads_.reserve(count);
+  for (unsigned int i = 0; i < count; ++i) {
+    threads_.emplace_back([this]() {
+      uint64_t last_run = 0;
+      std::unique_lock<std::mutex> lock(mutex_);
+      while (true) {
+        work_ready_.wait(lock, [&]() { return stop_ || run_ != last_run; });
+        if (stop_) {
+          return;
+        }
+        last_run = run_;
+        const auto* work = work_;
+        lock.unlock();
+        (*work)();
+        lock.lock();
+        if (--running_ == 0) {
+          work_done_.notify_one();
+        }
       }
+    });
+  }
+}
+
+DirectionsThreads::~DirectionsThreads() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  work_ready_.notify_all();
+  for (auto& thread : threads_) {
+    thread.join();
+  }
+}
+
+void DirectionsThreads::Run(const std::function<void()>& work) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    work_ = &work;
+    running_ = threads_.size();
+    ++run_;
+  }
+  work_ready_.notify_all();
+  work();
+  std::unique_lock<std::mutex> lock(mutex_);
+  work_done_.wait(lock, [this]() { return running_ == 0; });
+  work_ = nullptr;
+}
 
-      // Create an enhanced trip path from the specified trip_path
-      EnhancedTripLeg etp(trip_path);
+// Builds the directions of one leg of the trip.
+void DirectionsBuilder::BuildLeg(const Options& options,
+                                 const MarkupFormatter& markup_formatter,
+                                 const DirectionsContent& content,
+                                 TripLeg& trip_path,
+                                 DirectionsLeg& trip_directions) {
+  // Validate trip path node list
+  if (trip_path.node_size() < 1) {
+    throw valhalla_exception_t{210};
+  }
 
-      // Produce maneuvers if desired
-      std::list<Maneuver> maneuvers;
-      if (options.directions_type() != DirectionsType::none) {
-        // Update the heading of ~0 length edges
-        UpdateHeading(&etp);
+  // Create an enhanced trip path from the specified trip_path
+  EnhancedTripLeg etp(trip_path);
 
-        ManeuversBuilder maneuversBuilder(options, &etp);
-        maneuvers = maneuversBuilder.Build();
+  // Produce maneuvers if desired
+  std::list<Maneuver> maneuvers;
+  if (options.directions_type() != DirectionsType::none && content.maneuvers) {
+    // Update the heading of ~0 length edges
+    UpdateHeading(&etp);
 
-        // Create the instructions if desired
-        if (options.directions_type() == DirectionsType::instructions) {
-          std::unique_ptr<NarrativeBuilder> narrative_builder =
-              NarrativeBuilderFactory::Create(options, &etp, markup_formatter);
-          narrative_builder->Build(maneuvers);
-        }
-      }
+    ManeuversBuilder maneuversBuilder(options, &etp, content.turn_lanes,
+                                      content.verbal_instructions);
+    maneuvers = maneuversBuilder.Build();
 
-      // Return trip directions
-      PopulateDirectionsLeg(options, &etp, maneuvers, trip_directions);
+    // Create the instructions if desired
+    if (options.directions_type() == DirectionsType::instructions && content.instructions) {
+      std::unique_ptr<NarrativeBuilder> narrative_builder =
+          NarrativeBuilderFactory::Create(options, &etp, markup_formatter);
+      narrative_builder->Build(maneuvers, content.verbal_instructions);
     }
   }
+
+  // Return trip directions
+  PopulateDirectionsLeg(options, &etp, maneuvers, trip_directions);
 }
 
 // Update the heading of ~0 length edges.
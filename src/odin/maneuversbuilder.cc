@@ -8,6 +8,7 @@
 #include "baldr/verbal_text_formatter_factory.h"
 #include "exceptions.h"
 #include "midgard/logging.h"
+#include "midgard/metrics.h"
 #include "midgard/util.h"
 #include "odin/sign.h"
 #include "odin/signs.h"
@@ -86,11 +87,16 @@ bool has_level_changes(
 namespace valhalla {
 namespace odin {
 
-ManeuversBuilder::ManeuversBuilder(const Options& options, EnhancedTripLeg* etp)
-    : options_(options), trip_path_(etp) {
+ManeuversBuilder::ManeuversBuilder(const Options& options,
+                                   EnhancedTripLeg* etp,
+                                   bool turn_lanes,
+                                   bool verbal)
+    : options_(options), trip_path_(etp), turn_lanes_(turn_lanes), verbal_(verbal) {
 }
 
 std::list<Maneuver> ManeuversBuilder::Build() {
+  midgard::metrics::stage_timer_t timer(midgard::metrics::stage_t::maneuvers);
+
   // Create the maneuvers
   std::list<Maneuver> maneuvers = Produce();
 
@@ -142,13 +148,17 @@ std::list<Maneuver> ManeuversBuilder::Build() {
 
   // Process the turn lanes. Must happen after updating maneuver placement for internal edges so we
   // activate the correct lanes.
-  ProcessTurnLanes(maneuvers);
+  if (turn_lanes_) {
+    ProcessTurnLanes(maneuvers);
+  }
 
   // Add landmarks to maneuvers as direction guidance support
   // Each maneuver should get the landmarks associated with edges in the previous maneuver
   AddLandmarksFromTripLegToManeuvers(maneuvers);
 
-  ProcessVerbalSuccinctTransitionInstruction(maneuvers);
+  if (verbal_) {
+    ProcessVerbalSuccinctTransitionInstruction(maneuvers);
+  }
 
 #ifdef LOGGING_LEVEL_TRACE
   int final_man_id = 1;
@@ -3,6 +3,11 @@
 
 #include <boost/property_tree/ptree.hpp>
 
+#include <algorithm>
+#include <cctype>
+#include <limits>
+#include <stdexcept>
+
 namespace {
 
 // Read array and return as a vector
@@ -32,6 +37,73 @@ std::unordered_map<K, V> as_unordered_map(boost::property_tree::ptree const& pt,
 namespace valhalla {
 namespace odin {
 
+PhraseTemplate::PhraseTemplate(std::string phrase) : phrase_(std::move(phrase)) {
+  // a tag is an upper case name in angle brackets, anything else is literal text
+  size_t literal = 0;
+  size_t pos = 0;
+  while ((pos = phrase_.find('<', pos)) != std::string::npos) {
+    size_t end = pos + 1;
+    while (end < phrase_.size() && (std::isupper(static_cast<unsigned char>(phrase_[end])) ||
+                                    phrase_[end] == '_')) {
+      ++end;
+    }
+    if (end == pos + 1 || end == phrase_.size() || phrase_[end] != '>') {
+      ++pos;
+      continue;
+    }
+    if (pos > literal) {
+      pieces_.push_back(
+          {static_cast<uint32_t>(literal), static_cast<uint32_t>(pos - literal), false});
+    }
+    pieces_.push_back({static_cast<uint32_t>(pos), static_cast<uint32_t>(end + 1 - pos), true});
+    literal = pos = end + 1;
+  }
+  // an empty phrase still gets a piece so that it counts as loaded
+  if (literal < phrase_.size() || pieces_.empty()) {
+    pieces_.push_back(
+        {static_cast<uint32_t>(literal), static_cast<uint32_t>(phrase_.size() - literal), false});
+  }
+}
+
+std::string PhraseTemplate::Format(tag_values_t values) const {
+  auto value_of = [this, &values](const Piece& piece) -> const std::string_view* {
+    if (piece.tag) {
+      const std::string_view tag(phrase_.data() + piece.offset, piece.length);
+      for (const auto& value : values) {
+        if (value.first == tag) {
+          return &value.second;
+        }
+      }
+    }
+    return nullptr;
+  };
+
+  // size it up first so that the phrase is formed in a single allocation
+  size_t size = 0;
+  for (const auto& piece : pieces_) {
+    const auto* value = value_of(piece);
+    size += value ? value->size() : piece.length;
+  }
+
+  std::string formed;
+  formed.reserve(size);
+  for (const auto& piece : pieces_) {
+    if (const auto* value = value_of(piece)) {
+      formed.append(*value);
+    } else {
+      formed.append(phrase_, piece.offset, piece.length);
+    }
+  }
+  return formed;
+}
+
+const PhraseTemplate& PhraseSet::at(uint8_t phrase_id) const {
+  if (phrase_id >= templates.size() || !templates[phrase_id].loaded()) {
+    throw std::out_of_range("Missing phrase: " + std::to_string(phrase_id));
+  }
+  return templates[phrase_id];
+}
+
 NarrativeDictionary::NarrativeDictionary(const std::string& language_tag,
                                          const boost::property_tree::ptree& narrative_pt) {
   this->language_tag = language_tag;
@@ -350,6 +422,24 @@ void NarrativeDictionary::Load(PhraseSet& phrase_handle,
                                const boost::property_tree::ptree& phrase_pt) {
 
   phrase_handle.phrases = as_unordered_map<std::string, std::string>(phrase_pt, kPhrasesKey);
+
+  // Compile the phrases with a numeric key, those are the ones the narrative builder forms
+  phrase_handle.templates.clear();
+  for (const auto& phrase : phrase_handle.phrases) {
+    const auto& key = phrase.first;
+    if (key.empty() || key.size() > 3 ||
+        !std::all_of(key.begin(), key.end(), [](unsigned char c) { return std::isdigit(c); })) {
+      continue;
+    }
+    const auto phrase_id = std::stoul(key);
+    if (phrase_id > std::numeric_limits<uint8_t>::max()) {
+      continue;
+    }
+    if (phrase_id >= phrase_handle.templates.size()) {
+      phrase_handle.templates.resize(phrase_id + 1);
+    }
+    phrase_handle.templates[phrase_id] = PhraseTemplate(phrase.second);
+  }
 }
 
 void NarrativeDictionary::Load(StartSubset& start_handle,
@@ -2,6 +2,7 @@
 #include "baldr/verbal_text_formatter.h"
 #include "exceptions.h"
 #include "midgard/constants.h"
+#include "midgard/metrics.h"
 #include "odin/enhancedtrippath.h"
 #include "odin/maneuver.h"
 #include "odin/markup_formatter.h"
@@ -49,7 +50,8 @@ NarrativeBuilder::NarrativeBuilder(const Options& options,
       markup_formatter_(markup_formatter), articulated_preposition_enabled_(false) {
 }
 
-void NarrativeBuilder::Build(std::list<Maneuver>& maneuvers) {
+void NarrativeBuilder::Build(std::list<Maneuver>& maneuvers, bool verbal) {
+  midgard::metrics::stage_timer_t timer(midgard::metrics::stage_t::narrative);
   Maneuver* prev_maneuver = nullptr;
   for (auto& maneuver : maneuvers) {
     switch (maneuver.type()) {
@@ -61,16 +63,18 @@ void NarrativeBuilder::Build(std::list<Maneuver>& maneuvers) {
         // Set instruction
         maneuver.set_instruction(FormStartInstruction(maneuver));
 
-        // Set verbal succinct transition instruction
-        maneuver.set_verbal_succinct_transition_instruction(
-            FormVerbalSuccinctStartTransitionInstruction(maneuver));
+        if (verbal) {
+          // Set verbal succinct transition instruction
+          maneuver.set_verbal_succinct_transition_instruction(
+              FormVerbalSuccinctStartTransitionInstruction(maneuver));
 
-        // Set verbal pre transition instruction
-        maneuver.set_verbal_pre_transition_instruction(FormVerbalStartInstruction(maneuver));
+          // Set verbal pre transition instruction
+          maneuver.set_verbal_pre_transition_instruction(FormVerbalStartInstruction(maneuver));
 
-        // Set verbal post transition instruction
-        maneuver.set_verbal_post_transition_instruction(
-            FormVerbalPostTransitionInstruction(maneuver, maneuver.HasBeginStreetNames()));
+          // Set verbal post transition instruction
+          maneuver.set_verbal_post_transition_instruction(
+              FormVerbalPostTransitionInstruction(maneuver, maneuver.HasBeginStreetNames()));
+        }
         break;
       }
       case DirectionsLeg_Maneuver_Type_kDestinationRight:
@@ -79,12 +83,15 @@ void NarrativeBuilder::Build(std::list<Maneuver>& maneuvers) {
         // Set instruction
         maneuver.set_instruction(FormDestinationInstruction(maneuver));
 
-        // Set verbal transition alert instruction
-        maneuver.set_verbal_transition_alert_instruction(
-            FormVerbalAlertDestinationInstruction(maneuver));
+        if (verbal) {
+          // Set verbal transition alert instruction
+          maneuver.set_verbal_transition_alert_instruction(
+              FormVerbalAlertDestinationInstruction(maneuver));
 
-        // Set verbal pre transition instruction
-        maneuver.set_verbal_pre_transition_instruction(FormVerbalDestinationInstruction(maneuver));
+          // Set verbal pre transition instruction
+          maneuver.set_verbal_pre_transition_instruction(
+              FormVerbalDestinationInstruction(maneuver));
+        }
         break;
       }
       case DirectionsLeg_Maneuver_Type_kBecomes: {
@@ -92,18 +99,18 @@ void NarrativeBuilder::Build(std::list<Maneuver>& maneuvers) {
           // Set instruction
           maneuver.set_instruction(FormBecomesInstruction(maneuver, prev_maneuver));
 
-          // Set verbal pre transition instruction
-          maneuver.set_verbal_pre_transition_instruction(
-              FormVerbalBecomesInstruction(maneuver, prev_maneuver));
+          if (verbal) {
+            // Set verbal pre transition instruction
+            maneuver.set_verbal_pre_transition_instruction(
+                FormVerbalBecomesInstruction(maneuver, prev_maneuver));
+          }
         }
 
-        // Set verbal post transition instruction
-        maneuver.set_verbal_post_transition_instruction(
-            FormVerbalPostTransitionInstruction(maneuver,
-                                                maneuver
-                                                    .HasBeginStreetNames())); // Set verbal succinct
-                                                                              // transition
-                                                                              // instruction
+        if (verbal) {
+          // Set verbal post transition instruction
+          maneuver.set_verbal_post_transition_instruction(
+              FormVerbalPostTransitionInstruction(maneuver, maneuver.HasBeginStreetNames()));
+        }
         break;
       }
       case DirectionsLeg_Maneuver_Type_kSlightRight:
@@ -115,19 +122,22 @@ void NarrativeBuilder::Build(std::list<Maneuver>& maneuvers) {
         // Set instruction
         maneuver.set_instruction(FormTurnInstruction(maneuver));
 
-        // Set verbal succinct transition instruction
-        maneuver.set_verbal_succinct_transition_instruction(
-            FormVerbalSuccinctTurnTransitionInstruction(maneuver));
+        if (verbal) {
+          // Set verbal succinct transition instruction
+          maneuver.set_verbal_succinct_transition_instruction(
+              FormVerbalSuccinctTurnTransitionInstruction(maneuver));
 
-        // Set verbal transition alert instruction
-        maneuver.set_verbal_transition_alert_instruction(FormVerbalAlertTurnInstruction(maneuver));
+          // Set verbal transition alert instruction
+          maneuver.set_verbal_transition_alert_instruction(
+              FormVerbalAlertTurnInstruction(maneuver));
 
-        // Set verbal pre transition instruction
-        maneuver.set_verbal_pre_transition_instruction(FormVerbalTurnInstruction(maneuver));
+          // Set verbal pre transition instruction
+          maneuver.set_verbal_pre_transition_instruction(FormVerbalTurnInstruction(maneuver));
 
-        // Set verbal post transition instruction
-        maneuver.set_verbal_post_transition_instruction(
-            FormVerbalPostTransitionInstruction(maneuver, maneuver.HasBeginStreetNames()));
+          // Set verbal post transition instruction
+          maneuver.set_verbal_post_transition_instruction(
+              FormVerbalPostTransitionInstruction(maneuver, maneuver.HasBeginStreetNames()));
+        }
         break;
       }
       case DirectionsLeg_Maneuver_Type_kUturnRight:
@@ -135,40 +145,46 @@ void NarrativeBuilder::Build(std::list<Maneuver>& maneuvers) {
         // Set instruction
         maneuver.set_instruction(FormUturnInstruction(maneuver));
 
-        // Set verbal succinct transition instruction
-        maneuver.set_verbal_succinct_transition_instruction(
-            FormVerbalSuccinctUturnTransitionInstruction(maneuver));
+        if (verbal) {
+          // Set verbal succinct transition instruction
+          maneuver.set_verbal_succinct_transition_instruction(
+              FormVerbalSuccinctUturnTransitionInstruction(maneuver));
 
-        // Set verbal transition alert instruction
-        maneuver.set_verbal_transition_alert_instruction(FormVerbalAlertUturnInstruction(maneuver));
+          // Set verbal transition alert instruction
+          maneuver.set_verbal_transition_alert_instruction(
+              FormVerbalAlertUturnInstruction(maneuver));
 
-        // Set verbal pre transition instruction
-        maneuver.set_verbal_pre_transition_instruction(FormVerbalUturnInstruction(maneuver));
+          // Set verbal pre transition instruction
+          maneuver.set_verbal_pre_transition_instruction(FormVerbalUturnInstruction(maneuver));
 
-        // Set verbal post transition instruction
-        maneuver.set_verbal_post_transition_instruction(
-            FormVerbalPostTransitionInstruction(maneuver));
+          // Set verbal post transition instruction
+          maneuver.set_verbal_post_transition_instruction(
+              FormVerbalPostTransitionInstruction(maneuver));
+        }
         break;
       }
       case DirectionsLeg_Maneuver_Type_kRampStraight: {
         // Set instruction
         maneuver.set_instruction(FormRampStraightInstruction(maneuver));
 
-        // Set verbal transition alert instruction
-        maneuver.set_verbal_transition_alert_instruction(
-            FormVerbalAlertRampStraightInstruction(maneuver));
+        if (verbal) {
+          // Set verbal transition alert instruction
+          maneuver.set_verbal_transition_alert_instruction(
+              FormVerbalAlertRampStraightInstruction(maneuver));
 
-        // Set verbal pre transition instruction
-        maneuver.set_verbal_pre_transition_instruction(FormVerbalRampStraightInstruction(maneuver));
+          // Set verbal pre transition instruction
+          maneuver.set_verbal_pre_transition_instruction(
+              FormVerbalRampStraightInstruction(maneuver));
 
-        // Only set verbal post if > min ramp length
-        // or contains obvious maneuver
-        // or has collapsed merge maneuver
-        if ((maneuver.length() > kVerbalPostMinimumRampLength) ||
-            maneuver.contains_obvious_maneuver() || maneuver.has_collapsed_merge_maneuver()) {
-          // Set verbal post transition instruction
-          maneuver.set_verbal_post_transition_instruction(
-              FormVerbalPostTransitionInstruction(maneuver));
+          // Only set verbal post if > min ramp length
+          // or contains obvious maneuver
+          // or has collapsed merge maneuver
+          if ((maneuver.length() > kVerbalPostMinimumRampLength) ||
+              maneuver.contains_obvious_maneuver() || maneuver.has_collapsed_merge_maneuver()) {
+            // Set verbal post transition instruction
+            maneuver.set_verbal_post_transition_instruction(
+                FormVerbalPostTransitionInstruction(maneuver));
+          }
         }
         break;
       }
@@ -177,20 +193,23 @@ void NarrativeBuilder::Build(std::list<Maneuver>& maneuvers) {
         // Set instruction
         maneuver.set_instruction(FormRampInstruction(maneuver));
 
-        // Set verbal transition alert instruction
-        maneuver.set_verbal_transition_alert_instruction(FormVerbalAlertRampInstruction(maneuver));
+        if (verbal) {
+          // Set verbal transition alert instruction
+          maneuver.set_verbal_transition_alert_instruction(
+              FormVerbalAlertRampInstruction(maneuver));
 
-        // Set verbal pre transition instruction
-        maneuver.set_verbal_pre_transition_instruction(FormVerbalRampInstruction(maneuver));
+          // Set verbal pre transition instruction
+          maneuver.set_verbal_pre_transition_instruction(FormVerbalRampInstruction(maneuver));
 
-        // Only set verbal post if > min ramp length
-        // or contains obvious maneuver
-        // or has collapsed merge maneuver
-        if ((maneuver.length() > kVerbalPostMinimumRampLength) ||
-            maneuver.contains_obvious_maneuver() || maneuver.has_collapsed_merge_maneuver()) {
-          // Set verbal post transition instruction
-          maneuver.set_verbal_post_transition_instruction(
-              FormVerbalPostTransitionInstruction(maneuver));
+          // Only set verbal post if > min ramp length
+          // or contains obvious maneuver
+          // or has collapsed merge maneuver
+          if ((maneuver.length() > kVerbalPostMinimumRampLength) ||
+              maneuver.contains_obvious_maneuver() || maneuver.has_collapsed_merge_maneuver()) {
+            // Set verbal post transition instruction
+            maneuver.set_verbal_post_transition_instruction(
+                FormVerbalPostTransitionInstruction(maneuver));
+          }
         }
         break;
       }
@@ -199,20 +218,23 @@ void NarrativeBuilder::Build(std::list<Maneuver>& maneuvers) {
         // Set instruction
         maneuver.set_instruction(FormExitInstruction(maneuver));
 
-        // Set verbal transition alert instruction
-        maneuver.set_verbal_transition_alert_instruction(FormVerbalAlertExitInstruction(maneuver));
+        if (verbal) {
+          // Set verbal transition alert instruction
+          maneuver.set_verbal_transition_alert_instruction(
+              FormVerbalAlertExitInstruction(maneuver));
 
-        // Set verbal pre transition instruction
-        maneuver.set_verbal_pre_transition_instruction(FormVerbalExitInstruction(maneuver));
+          // Set verbal pre transition instruction
+          maneuver.set_verbal_pre_transition_instruction(FormVerbalExitInstruction(maneuver));
 
-        // Only set verbal post if > min ramp length
-        // or contains obvious maneuver
-        // or has collapsed merge maneuver
-        if ((maneuver.length() > kVerbalPostMinimumRampLength) ||
-            maneuver.contains_obvious_maneuver() || maneuver.has_collapsed_merge_maneuver()) {
-          // Set verbal post transition instruction
-          maneuver.set_verbal_post_transition_instruction(
-              FormVerbalPostTransitionInstruction(maneuver));
+          // Only set verbal post if > min ramp length
+          // or contains obvious maneuver
+          // or has collapsed merge maneuver
+          if ((maneuver.length() > kVerbalPostMinimumRampLength) ||
+              maneuver.contains_obvious_maneuver() || maneuver.has_collapsed_merge_maneuver()) {
+            // Set verbal post transition instruction
+            maneuver.set_verbal_post_transition_instruction(
+                FormVerbalPostTransitionInstruction(maneuver));
+          }
         }
         break;
       }
@@ -223,46 +245,52 @@ void NarrativeBuilder::Build(std::list<Maneuver>& maneuvers) {
           // Set stay on instruction
           maneuver.set_instruction(FormKeepToStayOnInstruction(maneuver));
 
-          // Set verbal transition alert instruction
-          maneuver.set_verbal_transition_alert_instruction(
-              FormVerbalAlertKeepToStayOnInstruction(maneuver));
-
-          // Set verbal pre transition instruction
-          maneuver.set_verbal_pre_transition_instruction(FormVerbalKeepToStayOnInstruction(maneuver));
-
-          // For a ramp - only set verbal post if > min ramp length
-          if (maneuver.ramp() && !maneuver.has_collapsed_merge_maneuver()) {
-            if (maneuver.length() > kVerbalPostMinimumRampLength) {
+          if (verbal) {
+            // Set verbal transition alert instruction
+            maneuver.set_verbal_transition_alert_instruction(
+                FormVerbalAlertKeepToStayOnInstruction(maneuver));
+
+            // Set verbal pre transition instruction
+            maneuver.set_verbal_pre_transition_instruction(
+                FormVerbalKeepToStayOnInstruction(maneuver));
+
+            // For a ramp - only set verbal post if > min ramp length
+            if (maneuver.ramp() && !maneuver.has_collapsed_merge_maneuver()) {
+              if (maneuver.length() > kVerbalPostMinimumRampLength) {
+                // Set verbal post transition instruction
+                maneuver.set_verbal_post_transition_instruction(
+                    FormVerbalPostTransitionInstruction(maneuver));
+              }
+            } else {
               // Set verbal post transition instruction
               maneuver.set_verbal_post_transition_instruction(
                   FormVerbalPostTransitionInstruction(maneuver));
             }
-          } else {
-            // Set verbal post transition instruction
-            maneuver.set_verbal_post_transition_instruction(
-                FormVerbalPostTransitionInstruction(maneuver));
           }
         } else {
           // Set instruction
           maneuver.set_instruction(FormKeepInstruction(maneuver));
 
-          // Set verbal transition alert instruction
-          maneuver.set_verbal_transition_alert_instruction(FormVerbalAlertKeepInstruction(maneuver));
-
-          // Set verbal pre transition instruction
-          maneuver.set_verbal_pre_transition_instruction(FormVerbalKeepInstruction(maneuver));
-
-          // For a ramp - only set verbal post if > min ramp length
-          if (maneuver.ramp() && !maneuver.has_collapsed_merge_maneuver()) {
-            if (maneuver.length() > kVerbalPostMinimumRampLength) {
+          if (verbal) {
+            // Set verbal transition alert instruction
+            maneuver.set_verbal_transition_alert_instruction(
+                FormVerbalAlertKeepInstruction(maneuver));
+
+            // Set verbal pre transition instruction
+            maneuver.set_verbal_pre_transition_instruction(FormVerbalKeepInstruction(maneuver));
+
+            // For a ramp - only set verbal post if > min ramp length
+            if (maneuver.ramp() && !maneuver.has_collapsed_merge_maneuver()) {
+              if (maneuver.length() > kVerbalPostMinimumRampLength) {
+                // Set verbal post transition instruction
+                maneuver.set_verbal_post_transition_instruction(
+                    FormVerbalPostTransitionInstruction(maneuver));
+              }
+            } else {
               // Set verbal post transition instruction
               maneuver.set_verbal_post_transition_instruction(
                   FormVerbalPostTransitionInstruction(maneuver));
             }
-          } else {
-            // Set verbal post transition instruction
-            maneuver.set_verbal_post_transition_instruction(
-                FormVerbalPostTransitionInstruction(maneuver));
           }
         }
         break;
@@ -273,47 +301,52 @@ void NarrativeBuilder::Build(std::list<Maneuver>& maneuvers) {
         // Set instruction
         maneuver.set_instruction(FormMergeInstruction(maneuver));
 
-        // Set verbal succinct transition instruction
-        maneuver.set_verbal_succinct_transition_instruction(
-            FormVerbalSuccinctMergeTransitionInstruction(maneuver));
-
-        // Set verbal transition alert instruction if previous maneuver
-        // is greater than 2 km
-        if (prev_maneuver && (prev_maneuver->length(Options::kilometers) >
-                              kVerbalAlertMergePriorManeuverMinimumLength)) {
-          maneuver.set_verbal_transition_alert_instruction(FormVerbalAlertMergeInstruction(maneuver));
-        }
+        if (verbal) {
+          // Set verbal succinct transition instruction
+          maneuver.set_verbal_succinct_transition_instruction(
+              FormVerbalSuccinctMergeTransitionInstruction(maneuver));
+
+          // Set verbal transition alert instruction if previous maneuver
+          // is greater than 2 km
+          if (prev_maneuver && (prev_maneuver->length(Options::kilometers) >
+                                kVerbalAlertMergePriorManeuverMinimumLength)) {
+            maneuver.set_verbal_transition_alert_instruction(
+                FormVerbalAlertMergeInstruction(maneuver));
+          }
 
-        // Set verbal pre transition instruction
-        maneuver.set_verbal_pre_transition_instruction(FormVerbalMergeInstruction(maneuver));
+          // Set verbal pre transition instruction
+          maneuver.set_verbal_pre_transition_instruction(FormVerbalMergeInstruction(maneuver));
 
-        // Set verbal post transition instruction
-        maneuver.set_verbal_post_transition_instruction(
-            FormVerbalPostTransitionInstruction(maneuver));
+          // Set verbal post transition instruction
+          maneuver.set_verbal_post_transition_instruction(
+              FormVerbalPostTransitionInstruction(maneuver));
+        }
         break;
       }
       case DirectionsLeg_Maneuver_Type_kRoundaboutEnter: {
         // Set instruction
         maneuver.set_instruction(FormEnterRoundaboutInstruction(maneuver));
 
-        // Set verbal succinct transition instruction
-        maneuver.set_verbal_succinct_transition_instruction(
-            FormVerbalSuccinctEnterRoundaboutTransitionInstruction(maneuver));
+        if (verbal) {
+          // Set verbal succinct transition instruction
+          maneuver.set_verbal_succinct_transition_instruction(
+              FormVerbalSuccinctEnterRoundaboutTransitionInstruction(maneuver));
 
-        // Set verbal transition alert instruction
-        maneuver.set_verbal_transition_alert_instruction(
-            FormVerbalAlertEnterRoundaboutInstruction(maneuver));
+          // Set verbal transition alert instruction
+          maneuver.set_verbal_transition_alert_instruction(
+              FormVerbalAlertEnterRoundaboutInstruction(maneuver));
 
-        // Set verbal pre transition instruction
-        maneuver.set_verbal_pre_transition_instruction(
-            FormVerbalEnterRoundaboutInstruction(maneuver));
+          // Set verbal pre transition instruction
+          maneuver.set_verbal_pre_transition_instruction(
+              FormVerbalEnterRoundaboutInstruction(maneuver));
 
-        // If the maneuver has a combined enter exit roundabout instruction
-        // then set verbal post transition instruction
-        if (maneuver.has_combined_enter_exit_roundabout()) {
-          maneuver.set_verbal_post_transition_instruction(
-              FormVerbalPostTransitionInstruction(maneuver,
-                                                  maneuver.HasRoundaboutExitBeginStreetNames()));
+          // If the maneuver has a combined enter exit roundabout instruction
+          // then set verbal post transition instruction
+          if (maneuver.has_combined_enter_exit_roundabout()) {
+            maneuver.set_verbal_post_transition_instruction(
+                FormVerbalPostTransitionInstruction(maneuver,
+                                                    maneuver.HasRoundaboutExitBeginStreetNames()));
+          }
         }
         break;
       }
@@ -321,95 +354,108 @@ void NarrativeBuilder::Build(std::list<Maneuver>& maneuvers) {
         // Set instruction
         maneuver.set_instruction(FormExitRoundaboutInstruction(maneuver));
 
-        // Set verbal succinct transition instruction
-        maneuver.set_verbal_succinct_transition_instruction(
-            FormVerbalSuccinctExitRoundaboutTransitionInstruction(maneuver));
+        if (verbal) {
+          // Set verbal succinct transition instruction
+          maneuver.set_verbal_succinct_transition_instruction(
+              FormVerbalSuccinctExitRoundaboutTransitionInstruction(maneuver));
 
-        // Set verbal pre transition instruction
-        maneuver.set_verbal_pre_transition_instruction(FormVerbalExitRoundaboutInstruction(maneuver));
+          // Set verbal pre transition instruction
+          maneuver.set_verbal_pre_transition_instruction(
+              FormVerbalExitRoundaboutInstruction(maneuver));
 
-        // Set verbal post transition instruction
-        maneuver.set_verbal_post_transition_instruction(
-            FormVerbalPostTransitionInstruction(maneuver, maneuver.HasBeginStreetNames()));
+          // Set verbal post transition instruction
+          maneuver.set_verbal_post_transition_instruction(
+              FormVerbalPostTransitionInstruction(maneuver, maneuver.HasBeginStreetNames()));
+        }
         break;
       }
       case DirectionsLeg_Maneuver_Type_kFerryEnter: {
         // Set instruction
         maneuver.set_instruction(FormEnterFerryInstruction(maneuver));
 
-        // Set verbal transition alert instruction
-        maneuver.set_verbal_transition_alert_instruction(
-            FormVerbalAlertEnterFerryInstruction(maneuver));
+        if (verbal) {
+          // Set verbal transition alert instruction
+          maneuver.set_verbal_transition_alert_instruction(
+              FormVerbalAlertEnterFerryInstruction(maneuver));
 
-        // Set verbal pre transition instruction
-        maneuver.set_verbal_pre_transition_instruction(FormVerbalEnterFerryInstruction(maneuver));
+          // Set verbal pre transition instruction
+          maneuver.set_verbal_pre_transition_instruction(FormVerbalEnterFerryInstruction(maneuver));
 
-        // Set verbal post transition instruction
-        maneuver.set_verbal_post_transition_instruction(
-            FormVerbalPostTransitionInstruction(maneuver));
+          // Set verbal post transition instruction
+          maneuver.set_verbal_post_transition_instruction(
+              FormVerbalPostTransitionInstruction(maneuver));
+        }
         break;
       }
       case DirectionsLeg_Maneuver_Type_kTransitConnectionStart: {
         // Set instruction
         maneuver.set_instruction(FormTransitConnectionStartInstruction(maneuver));
 
-        // Set verbal pre transition instruction
-        maneuver.set_verbal_pre_transition_instruction(
-            FormVerbalTransitConnectionStartInstruction(maneuver));
+        if (verbal) {
+          // Set verbal pre transition instruction
+          maneuver.set_verbal_pre_transition_instruction(
+              FormVerbalTransitConnectionStartInstruction(maneuver));
 
-        // Set verbal post transition instruction
-        maneuver.set_verbal_post_transition_instruction(
-            FormVerbalPostTransitionInstruction(maneuver));
+          // Set verbal post transition instruction
+          maneuver.set_verbal_post_transition_instruction(
+              FormVerbalPostTransitionInstruction(maneuver));
+        }
         break;
       }
       case DirectionsLeg_Maneuver_Type_kTransitConnectionTransfer: {
         // Set instruction
         maneuver.set_instruction(FormTransitConnectionTransferInstruction(maneuver));
 
-        // Set verbal pre transition instruction
-        maneuver.set_verbal_pre_transition_instruction(
-            FormVerbalTransitConnectionTransferInstruction(maneuver));
+        if (verbal) {
+          // Set verbal pre transition instruction
+          maneuver.set_verbal_pre_transition_instruction(
+              FormVerbalTransitConnectionTransferInstruction(maneuver));
 
-        // Set verbal post transition instruction
-        maneuver.set_verbal_post_transition_instruction(
-            FormVerbalPostTransitionInstruction(maneuver));
+          // Set verbal post transition instruction
+          maneuver.set_verbal_post_transition_instruction(
+              FormVerbalPostTransitionInstruction(maneuver));
+        }
         break;
       }
       case DirectionsLeg_Maneuver_Type_kTransitConnectionDestination: {
         // Set instruction
         maneuver.set_instruction(FormTransitConnectionDestinationInstruction(maneuver));
 
-        // Set verbal pre transition instruction
-        maneuver.set_verbal_pre_transition_instruction(
-            FormVerbalTransitConnectionDestinationInstruction(maneuver));
+        if (verbal) {
+          // Set verbal pre transition instruction
+          maneuver.set_verbal_pre_transition_instruction(
+              FormVerbalTransitConnectionDestinationInstruction(maneuver));
 
-        // Set verbal post transition instruction
-        maneuver.set_verbal_post_transition_instruction(
-            FormVerbalPostTransitionInstruction(maneuver));
+          // Set verbal post transition instruction
+          maneuver.set_verbal_post_transition_instruction(
+              FormVerbalPostTransitionInstruction(maneuver));
+        }
         break;
       }
       case DirectionsLeg_Maneuver_Type_kTransit: {
         // Set depart instruction
         maneuver.set_depart_instruction(FormDepartInstruction(maneuver));
 
-        // Set verbal depart instruction
-        maneuver.set_verbal_depart_instruction(FormVerbalDepartInstruction(maneuver));
-
         // Set instruction
         maneuver.set_instruction(FormTransitInstruction(maneuver));
 
-        // Set verbal pre transition instruction
-        maneuver.set_verbal_pre_transition_instruction(FormVerbalTransitInstruction(maneuver));
-
-        // Set verbal post transition instruction
-        maneuver.set_verbal_post_transition_instruction(
-            FormVerbalPostTransitionTransitInstruction(maneuver));
-
         // Set arrive instruction
         maneuver.set_arrive_instruction(FormArriveInstruction(maneuver));
 
-        // Set verbal arrive instruction
-        maneuver.set_verbal_arrive_instruction(FormVerbalArriveInstruction(maneuver));
+        if (verbal) {
+          // Set verbal depart instruction
+          maneuver.set_verbal_depart_instruction(FormVerbalDepartInstruction(maneuver));
+
+          // Set verbal pre transition instruction
+          maneuver.set_verbal_pre_transition_instruction(FormVerbalTransitInstruction(maneuver));
+
+          // Set verbal post transition instruction
+          maneuver.set_verbal_post_transition_instruction(
+              FormVerbalPostTransitionTransitInstruction(maneuver));
+
+          // Set verbal arrive instruction
+          maneuver.set_verbal_arrive_instruction(FormVerbalArriveInstruction(maneuver));
+        }
 
         break;
       }
@@ -417,25 +463,27 @@ void NarrativeBuilder::Build(std::list<Maneuver>& maneuvers) {
         // Set depart instruction
         maneuver.set_depart_instruction(FormDepartInstruction(maneuver));
 
-        // Set verbal depart instruction
-        maneuver.set_verbal_depart_instruction(FormVerbalDepartInstruction(maneuver));
-
         // Set instruction
         maneuver.set_instruction(FormTransitRemainOnInstruction(maneuver));
 
-        // Set verbal pre transition instruction
-        maneuver.set_verbal_pre_transition_instruction(
-            FormVerbalTransitRemainOnInstruction(maneuver));
-
-        // Set verbal post transition instruction
-        maneuver.set_verbal_post_transition_instruction(
-            FormVerbalPostTransitionTransitInstruction(maneuver));
-
         // Set arrive instruction
         maneuver.set_arrive_instruction(FormArriveInstruction(maneuver));
 
-        // Set verbal arrive instruction
-        maneuver.set_verbal_arrive_instruction(FormVerbalArriveInstruction(maneuver));
+        if (verbal) {
+          // Set verbal depart instruction
+          maneuver.set_verbal_depart_instruction(FormVerbalDepartInstruction(maneuver));
+
+          // Set verbal pre transition instruction
+          maneuver.set_verbal_pre_transition_instruction(
+              FormVerbalTransitRemainOnInstruction(maneuver));
+
+          // Set verbal post transition instruction
+          maneuver.set_verbal_post_transition_instruction(
+              FormVerbalPostTransitionTransitInstruction(maneuver));
+
+          // Set verbal arrive instruction
+          maneuver.set_verbal_arrive_instruction(FormVerbalArriveInstruction(maneuver));
+        }
 
         break;
       }
@@ -443,25 +491,27 @@ void NarrativeBuilder::Build(std::list<Maneuver>& maneuvers) {
         // Set depart instruction
         maneuver.set_depart_instruction(FormDepartInstruction(maneuver));
 
-        // Set verbal depart instruction
-        maneuver.set_verbal_depart_instruction(FormVerbalDepartInstruction(maneuver));
-
         // Set instruction
         maneuver.set_instruction(FormTransitTransferInstruction(maneuver));
 
-        // Set verbal pre transition instruction
-        maneuver.set_verbal_pre_transition_instruction(
-            FormVerbalTransitTransferInstruction(maneuver));
-
-        // Set verbal post transition instruction
-        maneuver.set_verbal_post_transition_instruction(
-            FormVerbalPostTransitionTransitInstruction(maneuver));
-
         // Set arrive instruction
         maneuver.set_arrive_instruction(FormArriveInstruction(maneuver));
 
-        // Set verbal arrive instruction
-        maneuver.set_verbal_arrive_instruction(FormVerbalArriveInstruction(maneuver));
+        if (verbal) {
+          // Set verbal depart instruction
+          maneuver.set_verbal_depart_instruction(FormVerbalDepartInstruction(maneuver));
+
+          // Set verbal pre transition instruction
+          maneuver.set_verbal_pre_transition_instruction(
+              FormVerbalTransitTransferInstruction(maneuver));
+
+          // Set verbal post transition instruction
+          maneuver.set_verbal_post_transition_instruction(
+              FormVerbalPostTransitionTransitInstruction(maneuver));
+
+          // Set verbal arrive instruction
+          maneuver.set_verbal_arrive_instruction(FormVerbalArriveInstruction(maneuver));
+        }
         break;
       }
       case DirectionsLeg_Maneuver_Type_kElevatorEnter: {
@@ -469,7 +519,8 @@ void NarrativeBuilder::Build(std::list<Maneuver>& maneuvers) {
         auto instr = FormElevatorInstruction(maneuver);
         maneuver.set_instruction(instr);
 
-        if (maneuver.has_node_type() && maneuver.node_type() == TripLeg_Node_Type_kElevator) {
+        if (verbal && maneuver.has_node_type() &&
+            maneuver.node_type() == TripLeg_Node_Type_kElevator) {
           maneuver.set_verbal_transition_alert_instruction(instr);
 
           // Set verbal pre transition instruction
@@ -485,14 +536,17 @@ void NarrativeBuilder::Build(std::list<Maneuver>& maneuvers) {
         // Set instruction
         auto instr = FormStepsInstruction(maneuver);
         maneuver.set_instruction(instr);
-        maneuver.set_verbal_transition_alert_instruction(instr);
 
-        // Set verbal pre transition instruction
-        maneuver.set_verbal_pre_transition_instruction(instr);
+        if (verbal) {
+          maneuver.set_verbal_transition_alert_instruction(instr);
+
+          // Set verbal pre transition instruction
+          maneuver.set_verbal_pre_transition_instruction(instr);
 
-        // Set verbal post transition instruction
-        maneuver.set_verbal_post_transition_instruction(
-            FormVerbalPostTransitionInstruction(maneuver));
+          // Set verbal post transition instruction
+          maneuver.set_verbal_post_transition_instruction(
+              FormVerbalPostTransitionInstruction(maneuver));
+        }
         break;
       }
       case DirectionsLeg_Maneuver_Type_kEscalatorEnter: {
@@ -522,22 +576,26 @@ void NarrativeBuilder::Build(std::list<Maneuver>& maneuvers) {
           std::string instr = FormPassInstruction(maneuver);
           // Set instruction
           maneuver.set_instruction(instr);
-          // Set verbal pre transition instruction
-          maneuver.set_verbal_pre_transition_instruction(instr);
+          if (verbal) {
+            // Set verbal pre transition instruction
+            maneuver.set_verbal_pre_transition_instruction(instr);
+          }
         } else {
           // Set instruction
           maneuver.set_instruction(FormContinueInstruction(maneuver));
 
-          // Set verbal transition alert instruction
-          maneuver.set_verbal_transition_alert_instruction(
-              FormVerbalAlertContinueInstruction(maneuver));
+          if (verbal) {
+            // Set verbal transition alert instruction
+            maneuver.set_verbal_transition_alert_instruction(
+                FormVerbalAlertContinueInstruction(maneuver));
 
-          // Set verbal pre transition instruction
-          maneuver.set_verbal_pre_transition_instruction(FormVerbalContinueInstruction(maneuver));
+            // Set verbal pre transition instruction
+            maneuver.set_verbal_pre_transition_instruction(FormVerbalContinueInstruction(maneuver));
 
-          // Set verbal post transition instruction
-          maneuver.set_verbal_post_transition_instruction(
-              FormVerbalPostTransitionInstruction(maneuver));
+            // Set verbal post transition instruction
+            maneuver.set_verbal_post_transition_instruction(
+                FormVerbalPostTransitionInstruction(maneuver));
+          }
         }
         break;
       }
@@ -550,23 +608,22 @@ void NarrativeBuilder::Build(std::list<Maneuver>& maneuvers) {
   }
 
   // Iterate over maneuvers to form verbal multi-cue instructions
-  FormVerbalMultiCue(maneuvers);
+  if (verbal) {
+    FormVerbalMultiCue(maneuvers);
+  }
 }
 
 std::string NarrativeBuilder::FormVerbalAlertApproachInstruction(float distance,
                                                                  const std::string& verbal_cue) {
   std::string instruction;
-  instruction.reserve(kInstructionInitialCapacity);
   uint8_t phrase_id = 0;
 
   // Set instruction to the determined tagged phrase
-  instruction = dictionary_.approach_verbal_alert_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kLengthTag,
-                     FormLength(distance, dictionary_.approach_verbal_alert_subset.metric_lengths,
-                                dictionary_.approach_verbal_alert_subset.us_customary_lengths));
-  boost::replace_all(instruction, kCurrentVerbalCueTag, verbal_cue);
+  instruction = dictionary_.approach_verbal_alert_subset.at(phrase_id).Format({
+      {kLengthTag, FormLength(distance, dictionary_.approach_verbal_alert_subset.metric_lengths,
+                              dictionary_.approach_verbal_alert_subset.us_customary_lengths)},
+      {kCurrentVerbalCueTag, verbal_cue},
+  });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -591,7 +648,6 @@ std::string NarrativeBuilder::FormStartInstruction(Maneuver& maneuver) {
   // "18": "Bike <CARDINAL_DIRECTION> on <BEGIN_STREET_NAMES>. Continue on <STREET_NAMES>."
 
   std::string instruction;
-  instruction.reserve(kInstructionInitialCapacity);
 
   // Set cardinal_direction value
   std::string cardinal_direction =
@@ -625,12 +681,11 @@ std::string NarrativeBuilder::FormStartInstruction(Maneuver& maneuver) {
   }
 
   // Set instruction to the determined tagged phrase
-  instruction = dictionary_.start_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kCardinalDirectionTag, cardinal_direction);
-  boost::replace_all(instruction, kStreetNamesTag, street_names);
-  boost::replace_all(instruction, kBeginStreetNamesTag, begin_street_names);
+  instruction = dictionary_.start_subset.at(phrase_id).Format({
+      {kCardinalDirectionTag, cardinal_direction},
+      {kStreetNamesTag, street_names},
+      {kBeginStreetNamesTag, begin_street_names},
+  });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -665,7 +720,6 @@ std::string NarrativeBuilder::FormVerbalStartInstruction(Maneuver& maneuver,
   // "19": "Bike <CARDINAL_DIRECTION> on <BEGIN_STREET_NAMES>."
 
   std::string instruction;
-  instruction.reserve(kInstructionInitialCapacity);
 
   // Set cardinal_direction value
   std::string cardinal_direction =
@@ -712,15 +766,13 @@ std::string NarrativeBuilder::FormVerbalStartInstruction(Maneuver& maneuver,
   }
 
   // Set instruction to the determined tagged phrase
-  instruction = dictionary_.start_verbal_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kCardinalDirectionTag, cardinal_direction);
-  boost::replace_all(instruction, kStreetNamesTag, street_names);
-  boost::replace_all(instruction, kBeginStreetNamesTag, begin_street_names);
-  boost::replace_all(instruction, kLengthTag,
-                     FormLength(maneuver, dictionary_.start_verbal_subset.metric_lengths,
-                                dictionary_.start_verbal_subset.us_customary_lengths));
+  instruction = dictionary_.start_verbal_subset.at(phrase_id).Format({
+      {kCardinalDirectionTag, cardinal_direction},
+      {kStreetNamesTag, street_names},
+      {kBeginStreetNamesTag, begin_street_names},
+      {kLengthTag, FormLength(maneuver, dictionary_.start_verbal_subset.metric_lengths,
+                              dictionary_.start_verbal_subset.us_customary_lengths)},
+  });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -738,7 +790,6 @@ std::string NarrativeBuilder::FormDestinationInstruction(Maneuver& maneuver) {
 
   uint8_t phrase_id = 0;
   std::string instruction;
-  instruction.reserve(kInstructionInitialCapacity);
 
   // Determine if location (name or street) exists
   std::string destination;
@@ -765,13 +816,10 @@ std::string NarrativeBuilder::FormDestinationInstruction(Maneuver& maneuver) {
   }
 
   // Set instruction to the determined tagged phrase
-  instruction = dictionary_.destination_subset.phrases.at(std::to_string(phrase_id));
-
-  if (phrase_id > 0) {
-    // Replace phrase tags with values
-    boost::replace_all(instruction, kRelativeDirectionTag, relative_direction);
-    boost::replace_all(instruction, kDestinationTag, destination);
-  }
+  instruction = dictionary_.destination_subset.at(phrase_id).Format({
+      {kRelativeDirectionTag, relative_direction},
+      {kDestinationTag, destination},
+  });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -789,7 +837,6 @@ std::string NarrativeBuilder::FormVerbalAlertDestinationInstruction(Maneuver& ma
 
   uint8_t phrase_id = 0;
   std::string instruction;
-  instruction.reserve(kInstructionInitialCapacity);
 
   // Determine if destination (name or street) exists
   std::string destination;
@@ -821,13 +868,10 @@ std::string NarrativeBuilder::FormVerbalAlertDestinationInstruction(Maneuver& ma
   }
 
   // Set instruction to the determined tagged phrase
-  instruction = dictionary_.destination_verbal_alert_subset.phrases.at(std::to_string(phrase_id));
-
-  if (phrase_id > 0) {
-    // Replace phrase tags with values
-    boost::replace_all(instruction, kRelativeDirectionTag, relative_direction);
-    boost::replace_all(instruction, kDestinationTag, destination);
-  }
+  instruction = dictionary_.destination_verbal_alert_subset.at(phrase_id).Format({
+      {kRelativeDirectionTag, relative_direction},
+      {kDestinationTag, destination},
+  });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -845,7 +889,6 @@ std::string NarrativeBuilder::FormVerbalDestinationInstruction(Maneuver& maneuve
 
   uint8_t phrase_id = 0;
   std::string instruction;
-  instruction.reserve(kInstructionInitialCapacity);
 
   // Determine if destination (name or street) exists
   std::string destination;
@@ -877,13 +920,10 @@ std::string NarrativeBuilder::FormVerbalDestinationInstruction(Maneuver& maneuve
   }
 
   // Set instruction to the determined tagged phrase
-  instruction = dictionary_.destination_verbal_subset.phrases.at(std::to_string(phrase_id));
-
-  if (phrase_id > 0) {
-    // Replace phrase tags with values
-    boost::replace_all(instruction, kRelativeDirectionTag, relative_direction);
-    boost::replace_all(instruction, kDestinationTag, destination);
-  }
+  instruction = dictionary_.destination_verbal_subset.at(phrase_id).Format({
+      {kRelativeDirectionTag, relative_direction},
+      {kDestinationTag, destination},
+  });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -897,7 +937,6 @@ std::string NarrativeBuilder::FormBecomesInstruction(Maneuver& maneuver, Maneuve
   // "0": "<PREVIOUS_STREET_NAMES> becomes <STREET_NAMES>."
 
   std::string instruction;
-  instruction.reserve(kInstructionInitialCapacity);
 
   // Assign the street names and the previous maneuver street names
   std::string street_names = FormStreetNames(maneuver, maneuver.street_names());
@@ -907,11 +946,10 @@ std::string NarrativeBuilder::FormBecomesInstruction(Maneuver& maneuver, Maneuve
   uint8_t phrase_id = 0;
 
   // Set instruction to the determined tagged phrase
-  instruction = dictionary_.becomes_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kPreviousStreetNamesTag, prev_street_names);
-  boost::replace_all(instruction, kStreetNamesTag, street_names);
+  instruction = dictionary_.becomes_subset.at(phrase_id).Format({
+      {kPreviousStreetNamesTag, prev_street_names},
+      {kStreetNamesTag, street_names},
+  });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -928,7 +966,6 @@ std::string NarrativeBuilder::FormVerbalBecomesInstruction(Maneuver& maneuver,
   // "0": "<PREVIOUS_STREET_NAMES> becomes <STREET_NAMES>."
 
   std::string instruction;
-  instruction.reserve(kInstructionInitialCapacity);
 
   // Assign the street names and the previous maneuver street names
   std::string street_names =
@@ -942,11 +979,10 @@ std::string NarrativeBuilder::FormVerbalBecomesInstruction(Maneuver& maneuver,
   uint8_t phrase_id = 0;
 
   // Set instruction to the determined tagged phrase
-  instruction = dictionary_.becomes_verbal_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kPreviousStreetNamesTag, prev_street_names);
-  boost::replace_all(instruction, kStreetNamesTag, street_names);
+  instruction = dictionary_.becomes_verbal_subset.at(phrase_id).Format({
+      {kPreviousStreetNamesTag, prev_street_names},
+      {kStreetNamesTag, street_names},
+  });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -965,7 +1001,6 @@ std::string NarrativeBuilder::FormContinueInstruction(Maneuver& maneuver,
   // "3": "Continue toward <TOWARD_SIGN>."
 
   std::string instruction;
-  instruction.reserve(kInstructionInitialCapacity);
 
   // Assign the street names
   std::string street_names =
@@ -993,12 +1028,11 @@ std::string NarrativeBuilder::FormContinueInstruction(Maneuver& maneuver,
   }
 
   // Set instruction to the determined tagged phrase
-  instruction = dictionary_.continue_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kStreetNamesTag, street_names);
-  boost::replace_all(instruction, kJunctionNameTag, junction_name);
-  boost::replace_all(instruction, kTowardSignTag, guide_sign);
+  instruction = dictionary_.continue_subset.at(phrase_id).Format({
+      {kStreetNamesTag, street_names},
+      {kJunctionNameTag, junction_name},
+      {kTowardSignTag, guide_sign},
+  });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -1018,7 +1052,6 @@ std::string NarrativeBuilder::FormVerbalAlertContinueInstruction(Maneuver& maneu
   // "3": "Continue toward <TOWARD_SIGN>."
 
   std::string instruction;
-  instruction.reserve(kInstructionInitialCapacity);
 
   // Assign the street names
   std::string street_names =
@@ -1049,12 +1082,11 @@ std::string NarrativeBuilder::FormVerbalAlertContinueInstruction(Maneuver& maneu
   }
 
   // Set instruction to the determined tagged phrase
-  instruction = dictionary_.continue_verbal_alert_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kStreetNamesTag, street_names);
-  boost::replace_all(instruction, kJunctionNameTag, junction_name);
-  boost::replace_all(instruction, kTowardSignTag, guide_sign);
+  instruction = dictionary_.continue_verbal_alert_subset.at(phrase_id).Format({
+      {kStreetNamesTag, street_names},
+      {kJunctionNameTag, junction_name},
+      {kTowardSignTag, guide_sign},
+  });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -1078,7 +1110,6 @@ std::string NarrativeBuilder::FormVerbalContinueInstruction(Maneuver& maneuver,
   // "7": "Continue toward <TOWARD_SIGN> for <LENGTH>."
 
   std::string instruction;
-  instruction.reserve(kInstructionInitialCapacity);
 
   // Assign the street names
   std::string street_names =
@@ -1114,15 +1145,13 @@ std::string NarrativeBuilder::FormVerbalContinueInstruction(Maneuver& maneuver,
   }
 
   // Set instruction to the determined tagged phrase
-  instruction = dictionary_.continue_verbal_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kLengthTag,
-                     FormLength(maneuver, dictionary_.continue_verbal_subset.metric_lengths,
-                                dictionary_.continue_verbal_subset.us_customary_lengths));
-  boost::replace_all(instruction, kStreetNamesTag, street_names);
-  boost::replace_all(instruction, kJunctionNameTag, junction_name);
-  boost::replace_all(instruction, kTowardSignTag, guide_sign);
+  instruction = dictionary_.continue_verbal_subset.at(phrase_id).Format({
+      {kLengthTag, FormLength(maneuver, dictionary_.continue_verbal_subset.metric_lengths,
+                              dictionary_.continue_verbal_subset.us_customary_lengths)},
+      {kStreetNamesTag, street_names},
+      {kJunctionNameTag, junction_name},
+      {kTowardSignTag, guide_sign},
+  });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -1162,7 +1191,6 @@ std::string NarrativeBuilder::FormTurnInstruction(Maneuver& maneuver,
   }
 
   std::string instruction;
-  instruction.reserve(kInstructionInitialCapacity);
 
   // Assign the street names
   std::string street_names =
@@ -1199,15 +1227,14 @@ std::string NarrativeBuilder::FormTurnInstruction(Maneuver& maneuver,
   }
 
   // Set instruction to the determined tagged phrase
-  instruction = subset->phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kRelativeDirectionTag,
-                     FormRelativeTwoDirection(maneuver.type(), subset->relative_directions));
-  boost::replace_all(instruction, kStreetNamesTag, street_names);
-  boost::replace_all(instruction, kBeginStreetNamesTag, begin_street_names);
-  boost::replace_all(instruction, kJunctionNameTag, junction_name);
-  boost::replace_all(instruction, kTowardSignTag, guide_sign);
+  instruction = subset->at(phrase_id).Format({
+      {kRelativeDirectionTag, FormRelativeTwoDirection(maneuver.type(),
+                                                       subset->relative_directions)},
+      {kStreetNamesTag, street_names},
+      {kBeginStreetNamesTag, begin_street_names},
+      {kJunctionNameTag, junction_name},
+      {kTowardSignTag, guide_sign},
+  });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -1261,7 +1288,6 @@ std::string NarrativeBuilder::FormVerbalTurnInstruction(Maneuver& maneuver,
   }
 
   std::string instruction;
-  instruction.reserve(kInstructionInitialCapacity);
 
   // Assign the street names
   std::string street_names =
@@ -1307,15 +1333,14 @@ std::string NarrativeBuilder::FormVerbalTurnInstruction(Maneuver& maneuver,
   }
 
   // Set instruction to the determined tagged phrase
-  instruction = subset->phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kRelativeDirectionTag,
-                     FormRelativeTwoDirection(maneuver.type(), subset->relative_directions));
-  boost::replace_all(instruction, kStreetNamesTag, street_names);
-  boost::replace_all(instruction, kBeginStreetNamesTag, begin_street_names);
-  boost::replace_all(instruction, kJunctionNameTag, junction_name);
-  boost::replace_all(instruction, kTowardSignTag, guide_sign);
+  instruction = subset->at(phrase_id).Format({
+      {kRelativeDirectionTag, FormRelativeTwoDirection(maneuver.type(),
+                                                       subset->relative_directions)},
+      {kStreetNamesTag, street_names},
+      {kBeginStreetNamesTag, begin_street_names},
+      {kJunctionNameTag, junction_name},
+      {kTowardSignTag, guide_sign},
+  });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -1338,7 +1363,6 @@ std::string NarrativeBuilder::FormUturnInstruction(Maneuver& maneuver,
   // "7": "Make a <RELATIVE_DIRECTION> U-turn toward <TOWARD_SIGN>."
 
   std::string instruction;
-  instruction.reserve(kInstructionInitialCapacity);
 
   // Assign the street names
   std::string street_names =
@@ -1377,16 +1401,14 @@ std::string NarrativeBuilder::FormUturnInstruction(Maneuver& maneuver,
   }
 
   // Set instruction to the determined tagged phrase
-  instruction = dictionary_.uturn_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kRelativeDirectionTag,
-                     FormRelativeTwoDirection(maneuver.type(),
-                                              dictionary_.uturn_subset.relative_directions));
-  boost::replace_all(instruction, kStreetNamesTag, street_names);
-  boost::replace_all(instruction, kCrossStreetNamesTag, cross_street_names);
-  boost::replace_all(instruction, kJunctionNameTag, junction_name);
-  boost::replace_all(instruction, kTowardSignTag, guide_sign);
+  instruction = dictionary_.uturn_subset.at(phrase_id).Format({
+      {kRelativeDirectionTag,
+       FormRelativeTwoDirection(maneuver.type(), dictionary_.uturn_subset.relative_directions)},
+      {kStreetNamesTag, street_names},
+      {kCrossStreetNamesTag, cross_street_names},
+      {kJunctionNameTag, junction_name},
+      {kTowardSignTag, guide_sign},
+  });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -1529,17 +1551,15 @@ std::string NarrativeBuilder::FormVerbalUturnInstruction(uint8_t phrase_id,
                                                          const std::string& guide_sign) {
 
   std::string instruction;
-  instruction.reserve(kInstructionInitialCapacity);
 
   // Set instruction to the determined tagged phrase
-  instruction = dictionary_.uturn_verbal_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kRelativeDirectionTag, relative_dir);
-  boost::replace_all(instruction, kStreetNamesTag, street_names);
-  boost::replace_all(instruction, kCrossStreetNamesTag, cross_street_names);
-  boost::replace_all(instruction, kJunctionNameTag, junction_name);
-  boost::replace_all(instruction, kTowardSignTag, guide_sign);
+  instruction = dictionary_.uturn_verbal_subset.at(phrase_id).Format({
+      {kRelativeDirectionTag, relative_dir},
+      {kStreetNamesTag, street_names},
+      {kCrossStreetNamesTag, cross_street_names},
+      {kJunctionNameTag, junction_name},
+      {kTowardSignTag, guide_sign},
+  });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -1559,7 +1579,6 @@ std::string NarrativeBuilder::FormRampStraightInstruction(Maneuver& maneuver,
   // "4": "Stay straight to take the <NAME_SIGN> ramp."
 
   std::string instruction;
-  instruction.reserve(kInstructionInitialCapacity);
 
   // Determine which phrase to use
   uint8_t phrase_id = 0;
@@ -1586,12 +1605,11 @@ std::string NarrativeBuilder::FormRampStraightInstruction(Maneuver& maneuver,
   }
 
   // Set instruction to the determined tagged phrase
-  instruction = dictionary_.ramp_straight_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kBranchSignTag, exit_branch_sign);
-  boost::replace_all(instruction, kTowardSignTag, exit_toward_sign);
-  boost::replace_all(instruction, kNameSignTag, exit_name_sign);
+  instruction = dictionary_.ramp_straight_subset.at(phrase_id).Format({
+      {kBranchSignTag, exit_branch_sign},
+      {kTowardSignTag, exit_toward_sign},
+      {kNameSignTag, exit_name_sign},
+  });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -1688,15 +1706,13 @@ std::string NarrativeBuilder::FormVerbalRampStraightInstruction(uint8_t phrase_i
                                                                 const std::string& exit_name_sign) {
 
   std::string instruction;
-  instruction.reserve(kInstructionInitialCapacity);
 
   // Set instruction to the determined tagged phrase
-  instruction = dictionary_.ramp_straight_verbal_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kBranchSignTag, exit_branch_sign);
-  boost::replace_all(instruction, kTowardSignTag, exit_toward_sign);
-  boost::replace_all(instruction, kNameSignTag, exit_name_sign);
+  instruction = dictionary_.ramp_straight_verbal_subset.at(phrase_id).Format({
+      {kBranchSignTag, exit_branch_sign},
+      {kTowardSignTag, exit_toward_sign},
+      {kNameSignTag, exit_name_sign},
+  });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -1726,7 +1742,6 @@ std::string NarrativeBuilder::FormRampInstruction(Maneuver& maneuver,
   // "14": "Take the <NAME_SIGN> ramp."
 
   std::string instruction;
-  instruction.reserve(kInstructionInitialCapacity);
 
   // Determine which phrase to use
   uint8_t phrase_id = 0;
@@ -1765,15 +1780,13 @@ std::string NarrativeBuilder::FormRampInstruction(Maneuver& maneuver,
   }
 
   // Set instruction to the determined tagged phrase
-  instruction = dictionary_.ramp_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kRelativeDirectionTag,
-                     FormRelativeTwoDirection(maneuver.type(),
-                                              dictionary_.ramp_subset.relative_directions));
-  boost::replace_all(instruction, kBranchSignTag, exit_branch_sign);
-  boost::replace_all(instruction, kTowardSignTag, exit_toward_sign);
-  boost::replace_all(instruction, kNameSignTag, exit_name_sign);
+  instruction = dictionary_.ramp_subset.at(phrase_id).Format({
+      {kRelativeDirectionTag,
+       FormRelativeTwoDirection(maneuver.type(), dictionary_.ramp_subset.relative_directions)},
+      {kBranchSignTag, exit_branch_sign},
+      {kTowardSignTag, exit_toward_sign},
+      {kNameSignTag, exit_name_sign},
+  });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -1922,16 +1935,14 @@ std::string NarrativeBuilder::FormVerbalRampInstruction(uint8_t phrase_id,
                                                         const std::string& exit_name_sign) {
 
   std::string instruction;
-  instruction.reserve(kInstructionInitialCapacity);
 
   // Set instruction to the determined tagged phrase
-  instruction = dictionary_.ramp_verbal_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kRelativeDirectionTag, relative_dir);
-  boost::replace_all(instruction, kBranchSignTag, exit_branch_sign);
-  boost::replace_all(instruction, kTowardSignTag, exit_toward_sign);
-  boost::replace_all(instruction, kNameSignTag, exit_name_sign);
+  instruction = dictionary_.ramp_verbal_subset.at(phrase_id).Format({
+      {kRelativeDirectionTag, relative_dir},
+      {kBranchSignTag, exit_branch_sign},
+      {kTowardSignTag, exit_toward_sign},
+      {kNameSignTag, exit_name_sign},
+  });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -1970,7 +1981,6 @@ std::string NarrativeBuilder::FormExitInstruction(Maneuver& maneuver,
   // "29": "Take the <NAME_SIGN> exit onto <BRANCH_SIGN> toward <TOWARD_SIGN>."
 
   std::string instruction;
-  instruction.reserve(kInstructionInitialCapacity);
 
   // Determine which phrase to use
   uint8_t phrase_id = 0;
@@ -2010,16 +2020,14 @@ std::string NarrativeBuilder::FormExitInstruction(Maneuver& maneuver,
   }
 
   // Set instruction to the determined tagged phrase
-  instruction = dictionary_.exit_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kRelativeDirectionTag,
-                     FormRelativeTwoDirection(maneuver.type(),
-                                              dictionary_.exit_subset.relative_directions));
-  boost::replace_all(instruction, kNumberSignTag, exit_number_sign);
-  boost::replace_all(instruction, kBranchSignTag, exit_branch_sign);
-  boost::replace_all(instruction, kTowardSignTag, exit_toward_sign);
-  boost::replace_all(instruction, kNameSignTag, exit_name_sign);
+  instruction = dictionary_.exit_subset.at(phrase_id).Format({
+      {kRelativeDirectionTag,
+       FormRelativeTwoDirection(maneuver.type(), dictionary_.exit_subset.relative_directions)},
+      {kNumberSignTag, exit_number_sign},
+      {kBranchSignTag, exit_branch_sign},
+      {kTowardSignTag, exit_toward_sign},
+      {kNameSignTag, exit_name_sign},
+  });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -2178,17 +2186,15 @@ std::string NarrativeBuilder::FormVerbalExitInstruction(uint8_t phrase_id,
                                                         const std::string& exit_name_sign) {
 
   std::string instruction;
-  instruction.reserve(kInstructionInitialCapacity);
 
   // Set instruction to the determined tagged phrase
-  instruction = dictionary_.exit_verbal_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kRelativeDirectionTag, relative_dir);
-  boost::replace_all(instruction, kNumberSignTag, exit_number_sign);
-  boost::replace_all(instruction, kBranchSignTag, exit_branch_sign);
-  boost::replace_all(instruction, kTowardSignTag, exit_toward_sign);
-  boost::replace_all(instruction, kNameSignTag, exit_name_sign);
+  instruction = dictionary_.exit_verbal_subset.at(phrase_id).Format({
+      {kRelativeDirectionTag, relative_dir},
+      {kNumberSignTag, exit_number_sign},
+      {kBranchSignTag, exit_branch_sign},
+      {kTowardSignTag, exit_toward_sign},
+      {kNameSignTag, exit_name_sign},
+  });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -2212,7 +2218,6 @@ std::string NarrativeBuilder::FormKeepInstruction(Maneuver& maneuver,
   // <TOWARD_SIGN>."
 
   std::string instruction;
-  instruction.reserve(kInstructionInitialCapacity);
 
   std::string street_names;
   std::string exit_number_sign;
@@ -2270,15 +2275,13 @@ std::string NarrativeBuilder::FormKeepInstruction(Maneuver& maneuver,
   }
 
   // Set instruction to the determined tagged phrase
-  instruction = dictionary_.keep_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kRelativeDirectionTag,
-                     FormRelativeThreeDirection(maneuver.type(),
-                                                dictionary_.keep_subset.relative_directions));
-  boost::replace_all(instruction, kNumberSignTag, exit_number_sign);
-  boost::replace_all(instruction, kStreetNamesTag, street_names);
-  boost::replace_all(instruction, kTowardSignTag, toward_sign);
+  instruction = dictionary_.keep_subset.at(phrase_id).Format({
+      {kRelativeDirectionTag,
+       FormRelativeThreeDirection(maneuver.type(), dictionary_.keep_subset.relative_directions)},
+      {kNumberSignTag, exit_number_sign},
+      {kStreetNamesTag, street_names},
+      {kTowardSignTag, toward_sign},
+  });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -2458,16 +2461,14 @@ std::string NarrativeBuilder::FormVerbalKeepInstruction(uint8_t phrase_id,
                                                         const std::string& toward_sign) {
 
   std::string instruction;
-  instruction.reserve(kInstructionInitialCapacity);
 
   // Set instruction to the determined tagged phrase
-  instruction = dictionary_.keep_verbal_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kRelativeDirectionTag, relative_dir);
-  boost::replace_all(instruction, kNumberSignTag, exit_number_sign);
-  boost::replace_all(instruction, kStreetNamesTag, street_names);
-  boost::replace_all(instruction, kTowardSignTag, toward_sign);
+  instruction = dictionary_.keep_verbal_subset.at(phrase_id).Format({
+      {kRelativeDirectionTag, relative_dir},
+      {kNumberSignTag, exit_number_sign},
+      {kStreetNamesTag, street_names},
+      {kTowardSignTag, toward_sign},
+  });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -2488,7 +2489,6 @@ std::string NarrativeBuilder::FormKeepToStayOnInstruction(Maneuver& maneuver,
   //      <TOWARD_SIGN>."
 
   std::string instruction;
-  instruction.reserve(kInstructionInitialCapacity);
 
   // Assign the street names
   std::string street_names =
@@ -2520,15 +2520,14 @@ std::string NarrativeBuilder::FormKeepToStayOnInstruction(Maneuver& maneuver,
   }
 
   // Set instruction to the determined tagged phrase
-  instruction = dictionary_.keep_to_stay_on_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kRelativeDirectionTag,
-                     FormRelativeThreeDirection(maneuver.type(), dictionary_.keep_to_stay_on_subset
-                                                                     .relative_directions));
-  boost::replace_all(instruction, kStreetNamesTag, street_names);
-  boost::replace_all(instruction, kNumberSignTag, exit_number_sign);
-  boost::replace_all(instruction, kTowardSignTag, toward_sign);
+  instruction = dictionary_.keep_to_stay_on_subset.at(phrase_id).Format({
+      {kRelativeDirectionTag,
+       FormRelativeThreeDirection(maneuver.type(),
+                                  dictionary_.keep_to_stay_on_subset.relative_directions)},
+      {kStreetNamesTag, street_names},
+      {kNumberSignTag, exit_number_sign},
+      {kTowardSignTag, toward_sign},
+  });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -2616,16 +2615,14 @@ std::string NarrativeBuilder::FormVerbalKeepToStayOnInstruction(uint8_t phrase_i
                                                                 const std::string& toward_sign) {
 
   std::string instruction;
-  instruction.reserve(kInstructionInitialCapacity);
 
   // Set instruction to the determined tagged phrase
-  instruction = dictionary_.keep_to_stay_on_verbal_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kRelativeDirectionTag, relative_dir);
-  boost::replace_all(instruction, kStreetNamesTag, street_names);
-  boost::replace_all(instruction, kNumberSignTag, exit_number_sign);
-  boost::replace_all(instruction, kTowardSignTag, toward_sign);
+  instruction = dictionary_.keep_to_stay_on_verbal_subset.at(phrase_id).Format({
+      {kRelativeDirectionTag, relative_dir},
+      {kStreetNamesTag, street_names},
+      {kNumberSignTag, exit_number_sign},
+      {kTowardSignTag, toward_sign},
+  });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -2646,7 +2643,6 @@ std::string NarrativeBuilder::FormMergeInstruction(Maneuver& maneuver,
   // "5": "Merge <RELATIVE_DIRECTION> toward <TOWARD_SIGN>."
 
   std::string instruction;
-  instruction.reserve(kInstructionInitialCapacity);
 
   // Assign the street names
   std::string street_names =
@@ -2677,12 +2673,11 @@ std::string NarrativeBuilder::FormMergeInstruction(Maneuver& maneuver,
   }
 
   // Set instruction to the determined tagged phrase
-  instruction = dictionary_.merge_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kRelativeDirectionTag, relative_direction);
-  boost::replace_all(instruction, kStreetNamesTag, street_names);
-  boost::replace_all(instruction, kTowardSignTag, guide_sign);
+  instruction = dictionary_.merge_subset.at(phrase_id).Format({
+      {kRelativeDirectionTag, relative_direction},
+      {kStreetNamesTag, street_names},
+      {kTowardSignTag, guide_sign},
+  });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -2718,7 +2713,6 @@ std::string NarrativeBuilder::FormVerbalMergeInstruction(Maneuver& maneuver,
   // "5": "Merge <RELATIVE_DIRECTION> toward <TOWARD_SIGN>."
 
   std::string instruction;
-  instruction.reserve(kInstructionInitialCapacity);
 
   // Assign the street names
   std::string street_names =
@@ -2752,12 +2746,11 @@ std::string NarrativeBuilder::FormVerbalMergeInstruction(Maneuver& maneuver,
   }
 
   // Set instruction to the determined tagged phrase
-  instruction = dictionary_.merge_verbal_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kRelativeDirectionTag, relative_direction);
-  boost::replace_all(instruction, kStreetNamesTag, street_names);
-  boost::replace_all(instruction, kTowardSignTag, guide_sign);
+  instruction = dictionary_.merge_verbal_subset.at(phrase_id).Format({
+      {kRelativeDirectionTag, relative_direction},
+      {kStreetNamesTag, street_names},
+      {kTowardSignTag, guide_sign},
+  });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -2798,7 +2791,6 @@ std::string NarrativeBuilder::FormEnterRoundaboutInstruction(Maneuver& maneuver,
   // "15": "Enter <STREET_NAMES> and take the exit toward <TOWARD_SIGN>.";
 
   std::string instruction;
-  instruction.reserve(kInstructionInitialCapacity);
 
   // Assign the street names
   std::string street_names = FormStreetNames(maneuver, maneuver.street_names());
@@ -2875,15 +2867,13 @@ std::string NarrativeBuilder::FormEnterRoundaboutInstruction(Maneuver& maneuver,
   }
 
   // Set instruction to the determined tagged phrase
-  instruction = dictionary_.enter_roundabout_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kOrdinalValueTag, ordinal_value);
-  boost::replace_all(instruction, kStreetNamesTag, street_names);
-  boost::replace_all(instruction, kTowardSignTag, guide_sign);
-  boost::replace_all(instruction, kRoundaboutExitStreetNamesTag, roundabout_exit_street_names);
-  boost::replace_all(instruction, kRoundaboutExitBeginStreetNamesTag,
-                     roundabout_exit_begin_street_names);
+  instruction = dictionary_.enter_roundabout_subset.at(phrase_id).Format({
+      {kOrdinalValueTag, ordinal_value},
+      {kStreetNamesTag, street_names},
+      {kTowardSignTag, guide_sign},
+      {kRoundaboutExitStreetNamesTag, roundabout_exit_street_names},
+      {kRoundaboutExitBeginStreetNamesTag, roundabout_exit_begin_street_names},
+  });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -2953,7 +2943,6 @@ std::string NarrativeBuilder::FormVerbalEnterRoundaboutInstruction(Maneuver& man
   // "15": "Enter <STREET_NAMES> and take the exit toward <TOWARD_SIGN>.";
 
   std::string instruction;
-  instruction.reserve(kInstructionInitialCapacity);
 
   // Assign the street names
   std::string street_names =
@@ -3027,15 +3016,13 @@ std::string NarrativeBuilder::FormVerbalEnterRoundaboutInstruction(Maneuver& man
   }
 
   // Set instruction to the determined tagged phrase
-  instruction = dictionary_.enter_roundabout_verbal_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kOrdinalValueTag, ordinal_value);
-  boost::replace_all(instruction, kStreetNamesTag, street_names);
-  boost::replace_all(instruction, kTowardSignTag, guide_sign);
-  boost::replace_all(instruction, kRoundaboutExitStreetNamesTag, roundabout_exit_street_names);
-  boost::replace_all(instruction, kRoundaboutExitBeginStreetNamesTag,
-                     roundabout_exit_begin_street_names);
+  instruction = dictionary_.enter_roundabout_verbal_subset.at(phrase_id).Format({
+      {kOrdinalValueTag, ordinal_value},
+      {kStreetNamesTag, street_names},
+      {kTowardSignTag, guide_sign},
+      {kRoundaboutExitStreetNamesTag, roundabout_exit_street_names},
+      {kRoundaboutExitBeginStreetNamesTag, roundabout_exit_begin_street_names},
+  });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -3054,7 +3041,6 @@ std::string NarrativeBuilder::FormExitRoundaboutInstruction(Maneuver& maneuver,
   // "3": "Exit the roundabout toward <TOWARD_SIGN>."
 
   std::string instruction;
-  instruction.reserve(kInstructionInitialCapacity);
 
   // Assign the street names
   std::string street_names =
@@ -3090,12 +3076,11 @@ std::string NarrativeBuilder::FormExitRoundaboutInstruction(Maneuver& maneuver,
   }
 
   // Set instruction to the determined tagged phrase
-  instruction = dictionary_.exit_roundabout_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kStreetNamesTag, street_names);
-  boost::replace_all(instruction, kBeginStreetNamesTag, begin_street_names);
-  boost::replace_all(instruction, kTowardSignTag, guide_sign);
+  instruction = dictionary_.exit_roundabout_subset.at(phrase_id).Format({
+      {kStreetNamesTag, street_names},
+      {kBeginStreetNamesTag, begin_street_names},
+      {kTowardSignTag, guide_sign},
+  });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -3115,7 +3100,6 @@ std::string NarrativeBuilder::FormVerbalExitRoundaboutInstruction(Maneuver& mane
   // "3": "Exit the roundabout toward <TOWARD_SIGN>."
 
   std::string instruction;
-  instruction.reserve(kInstructionInitialCapacity);
 
   // Assign the street names
   std::string street_names =
@@ -3154,12 +3138,11 @@ std::string NarrativeBuilder::FormVerbalExitRoundaboutInstruction(Maneuver& mane
   }
 
   // Set instruction to the determined tagged phrase
-  instruction = dictionary_.exit_roundabout_verbal_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kStreetNamesTag, street_names);
-  boost::replace_all(instruction, kBeginStreetNamesTag, begin_street_names);
-  boost::replace_all(instruction, kTowardSignTag, guide_sign);
+  instruction = dictionary_.exit_roundabout_verbal_subset.at(phrase_id).Format({
+      {kStreetNamesTag, street_names},
+      {kBeginStreetNamesTag, begin_street_names},
+      {kTowardSignTag, guide_sign},
+  });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -3178,7 +3161,6 @@ std::string NarrativeBuilder::FormEnterFerryInstruction(Maneuver& maneuver,
   // "3": "Take the ferry toward <TOWARD_SIGN>."
 
   std::string instruction;
-  instruction.reserve(kInstructionInitialCapacity);
 
   // Assign the street names
   std::string street_names =
@@ -3204,12 +3186,11 @@ std::string NarrativeBuilder::FormEnterFerryInstruction(Maneuver& maneuver,
   }
 
   // Set instruction to the determined tagged phrase
-  instruction = dictionary_.enter_ferry_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kStreetNamesTag, street_names);
-  boost::replace_all(instruction, kFerryLabelTag, ferry_label);
-  boost::replace_all(instruction, kTowardSignTag, guide_sign);
+  instruction = dictionary_.enter_ferry_subset.at(phrase_id).Format({
+      {kStreetNamesTag, street_names},
+      {kFerryLabelTag, ferry_label},
+      {kTowardSignTag, guide_sign},
+  });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -3242,7 +3223,6 @@ std::string NarrativeBuilder::FormVerbalEnterFerryInstruction(Maneuver& maneuver
   // "3": "Take the ferry toward <TOWARD_SIGN>."
 
   std::string instruction;
-  instruction.reserve(kInstructionInitialCapacity);
 
   // Assign the street names
   std::string street_names =
@@ -3271,12 +3251,11 @@ std::string NarrativeBuilder::FormVerbalEnterFerryInstruction(Maneuver& maneuver
   }
 
   // Set instruction to the determined tagged phrase
-  instruction = dictionary_.enter_ferry_verbal_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kStreetNamesTag, street_names);
-  boost::replace_all(instruction, kFerryLabelTag, ferry_label);
-  boost::replace_all(instruction, kTowardSignTag, guide_sign);
+  instruction = dictionary_.enter_ferry_verbal_subset.at(phrase_id).Format({
+      {kStreetNamesTag, street_names},
+      {kFerryLabelTag, ferry_label},
+      {kTowardSignTag, guide_sign},
+  });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -3292,7 +3271,6 @@ std::string NarrativeBuilder::FormTransitConnectionStartInstruction(Maneuver& ma
   // "2": "Enter the <TRANSIT_STOP> <STATION_LABEL>."
 
   std::string instruction;
-  instruction.reserve(kInstructionInitialCapacity);
 
   // Assign transit stop
   std::string transit_stop = maneuver.transit_connection_platform_info().name();
@@ -3310,11 +3288,10 @@ std::string NarrativeBuilder::FormTransitConnectionStartInstruction(Maneuver& ma
   }
 
   // Set instruction to the determined tagged phrase
-  instruction = dictionary_.transit_connection_start_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kTransitPlatformTag, transit_stop);
-  boost::replace_all(instruction, kStationLabelTag, station_label);
+  instruction = dictionary_.transit_connection_start_subset.at(phrase_id).Format({
+      {kTransitPlatformTag, transit_stop},
+      {kStationLabelTag, station_label},
+  });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -3330,7 +3307,6 @@ std::string NarrativeBuilder::FormVerbalTransitConnectionStartInstruction(Maneuv
   // "2": "Enter the <TRANSIT_STOP> <STATION_LABEL>."
 
   std::string instruction;
-  instruction.reserve(kInstructionInitialCapacity);
 
   // Assign transit stop
   std::string transit_stop = maneuver.transit_connection_platform_info().name();
@@ -3348,12 +3324,10 @@ std::string NarrativeBuilder::FormVerbalTransitConnectionStartInstruction(Maneuv
   }
 
   // Set instruction to the determined tagged phrase
-  instruction =
-      dictionary_.transit_connection_start_verbal_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kTransitPlatformTag, transit_stop);
-  boost::replace_all(instruction, kStationLabelTag, station_label);
+  instruction = dictionary_.transit_connection_start_verbal_subset.at(phrase_id).Format({
+      {kTransitPlatformTag, transit_stop},
+      {kStationLabelTag, station_label},
+  });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -3369,7 +3343,6 @@ std::string NarrativeBuilder::FormTransitConnectionTransferInstruction(Maneuver&
   // "2": "Transfer at the <TRANSIT_STOP> <STATION_LABEL>."
 
   std::string instruction;
-  instruction.reserve(kInstructionInitialCapacity);
 
   // Assign transit stop
   std::string transit_stop = maneuver.transit_connection_platform_info().name();
@@ -3387,11 +3360,10 @@ std::string NarrativeBuilder::FormTransitConnectionTransferInstruction(Maneuver&
   }
 
   // Set instruction to the determined tagged phrase
-  instruction = dictionary_.transit_connection_transfer_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kTransitPlatformTag, transit_stop);
-  boost::replace_all(instruction, kStationLabelTag, station_label);
+  instruction = dictionary_.transit_connection_transfer_subset.at(phrase_id).Format({
+      {kTransitPlatformTag, transit_stop},
+      {kStationLabelTag, station_label},
+  });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -3407,7 +3379,6 @@ std::string NarrativeBuilder::FormVerbalTransitConnectionTransferInstruction(Man
   // "2": "Transfer at the <TRANSIT_STOP> <STATION_LABEL>."
 
   std::string instruction;
-  instruction.reserve(kInstructionInitialCapacity);
 
   // Assign transit stop
   std::string transit_stop = maneuver.transit_connection_platform_info().name();
@@ -3425,12 +3396,10 @@ std::string NarrativeBuilder::FormVerbalTransitConnectionTransferInstruction(Man
   }
 
   // Set instruction to the determined tagged phrase
-  instruction =
-      dictionary_.transit_connection_transfer_verbal_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kTransitPlatformTag, transit_stop);
-  boost::replace_all(instruction, kStationLabelTag, station_label);
+  instruction = dictionary_.transit_connection_transfer_verbal_subset.at(phrase_id).Format({
+      {kTransitPlatformTag, transit_stop},
+      {kStationLabelTag, station_label},
+  });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -3446,7 +3415,6 @@ std::string NarrativeBuilder::FormTransitConnectionDestinationInstruction(Maneuv
   // "2": "Exit the <TRANSIT_STOP> <STATION_LABEL>."
 
   std::string instruction;
-  instruction.reserve(kInstructionInitialCapacity);
 
   // Assign transit stop
   std::string transit_stop = maneuver.transit_connection_platform_info().name();
@@ -3464,12 +3432,10 @@ std::string NarrativeBuilder::FormTransitConnectionDestinationInstruction(Maneuv
   }
 
   // Set instruction to the determined tagged phrase
-  instruction =
-      dictionary_.transit_connection_destination_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kTransitPlatformTag, transit_stop);
-  boost::replace_all(instruction, kStationLabelTag, station_label);
+  instruction = dictionary_.transit_connection_destination_subset.at(phrase_id).Format({
+      {kTransitPlatformTag, transit_stop},
+      {kStationLabelTag, station_label},
+  });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -3485,7 +3451,6 @@ std::string NarrativeBuilder::FormVerbalTransitConnectionDestinationInstruction(
   // "2": "Exit the <TRANSIT_STOP> <STATION_LABEL>."
 
   std::string instruction;
-  instruction.reserve(kInstructionInitialCapacity);
 
   // Assign transit stop
   std::string transit_stop = maneuver.transit_connection_platform_info().name();
@@ -3503,12 +3468,10 @@ std::string NarrativeBuilder::FormVerbalTransitConnectionDestinationInstruction(
   }
 
   // Set instruction to the determined tagged phrase
-  instruction =
-      dictionary_.transit_connection_destination_verbal_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kTransitPlatformTag, transit_stop);
-  boost::replace_all(instruction, kStationLabelTag, station_label);
+  instruction = dictionary_.transit_connection_destination_verbal_subset.at(phrase_id).Format({
+      {kTransitPlatformTag, transit_stop},
+      {kStationLabelTag, station_label},
+  });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -3523,7 +3486,6 @@ std::string NarrativeBuilder::FormDepartInstruction(Maneuver& maneuver) {
   // "1": "Depart: <TIME> from <TRANSIT_STOP>"
 
   std::string instruction;
-  instruction.reserve(kInstructionInitialCapacity);
   uint8_t phrase_id = 0;
   std::string transit_stop_name = maneuver.GetTransitStops().front().name();
 
@@ -3532,12 +3494,10 @@ std::string NarrativeBuilder::FormDepartInstruction(Maneuver& maneuver) {
   }
 
   // Set instruction to the determined tagged phrase
-  instruction = dictionary_.depart_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kTransitPlatformTag, transit_stop_name);
-  boost::replace_all(instruction, kTimeTag,
-                     get_localized_time(maneuver.GetTransitDepartureTime(), dictionary_.GetLocale()));
+  instruction = dictionary_.depart_subset.at(phrase_id).Format({
+      {kTransitPlatformTag, transit_stop_name},
+      {kTimeTag, get_localized_time(maneuver.GetTransitDepartureTime(), dictionary_.GetLocale())},
+  });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -3552,7 +3512,6 @@ std::string NarrativeBuilder::FormVerbalDepartInstruction(Maneuver& maneuver) {
   // "1": "Depart at <TIME> from <TRANSIT_STOP>"
 
   std::string instruction;
-  instruction.reserve(kInstructionInitialCapacity);
   uint8_t phrase_id = 0;
   std::string transit_stop_name = maneuver.GetTransitStops().front().name();
 
@@ -3561,12 +3520,10 @@ std::string NarrativeBuilder::FormVerbalDepartInstruction(Maneuver& maneuver) {
   }
 
   // Set instruction to the determined tagged phrase
-  instruction = dictionary_.depart_verbal_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kTransitPlatformTag, transit_stop_name);
-  boost::replace_all(instruction, kTimeTag,
-                     get_localized_time(maneuver.GetTransitDepartureTime(), dictionary_.GetLocale()));
+  instruction = dictionary_.depart_verbal_subset.at(phrase_id).Format({
+      {kTransitPlatformTag, transit_stop_name},
+      {kTimeTag, get_localized_time(maneuver.GetTransitDepartureTime(), dictionary_.GetLocale())},
+  });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -3581,7 +3538,6 @@ std::string NarrativeBuilder::FormArriveInstruction(Maneuver& maneuver) {
   // "1": "Arrive: <TIME> at <TRANSIT_STOP>"
 
   std::string instruction;
-  instruction.reserve(kInstructionInitialCapacity);
   uint8_t phrase_id = 0;
   std::string transit_stop_name = maneuver.GetTransitStops().back().name();
 
@@ -3590,12 +3546,10 @@ std::string NarrativeBuilder::FormArriveInstruction(Maneuver& maneuver) {
   }
 
   // Set instruction to the determined tagged phrase
-  instruction = dictionary_.arrive_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kTransitPlatformTag, transit_stop_name);
-  boost::replace_all(instruction, kTimeTag,
-                     get_localized_time(maneuver.GetTransitArrivalTime(), dictionary_.GetLocale()));
+  instruction = dictionary_.arrive_subset.at(phrase_id).Format({
+      {kTransitPlatformTag, transit_stop_name},
+      {kTimeTag, get_localized_time(maneuver.GetTransitArrivalTime(), dictionary_.GetLocale())},
+  });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -3610,7 +3564,6 @@ std::string NarrativeBuilder::FormVerbalArriveInstruction(Maneuver& maneuver) {
   // "1": "Arrive at <TIME> at <TRANSIT_STOP>"
 
   std::string instruction;
-  instruction.reserve(kInstructionInitialCapacity);
   uint8_t phrase_id = 0;
   std::string transit_stop_name = maneuver.GetTransitStops().back().name();
 
@@ -3619,12 +3572,10 @@ std::string NarrativeBuilder::FormVerbalArriveInstruction(Maneuver& maneuver) {
   }
 
   // Set instruction to the determined tagged phrase
-  instruction = dictionary_.arrive_verbal_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kTransitPlatformTag, transit_stop_name);
-  boost::replace_all(instruction, kTimeTag,
-                     get_localized_time(maneuver.GetTransitArrivalTime(), dictionary_.GetLocale()));
+  instruction = dictionary_.arrive_verbal_subset.at(phrase_id).Format({
+      {kTransitPlatformTag, transit_stop_name},
+      {kTimeTag, get_localized_time(maneuver.GetTransitArrivalTime(), dictionary_.GetLocale())},
+  });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -3640,7 +3591,6 @@ std::string NarrativeBuilder::FormTransitInstruction(Maneuver& maneuver) {
   // <TRANSIT_STOP_COUNT_LABEL>)"
 
   std::string instruction;
-  instruction.reserve(kInstructionInitialCapacity);
   uint8_t phrase_id = 0;
   std::string transit_headsign = maneuver.transit_info().headsign;
   auto stop_count = maneuver.GetTransitStopCount();
@@ -3652,15 +3602,13 @@ std::string NarrativeBuilder::FormTransitInstruction(Maneuver& maneuver) {
   }
 
   // Set instruction to the determined tagged phrase
-  instruction = dictionary_.transit_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kTransitNameTag,
-                     FormTransitName(maneuver, dictionary_.transit_subset.empty_transit_name_labels));
-  boost::replace_all(instruction, kTransitHeadSignTag, transit_headsign);
-  boost::replace_all(instruction, kTransitPlatformCountTag,
-                     std::to_string(stop_count)); // TODO: locale specific numerals
-  boost::replace_all(instruction, kTransitPlatformCountLabelTag, stop_count_label);
+  instruction = dictionary_.transit_subset.at(phrase_id).Format({
+      {kTransitNameTag, FormTransitName(maneuver,
+                                        dictionary_.transit_subset.empty_transit_name_labels)},
+      {kTransitHeadSignTag, transit_headsign},
+      {kTransitPlatformCountTag, std::to_string(stop_count)}, // TODO: locale specific numerals
+      {kTransitPlatformCountLabelTag, stop_count_label},
+  });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -3675,7 +3623,6 @@ std::string NarrativeBuilder::FormVerbalTransitInstruction(Maneuver& maneuver) {
   // "1": "Take the <TRANSIT_NAME> toward <TRANSIT_HEADSIGN>."
 
   std::string instruction;
-  instruction.reserve(kInstructionInitialCapacity);
   uint8_t phrase_id = 0;
   std::string transit_headsign = maneuver.transit_info().headsign;
 
@@ -3684,13 +3631,11 @@ std::string NarrativeBuilder::FormVerbalTransitInstruction(Maneuver& maneuver) {
   }
 
   // Set instruction to the determined tagged phrase
-  instruction = dictionary_.transit_verbal_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kTransitNameTag,
-                     FormTransitName(maneuver,
-                                     dictionary_.transit_verbal_subset.empty_transit_name_labels));
-  boost::replace_all(instruction, kTransitHeadSignTag, transit_headsign);
+  instruction = dictionary_.transit_verbal_subset.at(phrase_id).Format({
+      {kTransitNameTag,
+       FormTransitName(maneuver, dictionary_.transit_verbal_subset.empty_transit_name_labels)},
+      {kTransitHeadSignTag, transit_headsign},
+  });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -3706,7 +3651,6 @@ std::string NarrativeBuilder::FormTransitRemainOnInstruction(Maneuver& maneuver)
   // <TRANSIT_STOP_COUNT_LABEL>)"
 
   std::string instruction;
-  instruction.reserve(kInstructionInitialCapacity);
   uint8_t phrase_id = 0;
   std::string transit_headsign = maneuver.transit_info().headsign;
   auto stop_count = maneuver.GetTransitStopCount();
@@ -3719,16 +3663,13 @@ std::string NarrativeBuilder::FormTransitRemainOnInstruction(Maneuver& maneuver)
   }
 
   // Set instruction to the determined tagged phrase
-  instruction = dictionary_.transit_remain_on_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kTransitNameTag,
-                     FormTransitName(maneuver,
-                                     dictionary_.transit_remain_on_subset.empty_transit_name_labels));
-  boost::replace_all(instruction, kTransitHeadSignTag, transit_headsign);
-  boost::replace_all(instruction, kTransitPlatformCountTag,
-                     std::to_string(stop_count)); // TODO: locale specific numerals
-  boost::replace_all(instruction, kTransitPlatformCountLabelTag, stop_count_label);
+  instruction = dictionary_.transit_remain_on_subset.at(phrase_id).Format({
+      {kTransitNameTag,
+       FormTransitName(maneuver, dictionary_.transit_remain_on_subset.empty_transit_name_labels)},
+      {kTransitHeadSignTag, transit_headsign},
+      {kTransitPlatformCountTag, std::to_string(stop_count)}, // TODO: locale specific numerals
+      {kTransitPlatformCountLabelTag, stop_count_label},
+  });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -3743,7 +3684,6 @@ std::string NarrativeBuilder::FormVerbalTransitRemainOnInstruction(Maneuver& man
   // "1": "Remain on the <TRANSIT_NAME> toward <TRANSIT_HEADSIGN>."
 
   std::string instruction;
-  instruction.reserve(kInstructionInitialCapacity);
   uint8_t phrase_id = 0;
   std::string transit_headsign = maneuver.transit_info().headsign;
 
@@ -3752,13 +3692,12 @@ std::string NarrativeBuilder::FormVerbalTransitRemainOnInstruction(Maneuver& man
   }
 
   // Set instruction to the determined tagged phrase
-  instruction = dictionary_.transit_remain_on_verbal_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kTransitNameTag,
-                     FormTransitName(maneuver, dictionary_.transit_remain_on_verbal_subset
-                                                   .empty_transit_name_labels));
-  boost::replace_all(instruction, kTransitHeadSignTag, transit_headsign);
+  instruction = dictionary_.transit_remain_on_verbal_subset.at(phrase_id).Format({
+      {kTransitNameTag,
+       FormTransitName(maneuver,
+                       dictionary_.transit_remain_on_verbal_subset.empty_transit_name_labels)},
+      {kTransitHeadSignTag, transit_headsign},
+  });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -3774,7 +3713,6 @@ std::string NarrativeBuilder::FormTransitTransferInstruction(Maneuver& maneuver)
   // <TRANSIT_HEADSIGN>. (<TRANSIT_STOP_COUNT> <TRANSIT_STOP_COUNT_LABEL>)"
 
   std::string instruction;
-  instruction.reserve(kInstructionInitialCapacity);
   uint8_t phrase_id = 0;
   std::string transit_headsign = maneuver.transit_info().headsign;
   auto stop_count = maneuver.GetTransitStopCount();
@@ -3787,16 +3725,13 @@ std::string NarrativeBuilder::FormTransitTransferInstruction(Maneuver& maneuver)
   }
 
   // Set instruction to the determined tagged phrase
-  instruction = dictionary_.transit_transfer_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kTransitNameTag,
-                     FormTransitName(maneuver,
-                                     dictionary_.transit_transfer_subset.empty_transit_name_labels));
-  boost::replace_all(instruction, kTransitHeadSignTag, transit_headsign);
-  boost::replace_all(instruction, kTransitPlatformCountTag,
-                     std::to_string(stop_count)); // TODO: locale specific numerals
-  boost::replace_all(instruction, kTransitPlatformCountLabelTag, stop_count_label);
+  instruction = dictionary_.transit_transfer_subset.at(phrase_id).Format({
+      {kTransitNameTag,
+       FormTransitName(maneuver, dictionary_.transit_transfer_subset.empty_transit_name_labels)},
+      {kTransitHeadSignTag, transit_headsign},
+      {kTransitPlatformCountTag, std::to_string(stop_count)}, // TODO: locale specific numerals
+      {kTransitPlatformCountLabelTag, stop_count_label},
+  });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -3811,7 +3746,6 @@ std::string NarrativeBuilder::FormVerbalTransitTransferInstruction(Maneuver& man
   // "1": "Transfer to take the <TRANSIT_NAME> toward <TRANSIT_HEADSIGN>."
 
   std::string instruction;
-  instruction.reserve(kInstructionInitialCapacity);
   uint8_t phrase_id = 0;
   std::string transit_headsign = maneuver.transit_info().headsign;
 
@@ -3820,13 +3754,12 @@ std::string NarrativeBuilder::FormVerbalTransitTransferInstruction(Maneuver& man
   }
 
   // Set instruction to the determined tagged phrase
-  instruction = dictionary_.transit_transfer_verbal_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kTransitNameTag,
-                     FormTransitName(maneuver, dictionary_.transit_transfer_verbal_subset
-                                                   .empty_transit_name_labels));
-  boost::replace_all(instruction, kTransitHeadSignTag, transit_headsign);
+  instruction = dictionary_.transit_transfer_verbal_subset.at(phrase_id).Format({
+      {kTransitNameTag,
+       FormTransitName(maneuver,
+                       dictionary_.transit_transfer_verbal_subset.empty_transit_name_labels)},
+      {kTransitHeadSignTag, transit_headsign},
+  });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -3844,7 +3777,6 @@ std::string NarrativeBuilder::FormVerbalPostTransitionInstruction(Maneuver& mane
   // "1": "Continue on <STREET_NAMES> for <LENGTH>."
 
   std::string instruction;
-  instruction.reserve(kInstructionInitialCapacity);
 
   // Assign the street names if maneuver does not contain an obvious maneuver
   std::string street_names;
@@ -3868,13 +3800,11 @@ std::string NarrativeBuilder::FormVerbalPostTransitionInstruction(Maneuver& mane
   }
 
   // Set instruction to the determined tagged phrase
-  instruction = dictionary_.post_transition_verbal_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kLengthTag,
-                     FormLength(maneuver, dictionary_.post_transition_verbal_subset.metric_lengths,
-                                dictionary_.post_transition_verbal_subset.us_customary_lengths));
-  boost::replace_all(instruction, kStreetNamesTag, street_names);
+  instruction = dictionary_.post_transition_verbal_subset.at(phrase_id).Format({
+      {kLengthTag, FormLength(maneuver, dictionary_.post_transition_verbal_subset.metric_lengths,
+                              dictionary_.post_transition_verbal_subset.us_customary_lengths)},
+      {kStreetNamesTag, street_names},
+  });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -3888,7 +3818,6 @@ std::string NarrativeBuilder::FormVerbalPostTransitionTransitInstruction(Maneuve
   // "0": "Travel <TRANSIT_STOP_COUNT> <TRANSIT_STOP_COUNT_LABEL>."
 
   std::string instruction;
-  instruction.reserve(kInstructionInitialCapacity);
   uint8_t phrase_id = 0;
   auto stop_count = maneuver.GetTransitStopCount();
   auto stop_count_label =
@@ -3896,13 +3825,10 @@ std::string NarrativeBuilder::FormVerbalPostTransitionTransitInstruction(Maneuve
                                                     .transit_stop_count_labels);
 
   // Set instruction to the determined tagged phrase
-  instruction =
-      dictionary_.post_transition_transit_verbal_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kTransitPlatformCountTag,
-                     std::to_string(stop_count)); // TODO: locale specific numerals
-  boost::replace_all(instruction, kTransitPlatformCountLabelTag, stop_count_label);
+  instruction = dictionary_.post_transition_transit_verbal_subset.at(phrase_id).Format({
+      {kTransitPlatformCountTag, std::to_string(stop_count)}, // TODO: locale specific numerals
+      {kTransitPlatformCountLabelTag, stop_count_label},
+  });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -3923,7 +3849,6 @@ std::string NarrativeBuilder::FormVerbalSuccinctStartTransitionInstruction(Maneu
   // "16": "Bike <CARDINAL_DIRECTION> for <LENGTH>.",
 
   std::string instruction;
-  instruction.reserve(kInstructionInitialCapacity);
 
   // Set cardinal_direction value
   std::string cardinal_direction =
@@ -3947,13 +3872,11 @@ std::string NarrativeBuilder::FormVerbalSuccinctStartTransitionInstruction(Maneu
   }
 
   // Set instruction to the determined tagged phrase
-  instruction = dictionary_.start_verbal_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kCardinalDirectionTag, cardinal_direction);
-  boost::replace_all(instruction, kLengthTag,
-                     FormLength(maneuver, dictionary_.start_verbal_subset.metric_lengths,
-                                dictionary_.start_verbal_subset.us_customary_lengths));
+  instruction = dictionary_.start_verbal_subset.at(phrase_id).Format({
+      {kCardinalDirectionTag, cardinal_direction},
+      {kLengthTag, FormLength(maneuver, dictionary_.start_verbal_subset.metric_lengths,
+                              dictionary_.start_verbal_subset.us_customary_lengths)},
+  });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -3992,7 +3915,6 @@ NarrativeBuilder::FormVerbalSuccinctTurnTransitionInstruction(Maneuver& maneuver
   }
 
   std::string instruction;
-  instruction.reserve(kInstructionInitialCapacity);
   uint8_t phrase_id = 0;
   std::string junction_name;
   std::string guide_sign;
@@ -4013,13 +3935,12 @@ NarrativeBuilder::FormVerbalSuccinctTurnTransitionInstruction(Maneuver& maneuver
   }
 
   // Set instruction to the determined tagged phrase
-  instruction = subset->phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kRelativeDirectionTag,
-                     FormRelativeTwoDirection(maneuver.type(), subset->relative_directions));
-  boost::replace_all(instruction, kJunctionNameTag, junction_name);
-  boost::replace_all(instruction, kTowardSignTag, guide_sign);
+  instruction = subset->at(phrase_id).Format({
+      {kRelativeDirectionTag, FormRelativeTwoDirection(maneuver.type(),
+                                                       subset->relative_directions)},
+      {kJunctionNameTag, junction_name},
+      {kTowardSignTag, guide_sign},
+  });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -4039,7 +3960,6 @@ NarrativeBuilder::FormVerbalSuccinctUturnTransitionInstruction(Maneuver& maneuve
   // "7": "Make a <RELATIVE_DIRECTION> U-turn toward <TOWARD_SIGN>."
 
   std::string instruction;
-  instruction.reserve(kInstructionInitialCapacity);
   uint8_t phrase_id = 0;
   std::string junction_name;
   std::string guide_sign;
@@ -4059,14 +3979,13 @@ NarrativeBuilder::FormVerbalSuccinctUturnTransitionInstruction(Maneuver& maneuve
                                                maneuver.verbal_formatter(), &markup_formatter_);
   }
   // Set instruction to the determined tagged phrase
-  instruction = dictionary_.uturn_verbal_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kRelativeDirectionTag,
-                     FormRelativeTwoDirection(maneuver.type(),
-                                              dictionary_.uturn_verbal_subset.relative_directions));
-  boost::replace_all(instruction, kJunctionNameTag, junction_name);
-  boost::replace_all(instruction, kTowardSignTag, guide_sign);
+  instruction = dictionary_.uturn_verbal_subset.at(phrase_id).Format({
+      {kRelativeDirectionTag,
+       FormRelativeTwoDirection(maneuver.type(),
+                                dictionary_.uturn_verbal_subset.relative_directions)},
+      {kJunctionNameTag, junction_name},
+      {kTowardSignTag, guide_sign},
+  });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -4086,7 +4005,6 @@ NarrativeBuilder::FormVerbalSuccinctMergeTransitionInstruction(Maneuver& maneuve
   // "5": "Merge <RELATIVE_DIRECTION> toward <TOWARD_SIGN>."
 
   std::string instruction;
-  instruction.reserve(kInstructionInitialCapacity);
 
   // Determine which phrase to use
   uint8_t phrase_id = 0;
@@ -4111,11 +4029,10 @@ NarrativeBuilder::FormVerbalSuccinctMergeTransitionInstruction(Maneuver& maneuve
   }
 
   // Set instruction to the determined tagged phrase
-  instruction = dictionary_.merge_verbal_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kRelativeDirectionTag, relative_direction);
-  boost::replace_all(instruction, kTowardSignTag, guide_sign);
+  instruction = dictionary_.merge_verbal_subset.at(phrase_id).Format({
+      {kRelativeDirectionTag, relative_direction},
+      {kTowardSignTag, guide_sign},
+  });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -4136,7 +4053,6 @@ std::string NarrativeBuilder::FormVerbalSuccinctEnterRoundaboutTransitionInstruc
   // "7": "Enter the roundabout and take the exit toward <TOWARD_SIGN>.",
 
   std::string instruction;
-  instruction.reserve(kInstructionInitialCapacity);
   uint8_t phrase_id = 0;
   std::string guide_sign;
   std::string ordinal_value;
@@ -4159,11 +4075,10 @@ std::string NarrativeBuilder::FormVerbalSuccinctEnterRoundaboutTransitionInstruc
   }
 
   // Set instruction to the determined tagged phrase
-  instruction = dictionary_.enter_roundabout_verbal_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kOrdinalValueTag, ordinal_value);
-  boost::replace_all(instruction, kTowardSignTag, guide_sign);
+  instruction = dictionary_.enter_roundabout_verbal_subset.at(phrase_id).Format({
+      {kOrdinalValueTag, ordinal_value},
+      {kTowardSignTag, guide_sign},
+  });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -4182,7 +4097,6 @@ std::string NarrativeBuilder::FormVerbalSuccinctExitRoundaboutTransitionInstruct
   // "3": "Exit the roundabout toward <TOWARD_SIGN>."
 
   std::string instruction;
-  instruction.reserve(kInstructionInitialCapacity);
   uint8_t phrase_id = 0;
   std::string guide_sign;
 
@@ -4195,9 +4109,9 @@ std::string NarrativeBuilder::FormVerbalSuccinctExitRoundaboutTransitionInstruct
   }
 
   // Set instruction to the determined tagged phrase
-  instruction = dictionary_.exit_roundabout_verbal_subset.phrases.at(std::to_string(phrase_id));
-
-  boost::replace_all(instruction, kTowardSignTag, guide_sign);
+  instruction = dictionary_.exit_roundabout_verbal_subset.at(phrase_id).Format({
+      {kTowardSignTag, guide_sign},
+  });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -4212,7 +4126,6 @@ std::string NarrativeBuilder::FormElevatorInstruction(Maneuver& maneuver) {
   // "1": "Take the elevator to <LEVEL>."
 
   std::string instruction;
-  instruction.reserve(kInstructionInitialCapacity);
 
   // Determine which phrase to use
   uint8_t phrase_id = 0;
@@ -4224,10 +4137,7 @@ std::string NarrativeBuilder::FormElevatorInstruction(Maneuver& maneuver) {
   }
 
   // Set instruction to the determined tagged phrase
-  instruction = dictionary_.elevator_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kLevelTag, end_level);
+  instruction = dictionary_.elevator_subset.at(phrase_id).Format({{kLevelTag, end_level}});
 
   return instruction;
 }
@@ -4237,7 +4147,6 @@ std::string NarrativeBuilder::FormStepsInstruction(Maneuver& maneuver) {
   // "1": "Take the stairs to <LEVEL>."
 
   std::string instruction;
-  instruction.reserve(kInstructionInitialCapacity);
 
   // Determine which phrase to use
   uint8_t phrase_id = 0;
@@ -4249,10 +4158,7 @@ std::string NarrativeBuilder::FormStepsInstruction(Maneuver& maneuver) {
   }
 
   // Set instruction to the determined tagged phrase
-  instruction = dictionary_.steps_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kLevelTag, end_level);
+  instruction = dictionary_.steps_subset.at(phrase_id).Format({{kLevelTag, end_level}});
 
   return instruction;
 }
@@ -4261,7 +4167,6 @@ std::string NarrativeBuilder::FormGenericLevelChangeInstruction(Maneuver& maneuv
   // "0": "Change to <LEVEL>",
 
   std::string instruction;
-  instruction.reserve(kInstructionInitialCapacity);
 
   // Determine which phrase to use
   uint8_t phrase_id = 0;
@@ -4272,10 +4177,7 @@ std::string NarrativeBuilder::FormGenericLevelChangeInstruction(Maneuver& maneuv
   }
 
   // Set instruction to the determined tagged phrase
-  instruction = dictionary_.level_change_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kLevelTag, end_level);
+  instruction = dictionary_.level_change_subset.at(phrase_id).Format({{kLevelTag, end_level}});
 
   return instruction;
 }
@@ -4284,12 +4186,10 @@ std::string NarrativeBuilder::FormParkVehicleInstruction(Maneuver& /*maneuver*/)
   // "0": "Park your vehicle.",
 
   std::string instruction;
-  instruction.reserve(kInstructionInitialCapacity);
 
   // Determine which phrase to use
   uint8_t phrase_id = 0;
-  instruction = dictionary_.park_vehicle_subset.phrases.at(std::to_string(phrase_id));
-
+  instruction = dictionary_.park_vehicle_subset.at(phrase_id).phrase();
   return instruction;
 }
 
@@ -4298,7 +4198,6 @@ std::string NarrativeBuilder::FormEscalatorInstruction(Maneuver& maneuver) {
   // "1": "Take the escalator to <LEVEL>."
 
   std::string instruction;
-  instruction.reserve(kInstructionInitialCapacity);
 
   // Determine which phrase to use
   uint8_t phrase_id = 0;
@@ -4310,10 +4209,7 @@ std::string NarrativeBuilder::FormEscalatorInstruction(Maneuver& maneuver) {
   }
 
   // Set instruction to the determined tagged phrase
-  instruction = dictionary_.escalator_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kLevelTag, end_level);
+  instruction = dictionary_.escalator_subset.at(phrase_id).Format({{kLevelTag, end_level}});
 
   return instruction;
 }
@@ -4323,7 +4219,6 @@ std::string NarrativeBuilder::FormEnterBuildingInstruction(Maneuver& maneuver) {
   // "1": "Enter the building, and continue on <STREET_NAMES>."
 
   std::string instruction;
-  instruction.reserve(kInstructionInitialCapacity);
 
   // Assign the street names
   std::string street_names =
@@ -4337,10 +4232,9 @@ std::string NarrativeBuilder::FormEnterBuildingInstruction(Maneuver& maneuver) {
   }
 
   // Set instruction to the determined tagged phrase
-  instruction = dictionary_.enter_building_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kStreetNamesTag, street_names);
+  instruction = dictionary_.enter_building_subset.at(phrase_id).Format({
+      {kStreetNamesTag, street_names},
+  });
 
   return instruction;
 }
@@ -4350,7 +4244,6 @@ std::string NarrativeBuilder::FormExitBuildingInstruction(Maneuver& maneuver) {
   // "1": "Exit the building, and continue on <STREET_NAMES>."
 
   std::string instruction;
-  instruction.reserve(kInstructionInitialCapacity);
 
   // Assign the street names
   std::string street_names =
@@ -4364,10 +4257,9 @@ std::string NarrativeBuilder::FormExitBuildingInstruction(Maneuver& maneuver) {
   }
 
   // Set instruction to the determined tagged phrase
-  instruction = dictionary_.exit_building_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kStreetNamesTag, street_names);
+  instruction = dictionary_.exit_building_subset.at(phrase_id).Format({
+      {kStreetNamesTag, street_names},
+  });
 
   return instruction;
 }
@@ -4388,7 +4280,6 @@ std::string NarrativeBuilder::FormPassInstruction(Maneuver& maneuver) {
   // "0": "Pass <object>.",
   // "1": "Pass traffic lights on <object>.",
   std::string instruction;
-  instruction.reserve(kInstructionInitialCapacity);
 
   // Determine which phrase to use
   uint8_t phrase_id = 0;
@@ -4417,10 +4308,7 @@ std::string NarrativeBuilder::FormPassInstruction(Maneuver& maneuver) {
   }
 
   // Set instruction to the determined tagged phrase
-  instruction = dictionary_.pass_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kObjectLabelTag, object_label);
+  instruction = dictionary_.pass_subset.at(phrase_id).Format({{kObjectLabelTag, object_label}});
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -4841,21 +4729,18 @@ std::string NarrativeBuilder::FormVerbalMultiCue(Maneuver& maneuver,
   // "1": "<CURRENT_VERBAL_CUE> Then, in <LENGTH>, <NEXT_VERBAL_CUE>"
 
   std::string instruction;
-  instruction.reserve(kInstructionInitialCapacity);
 
   // Set instruction to the proper verbal multi-cue
   uint8_t phrase_id = 0;
   if (maneuver.distant_verbal_multi_cue()) {
     phrase_id = 1;
   }
-  instruction = dictionary_.verbal_multi_cue_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kCurrentVerbalCueTag, first_verbal_cue);
-  boost::replace_all(instruction, kNextVerbalCueTag, second_verbal_cue);
-  boost::replace_all(instruction, kLengthTag,
-                     FormLength(maneuver, dictionary_.post_transition_verbal_subset.metric_lengths,
-                                dictionary_.post_transition_verbal_subset.us_customary_lengths));
+  instruction = dictionary_.verbal_multi_cue_subset.at(phrase_id).Format({
+      {kCurrentVerbalCueTag, first_verbal_cue},
+      {kNextVerbalCueTag, second_verbal_cue},
+      {kLengthTag, FormLength(maneuver, dictionary_.post_transition_verbal_subset.metric_lengths,
+                              dictionary_.post_transition_verbal_subset.us_customary_lengths)},
+  });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
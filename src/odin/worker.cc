@@ -1,10 +1,13 @@
 #include "odin/worker.h"
 #include "midgard/logging.h"
 #include "odin/directionsbuilder.h"
+#include "proto_conversions.h"
 #include "tyr/serializers.h"
 
 #include <boost/property_tree/ptree.hpp>
 
+#include <algorithm>
+#include <chrono>
 #include <functional>
 #include <string>
 
@@ -18,6 +21,10 @@ namespace odin {
 
 odin_worker_t::odin_worker_t(const boost::property_tree::ptree& config)
     : service_worker_t(config), markup_formatter_(config) {
+  const auto concurrency = std::max(1u, config.get<unsigned int>("odin.concurrency", 1));
+  if (concurrency > 1) {
+    directions_threads_ = std::make_unique<DirectionsThreads>(concurrency - 1);
+  }
   // signal that the worker started successfully
   started();
 }
@@ -29,11 +36,23 @@ std::string odin_worker_t::narrate(Api& request) const {
   // time this whole method and save that statistic
   auto _ = measure_scope_time(request);
 
-  // get some annotated directions
+  // get some annotated directions, only as much of them as the response will have
+  const auto content = DirectionsContent::FromOptions(request.options());
+  const auto start = std::chrono::steady_clock::now();
   try {
-    odin::DirectionsBuilder().Build(request, markup_formatter_);
+    odin::DirectionsBuilder().Build(request, markup_formatter_, content, directions_threads_.get());
   } catch (const std::exception& e) { throw valhalla_exception_t{202, e.what()}; }
 
+  // keep track of how long the directions take per level of detail
+  const std::chrono::duration<double, std::milli> elapsed =
+      std::chrono::steady_clock::now() - start;
+  const auto& action = Options_Action_Enum_Name(request.options().action());
+  auto* stat = request.mutable_info()->mutable_statistics()->Add();
+  stat->set_key(action + ".info." + service_name() + ".directions." + std::string(content.level()) +
+                "_ms");
+  stat->set_value(elapsed.count());
+  stat->set_type(timing);
+
   // serialize those to the proper format
   return tyr::serializeDirections(request);
 }
@@ -56,7 +75,8 @@ odin_worker_t::work(const std::list<zmq::message_t>& job,
                     const std::function<void()>& interrupt_function) {
   auto& info = *static_cast<prime_server::http_request_info_t*>(request_info);
   LOG_INFO("Got Odin Request " + std::to_string(info.id));
-  Api request;
+  // the request lives on the arena of the worker until cleanup
+  Api& request = arena.request();
   prime_server::worker_t::result_t result{false, {}, {}};
   try {
     // Set the interrupt function
@@ -3,6 +3,7 @@
 #include "baldr/directededge.h"
 #include "baldr/graphid.h"
 #include "midgard/logging.h"
+#include "midgard/metrics.h"
 #include "sif/edgelabel.h"
 #include "sif/hierarchylimits.h"
 #include "sif/recost.h"
@@ -591,6 +592,7 @@ BidirectionalAStar::GetBestPath(valhalla::Location& origin,
   BDEdgeLabel fwd_pred, rev_pred;
   bool expand_forward = true;
   bool expand_reverse = true;
+  midgard::metrics::local_counter_t settled(midgard::metrics::counter_t::labels_settled);
   while (true) {
     // Allow this process to be aborted
     if (interrupt && (++n % kInterruptIterationsInterval) == 0) {
@@ -610,6 +612,7 @@ BidirectionalAStar::GetBestPath(valhalla::Location& origin,
 
         // Forward path to this edge can't be improved, so we can settle it right now.
         edgestatus_forward_.Update(fwd_pred.edgeid(), EdgeSet::kPermanent);
+        ++settled;
 
         // Terminate if the cost threshold has been exceeded.
         if (fwd_pred.sortcost() + cost_diff_ > cost_threshold_) {
@@ -659,6 +662,7 @@ BidirectionalAStar::GetBestPath(valhalla::Location& origin,
 
         // Reverse path to this edge can't be improved, so we can settle it right now.
         edgestatus_reverse_.Update(rev_pred.edgeid(), EdgeSet::kPermanent);
+        ++settled;
 
         // Terminate if the cost threshold has been exceeded.
         if (rev_pred.sortcost() > cost_threshold_) {
@@ -0,0 +1,50 @@
+#include "thor/budget.h"
+#include "exceptions.h"
+#include "thor/pathalgorithm.h"
+
+#include <boost/property_tree/ptree.hpp>
+
+namespace valhalla {
+namespace thor {
+
+budget_t::budget_t(const boost::property_tree::ptree& config)
+    : max_settled_edges_(config.get<uint64_t>("service_limits.budget.max_settled_edges", 0)),
+      max_tiles_loaded_(config.get<uint64_t>("service_limits.budget.max_tiles_loaded", 0)),
+      max_time_(static_cast<int64_t>(
+          config.get<double>("service_limits.budget.max_seconds", 0) * 1000)),
+      reader_(nullptr), interrupt_(nullptr), settled_edges_(0), tiles_loaded_(0),
+      check_([this]() { check(); }) {
+}
+
+void budget_t::start(const baldr::GraphReader& reader, const std::function<void()>* interrupt) {
+  reader_ = &reader;
+  interrupt_ = interrupt;
+  settled_edges_ = 0;
+  tiles_loaded_ = reader.TilesLoaded();
+  started_ = std::chrono::steady_clock::now();
+}
+
+void budget_t::check() {
+  // the request may have been cancelled or timed out in the meantime
+  if (interrupt_) {
+    (*interrupt_)();
+  }
+
+  // the algorithms call this once they are another interval further
+  settled_edges_ += kInterruptIterationsInterval;
+  if (max_settled_edges_ && settled_edges_ > max_settled_edges_) {
+    throw valhalla_exception_t{447, "settled more than " + std::to_string(max_settled_edges_) +
+                                        " edges"};
+  }
+  if (max_tiles_loaded_ && reader_ && reader_->TilesLoaded() - tiles_loaded_ > max_tiles_loaded_) {
+    throw valhalla_exception_t{447, "loaded more than " + std::to_string(max_tiles_loaded_) +
+                                        " tiles"};
+  }
+  if (max_time_.count() && std::chrono::steady_clock::now() - started_ > max_time_) {
+    throw valhalla_exception_t{447, "took longer than " + std::to_string(max_time_.count()) +
+                                        " milliseconds"};
+  }
+}
+
+} // namespace thor
+} // namespace valhalla
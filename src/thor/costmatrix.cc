@@ -205,6 +205,7 @@ bool CostMatrix::SourceToTarget(Api& request,
   // search from all source locations. Connections between the 2 search
   // spaces is checked during the forward search.
   uint32_t n = 0;
+  // the expansions since the interrupt was last called, each settles an edge at most
   uint32_t interrupt_n = 0;
   while (true) {
     // First iterate over all targets, then over all sources: we only for sure
@@ -214,6 +215,7 @@ bool CostMatrix::SourceToTarget(Api& request,
       if (locs_status_[MATRIX_REV][i].threshold > 0) {
         locs_status_[MATRIX_REV][i].threshold--;
         Expand<MatrixExpansionType::reverse>(i, n, graphreader, request.options());
+        ++interrupt_n;
         // if we exhausted this search
         if (locs_status_[MATRIX_REV][i].threshold == 0) {
           for (uint32_t source = 0; source < locs_count_[MATRIX_FORW]; source++) {
@@ -250,6 +252,7 @@ bool CostMatrix::SourceToTarget(Api& request,
         locs_status_[MATRIX_FORW][i].threshold--;
         Expand<MatrixExpansionType::forward>(i, n, graphreader, request.options(), time_infos[i],
                                              invariant);
+        ++interrupt_n;
         // if we exhausted this search
         if (locs_status_[MATRIX_FORW][i].threshold == 0) {
           for (uint32_t target = 0; target < locs_count_[MATRIX_REV]; target++) {
@@ -292,8 +295,9 @@ bool CostMatrix::SourceToTarget(Api& request,
     if (n >= kMaxMatrixIterations) {
       throw valhalla_exception_t{430};
     }
-    // Allow this process to be aborted
-    if (interrupt_ && (interrupt_n++ % kInterruptIterationsInterval) == 0) {
+    // Allow this process to be aborted, once per so many expansions of all of the searches
+    for (; interrupt_ && interrupt_n >= kInterruptIterationsInterval;
+         interrupt_n -= kInterruptIterationsInterval) {
       (*interrupt_)();
     }
     n++;
@@ -97,13 +97,13 @@ std::string thor_worker_t::matrix(Api& request) {
       check_matrix_time(request, options.prioritize_bidirectional() ? Matrix::CostMatrix
                                                                     : Matrix::TimeDistanceMatrix);
 
-  // allow all algos to be cancelled
+  // allow all algos to be cancelled and keep them within the budget
   for (auto* alg : std::vector<MatrixAlgorithm*>{
            &costmatrix_,
            &time_distance_matrix_,
            &time_distance_bss_matrix_,
        }) {
-    alg->set_interrupt(interrupt);
+    alg->set_interrupt(budget.interrupt());
     alg->set_has_time(has_time);
   }
 
@@ -1,5 +1,6 @@
 #include "baldr/datetime.h"
 #include "midgard/logging.h"
+#include "midgard/metrics.h"
 #include "proto_conversions.h"
 #include "sif/hierarchylimits.h"
 #include "thor/multimodal_astar.h"
@@ -314,6 +315,7 @@ MultimodalAStar::GetBestPath(valhalla::Location& origin,
                    // towards destination
   std::pair<int32_t, float> best_path = std::make_pair(-1, 0.0f);
   size_t n = 0;
+  midgard::metrics::local_counter_t settled(midgard::metrics::counter_t::labels_settled);
   while (true) {
     // Allow this process to be aborted
     if (interrupt && (++n % kInterruptIterationsInterval) == 0) {
@@ -369,6 +371,7 @@ MultimodalAStar::GetBestPath(valhalla::Location& origin,
     if (!pred.origin()) {
       edge_status_[static_cast<size_t>(pred.mode() != start_mode_)].Update(pred.edgeid(),
                                                                            EdgeSet::kPermanent);
+      ++settled;
     }
     if (expansion_callback_) {
       expansion_callback_(graphreader, pred.edgeid(),
@@ -1,5 +1,6 @@
 #include "baldr/attributes_controller.h"
 #include "midgard/logging.h"
+#include "midgard/metrics.h"
 #include "proto/common.pb.h"
 #include "thor/route_matcher.h"
 #include "thor/triplegbuilder.h"
@@ -326,6 +327,7 @@ void thor_worker_t::centroid(Api& request) {
   valhalla::Location destination;
 
   // get all the routes
+  centroid_gen.set_interrupt(budget.interrupt());
   auto paths =
       centroid_gen.Expand(ExpansionType::forward, request, *reader, mode_costing, mode, destination);
 
@@ -378,7 +380,7 @@ thor::PathAlgorithm* thor_worker_t::get_path_algorithm(const std::string& routet
                                                        const valhalla::Location& origin,
                                                        const valhalla::Location& destination,
                                                        Api& request) {
-  // make sure they are all cancelable
+  // make sure they are all cancelable and stay within the budget
   for (auto* alg : std::vector<PathAlgorithm*>{
            &multi_modal_transit,
            &timedep_forward,
@@ -386,7 +388,7 @@ thor::PathAlgorithm* thor_worker_t::get_path_algorithm(const std::string& routet
            &bidir_astar,
            &multimodal_astar,
        }) {
-    alg->set_interrupt(interrupt);
+    alg->set_interrupt(budget.interrupt());
   }
 
   // Have to use multimodal for transit based routing
@@ -453,6 +455,7 @@ std::vector<std::vector<thor::PathInfo>> thor_worker_t::get_path(PathAlgorithm*
                                                                  valhalla::Location& destination,
                                                                  const std::string& costing,
                                                                  Api& request) {
+  midgard::metrics::stage_timer_t timer(midgard::metrics::stage_t::path);
   const Options& options = request.options();
   // Find the path.
   valhalla::sif::cost_ptr_t cost = mode_costing[static_cast<uint32_t>(mode)];
@@ -253,7 +253,7 @@ bool TimeDistanceBSSMatrix::ComputeMatrix(Api& request,
                                   pred.mode());
 
       // Allow this process to be aborted
-      if (interrupt_ && (n++ % kInterruptIterationsInterval) == 0) {
+      if (interrupt_ && (++n % kInterruptIterationsInterval) == 0) {
         (*interrupt_)();
       }
     }
@@ -291,7 +291,7 @@ bool TimeDistanceMatrix::ComputeMatrix(Api& request,
                                   invariant);
 
       // Allow this process to be aborted
-      if (interrupt_ && (n++ % kInterruptIterationsInterval) == 0) {
+      if (interrupt_ && (++n % kInterruptIterationsInterval) == 0) {
         (*interrupt_)();
       }
     }
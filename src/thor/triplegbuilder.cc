@@ -10,6 +10,7 @@
 #include "midgard/elevation_encoding.h"
 #include "midgard/encoded.h"
 #include "midgard/logging.h"
+#include "midgard/metrics.h"
 #include "midgard/pointll.h"
 #include "midgard/util.h"
 #include "proto_conversions.h"
@@ -1818,6 +1819,8 @@ void TripLegBuilder::Build(
     const std::function<void()>* interrupt_callback,
     const std::unordered_map<size_t, std::pair<EdgeTrimmingInfo, EdgeTrimmingInfo>>& edge_trimming,
     const std::vector<valhalla::Location>& intermediates) {
+  midgard::metrics::stage_timer_t timer(midgard::metrics::stage_t::trip_leg);
+
   // Test interrupt prior to building trip path
   if (interrupt_callback) {
     (*interrupt_callback)();
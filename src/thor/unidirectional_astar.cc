@@ -1,6 +1,7 @@
 #include "thor/unidirectional_astar.h"
 #include "baldr/graphconstants.h"
 #include "midgard/logging.h"
+#include "midgard/metrics.h"
 #include "sif/hierarchylimits.h"
 
 #include <boost/property_tree/ptree.hpp>
@@ -523,6 +524,7 @@ std::vector<std::vector<PathInfo>> UnidirectionalAStar<expansion_direction, FORW
                    // towards destination
   std::pair<int32_t, float> best_path = std::make_pair(-1, 0.0f);
   size_t n = 0;
+  midgard::metrics::local_counter_t settled(midgard::metrics::counter_t::labels_settled);
   while (true) {
     // Allow this process to be aborted
     if (interrupt && (++n % kInterruptIterationsInterval) == 0) {
@@ -562,6 +564,7 @@ std::vector<std::vector<PathInfo>> UnidirectionalAStar<expansion_direction, FORW
     // edge (this will allow loops/around the block cases)
     if (!pred.origin()) {
       edgestatus_.Update(pred.edgeid(), EdgeSet::kPermanent);
+      ++settled;
     }
 
     // setting this edge as settled
@@ -71,7 +71,8 @@ thor_worker_t::thor_worker_t(const boost::property_tree::ptree& config,
       allow_hierarchy_limits_modifications(
           config.get<bool>("service_limits.hierarchy_limits.allow_modification", false)),
       min_linear_cost_factor(config.get<double>("service_limits.min_linear_cost_factor", 1.0)),
-      max_linear_cost_edges(config.get<uint64_t>("service_limits.max_linear_cost_edges", 50000)) {
+      max_linear_cost_edges(config.get<uint64_t>("service_limits.max_linear_cost_edges", 50000)),
+      budget(config) {
 
   // Select the matrix algorithm based on the conf file (defaults to
   // select_optimal if not present)
@@ -84,7 +85,7 @@ thor_worker_t::thor_worker_t(const boost::property_tree::ptree& config,
         kv.first == "isochrone" || kv.first == "centroid" || kv.first == "status" ||
         kv.first == "max_distance_disable_hierarchy_culling" || kv.first == "allow_hard_exclusions" ||
         kv.first == "hierarchy_limits" || kv.first == "min_linear_cost_factor" ||
-        kv.first == "max_linear_cost_edges") {
+        kv.first == "max_linear_cost_edges" || kv.first == "budget") {
       continue;
     }
 
@@ -127,7 +128,8 @@ thor_worker_t::work(const std::list<zmq::message_t>& job,
   // get request info and make sure to record any metrics before we are done
   auto& info = *static_cast<prime_server::http_request_info_t*>(request_info);
   LOG_INFO("Got Thor Request " + std::to_string(info.id));
-  Api request;
+  // the request lives on the arena of the worker until cleanup
+  Api& request = arena.request();
   prime_server::worker_t::result_t result{true, {}, {}};
   try {
     // crack open the original request
@@ -140,6 +142,7 @@ thor_worker_t::work(const std::list<zmq::message_t>& job,
 
     // Set the interrupt function
     service_worker_t::set_interrupt(&interrupt_function);
+    budget.start(*reader, &interrupt_function);
 
     // do request specific processing
     switch (options.action()) {
@@ -193,8 +196,23 @@ thor_worker_t::work(const std::list<zmq::message_t>& job,
   }
 
   // keep track of the metrics if the request is going back to the client
-  if (!result.intermediate)
+  if (!result.intermediate) {
+    // and how well the map matching candidate grids are reused across requests
+    if (request.options().action() == Options::trace_route ||
+        request.options().action() == Options::trace_attributes) {
+      const auto& grid_stats = matcher_factory.grid_cache_stats();
+      const auto& action = Options_Action_Enum_Name(request.options().action());
+      auto* hit_rate = request.mutable_info()->mutable_statistics()->Add();
+      hit_rate->set_key(action + ".info." + service_name() + ".grid_cache_hit_percent");
+      hit_rate->set_value(grid_stats.hit_rate() * 100.f);
+      hit_rate->set_type(gauge);
+      auto* memory = request.mutable_info()->mutable_statistics()->Add();
+      memory->set_key(action + ".info." + service_name() + ".grid_cache_kb");
+      memory->set_value(grid_stats.memory / 1024.f);
+      memory->set_type(gauge);
+    }
     enqueue_statistics(request);
+  }
 
   return result;
 }
@@ -372,6 +390,7 @@ void thor_worker_t::cleanup() {
 void thor_worker_t::set_interrupt(const std::function<void()>* interrupt_function) {
   interrupt = interrupt_function;
   reader->SetInterrupt(interrupt);
+  budget.start(*reader, interrupt);
 }
 } // namespace thor
 } // namespace valhalla
@@ -22,11 +22,11 @@ namespace tyr {
 struct actor_t::pimpl_t {
   pimpl_t(const boost::property_tree::ptree& config)
       : reader(new baldr::GraphReader(config.get_child("mjolnir"))), loki_worker(config, reader),
-        thor_worker(config, reader), odin_worker(config) {
+        thor_worker(config, reader), odin_worker(config), arena(config) {
   }
   pimpl_t(const boost::property_tree::ptree& config, baldr::GraphReader& graph_reader)
       : reader(&graph_reader, [](baldr::GraphReader*) {}), loki_worker(config, reader),
-        thor_worker(config, reader), odin_worker(config) {
+        thor_worker(config, reader), odin_worker(config), arena(config) {
   }
   void set_interrupts(const std::function<void()>* interrupt_function) {
     loki_worker.set_interrupt(interrupt_function);
@@ -38,10 +38,19 @@ struct actor_t::pimpl_t {
     thor_worker.cleanup();
     odin_worker.cleanup();
   }
+  // Points the request at one on the arena if the caller didn't pass their own. The arena is
+  // reset once the action is done, whether or not the workers are cleaned up after it
+  midgard::Finally<std::function<void()>> request(Api*& api) {
+    if (!api) {
+      api = &arena.request();
+    }
+    return midgard::Finally<std::function<void()>>([this]() { arena.reset(); });
+  }
   std::shared_ptr<baldr::GraphReader> reader;
   loki::loki_worker_t loki_worker;
   thor::thor_worker_t thor_worker;
   odin_worker_t odin_worker;
+  request_arena_t arena;
 };
 
 actor_t::actor_t(const boost::property_tree::ptree& config, bool auto_cleanup)
@@ -101,11 +110,8 @@ actor_t::route(const std::string& request_str, const std::function<void()>* inte
   });
   // set the interrupts
   pimpl->set_interrupts(interrupt);
-  // if the caller doesn't want a copy we'll use this dummy
-  Api dummy;
-  if (!api) {
-    api = &dummy;
-  }
+  // if the caller doesn't want a copy we'll use one on the arena
+  auto scoped_request = pimpl->request(api);
   // parse the request
   ParseApi(request_str, Options::route, *api);
   // check the request and locate the locations in the graph
@@ -125,11 +131,8 @@ actor_t::locate(const std::string& request_str, const std::function<void()>* int
   });
   // set the interrupts
   pimpl->set_interrupts(interrupt);
-  // if the caller doesn't want a copy we'll use this dummy
-  Api dummy;
-  if (!api) {
-    api = &dummy;
-  }
+  // if the caller doesn't want a copy we'll use one on the arena
+  auto scoped_request = pimpl->request(api);
   // parse the request
   ParseApi(request_str, Options::locate, *api);
   // check the request and locate the locations in the graph
@@ -145,11 +148,8 @@ actor_t::matrix(const std::string& request_str, const std::function<void()>* int
   });
   // set the interrupts
   pimpl->set_interrupts(interrupt);
-  // if the caller doesn't want a copy we'll use this dummy
-  Api dummy;
-  if (!api) {
-    api = &dummy;
-  }
+  // if the caller doesn't want a copy we'll use one on the arena
+  auto scoped_request = pimpl->request(api);
   // parse the request
   ParseApi(request_str, Options::sources_to_targets, *api);
   // check the request and locate the locations in the graph
@@ -168,11 +168,8 @@ std::string actor_t::optimized_route(const std::string& request_str,
   });
   // set the interrupts
   pimpl->set_interrupts(interrupt);
-  // if the caller doesn't want a copy we'll use this dummy
-  Api dummy;
-  if (!api) {
-    api = &dummy;
-  }
+  // if the caller doesn't want a copy we'll use one on the arena
+  auto scoped_request = pimpl->request(api);
   // parse the request
   ParseApi(request_str, Options::optimized_route, *api);
   // check the request and locate the locations in the graph
@@ -192,11 +189,8 @@ actor_t::isochrone(const std::string& request_str, const std::function<void()>*
   });
   // set the interrupts
   pimpl->set_interrupts(interrupt);
-  // if the caller doesn't want a copy we'll use this dummy
-  Api dummy;
-  if (!api) {
-    api = &dummy;
-  }
+  // if the caller doesn't want a copy we'll use one on the arena
+  auto scoped_request = pimpl->request(api);
   // parse the request
   ParseApi(request_str, Options::isochrone, *api);
   // check the request and locate the locations in the graph
@@ -215,11 +209,8 @@ std::string actor_t::trace_route(const std::string& request_str,
   });
   // set the interrupts
   pimpl->set_interrupts(interrupt);
-  // if the caller doesn't want a copy we'll use this dummy
-  Api dummy;
-  if (!api) {
-    api = &dummy;
-  }
+  // if the caller doesn't want a copy we'll use one on the arena
+  auto scoped_request = pimpl->request(api);
   // parse the request
   ParseApi(request_str, Options::trace_route, *api);
   // check the request and locate the locations in the graph
@@ -240,11 +231,8 @@ std::string actor_t::trace_attributes(const std::string& request_str,
   });
   // set the interrupts
   pimpl->set_interrupts(interrupt);
-  // if the caller doesn't want a copy we'll use this dummy
-  Api dummy;
-  if (!api) {
-    api = &dummy;
-  }
+  // if the caller doesn't want a copy we'll use one on the arena
+  auto scoped_request = pimpl->request(api);
   // parse the request
   ParseApi(request_str, Options::trace_attributes, *api);
   // check the request and locate the locations in the graph
@@ -262,11 +250,8 @@ actor_t::height(const std::string& request_str, const std::function<void()>* int
   });
   // set the interrupts
   pimpl->set_interrupts(interrupt);
-  // if the caller doesn't want a copy we'll use this dummy
-  Api dummy;
-  if (!api) {
-    api = &dummy;
-  }
+  // if the caller doesn't want a copy we'll use one on the arena
+  auto scoped_request = pimpl->request(api);
   // parse the request
   ParseApi(request_str, Options::height, *api);
   // get the height at each point
@@ -283,11 +268,8 @@ std::string actor_t::transit_available(const std::string& request_str,
   });
   // set the interrupts
   pimpl->set_interrupts(interrupt);
-  // if the caller doesn't want a copy we'll use this dummy
-  Api dummy;
-  if (!api) {
-    api = &dummy;
-  }
+  // if the caller doesn't want a copy we'll use one on the arena
+  auto scoped_request = pimpl->request(api);
   // parse the request
   ParseApi(request_str, Options::transit_available, *api);
   // check the request and locate the locations in the graph
@@ -303,11 +285,8 @@ actor_t::expansion(const std::string& request_str, const std::function<void()>*
   });
   // set the interrupts
   pimpl->set_interrupts(interrupt);
-  // if the caller doesn't want a copy we'll use this dummy
-  Api dummy;
-  if (!api) {
-    api = &dummy;
-  }
+  // if the caller doesn't want a copy we'll use one on the arena
+  auto scoped_request = pimpl->request(api);
   // parse the request
   ParseApi(request_str, Options::expansion, *api);
   // check the request and locate the locations in the graph
@@ -331,11 +310,8 @@ actor_t::centroid(const std::string& request_str, const std::function<void()>* i
   });
   // set the interrupts
   pimpl->set_interrupts(interrupt);
-  // if the caller doesn't want a copy we'll use this dummy
-  Api dummy;
-  if (!api) {
-    api = &dummy;
-  }
+  // if the caller doesn't want a copy we'll use one on the arena
+  auto scoped_request = pimpl->request(api);
   // parse the request
   ParseApi(request_str, Options::centroid, *api);
   // check the request and locate the locations in the graph
@@ -355,11 +331,8 @@ actor_t::status(const std::string& request_str, const std::function<void()>* int
   });
   // set the interrupts
   pimpl->set_interrupts(interrupt);
-  // if the caller doesn't want a copy we'll use this dummy
-  Api dummy;
-  if (!api) {
-    api = &dummy;
-  }
+  // if the caller doesn't want a copy we'll use one on the arena
+  auto scoped_request = pimpl->request(api);
   // parse the request
   ParseApi(request_str, Options::status, *api);
   // check lokis status
@@ -381,11 +354,8 @@ actor_t::tile(const std::string& request_str, const std::function<void()>* inter
   });
   // set the interrupts
   pimpl->set_interrupts(interrupt);
-  // if the caller doesn't want a copy we'll use this dummy
-  Api dummy;
-  if (!api) {
-    api = &dummy;
-  }
+  // if the caller doesn't want a copy we'll use one on the arena
+  auto scoped_request = pimpl->request(api);
   // parse the request
   ParseApi(request_str, Options::tile, *api);
   auto bytes = pimpl->loki_worker.render_tile(*api);
@@ -0,0 +1,694 @@
+#include "tyr/http_frontend.h"
+#include "exceptions.h"
+#include "midgard/logging.h"
+#include "proto_conversions.h"
+
+#include <boost/property_tree/ptree.hpp>
+
+#ifdef ENABLE_SERVICES
+#ifdef __linux__
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+
+using namespace prime_server;
+
+namespace {
+
+// ids of the event sources of the loop that aren't connections
+constexpr uint64_t kListener = 0;
+constexpr uint64_t kWakeup = 1;
+constexpr uint64_t kFirstConnection = 2;
+
+#ifdef __linux__
+// whether the connection should be closed once the request is answered, http/1.0 closes unless
+// asked to keep it alive
+bool closes(const http_request_info_t& info) {
+  return info.connection_close || (info.version == 0 && !info.connection_keep_alive);
+}
+
+// wakes up the event loop
+void wake(int fd) {
+  uint64_t one = 1;
+  [[maybe_unused]] auto written = ::write(fd, &one, sizeof(one));
+}
+#endif
+
+} // namespace
+
+namespace valhalla {
+namespace tyr {
+
+httpd_worker_t::httpd_worker_t(const boost::property_tree::ptree& config,
+                               const std::shared_ptr<response_cache_t>& cache)
+    : service_worker_t(config), actor_(config, true), cache_(cache),
+      hop_sample_every_(config.get<uint32_t>("httpd.event_loop.hop_sample_every", 0)),
+      answered_(0) {
+  // the same actions loki lets through
+  Options::Action action;
+  for (const auto& kv : config.get_child("loki.actions")) {
+    auto path = kv.second.get_value<std::string>();
+    if (!Options_Action_Enum_Parse(path, &action)) {
+      throw std::runtime_error("Action not supported " + path);
+    }
+    actions_.insert(action);
+    action_str_.append("'/" + path + "' ");
+  }
+  started();
+}
+
+httpd_worker_t::~httpd_worker_t() {
+}
+
+worker_t::result_t httpd_worker_t::work(const std::list<zmq::message_t>& job,
+                                        void* request_info,
+                                        const std::function<void()>& interrupt_function) {
+  auto& info = *static_cast<http_request_info_t*>(request_info);
+  worker_t::result_t result{false, {}, ""};
+  try {
+    auto http_request = http_request_t::from_string(static_cast<const char*>(job.front().data()),
+                                                    job.front().size());
+    result.messages.emplace_back(answer(http_request, info, interrupt_function));
+  } catch (const std::exception& e) {
+    Api request;
+    result = serialize_error({100, std::string(e.what())}, info, request);
+  }
+  return result;
+}
+
+std::string httpd_worker_t::answer(const http_request_t& http_request,
+                                   http_request_info_t& info,
+                                   const std::function<void()>& interrupt_function) {
+  // the request lives on the arena of the worker until cleanup
+  Api& request = arena.request();
+  std::string response;
+  try {
+    // the latencies and counters of the whole process, which isn't an action
+    if (http_request.path == "/metrics") {
+      return serialize_metrics(info).messages.front();
+    }
+    ParseApi(http_request, request);
+    const auto action = request.options().action();
+    if (actions_.find(action) == actions_.cend()) {
+      throw valhalla_exception_t{106, action_str_};
+    }
+
+    // all of the stages on this thread, one after the other, unless an identical request was
+    // answered before or is being answered right now
+    const auto answer = [&]() {
+      return std::make_shared<const std::string>(actor_.act(request, &interrupt_function));
+    };
+    auto found = std::make_pair(response_cache_t::response_t{}, response_cache_t::outcome_t::miss);
+    if (cache_ && cache_->caches(request.options())) {
+      found = cache_->get(cache_->key(request.options()), cache_->time_dependent(request.options()),
+                          answer, &interrupt_function);
+      const auto key = Options_Action_Enum_Name(action) + ".info." + service_name();
+      auto* stat = request.mutable_info()->mutable_statistics()->Add();
+      switch (found.second) {
+        case response_cache_t::outcome_t::hit:
+          stat->set_key(key + ".cache_hit");
+          break;
+        case response_cache_t::outcome_t::coalesced:
+          stat->set_key(key + ".cache_coalesced");
+          break;
+        case response_cache_t::outcome_t::miss:
+          stat->set_key(key + ".cache_miss");
+          break;
+      }
+      stat->set_value(1);
+      stat->set_type(count);
+      stat = request.mutable_info()->mutable_statistics()->Add();
+      stat->set_key(key + ".cache_kb");
+      stat->set_value(cache_->size() / 1024);
+      stat->set_type(gauge);
+    } else {
+      found.first = answer();
+    }
+    response = to_response(*found.first, info, request).messages.front();
+
+    // when asked to, every so often time what handing the request between the stages would have
+    // cost, the request is bigger by now than on any of the hops so this is an upper bound
+    const auto hops = pipeline_hops(action);
+    if (found.second == response_cache_t::outcome_t::miss && hop_sample_every_ && hops &&
+        ++answered_ % hop_sample_every_ == 0) {
+      const auto start = std::chrono::steady_clock::now();
+      Api copy;
+      for (uint32_t i = 0; i < hops; ++i) {
+        copy.ParseFromString(request.SerializeAsString());
+      }
+      const std::chrono::duration<double, std::milli> took =
+          std::chrono::steady_clock::now() - start;
+      auto* stat = request.mutable_info()->mutable_statistics()->Add();
+      stat->set_key(Options_Action_Enum_Name(action) + ".info." + service_name() +
+                    ".hops_saved_ms");
+      stat->set_value(took.count());
+      stat->set_type(timing);
+      stat->set_frequency(1.f / hop_sample_every_);
+    }
+  } catch (const valhalla_exception_t& e) {
+    LOG_WARN("400::" + std::string(e.what()) + " request_id=" + std::to_string(info.id));
+    response = serialize_error(e, info, request).messages.front();
+  } catch (const std::exception& e) {
+    LOG_ERROR("500::" + std::string(e.what()) + " request_id=" + std::to_string(info.id));
+    response = serialize_error({199, std::string(e.what())}, info, request).messages.front();
+  }
+
+  enqueue_statistics(request);
+  return response;
+}
+
+uint32_t httpd_worker_t::pipeline_hops(Options::Action action) {
+  switch (action) {
+    // loki to thor to odin
+    case Options::route:
+    case Options::centroid:
+    case Options::optimized_route:
+    case Options::trace_route:
+    case Options::status:
+      return 2;
+    // loki to thor
+    case Options::sources_to_targets:
+    case Options::isochrone:
+    case Options::trace_attributes:
+    case Options::expansion:
+      return 1;
+    // loki answers these itself
+    default:
+      return 0;
+  }
+}
+
+#ifdef __linux__
+
+http_frontend_t::http_frontend_t(const boost::property_tree::ptree& config,
+                                 unsigned int concurrency)
+    : listen_(config.get<std::string>("httpd.service.listen")),
+      max_queued_(config.get<size_t>("httpd.event_loop.max_queued", 1024)),
+      max_pipelined_(std::max<size_t>(1, config.get<size_t>("httpd.event_loop.max_pipelined", 16))),
+      max_request_size_(
+          config.get<size_t>("httpd.service.max_request_size", DEFAULT_MAX_REQUEST_SIZE)),
+      timeout_(config.get<int>("httpd.service.timeout_seconds", -1)), listener_(-1), epoll_(-1),
+      wakeup_(-1), stopped_(false), draining_(false), drain_seconds_(0),
+      next_connection_(kFirstConnection), next_request_id_(0), in_flight_(0) {
+  // the workers each get their own actor and with it their own graph reader, the responses they
+  // cache are shared
+  auto cache = std::make_shared<response_cache_t>(config);
+  for (unsigned int i = 0; i < std::max(1u, concurrency); ++i) {
+    workers_.emplace_back(std::make_unique<httpd_worker_t>(config, cache));
+  }
+  Listen();
+}
+
+http_frontend_t::~http_frontend_t() {
+  stop();
+  for (auto& thread : threads_) {
+    if (thread.joinable()) {
+      thread.join();
+    }
+  }
+  for (const auto& connection : connections_) {
+    ::close(connection.second.fd);
+  }
+  for (int fd : {listener_, epoll_, wakeup_}) {
+    if (fd != -1) {
+      ::close(fd);
+    }
+  }
+}
+
+void http_frontend_t::Listen() {
+  auto fail = [this](const std::string& what) {
+    throw std::system_error(errno, std::generic_category(), what + " " + listen_);
+  };
+
+  // a tcp port or a domain socket
+  if (listen_.find("tcp://") == 0) {
+    const auto address = listen_.substr(6);
+    const auto colon = address.rfind(':');
+    if (colon == std::string::npos) {
+      throw std::runtime_error("Missing the port to listen on " + listen_);
+    }
+    const auto host = address.substr(0, colon);
+    const auto port = address.substr(colon + 1);
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE;
+    addrinfo* found = nullptr;
+    if (getaddrinfo(host == "*" ? nullptr : host.c_str(), port.c_str(), &hints, &found) != 0 ||
+        !found) {
+      throw std::runtime_error("Could not resolve the address to listen on " + listen_);
+    }
+    listener_ = socket(found->ai_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    int on = 1;
+    if (listener_ != -1) {
+      setsockopt(listener_, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    }
+    const bool bound = listener_ != -1 && bind(listener_, found->ai_addr, found->ai_addrlen) == 0;
+    freeaddrinfo(found);
+    if (!bound) {
+      fail("Could not bind to");
+    }
+  } else if (listen_.find("ipc://") == 0) {
+    const auto path = listen_.substr(6);
+    sockaddr_un address{};
+    if (path.size() >= sizeof(address.sun_path)) {
+      throw std::runtime_error("The socket path is too long " + listen_);
+    }
+    address.sun_family = AF_UNIX;
+    std::memcpy(address.sun_path, path.c_str(), path.size());
+    unlink(path.c_str());
+    listener_ = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listener_ == -1 ||
+        bind(listener_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+      fail("Could not bind to");
+    }
+  } else {
+    throw std::runtime_error("You must listen on either tcp://ip:port or ipc://some_socket_file");
+  }
+  if (listen(listener_, SOMAXCONN) != 0) {
+    fail("Could not listen on");
+  }
+
+  // the loop waits on the listener, the connections and the workers handing back responses
+  epoll_ = epoll_create1(EPOLL_CLOEXEC);
+  wakeup_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (epoll_ == -1 || wakeup_ == -1) {
+    fail("Could not set up the event loop for");
+  }
+  epoll_event event{};
+  event.events = EPOLLIN;
+  event.data.u64 = kListener;
+  epoll_ctl(epoll_, EPOLL_CTL_ADD, listener_, &event);
+  event.data.u64 = kWakeup;
+  epoll_ctl(epoll_, EPOLL_CTL_ADD, wakeup_, &event);
+}
+
+void http_frontend_t::serve() {
+  for (auto& worker : workers_) {
+    threads_.emplace_back(&http_frontend_t::Work, this, std::ref(*worker));
+  }
+  LOG_INFO("Serving " + listen_ + " in process on " + std::to_string(workers_.size()) +
+           " workers");
+
+  std::array<epoll_event, 256> events;
+  while (!stopped_) {
+    // once draining there is only so long to wait for the requests that were read
+    int wait = -1;
+    if (draining_) {
+      if (drain_until_ == clock::time_point{}) {
+        Drain();
+      }
+      const auto now = clock::now();
+      if (Drained() || now >= drain_until_) {
+        stop();
+        break;
+      }
+      wait = static_cast<int>(
+          std::chrono::ceil<std::chrono::milliseconds>(drain_until_ - now).count());
+    }
+
+    const int count = epoll_wait(epoll_, events.data(), events.size(), wait);
+    if (count < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      throw std::system_error(errno, std::generic_category(), "The event loop failed");
+    }
+    for (int i = 0; i < count && !stopped_; ++i) {
+      const auto id = events[i].data.u64;
+      const auto what = events[i].events;
+      if (id == kListener) {
+        Accept();
+      } else if (id == kWakeup) {
+        Answered();
+      } else if (what & (EPOLLERR | EPOLLHUP)) {
+        // nobody is left to answer
+        Close(id);
+      } else {
+        if (what & EPOLLIN) {
+          Read(id);
+        }
+        if (what & EPOLLOUT) {
+          Write(id);
+        }
+      }
+    }
+  }
+
+  // the workers finish what they are on and the rest of the queue is dropped
+  jobs_ready_.notify_all();
+  for (auto& thread : threads_) {
+    thread.join();
+  }
+  threads_.clear();
+}
+
+void http_frontend_t::stop() {
+  {
+    std::lock_guard<std::mutex> lock(jobs_lock_);
+    stopped_ = true;
+  }
+  jobs_ready_.notify_all();
+  if (wakeup_ != -1) {
+    wake(wakeup_);
+  }
+}
+
+void http_frontend_t::drain(std::chrono::seconds seconds) {
+  {
+    std::lock_guard<std::mutex> lock(jobs_lock_);
+    drain_seconds_ = seconds;
+  }
+  draining_ = true;
+  if (wakeup_ != -1) {
+    wake(wakeup_);
+  }
+}
+
+void http_frontend_t::Drain() {
+  {
+    std::lock_guard<std::mutex> lock(jobs_lock_);
+    drain_until_ = clock::now() + drain_seconds_;
+  }
+  LOG_INFO("Draining " + listen_ + " for up to " + std::to_string(drain_seconds_.count()) +
+           " seconds");
+
+  // no new connections and nothing more is read from the ones there are
+  epoll_ctl(epoll_, EPOLL_CTL_DEL, listener_, nullptr);
+  ::close(listener_);
+  listener_ = -1;
+  std::vector<uint64_t> idle;
+  for (const auto& connection : connections_) {
+    if (connection.second.next_response == connection.second.next_request &&
+        connection.second.out.empty()) {
+      idle.push_back(connection.first);
+    } else {
+      Watch(connection.first, connection.second);
+    }
+  }
+  for (auto id : idle) {
+    Close(id);
+  }
+}
+
+bool http_frontend_t::Drained() const {
+  return in_flight_ == 0 && std::all_of(connections_.begin(), connections_.end(),
+                                        [](const auto& connection) {
+                                          return connection.second.out.empty();
+                                        });
+}
+
+void http_frontend_t::Accept() {
+  while (true) {
+    const int fd = accept4(listener_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+    if (fd == -1) {
+      if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+        LOG_WARN("Could not accept a connection: " + std::string(std::strerror(errno)));
+      }
+      return;
+    }
+    // the responses are written whole so there is nothing to gain from waiting for more
+    int on = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+
+    const auto id = next_connection_++;
+    connections_[id].fd = fd;
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.u64 = id;
+    epoll_ctl(epoll_, EPOLL_CTL_ADD, fd, &event);
+  }
+}
+
+void http_frontend_t::Read(uint64_t id) {
+  auto found = connections_.find(id);
+  if (found == connections_.end()) {
+    return;
+  }
+  auto& connection = found->second;
+
+  std::array<char, 64 * 1024> buffer;
+  const auto size = recv(connection.fd, buffer.data(), buffer.size(), 0);
+  if (size < 0) {
+    if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+      Close(id);
+    }
+    return;
+  }
+  // the client is done sending but still gets the responses to what it sent so far
+  if (size == 0) {
+    connection.closing = true;
+    connection.hangup = true;
+    Write(id);
+    return;
+  }
+
+  // the requests that are complete go to the workers, a request that doesn't parse ends the
+  // connection once the ones before it are answered. the parser drops whatever it parsed out of
+  // the read when it throws, so the bytes of the request it is in the middle of are kept along
+  // with the read to parse those again. the kept bytes are only moved once the ones no longer
+  // needed make up half of them
+  auto& received = connection.received;
+  const auto buffered = std::min(connection.parser.size(), received.size());
+  if (received.size() - buffered > received.size() / 2) {
+    received.erase(0, received.size() - buffered);
+  }
+  const auto start = received.size() - buffered;
+  received.append(buffer.data(), size);
+
+  std::list<http_request_t> requests;
+  std::string rejected;
+  try {
+    requests = connection.parser.from_stream(buffer.data(), size, max_request_size_);
+  } catch (const http_response_t& response) {
+    rejected = response.to_string();
+  } catch (const std::exception& e) {
+    rejected = http_response_t(400, "Bad Request", std::string(e.what())).to_string();
+  }
+  if (!rejected.empty()) {
+    requests = Parseable(received.data() + start, received.size() - start);
+  }
+  for (auto& request : requests) {
+    if (connection.closing) {
+      break;
+    }
+    Enqueue(id, connection, std::move(request));
+  }
+  if (!rejected.empty() && !connection.closing) {
+    connection.closing = true;
+    Respond(connection, {id, connection.next_request++, std::move(rejected), true});
+  }
+  Write(id);
+}
+
+std::list<http_request_t> http_frontend_t::Parseable(const char* bytes, size_t size) const {
+  // the parser fails on the longer of two starts of the bytes if it fails on the shorter one, so
+  // the longest start it gets through is found by bisection
+  size_t parses = 0, fails = size;
+  while (fails - parses > 1) {
+    const auto middle = parses + (fails - parses) / 2;
+    try {
+      http_request_t parser;
+      parser.from_stream(bytes, middle, max_request_size_);
+      parses = middle;
+    } catch (...) {
+      fails = middle;
+    }
+  }
+  http_request_t parser;
+  return parser.from_stream(bytes, parses, max_request_size_);
+}
+
+void http_frontend_t::Enqueue(uint64_t id, connection_t& connection, http_request_t&& request) {
+  const auto sequence = connection.next_request++;
+  auto info = request.to_info(next_request_id_++);
+  const bool close = closes(info);
+  connection.closing = connection.closing || close;
+
+  {
+    std::unique_lock<std::mutex> lock(jobs_lock_);
+    if (jobs_.size() < max_queued_) {
+      const auto deadline =
+          timeout_.count() < 0 ? clock::time_point::max() : clock::now() + timeout_;
+      jobs_.push_back(job_t{id, sequence, std::move(request), info, deadline});
+      ++in_flight_;
+      lock.unlock();
+      jobs_ready_.notify_one();
+      return;
+    }
+  }
+
+  // the workers are too far behind so this one is turned away now rather than left waiting
+  Api api;
+  Respond(connection,
+          {id, sequence, serialize_error({108}, info, api).messages.front(), close});
+}
+
+void http_frontend_t::Work(httpd_worker_t& worker) {
+  while (true) {
+    job_t job;
+    {
+      std::unique_lock<std::mutex> lock(jobs_lock_);
+      jobs_ready_.wait(lock, [this]() { return stopped_ || !jobs_.empty(); });
+      if (stopped_) {
+        return;
+      }
+      job = std::move(jobs_.front());
+      jobs_.pop_front();
+    }
+
+    const std::function<void()> interrupt = [this, &job]() {
+      if (stopped_) {
+        throw valhalla_exception_t{102};
+      }
+      if (clock::now() > job.deadline) {
+        throw valhalla_exception_t{109};
+      }
+    };
+    answer_t answer{job.connection, job.sequence, worker.answer(job.request, job.info, interrupt),
+                    closes(job.info)};
+    worker.cleanup();
+
+    {
+      std::lock_guard<std::mutex> lock(answers_lock_);
+      answers_.emplace_back(std::move(answer));
+    }
+    wake(wakeup_);
+  }
+}
+
+void http_frontend_t::Answered() {
+  uint64_t count;
+  [[maybe_unused]] auto read = ::read(wakeup_, &count, sizeof(count));
+  std::vector<answer_t> answers;
+  {
+    std::lock_guard<std::mutex> lock(answers_lock_);
+    answers.swap(answers_);
+  }
+  // the connection may have gone away while its request was worked on
+  in_flight_ -= answers.size();
+  for (auto& answer : answers) {
+    const auto id = answer.connection;
+    auto found = connections_.find(id);
+    if (found != connections_.end()) {
+      Respond(found->second, std::move(answer));
+      Write(id);
+    }
+  }
+}
+
+void http_frontend_t::Respond(connection_t& connection, answer_t&& answer) {
+  // wait for the responses of the requests that came before
+  if (answer.sequence != connection.next_response) {
+    connection.done.emplace(answer.sequence, std::move(answer));
+    return;
+  }
+  connection.out.append(answer.response);
+  connection.hangup = connection.hangup || answer.close;
+  ++connection.next_response;
+  for (auto next = connection.done.begin();
+       next != connection.done.end() && next->first == connection.next_response;
+       next = connection.done.erase(next)) {
+    connection.out.append(next->second.response);
+    connection.hangup = connection.hangup || next->second.close;
+    ++connection.next_response;
+  }
+}
+
+void http_frontend_t::Write(uint64_t id) {
+  auto found = connections_.find(id);
+  if (found == connections_.end()) {
+    return;
+  }
+  auto& connection = found->second;
+
+  while (connection.written < connection.out.size()) {
+    const auto size = send(connection.fd, connection.out.data() + connection.written,
+                           connection.out.size() - connection.written, MSG_NOSIGNAL);
+    if (size < 0) {
+      if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+        break;
+      }
+      Close(id);
+      return;
+    }
+    connection.written += size;
+  }
+
+  // all of it went out
+  if (connection.written == connection.out.size()) {
+    connection.out.clear();
+    connection.written = 0;
+    if (connection.hangup && connection.next_response == connection.next_request) {
+      Close(id);
+      return;
+    }
+  }
+  Watch(id, connection);
+}
+
+void http_frontend_t::Watch(uint64_t id, const connection_t& connection) {
+  // read more requests unless there are enough in flight already, write while there is something
+  // left to write
+  epoll_event event{};
+  event.data.u64 = id;
+  if (!connection.closing && !draining_ &&
+      connection.next_request - connection.next_response < max_pipelined_) {
+    event.events |= EPOLLIN;
+  }
+  if (!connection.out.empty()) {
+    event.events |= EPOLLOUT;
+  }
+  epoll_ctl(epoll_, EPOLL_CTL_MOD, connection.fd, &event);
+}
+
+void http_frontend_t::Close(uint64_t id) {
+  auto found = connections_.find(id);
+  if (found == connections_.end()) {
+    return;
+  }
+  epoll_ctl(epoll_, EPOLL_CTL_DEL, found->second.fd, nullptr);
+  ::close(found->second.fd);
+  connections_.erase(found);
+}
+
+#else
+
+http_frontend_t::http_frontend_t(const boost::property_tree::ptree&, unsigned int)
+    : listener_(-1), epoll_(-1), wakeup_(-1), stopped_(false), draining_(false) {
+  throw std::runtime_error("The in process http frontend needs epoll which is only on linux");
+}
+
+http_frontend_t::~http_frontend_t() {
+}
+
+void http_frontend_t::serve() {
+}
+
+void http_frontend_t::stop() {
+}
+
+void http_frontend_t::drain(std::chrono::seconds) {
+}
+
+#endif
+
+} // namespace tyr
+} // namespace valhalla
+
+#endif
@@ -1,6 +1,7 @@
 #include "baldr/rapidjson_utils.h"
 #include "exceptions.h"
 #include "midgard/logging.h"
+#include "midgard/metrics.h"
 #include "midgard/pointll.h"
 #include "tyr/serializers.h"
 
@@ -518,6 +519,7 @@ namespace tyr {
 std::string serializeIsochrones(Api& request,
                                 std::vector<midgard::GriddedData<2>::contour_interval_t>& intervals,
                                 const std::shared_ptr<const midgard::GriddedData<2>>& isogrid) {
+  midgard::metrics::stage_timer_t timer(midgard::metrics::stage_t::serialize);
 
   // only generate if json or pbf output is requested
   contours_t contours;
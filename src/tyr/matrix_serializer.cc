@@ -1,4 +1,5 @@
 #include "baldr/rapidjson_utils.h"
+#include "midgard/metrics.h"
 #include "proto_conversions.h"
 #include "thor/matrixalgorithm.h"
 #include "tyr/serializers.h"
@@ -296,6 +297,7 @@ namespace valhalla {
 namespace tyr {
 
 std::string serializeMatrix(Api& request) {
+  midgard::metrics::stage_timer_t timer(midgard::metrics::stage_t::serialize);
   double distance_scale = (request.options().units() == Options::miles) ? kMilePerMeter : kKmPerMeter;
 
   // dont bother serializing in case of /expansion request
@@ -0,0 +1,178 @@
+#include "tyr/response_cache.h"
+#include "filesystem_utils.h"
+#include "proto_conversions.h"
+
+#include <boost/property_tree/ptree.hpp>
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/io/zero_copy_stream_impl_lite.h>
+
+#include <filesystem>
+#include <stdexcept>
+
+namespace {
+
+// how often a request waiting on an identical one checks whether it should stop waiting
+constexpr std::chrono::milliseconds kWaitInterval(10);
+
+} // namespace
+
+namespace valhalla {
+namespace tyr {
+
+response_cache_t::response_cache_t(const boost::property_tree::ptree& config)
+    : max_bytes_(config.get<size_t>("httpd.cache.max_bytes", 0)),
+      ttl_(config.get<unsigned int>("httpd.cache.ttl_seconds", 60)),
+      coalesce_(static_cast<int64_t>(config.get<float>("httpd.cache.coalesce_seconds", 5) * 1000)),
+      live_traffic_(!config.get<std::string>("mjolnir.traffic_extract", "").empty()), bytes_(0) {
+  // the actions whose responses are cached
+  Options::Action action;
+  auto actions = config.get_child_optional("httpd.cache.actions");
+  if (!actions) {
+    actions_ = {Options::route, Options::isochrone};
+  } else {
+    for (const auto& kv : *actions) {
+      auto name = kv.second.get_value<std::string>();
+      if (!Options_Action_Enum_Parse(name, &action)) {
+        throw std::runtime_error("Action not supported " + name);
+      }
+      actions_.insert(action);
+    }
+  }
+
+  // the same tileset the graph reader goes by
+  const auto extract = config.get<std::string>("mjolnir.tile_extract", "");
+  tileset_ = !extract.empty() && std::filesystem::exists(extract)
+                 ? extract
+                 : config.get<std::string>("mjolnir.tile_dir", "");
+}
+
+bool response_cache_t::caches(const Options& options) const {
+  return max_bytes_ > 0 && actions_.find(options.action()) != actions_.cend();
+}
+
+std::string response_cache_t::key(const Options& options) const {
+  // the tileset as of its last modification, like the status reports it
+  std::time_t modified = 0;
+  try {
+    modified = filesystem_utils::last_write_time_t(tileset_);
+  } catch (...) {}
+  std::string key(reinterpret_cast<const char*>(&modified), sizeof(modified));
+
+  // the map fields like the costings have to come out in the same order every time
+  {
+    google::protobuf::io::StringOutputStream stream(&key);
+    google::protobuf::io::CodedOutputStream coded(&stream);
+    coded.SetSerializationDeterministic(true);
+    options.SerializeToCodedStream(&coded);
+  }
+  return key;
+}
+
+bool response_cache_t::time_dependent(const Options& options) const {
+  return live_traffic_ || options.date_time_type() != Options::no_time;
+}
+
+std::pair<response_cache_t::response_t, response_cache_t::outcome_t>
+response_cache_t::get(const std::string& key,
+                      bool time_dependent,
+                      const std::function<response_t()>& answer,
+                      const std::function<void()>* interrupt) {
+  std::promise<response_t> promise;
+  for (std::unique_lock<std::mutex> lock(lock_);; lock.lock()) {
+    auto found = entries_.find(key);
+    if (found != entries_.end()) {
+      if (clock::now() < found->second.expires) {
+        recency_.splice(recency_.begin(), recency_, found->second.recency);
+        return {found->second.response, outcome_t::hit};
+      }
+      erase(found);
+    }
+
+    // someone is on it already
+    auto flying = in_flight_.find(key);
+    if (flying == in_flight_.end()) {
+      in_flight_.emplace(key, promise.get_future().share());
+      break;
+    }
+    auto future = flying->second;
+    lock.unlock();
+
+    // the request may be given up on while it waits, and if the identical one takes too long it is
+    // answered again rather than waited on any longer
+    const auto until = clock::now() + coalesce_;
+    while (future.wait_for(kWaitInterval) != std::future_status::ready) {
+      if (interrupt) {
+        (*interrupt)();
+      }
+      if (clock::now() >= until) {
+        auto response = answer();
+        put(key, response, time_dependent, false);
+        return {response, outcome_t::miss};
+      }
+    }
+    if (auto response = future.get()) {
+      return {response, outcome_t::coalesced};
+    }
+    // they failed so one of the ones waiting tries again
+  }
+
+  // let the ones waiting go whether or not there is a response
+  response_t response;
+  try {
+    response = answer();
+  } catch (...) {
+    {
+      std::lock_guard<std::mutex> lock(lock_);
+      in_flight_.erase(key);
+    }
+    promise.set_value(nullptr);
+    throw;
+  }
+  put(key, response, time_dependent, true);
+  promise.set_value(response);
+  return {response, outcome_t::miss};
+}
+
+size_t response_cache_t::size() const {
+  std::lock_guard<std::mutex> lock(lock_);
+  return bytes_;
+}
+
+void response_cache_t::put(const std::string& key,
+                           const response_t& response,
+                           bool time_dependent,
+                           bool flying) {
+  std::lock_guard<std::mutex> lock(lock_);
+  if (flying) {
+    in_flight_.erase(key);
+  }
+  const auto bytes = key.size() + response->size();
+  if (bytes > max_bytes_) {
+    return;
+  }
+
+  // an expired one may have come back in the meantime
+  auto found = entries_.find(key);
+  if (found != entries_.end()) {
+    erase(found);
+  }
+  const auto expires = time_dependent ? clock::now() + ttl_ : clock::time_point::max();
+  auto inserted = entries_.emplace(key, entry_t{response, expires, {}}).first;
+  recency_.push_front(&inserted->first);
+  inserted->second.recency = recency_.begin();
+  bytes_ += bytes;
+
+  // make room
+  while (bytes_ > max_bytes_) {
+    erase(entries_.find(*recency_.back()));
+  }
+}
+
+void response_cache_t::erase(entries_t::iterator entry) {
+  bytes_ -= entry->first.size() + entry->second.response->size();
+  recency_.erase(entry->second.recency);
+  entries_.erase(entry);
+}
+
+} // namespace tyr
+} // namespace valhalla
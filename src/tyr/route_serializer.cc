@@ -1,4 +1,5 @@
 #include "midgard/encoded.h"
+#include "midgard/metrics.h"
 #include "proto/options.pb.h"
 #include "proto/trip.pb.h"
 #include "route_serializer_osrm.h"
@@ -68,6 +69,7 @@ namespace valhalla {
 namespace tyr {
 
 std::string serializeDirections(Api& request) {
+  midgard::metrics::stage_timer_t timer(midgard::metrics::stage_t::serialize);
   // serialize them
   switch (request.options().format()) {
     case Options_Format_osrm:
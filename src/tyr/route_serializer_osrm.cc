@@ -1,6 +1,5 @@
 #include "route_serializer_osrm.h"
 #include "baldr/admin.h"
-#include "baldr/json.h"
 #include "baldr/rapidjson_utils.h"
 #include "baldr/turnlanes.h"
 #include "exceptions.h"
@@ -20,14 +19,11 @@
 #include "tyr/serializer_constants.h"
 #include "tyr/serializers.h"
 
-#include <boost/variant/get.hpp>
-
 #ifdef INLINE_TEST
 #include <gtest/gtest.h>
 #endif
 
 #include <numeric>
-#include <sstream>
 #include <stdexcept>
 #include <string>
 #include <unordered_map>
@@ -187,7 +183,10 @@ std::unordered_map<std::string, std::pair<std::string, std::string>> speed_limit
 std::string destinations(const valhalla::TripSign& sign);
 
 // Add OSRM route summary information: distance, duration
-void route_summary(json::MapPtr& route, const valhalla::Api& api, bool imperial, int route_index) {
+void route_summary(const valhalla::Api& api,
+                   bool imperial,
+                   int route_index,
+                   rapidjson::writer_wrapper_t& writer) {
   // Compute total distance and duration
   double duration = 0;
   double distance = 0;
@@ -213,22 +212,21 @@ void route_summary(json::MapPtr& route, const valhalla::Api& api, bool imperial,
 
   // Convert distance to meters. Output distance and duration.
   distance = units_to_meters(distance, !imperial);
-  route->emplace("distance", json::fixed_t{distance, 3});
-  route->emplace("duration", json::fixed_t{duration, 3});
+  writer("distance", distance);
+  writer("duration", duration);
 
-  route->emplace("weight", json::fixed_t{weight, 3});
+  writer("weight", weight);
   assert(api.options().costings().find(api.options().costing_type())->second.has_name_case());
-  route->emplace("weight_name",
-                 api.options().costings().find(api.options().costing_type())->second.name());
+  writer("weight_name", api.options().costings().find(api.options().costing_type())->second.name());
 
   auto recosting_itr = api.options().recostings().begin();
   for (const auto& recost : recosts) {
     if (recost.first < 0) {
-      route->emplace("duration_" + recosting_itr->name(), nullptr_t());
-      route->emplace("weight_" + recosting_itr->name(), nullptr_t());
+      writer("duration_" + recosting_itr->name(), nullptr);
+      writer("weight_" + recosting_itr->name(), nullptr);
     } else {
-      route->emplace("duration_" + recosting_itr->name(), json::fixed_t{recost.first, 3});
-      route->emplace("weight_" + recosting_itr->name(), json::fixed_t{recost.second, 3});
+      writer("duration_" + recosting_itr->name(), recost.first);
+      writer("weight_" + recosting_itr->name(), recost.second);
     }
     ++recosting_itr;
   }
@@ -286,9 +284,9 @@ std::vector<PointLL> simplified_shape(const valhalla::DirectionsRoute& direction
   return simple_shape;
 }
 
-void route_geometry(json::MapPtr& route,
-                    const valhalla::DirectionsRoute& directions,
-                    const valhalla::Options& options) {
+void route_geometry(const valhalla::DirectionsRoute& directions,
+                    const valhalla::Options& options,
+                    rapidjson::writer_wrapper_t& writer) {
   if (options.shape_format() == no_shape) {
     return;
   }
@@ -301,82 +299,81 @@ void route_geometry(json::MapPtr& route,
     shape = full_shape(directions, options);
   }
   if (options.shape_format() == geojson) {
-    route->emplace("geometry", geojson_shape(shape));
+    writer.start_object("geometry");
+    geojson_shape(shape, writer);
+    writer.end_object();
   } else {
     int precision = options.shape_format() == polyline6 ? 1e6 : 1e5;
-    route->emplace("geometry", midgard::encode(shape, precision));
+    writer("geometry", midgard::encode(shape, precision));
   }
 }
 
-json::MapPtr serialize_annotations(const valhalla::TripLeg& trip_leg) {
-  auto attributes_map = json::map({});
-  attributes_map->reserve(4);
+void serialize_annotations(const valhalla::TripLeg& trip_leg, rapidjson::writer_wrapper_t& writer) {
+  writer.start_object();
 
   if (trip_leg.shape_attributes().time_size() > 0) {
-    auto duration_array = json::array({});
-    duration_array->reserve(trip_leg.shape_attributes().time_size());
+    writer.start_array("duration");
     for (const auto& time : trip_leg.shape_attributes().time()) {
       // milliseconds (ms) to seconds (sec)
-      duration_array->push_back(json::fixed_t{time * kSecPerMillisecond, 3});
+      writer(time * kSecPerMillisecond);
     }
-    attributes_map->emplace("duration", duration_array);
+    writer.end_array();
   }
 
+  writer.set_precision(1);
   if (trip_leg.shape_attributes().length_size() > 0) {
-    auto distance_array = json::array({});
-    distance_array->reserve(trip_leg.shape_attributes().length_size());
+    writer.start_array("distance");
     for (const auto& length : trip_leg.shape_attributes().length()) {
       // decimeters (dm) to meters (m)
-      distance_array->push_back(json::fixed_t{length * kMeterPerDecimeter, 1});
+      writer(length * kMeterPerDecimeter);
     }
-    attributes_map->emplace("distance", distance_array);
+    writer.end_array();
   }
 
   if (trip_leg.shape_attributes().congestion_size() > 0) {
-    auto congestion_array = json::array({});
-    congestion_array->reserve(trip_leg.shape_attributes().congestion_size());
+    writer.start_array("congestion");
     for (const auto& congestion : trip_leg.shape_attributes().congestion()) {
-      congestion_array->push_back(uint64_t(congestion));
+      writer(static_cast<uint64_t>(congestion));
     }
-    attributes_map->emplace("congestion", congestion_array);
+    writer.end_array();
   }
 
   if (trip_leg.shape_attributes().speed_size() > 0) {
-    auto speeds_array = json::array({});
-    speeds_array->reserve(trip_leg.shape_attributes().speed_size());
+    writer.start_array("speed");
     for (const auto& speed : trip_leg.shape_attributes().speed()) {
       // dm/s to m/s
-      speeds_array->push_back(json::fixed_t{speed * kMeterPerDecimeter, 1});
+      writer(speed * kMeterPerDecimeter);
     }
-    attributes_map->emplace("speed", speeds_array);
+    writer.end_array();
   }
+  writer.set_precision(tyr::kDefaultPrecision);
 
   if (trip_leg.shape_attributes().speed_limit_size() > 0) {
-    auto speed_limits_array = json::array({});
-    speed_limits_array->reserve(trip_leg.shape_attributes().speed_limit_size());
+    writer.start_array("maxspeed");
     for (const auto& speed_limit : trip_leg.shape_attributes().speed_limit()) {
-      auto speed_limit_annotation = json::map({});
+      writer.start_object();
       if (speed_limit == kUnlimitedSpeedLimit) {
-        speed_limit_annotation->emplace("none", true);
+        writer("none", true);
       } else if (speed_limit > 0) {
         // TODO support mph?
-        speed_limit_annotation->emplace("unit", kSpeedLimitUnitsKph);
-        speed_limit_annotation->emplace("speed", static_cast<uint64_t>(speed_limit));
+        writer("unit", kSpeedLimitUnitsKph);
+        writer("speed", static_cast<uint64_t>(speed_limit));
       } else {
-        speed_limit_annotation->emplace("unknown", true);
+        writer("unknown", true);
       }
-      speed_limits_array->push_back(speed_limit_annotation);
+      writer.end_object();
     }
-    attributes_map->emplace("maxspeed", speed_limits_array);
+    writer.end_array();
   }
 
-  return attributes_map;
+  writer.end_object();
 }
 
 // Serialize waypoints for optimized route. Note that OSRM retains the
 // original location order, and stores an index for the waypoint index in
 // the optimized sequence.
-json::ArrayPtr waypoints(google::protobuf::RepeatedPtrField<valhalla::Location>& locs) {
+void waypoints(google::protobuf::RepeatedPtrField<valhalla::Location>& locs,
+               rapidjson::writer_wrapper_t& writer) {
   // Create a vector of indexes.
   std::vector<uint32_t> indexes(locs.size());
   std::iota(indexes.begin(), indexes.end(), 0);
@@ -388,12 +385,10 @@ json::ArrayPtr waypoints(google::protobuf::RepeatedPtrField<valhalla::Location>&
 
   // Output each location in its original index order along with its
   // waypoint index (which is the index in the optimized order).
-  auto waypoints = json::array({});
   for (const auto& index : indexes) {
     locs.Mutable(index)->mutable_correlation()->set_waypoint_index(index);
-    waypoints->emplace_back(osrm::waypoint(locs.Get(index), false, true));
+    osrm::waypoint(locs.Get(index), writer, false, true);
   }
-  return waypoints;
 }
 
 // Simple structure for storing intersection data
@@ -413,63 +408,61 @@ struct IntersectionEdges {
 };
 
 // Process 'indications' array - add indications from left to right
-json::ArrayPtr lane_indications(const bool drive_on_right, const uint16_t mask) {
-  auto indications = json::array({});
-
+void lane_indications(const bool drive_on_right,
+                      const uint16_t mask,
+                      rapidjson::writer_wrapper_t& writer) {
   // TODO make map for lane mask to osrm indication string
 
   // reverse (left u-turn)
   if (mask & kTurnLaneReverse && drive_on_right) {
-    indications->emplace_back(osrmconstants::kModifierUturn);
+    writer(osrmconstants::kModifierUturn);
   }
   // sharp_left
   if (mask & kTurnLaneSharpLeft) {
-    indications->emplace_back(osrmconstants::kModifierSharpLeft);
+    writer(osrmconstants::kModifierSharpLeft);
   }
   // left
   if (mask & kTurnLaneLeft) {
-    indications->emplace_back(osrmconstants::kModifierLeft);
+    writer(osrmconstants::kModifierLeft);
   }
   // slight_left
   if (mask & kTurnLaneSlightLeft) {
-    indications->emplace_back(osrmconstants::kModifierSlightLeft);
+    writer(osrmconstants::kModifierSlightLeft);
   }
   // through
   if (mask & kTurnLaneThrough) {
-    indications->emplace_back(osrmconstants::kModifierStraight);
+    writer(osrmconstants::kModifierStraight);
   }
   // slight_right
   if (mask & kTurnLaneSlightRight) {
-    indications->emplace_back(osrmconstants::kModifierSlightRight);
+    writer(osrmconstants::kModifierSlightRight);
   }
   // right
   if (mask & kTurnLaneRight) {
-    indications->emplace_back(osrmconstants::kModifierRight);
+    writer(osrmconstants::kModifierRight);
   }
   // sharp_right
   if (mask & kTurnLaneSharpRight) {
-    indications->emplace_back(osrmconstants::kModifierSharpRight);
+    writer(osrmconstants::kModifierSharpRight);
   }
   // reverse (right u-turn)
   if (mask & kTurnLaneReverse && !drive_on_right) {
-    indications->emplace_back(osrmconstants::kModifierUturn);
+    writer(osrmconstants::kModifierUturn);
   }
-  return indications;
 }
 
 // Add intersections along a step/maneuver.
-json::ArrayPtr intersections(const valhalla::DirectionsLeg::Maneuver& maneuver,
-                             valhalla::odin::EnhancedTripLeg* etp,
-                             const std::vector<PointLL>& shape,
-                             uint32_t& count,
-                             const bool arrive_maneuver,
-                             const baldr::AttributesController& controller) {
+void intersections(const valhalla::DirectionsLeg::Maneuver& maneuver,
+                   valhalla::odin::EnhancedTripLeg* etp,
+                   const std::vector<PointLL>& shape,
+                   const bool arrive_maneuver,
+                   const baldr::AttributesController& controller,
+                   rapidjson::writer_wrapper_t& writer) {
   // Iterate through the nodes/intersections of the path for this maneuver
-  count = 0;
-  auto intersections = json::array({});
+  writer.start_array("intersections");
   uint32_t n = arrive_maneuver ? maneuver.end_path_index() + 1 : maneuver.end_path_index();
   for (uint32_t i = maneuver.begin_path_index(); i < n; i++) {
-    auto intersection = json::map({});
+    writer.start_object();
 
     // Get the node and current edge from the enhanced trip path
     // NOTE: curr_edge does not exist for the arrive maneuver
@@ -479,55 +472,60 @@ json::ArrayPtr intersections(const valhalla::DirectionsLeg::Maneuver& maneuver,
 
     // Add the node location (lon, lat). Use the last shape point for
     // the arrive step
-    auto loc = json::array({});
     size_t shape_index = arrive_maneuver ? shape.size() - 1 : curr_edge->begin_shape_index();
     PointLL ll = shape[shape_index];
-    loc->emplace_back(json::fixed_t{ll.lng(), 6});
-    loc->emplace_back(json::fixed_t{ll.lat(), 6});
-    intersection->emplace("location", loc);
-    intersection->emplace("geometry_index", static_cast<uint64_t>(shape_index));
+    writer.start_array("location");
+    writer.set_precision(tyr::kCoordinatePrecision);
+    writer(ll.lng());
+    writer(ll.lat());
+    writer.set_precision(tyr::kDefaultPrecision);
+    writer.end_array();
+    writer("geometry_index", static_cast<uint64_t>(shape_index));
 
     // Add index into admin list
     if (controller(kNodeAdminIndex)) {
-      intersection->emplace("admin_index", static_cast<uint64_t>(node->admin_index()));
+      writer("admin_index", static_cast<uint64_t>(node->admin_index()));
     }
 
     if (!arrive_maneuver && controller(kEdgeIsUrban)) {
-      intersection->emplace("is_urban", curr_edge->is_urban());
+      writer("is_urban", curr_edge->is_urban());
     }
 
-    auto toll_collection = json::map({});
     if (node->type() == TripLeg_Node::kTollBooth) {
-      toll_collection->emplace("type", std::string("toll_booth"));
+      writer.start_object("toll_collection");
+      writer("type", "toll_booth");
+      writer.end_object();
     } else if (node->type() == TripLeg_Node::kTollGantry) {
-      toll_collection->emplace("type", std::string("toll_gantry"));
+      writer.start_object("toll_collection");
+      writer("type", "toll_gantry");
+      writer.end_object();
     }
-    if (!toll_collection->empty())
-      intersection->emplace("toll_collection", toll_collection);
 
     if (node->cost().transition_cost().seconds() > 0)
-      intersection->emplace("turn_duration",
-                            json::fixed_t{node->cost().transition_cost().seconds(), 3});
+      writer("turn_duration", node->cost().transition_cost().seconds());
     if (node->cost().transition_cost().cost() > 0)
-      intersection->emplace("turn_weight", json::fixed_t{node->cost().transition_cost().cost(), 3});
+      writer("turn_weight", node->cost().transition_cost().cost());
     auto next_node = i + 1 < n ? etp->GetEnhancedNode(i + 1) : nullptr;
     if (next_node) {
       auto secs = next_node->cost().elapsed_cost().seconds() - node->cost().elapsed_cost().seconds();
       auto cost = next_node->cost().elapsed_cost().cost() - node->cost().elapsed_cost().cost();
       if (secs > 0)
-        intersection->emplace("duration", json::fixed_t{secs, 3});
+        writer("duration", secs);
       if (cost > 0)
-        intersection->emplace("weight", json::fixed_t{cost, 3});
+        writer("weight", cost);
     }
 
     // TODO: add recosted durations to the intersection?
 
     // Add rest_stop when passing by a rest_area or service_area
     if (i > 0 && !arrive_maneuver) {
-      auto rest_stop = json::map({});
       for (int m = 0; m < node->intersecting_edge_size(); m++) {
         auto intersecting_edge = node->GetIntersectingEdge(m);
         bool routeable = intersecting_edge->IsTraversableOutbound(curr_edge->travel_mode());
+        bool rest_area = intersecting_edge->use() == TripLeg_Use_kRestAreaUse;
+        if (!routeable || (!rest_area && intersecting_edge->use() != TripLeg_Use_kServiceAreaUse)) {
+          continue;
+        }
 
         std::string sign_text;
         if (intersecting_edge->has_sign()) {
@@ -539,21 +537,13 @@ json::ArrayPtr intersections(const valhalla::DirectionsLeg::Maneuver& maneuver,
           sign_text = destinations(trip_leg_sign);
         }
 
-        if (routeable && intersecting_edge->use() == TripLeg_Use_kRestAreaUse) {
-          rest_stop->emplace("type", std::string("rest_area"));
-          if (!sign_text.empty()) {
-            rest_stop->emplace("name", sign_text);
-          }
-          intersection->emplace("rest_stop", rest_stop);
-          break;
-        } else if (routeable && intersecting_edge->use() == TripLeg_Use_kServiceAreaUse) {
-          rest_stop->emplace("type", std::string("service_area"));
-          if (!sign_text.empty()) {
-            rest_stop->emplace("name", sign_text);
-          }
-          intersection->emplace("rest_stop", rest_stop);
-          break;
+        writer.start_object("rest_stop");
+        writer("type", rest_area ? "rest_area" : "service_area");
+        if (!sign_text.empty()) {
+          writer("name", sign_text);
         }
+        writer.end_object();
+        break;
       }
     }
 
@@ -583,10 +573,6 @@ json::ArrayPtr intersections(const valhalla::DirectionsLeg::Maneuver& maneuver,
       edges.emplace_back(((prior_heading + 180) % 360), entry, true, false);
     }
 
-    // Create bearing and entry output
-    auto bearings = json::array({});
-    auto entries = json::array({});
-
     // Sort edges by increasing bearing and update the in/out edge indexes
     std::sort(edges.begin(), edges.end());
     uint32_t incoming_index = 0, outgoing_index = 0;
@@ -597,27 +583,35 @@ json::ArrayPtr intersections(const valhalla::DirectionsLeg::Maneuver& maneuver,
       if (edges[n].out_edge) {
         outgoing_index = n;
       }
-      bearings->emplace_back(static_cast<uint64_t>(edges[n].bearing));
-      entries->emplace_back(edges[n].routeable);
     }
 
     // Add the index of the input edge and output edge
     if (i > 0) {
-      intersection->emplace("in", static_cast<uint64_t>(incoming_index));
+      writer("in", static_cast<uint64_t>(incoming_index));
     }
     if (!arrive_maneuver) {
-      intersection->emplace("out", static_cast<uint64_t>(outgoing_index));
+      writer("out", static_cast<uint64_t>(outgoing_index));
     }
 
-    intersection->emplace("entry", entries);
-    intersection->emplace("bearings", bearings);
+    // Create bearing and entry output
+    writer.start_array("entry");
+    for (const auto& edge : edges) {
+      writer(edge.routeable);
+    }
+    writer.end_array();
+    writer.start_array("bearings");
+    for (const auto& edge : edges) {
+      writer(static_cast<uint64_t>(edge.bearing));
+    }
+    writer.end_array();
 
     // Add tunnel_name for tunnels
     if (!arrive_maneuver) {
       if (curr_edge->tunnel() && !curr_edge->tagged_value().empty()) {
         for (const auto& e : curr_edge->tagged_value()) {
           if (e.type() == TaggedValue_Type_kTunnel) {
-            intersection->emplace("tunnel_name", e.value());
+            writer("tunnel_name", e.value());
+            break;
           }
         }
       }
@@ -644,11 +638,11 @@ json::ArrayPtr intersections(const valhalla::DirectionsLeg::Maneuver& maneuver,
         classes.push_back("restricted");
       }
       if (classes.size() > 0) {
-        auto class_list = json::array({});
+        writer.start_array("classes");
         for (const auto& cl : classes) {
-          class_list->emplace_back(cl);
+          writer(cl);
         }
-        intersection->emplace("classes", class_list);
+        writer.end_array();
       }
     }
 
@@ -657,31 +651,31 @@ json::ArrayPtr intersections(const valhalla::DirectionsLeg::Maneuver& maneuver,
     // Verify that turn lanes are not non-directional
     if (prev_edge && (prev_edge->turn_lanes_size() > 0) && prev_edge->HasActiveTurnLane() &&
         !prev_edge->HasNonDirectionalTurnLane()) {
-      auto lanes = json::array({});
+      writer.start_array("lanes");
       for (const auto& turn_lane : prev_edge->turn_lanes()) {
-        auto lane = json::map({});
+        writer.start_object();
         // Process 'valid' & 'active' flags
         bool is_active = turn_lane.state() == TurnLane::kActive;
         // an active lane is also valid
         bool is_valid = is_active || turn_lane.state() == TurnLane::kValid;
-        lane->emplace("active", is_active);
-        lane->emplace("valid", is_valid);
+        writer("active", is_active);
+        writer("valid", is_valid);
         // Add valid_indication for a valid & active lanes
         if (turn_lane.state() != TurnLane::kInvalid) {
-          lane->emplace("valid_indication", turn_lane_direction(turn_lane.active_direction()));
+          writer("valid_indication", turn_lane_direction(turn_lane.active_direction()));
         }
-        lane->emplace("indications",
-                      lane_indications(prev_edge->drive_on_right(), turn_lane.directions_mask()));
-        lanes->emplace_back(std::move(lane));
+        writer.start_array("indications");
+        lane_indications(prev_edge->drive_on_right(), turn_lane.directions_mask(), writer);
+        writer.end_array();
+        writer.end_object();
       }
-      intersection->emplace("lanes", std::move(lanes));
+      writer.end_array();
     }
 
-    // Add the intersection to the JSON array
-    intersections->emplace_back(intersection);
-    count++;
+    // Close the intersection
+    writer.end_object();
   }
-  return intersections;
+  writer.end_array();
 }
 
 // Add exits (exit numbers) along a step/maneuver.
@@ -697,54 +691,38 @@ std::string exits(const valhalla::TripSign& sign) {
   return exits;
 }
 
-valhalla::baldr::json::RawJSON serializeIncident(const TripLeg::Incident& incident) {
-  rapidjson::writer_wrapper_t writer;
-  writer.start_object();
-  osrm::serializeIncidentProperties(writer, incident.metadata(), incident.begin_shape_index(),
-                                    incident.end_shape_index(), "", "");
-  writer.end_object();
-  return {writer.get_buffer()};
-}
-
-// Serializes incidents and adds to json-document
+// Serializes incidents into the leg
 void serializeIncidents(const google::protobuf::RepeatedPtrField<TripLeg::Incident>& incidents,
-                        json::Jmap& doc) {
+                        rapidjson::writer_wrapper_t& writer) {
   if (incidents.size() == 0) {
     // No incidents, nothing to do
     return;
   }
-  json::ArrayPtr serialized_incidents = std::make_shared<json::Jarray>();
-  {
-    // Bring up any already existing array
-    auto existing = doc.find("incidents");
-    if (existing != doc.end()) {
-      if (auto* ptr = boost::get<std::shared_ptr<valhalla::baldr::json::Jarray>>(&existing->second)) {
-        serialized_incidents = *ptr;
-      } else {
-        throw std::logic_error("Invalid state: stored ptr should not be null");
-      }
-    }
-  }
+  // the display location of incidents is written at full precision
+  writer.set_precision(rapidjson::Writer<rapidjson::StringBuffer>::kDefaultMaxDecimalPlaces);
+  writer.start_array("incidents");
   for (const auto& incident : incidents) {
-    auto json_incident = serializeIncident(incident);
-    serialized_incidents->emplace_back(json_incident);
+    writer.start_object();
+    osrm::serializeIncidentProperties(writer, incident.metadata(), incident.begin_shape_index(),
+                                      incident.end_shape_index(), "", "");
+    writer.end_object();
   }
-  doc.emplace("incidents", serialized_incidents);
+  writer.end_array();
+  writer.set_precision(tyr::kDefaultPrecision);
 }
 
-void serializeClosures(const valhalla::TripLeg& leg, json::Jmap& doc) {
+void serializeClosures(const valhalla::TripLeg& leg, rapidjson::writer_wrapper_t& writer) {
   if (!leg.closures_size()) {
     return;
   }
-  auto closures = json::array({});
-  closures->reserve(leg.closures_size());
+  writer.start_array("closures");
   for (const valhalla::TripLeg_Closure& closure : leg.closures()) {
-    auto closure_obj = json::map({});
-    closure_obj->emplace("geometry_index_start", static_cast<uint64_t>(closure.begin_shape_index()));
-    closure_obj->emplace("geometry_index_end", static_cast<uint64_t>(closure.end_shape_index()));
-    closures->emplace_back(std::move(closure_obj));
+    writer.start_object();
+    writer("geometry_index_start", static_cast<uint64_t>(closure.begin_shape_index()));
+    writer("geometry_index_end", static_cast<uint64_t>(closure.end_shape_index()));
+    writer.end_object();
   }
-  doc.emplace("closures", closures);
+  writer.end_array();
 }
 
 // Compile and return the refs of the specified list
@@ -1153,96 +1131,102 @@ std::string maneuver_type(const valhalla::DirectionsLeg::Maneuver& maneuver,
 }
 
 // Populate the OSRM maneuver record within a step.
-json::MapPtr osrm_maneuver(const valhalla::DirectionsLeg::Maneuver& maneuver,
-                           const std::string& maneuver_type,
-                           const std::string& modifier,
-                           const uint32_t in_brg,
-                           const uint32_t out_brg,
-                           const PointLL& man_ll,
-                           const bool emplace_instructions) {
-  auto osrm_man = json::map({});
+void osrm_maneuver(const valhalla::DirectionsLeg::Maneuver& maneuver,
+                   const std::string& maneuver_type,
+                   const std::string& modifier,
+                   const uint32_t in_brg,
+                   const uint32_t out_brg,
+                   const PointLL& man_ll,
+                   const bool emplace_instructions,
+                   rapidjson::writer_wrapper_t& writer) {
+  writer.start_object("maneuver");
 
   // Set the location
-  auto loc = json::array({});
-  loc->emplace_back(json::fixed_t{man_ll.lng(), 6});
-  loc->emplace_back(json::fixed_t{man_ll.lat(), 6});
-  osrm_man->emplace("location", loc);
+  writer.start_array("location");
+  writer.set_precision(tyr::kCoordinatePrecision);
+  writer(man_ll.lng());
+  writer(man_ll.lat());
+  writer.set_precision(tyr::kDefaultPrecision);
+  writer.end_array();
 
-  osrm_man->emplace("bearing_before", static_cast<uint64_t>(in_brg));
-  osrm_man->emplace("bearing_after", static_cast<uint64_t>(out_brg));
-  osrm_man->emplace("type", maneuver_type);
+  writer("bearing_before", static_cast<uint64_t>(in_brg));
+  writer("bearing_after", static_cast<uint64_t>(out_brg));
+  writer("type", maneuver_type);
 
   if (emplace_instructions) {
-    osrm_man->emplace("instruction", maneuver.text_instruction());
+    writer("instruction", maneuver.text_instruction());
   }
   if (!modifier.empty()) {
-    osrm_man->emplace("modifier", modifier);
+    writer("modifier", modifier);
   }
   // Roundabout count
   if (maneuver.type() == DirectionsLeg_Maneuver_Type_kRoundaboutEnter &&
       maneuver.roundabout_exit_count() > 0) {
-    osrm_man->emplace("exit", static_cast<uint64_t>(maneuver.roundabout_exit_count()));
+    writer("exit", static_cast<uint64_t>(maneuver.roundabout_exit_count()));
   }
 
-  return osrm_man;
+  writer.end_object();
 }
 
-// Return a banner component
-json::MapPtr banner_component(const std::string& type, const std::string& text) {
-  json::MapPtr component = json::map({});
-  component->emplace("type", type);
-  component->emplace("text", text);
-  return component;
+// Write a banner component
+void banner_component(const std::string& type,
+                      const std::string& text,
+                      rapidjson::writer_wrapper_t& writer) {
+  writer.start_object();
+  writer("type", type);
+  writer("text", text);
+  writer.end_object();
 }
 
 // Primary banners hold the most important information and supposed to be the large text in a
 // navigation app. Mostly they are used to show the primary_banner of the upcoming road.
 // TODO: Highway shield information could be added here as well.
-json::MapPtr primary_banner_instruction(const std::string& primary_text,
-                                        const std::string& ref,
-                                        const std::string& exit,
-                                        const bool arrive_maneuver,
-                                        const std::string& maneuver_type,
-                                        const std::string& modifier,
-                                        const bool roundabout,
-                                        const uint32_t roundabout_turn_degrees,
-                                        const std::string& drive_side) {
-  json::MapPtr instruction = json::map({});
-  json::ArrayPtr components = json::array({});
-
+void primary_banner_instruction(const std::string& primary_text,
+                                const std::string& ref,
+                                const std::string& exit,
+                                const bool arrive_maneuver,
+                                const std::string& maneuver_type,
+                                const std::string& modifier,
+                                const bool roundabout,
+                                const uint32_t roundabout_turn_degrees,
+                                const std::string& drive_side,
+                                rapidjson::writer_wrapper_t& writer) {
+  writer.start_object("primary");
+  writer.start_array("components");
   if (!exit.empty() && !arrive_maneuver) {
-    components->emplace_back(banner_component("exit", "Exit"));
-    components->emplace_back(banner_component("exit-number", exit));
+    banner_component("exit", "Exit", writer);
+    banner_component("exit-number", exit, writer);
   }
-  components->emplace_back(banner_component("text", primary_text));
+  banner_component("text", primary_text, writer);
   if (!ref.empty() && !arrive_maneuver) {
-    components->emplace_back(banner_component("delimiter", "/"));
-    components->emplace_back(banner_component("text", ref));
+    banner_component("delimiter", "/", writer);
+    banner_component("text", ref, writer);
   }
-  instruction->emplace("components", std::move(components));
-  instruction->emplace("text", primary_text);
+  writer.end_array();
+  writer("text", primary_text);
   if (!maneuver_type.empty()) {
-    instruction->emplace("type", maneuver_type);
+    writer("type", maneuver_type);
   }
   if (!modifier.empty()) {
-    instruction->emplace("modifier", modifier);
+    writer("modifier", modifier);
   }
   if (roundabout) {
-    instruction->emplace("degrees", static_cast<uint64_t>(roundabout_turn_degrees));
-    instruction->emplace("driving_side", drive_side);
+    writer("degrees", static_cast<uint64_t>(roundabout_turn_degrees));
+    writer("driving_side", drive_side);
   }
-  return instruction;
+  writer.end_object();
 }
 
 // Secondary banners hold additional information which is displayed slightly smaller than the
 // primary information. They are mostly used to show the destination names on street signs.
-json::MapPtr secondary_banner_instruction(const std::string& secondary_text) {
-  json::MapPtr instruction = json::map({});
-  json::ArrayPtr components = json::array({});
-  components->emplace_back(banner_component("text", secondary_text));
-  instruction->emplace("components", std::move(components));
-  instruction->emplace("text", secondary_text);
-  return instruction;
+void secondary_banner_instruction(const std::string& secondary_text,
+                                  rapidjson::writer_wrapper_t& writer) {
+  writer.start_object("secondary");
+  writer.start_array("components");
+  banner_component("text", secondary_text, writer);
+  writer.end_array();
+  writer("text", secondary_text);
+  writer.end_object();
 }
 
 // Sub Banner Instructions are used to indicate which lane to use when multiple lanes are
@@ -1250,12 +1234,11 @@ json::MapPtr secondary_banner_instruction(const std::string& secondary_text) {
 // The new bannerInstruction object's distanceAlongGeometry is determined by the first
 // intersection which carries the lane information.
 //
-// This is very similar to the lane indication of the last intersection(s).
-json::MapPtr sub_banner_instruction(const valhalla::DirectionsLeg::Maneuver* prev_maneuver,
-                                    valhalla::odin::EnhancedTripLeg* etp) {
-  json::MapPtr instruction = nullptr;
-  json::ArrayPtr lanes = nullptr;
-
+// This is very similar to the lane indication of the last intersection(s). Returns the edge
+// which holds the lanes, nullptr if there is no sub banner for the maneuver.
+std::unique_ptr<EnhancedTripLeg_Edge>
+sub_banner_edge(const valhalla::DirectionsLeg::Maneuver* prev_maneuver,
+                valhalla::odin::EnhancedTripLeg* etp) {
   // We only care about the lanes directly before the end of the maneuver
   auto edge = etp->GetPrevEdge(prev_maneuver->end_path_index());
 
@@ -1264,27 +1247,31 @@ json::MapPtr sub_banner_instruction(const valhalla::DirectionsLeg::Maneuver* pre
   // Verify that turn lanes are not non-directional
   if (edge && (edge->turn_lanes_size() > 0) && edge->HasActiveTurnLane() &&
       !edge->HasNonDirectionalTurnLane()) {
-    lanes = json::array({});
-    for (const auto& turn_lane : edge->turn_lanes()) {
-      auto lane = banner_component("lane", "");
-      lane->emplace("active", turn_lane.state() == TurnLane::kActive);
-      // Add active_direction for a valid & active lanes
-      if (turn_lane.state() != TurnLane::kInvalid) {
-        lane->emplace("active_direction", turn_lane_direction(turn_lane.active_direction()));
-      }
-      lane->emplace("directions",
-                    lane_indications(edge->drive_on_right(), turn_lane.directions_mask()));
-      lanes->emplace_back(std::move(lane));
-    }
+    return edge;
   }
+  return nullptr;
+}
 
-  if (lanes != nullptr) {
-    instruction = json::map({});
-    instruction->emplace("components", std::move(lanes));
-    instruction->emplace("text", std::string(""));
+void sub_banner_instruction(const EnhancedTripLeg_Edge& edge, rapidjson::writer_wrapper_t& writer) {
+  writer.start_object("sub");
+  writer.start_array("components");
+  for (const auto& turn_lane : edge.turn_lanes()) {
+    writer.start_object();
+    writer("type", "lane");
+    writer("text", "");
+    writer("active", turn_lane.state() == TurnLane::kActive);
+    // Add active_direction for a valid & active lanes
+    if (turn_lane.state() != TurnLane::kInvalid) {
+      writer("active_direction", turn_lane_direction(turn_lane.active_direction()));
+    }
+    writer.start_array("directions");
+    lane_indications(edge.drive_on_right(), turn_lane.directions_mask(), writer);
+    writer.end_array();
+    writer.end_object();
   }
-
-  return instruction;
+  writer.end_array();
+  writer("text", "");
+  writer.end_object();
 }
 
 // The roundabout_turn_degrees is approximated by comparing the heading of the last edge
@@ -1333,26 +1320,24 @@ uint32_t calc_roundabout_turn_degrees(const valhalla::DirectionsLeg::Maneuver* p
 
 // Populate the bannerInstructions within a step.
 // bannerInstructions are a unified object of maneuvers name, dest, ref and intersection.lanes
-json::ArrayPtr banner_instructions(const std::string& name,
-                                   const std::string& dest,
-                                   const std::string& ref,
-                                   const valhalla::DirectionsLeg::Maneuver* prev_maneuver,
-                                   const valhalla::DirectionsLeg::Maneuver& maneuver,
-                                   const bool arrive_maneuver,
-                                   valhalla::odin::EnhancedTripLeg* etp,
-                                   const std::string& maneuver_type,
-                                   const std::string& modifier,
-                                   const std::string& exit,
-                                   const double distance,
-                                   const std::string& drive_side) {
+void banner_instructions(const std::string& name,
+                         const std::string& dest,
+                         const std::string& ref,
+                         const valhalla::DirectionsLeg::Maneuver* prev_maneuver,
+                         const valhalla::DirectionsLeg::Maneuver& maneuver,
+                         const bool arrive_maneuver,
+                         valhalla::odin::EnhancedTripLeg* etp,
+                         const std::string& maneuver_type,
+                         const std::string& modifier,
+                         const std::string& exit,
+                         const double distance,
+                         const std::string& drive_side,
+                         rapidjson::writer_wrapper_t& writer) {
   // bannerInstructions is an array, because there may be multiple similar banner instruction
   // objects. Mostly if the 'sub' attribute is to be added along the current step, a new
   // instruction is created and the primary and secondary instructions are repeated with the
   // additional 'sub' attribute and an updated 'distanceAlongGeometry', which is from where on
   // this banner will be shown.
-  json::ArrayPtr banner_instructions_array = json::array({});
-  json::MapPtr banner_instruction_main = json::map({});
-
   std::string primary_text = name;
   std::string secondary_text = dest;
   std::string ref_ = ref;
@@ -1378,58 +1363,40 @@ json::ArrayPtr banner_instructions(const std::string& name,
   uint32_t roundabout_turn_degrees =
       roundabout ? calc_roundabout_turn_degrees(prev_maneuver, maneuver, etp) : 0;
 
-  // distanceAlongGeometry is the distance along the current step from where on this
-  // banner should be visible. The first banner starts at the beginning.
-  banner_instruction_main->emplace("distanceAlongGeometry", json::fixed_t{distance, 3});
-  banner_instruction_main->emplace("primary",
-                                   primary_banner_instruction(primary_text, ref_, exit,
-                                                              arrive_maneuver, maneuver_type,
-                                                              modifier, roundabout,
-                                                              roundabout_turn_degrees, drive_side));
-
-  if (!secondary_text.empty()) {
-    banner_instruction_main->emplace("secondary", secondary_banner_instruction(secondary_text));
-  }
-
-  json::MapPtr sub_banner = sub_banner_instruction(prev_maneuver, etp);
-
-  json::MapPtr banner_instruction_with_sub = nullptr;
-  if (sub_banner != nullptr) {
-    if (distance > 400) {
-      banner_instruction_with_sub = json::map({});
-      banner_instruction_with_sub->emplace("sub", std::move(sub_banner));
-      if (!secondary_text.empty()) {
-        banner_instruction_with_sub->emplace("secondary",
-                                             secondary_banner_instruction(secondary_text));
-      }
-      banner_instruction_with_sub->emplace("primary",
-                                           primary_banner_instruction(primary_text, ref_, exit,
-                                                                      arrive_maneuver, maneuver_type,
-                                                                      modifier, roundabout,
-                                                                      roundabout_turn_degrees,
-                                                                      drive_side));
-      banner_instruction_with_sub->emplace("distanceAlongGeometry", json::fixed_t{400, 3});
-    } else {
-      banner_instruction_main->emplace("sub", std::move(sub_banner));
+  // The lanes are shown in the main banner if the step is short, otherwise they get a banner of
+  // their own towards the end of the step
+  auto sub_edge = sub_banner_edge(prev_maneuver, etp);
+  auto banner_instruction = [&](double distance_along_geometry, bool with_sub) {
+    // distanceAlongGeometry is the distance along the current step from where on this
+    // banner should be visible. The first banner starts at the beginning.
+    writer.start_object();
+    writer("distanceAlongGeometry", distance_along_geometry);
+    primary_banner_instruction(primary_text, ref_, exit, arrive_maneuver, maneuver_type, modifier,
+                               roundabout, roundabout_turn_degrees, drive_side, writer);
+    if (!secondary_text.empty()) {
+      secondary_banner_instruction(secondary_text, writer);
     }
-  }
-
-  banner_instructions_array->emplace_back(std::move(banner_instruction_main));
+    if (with_sub) {
+      sub_banner_instruction(*sub_edge, writer);
+    }
+    writer.end_object();
+  };
 
-  if (banner_instruction_with_sub != nullptr) {
-    banner_instructions_array->emplace_back(std::move(banner_instruction_with_sub));
+  writer.start_array("bannerInstructions");
+  banner_instruction(distance, sub_edge && distance <= 400);
+  if (sub_edge && distance > 400) {
+    banner_instruction(400, true);
   }
-
-  return banner_instructions_array;
+  writer.end_array();
 }
 
 // Method to get the geometry string for a maneuver.
-void maneuver_geometry(json::MapPtr& step,
-                       const uint32_t begin_idx,
+void maneuver_geometry(const uint32_t begin_idx,
                        const uint32_t end_idx,
                        const std::vector<PointLL>& shape,
                        bool is_arrive_maneuver,
-                       const valhalla::Options& options) {
+                       const valhalla::Options& options,
+                       rapidjson::writer_wrapper_t& writer) {
   // Must add one to the end range since maneuver end shape index is exclusive
   std::vector<PointLL> maneuver_shape(shape.begin() + begin_idx, shape.begin() + end_idx + 1);
   // Last maneuver shape is a linestring with two identical points at the destination
@@ -1438,10 +1405,12 @@ void maneuver_geometry(json::MapPtr& step,
   }
 
   if (options.shape_format() == geojson) {
-    step->emplace("geometry", geojson_shape(maneuver_shape));
+    writer.start_object("geometry");
+    geojson_shape(maneuver_shape, writer);
+    writer.end_object();
   } else {
     int precision = options.shape_format() == polyline6 ? 1e6 : 1e5;
-    step->emplace("geometry", midgard::encode(maneuver_shape, precision));
+    writer("geometry", midgard::encode(maneuver_shape, precision));
   }
 }
 
@@ -1496,21 +1465,24 @@ float distance_along_geometry(const valhalla::DirectionsLeg::Maneuver* prev_mane
 
 void addVoiceInstruction(const std::string& instruction,
                          double distance_along_geometry,
-                         json::ArrayPtr& voice_instructions) {
-  json::MapPtr voice_instruction = json::map({});
-  voice_instruction->emplace("distanceAlongGeometry", json::fixed_t{distance_along_geometry, 1});
-  voice_instruction->emplace("announcement", instruction);
-  voice_instruction->emplace("ssmlAnnouncement", "<speak>" + instruction + "</speak>");
-  voice_instructions->emplace_back(std::move(voice_instruction));
+                         rapidjson::writer_wrapper_t& writer) {
+  writer.start_object();
+  writer.set_precision(1);
+  writer("distanceAlongGeometry", distance_along_geometry);
+  writer.set_precision(tyr::kDefaultPrecision);
+  writer("announcement", instruction);
+  writer("ssmlAnnouncement", "<speak>" + instruction + "</speak>");
+  writer.end_object();
 }
 
 // Populate the voiceInstructions within a step.
-json::ArrayPtr voice_instructions(const valhalla::DirectionsLeg::Maneuver* prev_maneuver,
-                                  const valhalla::DirectionsLeg::Maneuver& maneuver,
-                                  const double distance,
-                                  const uint32_t maneuver_index,
-                                  valhalla::odin::EnhancedTripLeg* etp,
-                                  const valhalla::Options& options) {
+void voice_instructions(const valhalla::DirectionsLeg::Maneuver* prev_maneuver,
+                        const valhalla::DirectionsLeg::Maneuver& maneuver,
+                        const double distance,
+                        const uint32_t maneuver_index,
+                        valhalla::odin::EnhancedTripLeg* etp,
+                        const valhalla::Options& options,
+                        rapidjson::writer_wrapper_t& writer) {
   // narrative builder for custom pre alert instructions
   // TODO: actually we should build the alert instructions with enhanced distance information during
   // building the maneuver. The would require enhancing the voice instructions of the maneuver
@@ -1521,7 +1493,7 @@ json::ArrayPtr voice_instructions(const valhalla::DirectionsLeg::Maneuver* prev_
 
   // voiceInstructions is an array, because there may be similar voice instructions.
   // When the step is long enough, there may be multiple voice instructions.
-  json::ArrayPtr voice_instructions = json::array({});
+  writer.start_array("voiceInstructions");
 
   // distanceAlongGeometry is the distance along the current step from where on this
   // voice instruction should be played. It is measured from the end of the maneuver.
@@ -1561,7 +1533,7 @@ json::ArrayPtr voice_instructions(const valhalla::DirectionsLeg::Maneuver* prev_
     // This voice_instruction_start is only created once. It is always played, even when
     // the maneuver would otherwise be too short.
     addVoiceInstruction(prev_maneuver->verbal_pre_transition_instruction(), double(distance),
-                        voice_instructions);
+                        writer);
   } else if (distance_before_verbal_transition_alert_instruction >= 0.0 &&
              distance > distance_before_verbal_transition_alert_instruction +
                             APPROXIMATE_VERBAL_POSTRANSITION_LENGTH &&
@@ -1576,7 +1548,7 @@ json::ArrayPtr voice_instructions(const valhalla::DirectionsLeg::Maneuver* prev_
     // meters to play + the 10 meters after the maneuver start which is added so that the
     // instruction is not played directly on the intersection where the maneuver starts.
     addVoiceInstruction(prev_maneuver->verbal_post_transition_instruction(), double(distance - 10),
-                        voice_instructions);
+                        writer);
   }
 
   // If there is an alert instruction and we have enough time to play it, we will play it
@@ -1601,7 +1573,7 @@ json::ArrayPtr voice_instructions(const valhalla::DirectionsLeg::Maneuver* prev_
             ->FormVerbalAlertApproachInstruction(distance_km,
                                                  maneuver.verbal_transition_alert_instruction());
     addVoiceInstruction(instruction, distance_before_verbal_transition_alert_instruction,
-                        voice_instructions);
+                        writer);
   }
 
   // add pre transition instruction if available
@@ -1614,10 +1586,10 @@ json::ArrayPtr voice_instructions(const valhalla::DirectionsLeg::Maneuver* prev_
       distance_before_verbal_pre_transition_instruction = distance / 4;
     }
     addVoiceInstruction(maneuver.verbal_pre_transition_instruction(),
-                        distance_before_verbal_pre_transition_instruction, voice_instructions);
+                        distance_before_verbal_pre_transition_instruction, writer);
   }
 
-  return voice_instructions;
+  writer.end_array();
 }
 
 // Get the mode
@@ -1706,16 +1678,116 @@ std::string get_pronunciations(const valhalla::DirectionsLeg::Maneuver& maneuver
   return pronunciations;
 }
 
-// Serialize each leg
-json::ArrayPtr serialize_legs(const google::protobuf::RepeatedPtrField<valhalla::DirectionsLeg>& legs,
-                              const std::vector<std::string>& leg_summaries,
-                              google::protobuf::RepeatedPtrField<valhalla::TripLeg>& path_legs,
-                              bool imperial,
-                              const valhalla::Options& options,
-                              const baldr::AttributesController& controller) {
-  auto output_legs = json::array({});
-  output_legs->reserve(path_legs.size());
+// What a step takes from its maneuver. The banner and voice instructions of a step and, after a
+// roundabout, its destinations describe the maneuver that follows it, so these are gathered for
+// all of the maneuvers of a leg before its steps are written
+struct osrm_step_t {
+  bool depart_maneuver;
+  bool arrive_maneuver;
+  bool rotary;
+  double distance;
+  double duration;
+  uint32_t in_brg;
+  uint32_t out_brg;
+  std::string drive_side;
+  std::string name;
+  std::string ref;
+  std::string pronunciation;
+  std::string mode;
+  std::string modifier;
+  std::string type;
+  std::string destinations;
+  std::string exits;
+};
+
+std::vector<osrm_step_t> osrm_steps(const valhalla::DirectionsLeg& leg,
+                                    valhalla::odin::EnhancedTripLeg& etp,
+                                    bool imperial) {
+  std::vector<osrm_step_t> steps;
+  steps.reserve(leg.maneuver_size());
+
+  int maneuver_index = 0;
+  uint32_t prev_intersection_count = 0;
+  std::string drive_side = "right";
+  std::string name = "";
+  std::string ref = "";
+  std::string pronunciation = "";
+  std::string mode = "";
+  std::string prev_mode = "";
+  bool prev_rotary = false;
+  for (const auto& maneuver : leg.maneuver()) {
+    osrm_step_t step;
+    step.depart_maneuver = (maneuver_index == 0);
+    step.arrive_maneuver = (maneuver_index == leg.maneuver_size() - 1);
+
+    // TODO - iterate through TripLeg from prior maneuver end to
+    // end of this maneuver - perhaps insert OSRM specific steps such as
+    // name change
+
+    // Add mode, driving side, weight, distance, duration, name
+    step.distance = units_to_meters(maneuver.length(), !imperial);
+    step.duration = maneuver.time();
+
+    // Process drive_side, name, ref, mode, and prev_mode attributes if not the arrive maneuver
+    if (!step.arrive_maneuver) {
+      drive_side =
+          (etp.GetCurrEdge(maneuver.begin_path_index())->drive_on_right()) ? "right" : "left";
+      auto name_ref_pair = names_and_refs(maneuver);
+      name = name_ref_pair.first;
+      ref = name_ref_pair.second;
+      pronunciation = get_pronunciations(maneuver);
+      mode = get_mode(maneuver, step.arrive_maneuver, &etp);
+      if (prev_mode.empty())
+        prev_mode = mode;
+    }
+    step.drive_side = drive_side;
+    step.name = name;
+    step.ref = ref;
+    step.pronunciation = pronunciation;
+    step.mode = mode;
+
+    step.rotary = ((maneuver.type() == DirectionsLeg_Maneuver_Type_kRoundaboutEnter) &&
+                   (maneuver.street_name_size() > 0));
+
+    // Get incoming and outgoing bearing. For the incoming heading, use the
+    // prior edge from the TripLeg. Compute turn modifier. TODO - reconcile
+    // turn degrees between Valhalla and OSRM
+    uint32_t idx = maneuver.begin_path_index();
+    step.in_brg = (idx > 0) ? etp.GetPrevEdge(idx)->end_heading() : 0;
+    step.out_brg = maneuver.begin_heading();
+
+    if (!step.depart_maneuver) {
+      step.modifier = turn_modifier(maneuver, step.in_brg, step.out_brg, step.arrive_maneuver);
+    }
+
+    step.type = maneuver_type(maneuver, &etp, step.depart_maneuver, step.arrive_maneuver,
+                              step.modifier, prev_intersection_count, mode, prev_mode, step.rotary,
+                              prev_rotary);
+
+    // Add destinations and exits
+    step.destinations = destinations(maneuver.sign());
+    step.exits = exits(maneuver.sign());
 
+    // The number of intersections the step will list
+    uint32_t n = step.arrive_maneuver ? maneuver.end_path_index() + 1 : maneuver.end_path_index();
+    prev_intersection_count = n > maneuver.begin_path_index() ? n - maneuver.begin_path_index() : 0;
+
+    prev_rotary = step.rotary;
+    prev_mode = mode;
+    maneuver_index++;
+    steps.emplace_back(std::move(step));
+  }
+  return steps;
+}
+
+// Serialize each leg
+void serialize_legs(const google::protobuf::RepeatedPtrField<valhalla::DirectionsLeg>& legs,
+                    const std::vector<std::string>& leg_summaries,
+                    google::protobuf::RepeatedPtrField<valhalla::TripLeg>& path_legs,
+                    bool imperial,
+                    const valhalla::Options& options,
+                    const baldr::AttributesController& controller,
+                    rapidjson::writer_wrapper_t& writer) {
   // Verify that the path_legs list is the same size as the legs list
   if (legs.size() != path_legs.size()) {
     throw valhalla_exception_t{503};
@@ -1725,10 +1797,46 @@ json::ArrayPtr serialize_legs(const google::protobuf::RepeatedPtrField<valhalla:
   int leg_index = 0;
   auto leg = legs.begin();
 
+  writer.start_array("legs");
   for (auto& path_leg : path_legs) {
     valhalla::odin::EnhancedTripLeg etp(path_leg);
-    auto output_leg = json::map({});
-    output_leg->reserve(10);
+    writer.start_object();
+
+    // Add distance, duration, weight, and summary
+    // Get a summary based on longest maneuvers.
+    double duration = leg->summary().time();
+    double distance = units_to_meters(leg->summary().length(), !imperial);
+    writer("summary", leg_summaries[leg_index]);
+    writer("distance", distance);
+    writer("duration", duration);
+    writer("weight", path_leg.node().rbegin()->cost().elapsed_cost().cost());
+    auto recost_itr = options.recostings().begin();
+    for (const auto& recost : path_leg.node().rbegin()->recosts()) {
+      if (recost.has_elapsed_cost()) {
+        writer("duration_" + recost_itr->name(), recost.elapsed_cost().seconds());
+        writer("weight_" + recost_itr->name(), recost.elapsed_cost().cost());
+      } else {
+        writer("duration_" + recost_itr->name(), nullptr);
+        writer("weight_" + recost_itr->name(), nullptr);
+      }
+      ++recost_itr;
+    }
+
+    // Add admin country codes to leg json
+    writer.start_array("admins");
+    for (const auto& admin : path_leg.admin()) {
+      writer.start_object();
+      if (!admin.country_code().empty()) {
+        writer("iso_3166_1", admin.country_code());
+        auto country_iso3 = valhalla::baldr::get_iso_3166_1_alpha3(admin.country_code());
+        if (!country_iso3.empty()) {
+          writer("iso_3166_1_alpha3", country_iso3);
+        }
+      }
+      // TODO: iso_3166_2 state code
+      writer.end_object();
+    }
+    writer.end_array();
 
     // Get the full shape for the leg. We want to use this for serializing
     // encoded shape for each step (maneuver) in OSRM output.
@@ -1736,85 +1844,50 @@ json::ArrayPtr serialize_legs(const google::protobuf::RepeatedPtrField<valhalla:
 
     // #########################################################################
     //  Iterate through maneuvers - convert to OSRM steps
-    int maneuver_index = 0;
-    uint32_t prev_intersection_count = 0;
-    double prev_distance = 0;
-    std::string drive_side = "right";
-    std::string name = "";
-    std::string ref = "";
-    std::string pronunciation = "";
-    std::string mode = "";
-    std::string prev_mode = "";
-    bool rotary = false;
-    bool prev_rotary = false;
-    auto steps = json::array({});
-    const DirectionsLeg_Maneuver* prev_maneuver = nullptr;
-    json::MapPtr prev_step;
-    for (const auto& maneuver : leg->maneuver()) {
-      auto step = json::map({});
-      step->reserve(15); // lots of conditional stuff here
-      bool depart_maneuver = (maneuver_index == 0);
-      bool arrive_maneuver = (maneuver_index == leg->maneuver_size() - 1);
-
-      // TODO - iterate through TripLeg from prior maneuver end to
-      // end of this maneuver - perhaps insert OSRM specific steps such as
-      // name change
+    const auto steps = osrm_steps(*leg, etp, imperial);
+    writer.start_array("steps");
+    for (int maneuver_index = 0; maneuver_index < leg->maneuver_size(); ++maneuver_index) {
+      const auto& maneuver = leg->maneuver(maneuver_index);
+      const auto& step = steps[maneuver_index];
+      const auto* next_maneuver =
+          maneuver_index + 1 < leg->maneuver_size() ? &leg->maneuver(maneuver_index + 1) : nullptr;
+      const auto* next_step = next_maneuver ? &steps[maneuver_index + 1] : nullptr;
+      writer.start_object();
 
       // Add geometry for this maneuver
-      maneuver_geometry(step, maneuver.begin_shape_index(), maneuver.end_shape_index(), shape,
-                        arrive_maneuver, options);
-
-      // Add mode, driving side, weight, distance, duration, name
-      double distance = units_to_meters(maneuver.length(), !imperial);
-      double duration = maneuver.time();
-
-      // Process drive_side, name, ref, mode, and prev_mode attributes if not the arrive maneuver
-      if (!arrive_maneuver) {
-        drive_side =
-            (etp.GetCurrEdge(maneuver.begin_path_index())->drive_on_right()) ? "right" : "left";
-        auto name_ref_pair = names_and_refs(maneuver);
-        name = name_ref_pair.first;
-        ref = name_ref_pair.second;
-        pronunciation = get_pronunciations(maneuver);
-        mode = get_mode(maneuver, arrive_maneuver, &etp);
-        if (prev_mode.empty())
-          prev_mode = mode;
-      }
+      maneuver_geometry(maneuver.begin_shape_index(), maneuver.end_shape_index(), shape,
+                        step.arrive_maneuver, options, writer);
 
-      step->emplace("mode", mode);
-      step->emplace("driving_side", drive_side);
-      step->emplace("distance", json::fixed_t{distance, 3});
-      step->emplace("duration", json::fixed_t{duration, 3});
+      writer("mode", step.mode);
+      writer("driving_side", step.drive_side);
+      writer("distance", step.distance);
+      writer("duration", step.duration);
       const auto& end_node = path_leg.node(maneuver.end_path_index());
       const auto& begin_node = path_leg.node(maneuver.begin_path_index());
       auto weight = end_node.cost().elapsed_cost().cost() - begin_node.cost().elapsed_cost().cost();
-      step->emplace("weight", json::fixed_t{weight, 3});
+      writer("weight", weight);
       auto recost_itr = options.recostings().begin();
       auto begin_recost_itr = begin_node.recosts().begin();
       for (const auto& end_recost : end_node.recosts()) {
         if (end_recost.has_elapsed_cost()) {
-          step->emplace("duration_" + recost_itr->name(),
-                        json::fixed_t{end_recost.elapsed_cost().seconds() -
-                                          begin_recost_itr->elapsed_cost().seconds(),
-                                      3});
-          step->emplace("weight_" + recost_itr->name(),
-                        json::fixed_t{end_recost.elapsed_cost().cost() -
-                                          begin_recost_itr->elapsed_cost().cost(),
-                                      3});
+          writer("duration_" + recost_itr->name(),
+                 end_recost.elapsed_cost().seconds() - begin_recost_itr->elapsed_cost().seconds());
+          writer("weight_" + recost_itr->name(),
+                 end_recost.elapsed_cost().cost() - begin_recost_itr->elapsed_cost().cost());
         } else {
-          step->emplace("duration_" + recost_itr->name(), nullptr_t());
-          step->emplace("weight_" + recost_itr->name(), nullptr_t());
+          writer("duration_" + recost_itr->name(), nullptr);
+          writer("weight_" + recost_itr->name(), nullptr);
         }
         ++recost_itr;
         ++begin_recost_itr;
       }
 
-      step->emplace("name", name);
-      if (!ref.empty()) {
-        step->emplace("ref", ref);
+      writer("name", step.name);
+      if (!step.ref.empty()) {
+        writer("ref", step.ref);
       }
-      if (!pronunciation.empty()) {
-        step->emplace("pronunciation", pronunciation);
+      if (!step.pronunciation.empty()) {
+        writer("pronunciation", step.pronunciation);
       }
 
       // Check if speed limits were requested
@@ -1824,200 +1897,123 @@ json::ArrayPtr serialize_legs(const google::protobuf::RepeatedPtrField<valhalla:
         auto country = speed_limit_info.find(country_code);
         if (country != speed_limit_info.end()) {
           // Some countries have different speed limit sign types and speed units
-          step->emplace("speedLimitSign", country->second.first);
-          step->emplace("speedLimitUnit", country->second.second);
+          writer("speedLimitSign", country->second.first);
+          writer("speedLimitUnit", country->second.second);
         } else {
           // Otherwise use the defaults (vienna convention style and km/h)
-          step->emplace("speedLimitSign", kSpeedLimitSignVienna);
-          step->emplace("speedLimitUnit", kSpeedLimitUnitsKph);
+          writer("speedLimitSign", kSpeedLimitSignVienna);
+          writer("speedLimitUnit", kSpeedLimitUnitsKph);
         }
       }
 
-      rotary = ((maneuver.type() == DirectionsLeg_Maneuver_Type_kRoundaboutEnter) &&
-                (maneuver.street_name_size() > 0));
-      if (rotary) {
-        step->emplace("rotary_name", maneuver.street_name(0).value());
+      if (step.rotary) {
+        writer("rotary_name", maneuver.street_name(0).value());
       }
 
-      // Get incoming and outgoing bearing. For the incoming heading, use the
-      // prior edge from the TripLeg. Compute turn modifier. TODO - reconcile
-      // turn degrees between Valhalla and OSRM
-      uint32_t idx = maneuver.begin_path_index();
-      uint32_t in_brg = (idx > 0) ? etp.GetPrevEdge(idx)->end_heading() : 0;
-      uint32_t out_brg = maneuver.begin_heading();
-
-      std::string modifier;
-      if (!depart_maneuver) {
-        modifier = turn_modifier(maneuver, in_brg, out_brg, arrive_maneuver);
-      }
-
-      std::string mnvr_type =
-          maneuver_type(maneuver, &etp, depart_maneuver, arrive_maneuver, modifier,
-                        prev_intersection_count, mode, prev_mode, rotary, prev_rotary);
-
       // Add OSRM maneuver
-      step->emplace("maneuver",
-                    osrm_maneuver(maneuver, mnvr_type, modifier, in_brg, out_brg,
-                                  shape[maneuver.begin_shape_index()],
-                                  (options.directions_type() == DirectionsType::instructions)));
-
-      // Add destinations
-      const auto& sign = maneuver.sign();
-      std::string dest = destinations(sign);
-      if (!dest.empty()) {
-        step->emplace("destinations", dest);
-        // If the maneuver is an exit roundabout
-        // and the previous maneuver is an enter roundabout
-        // then set the destinations on the previous step
-        if ((maneuver.type() == DirectionsLeg_Maneuver_Type_kRoundaboutExit) && prev_maneuver &&
-            (prev_maneuver->type() == DirectionsLeg_Maneuver_Type_kRoundaboutEnter) && prev_step) {
-          prev_step->emplace("destinations", dest);
-        }
+      osrm_maneuver(maneuver, step.type, step.modifier, step.in_brg, step.out_brg,
+                    shape[maneuver.begin_shape_index()],
+                    (options.directions_type() == DirectionsType::instructions), writer);
+
+      // Add destinations. If the maneuver is an enter roundabout and the next maneuver is an
+      // exit roundabout then use the destinations of the exit if it has none of its own
+      if (!step.destinations.empty()) {
+        writer("destinations", step.destinations);
+      } else if (next_step && !next_step->destinations.empty() &&
+                 (maneuver.type() == DirectionsLeg_Maneuver_Type_kRoundaboutEnter) &&
+                 (next_maneuver->type() == DirectionsLeg_Maneuver_Type_kRoundaboutExit)) {
+        writer("destinations", next_step->destinations);
       }
 
       // Add exits
-      std::string ex = exits(sign);
-      if (!ex.empty()) {
-        step->emplace("exits", ex);
+      if (!step.exits.empty()) {
+        writer("exits", step.exits);
       }
 
       // Add banner instructions if the user requested them
       if (options.banner_instructions()) {
-        if (prev_step && prev_maneuver) {
-          prev_step->emplace("bannerInstructions",
-                             banner_instructions(name, dest, ref, prev_maneuver, maneuver,
-                                                 arrive_maneuver, &etp, mnvr_type, modifier, ex,
-                                                 prev_distance, drive_side));
-        }
-        if (arrive_maneuver) {
+        if (next_step) {
+          banner_instructions(next_step->name, next_step->destinations, next_step->ref, &maneuver,
+                              *next_maneuver, next_step->arrive_maneuver, &etp, next_step->type,
+                              next_step->modifier, next_step->exits, step.distance,
+                              next_step->drive_side, writer);
+        } else if (step.arrive_maneuver) {
           // just add empty array for arrival maneuver
-          step->emplace("bannerInstructions", json::array({}));
+          writer.start_array("bannerInstructions");
+          writer.end_array();
         }
       }
 
       // Add voice instructions if the user requested them
       if (options.voice_instructions()) {
-        if (prev_step && prev_maneuver) {
-          prev_step->emplace("voiceInstructions",
-                             voice_instructions(prev_maneuver, maneuver, prev_distance,
-                                                maneuver_index, &etp, options));
-        }
-        if (arrive_maneuver) {
+        if (next_step) {
+          voice_instructions(&maneuver, *next_maneuver, step.distance, maneuver_index + 1, &etp,
+                             options, writer);
+        } else if (step.arrive_maneuver) {
           // just add empty array for arrival maneuver
-          step->emplace("voiceInstructions", json::array({}));
+          writer.start_array("voiceInstructions");
+          writer.end_array();
         }
       }
 
       // Add junction_name if not the start maneuver
-      std::string junction_name = get_sign_elements(sign.junction_names());
-      if (!depart_maneuver && !junction_name.empty()) {
-        step->emplace("junction_name", junction_name);
+      std::string junction_name = get_sign_elements(maneuver.sign().junction_names());
+      if (!step.depart_maneuver && !junction_name.empty()) {
+        writer("junction_name", junction_name);
       }
 
       // If the user requested guidance_views
       if (options.guidance_views()) {
         // Add guidance_views if not the start maneuver
-        if (!depart_maneuver && (maneuver.guidance_views_size() > 0)) {
-          auto guidance_views = json::array({});
-          guidance_views->reserve(maneuver.guidance_views_size());
+        if (!step.depart_maneuver && (maneuver.guidance_views_size() > 0)) {
+          writer.start_array("guidance_views");
           for (const auto& gv : maneuver.guidance_views()) {
-            auto guidance_view = json::map({});
-            guidance_view->emplace("data_id", gv.data_id());
-            guidance_view->emplace("type", GuidanceViewTypeToString(gv.type()));
-            guidance_view->emplace("base_id", gv.base_id());
-            auto overlay_ids = json::array({});
-            overlay_ids->reserve(gv.overlay_ids_size());
+            writer.start_object();
+            writer("data_id", gv.data_id());
+            writer("type", GuidanceViewTypeToString(gv.type()));
+            writer("base_id", gv.base_id());
+            writer.start_array("overlay_ids");
             for (const auto& overlay : gv.overlay_ids()) {
-              overlay_ids->emplace_back(overlay);
+              writer(overlay);
             }
-            guidance_view->emplace("overlay_ids", std::move(overlay_ids));
-
-            // Append to guidance view list
-            guidance_views->emplace_back(std::move(guidance_view));
+            writer.end_array();
+            writer.end_object();
           }
-          // Add guidance views to step
-          step->emplace("guidance_views", std::move(guidance_views));
+          writer.end_array();
         }
       }
 
       // Add intersections
-      step->emplace("intersections", intersections(maneuver, &etp, shape, prev_intersection_count,
-                                                   arrive_maneuver, controller));
-
-      // Add step
-      prev_rotary = rotary;
-      prev_mode = mode;
-      prev_step = step;
-      prev_maneuver = &maneuver;
-      prev_distance = distance;
-      maneuver_index++;
-      steps->emplace_back(std::move(step));
+      intersections(maneuver, &etp, shape, step.arrive_maneuver, controller, writer);
+
+      writer.end_object();
     } // end maneuver loop
       // #########################################################################
-
-    // Add distance, duration, weight, and summary
-    // Get a summary based on longest maneuvers.
-    double duration = leg->summary().time();
-    double distance = units_to_meters(leg->summary().length(), !imperial);
-    output_leg->emplace("summary", leg_summaries[leg_index]);
-    output_leg->emplace("distance", json::fixed_t{distance, 3});
-    output_leg->emplace("duration", json::fixed_t{duration, 3});
-    output_leg->emplace("weight",
-                        json::fixed_t{path_leg.node().rbegin()->cost().elapsed_cost().cost(), 3});
-    auto recost_itr = options.recostings().begin();
-    for (const auto& recost : path_leg.node().rbegin()->recosts()) {
-      if (recost.has_elapsed_cost()) {
-        output_leg->emplace("duration_" + recost_itr->name(),
-                            json::fixed_t{recost.elapsed_cost().seconds(), 3});
-        output_leg->emplace("weight_" + recost_itr->name(),
-                            json::fixed_t{recost.elapsed_cost().cost(), 3});
-      } else {
-        output_leg->emplace("duration_" + recost_itr->name(), nullptr_t());
-        output_leg->emplace("weight_" + recost_itr->name(), nullptr_t());
-      }
-      ++recost_itr;
-    }
-
-    // Add admin country codes to leg json
-    auto admins = json::array({});
-    admins->reserve(path_leg.admin_size());
-    for (const auto& admin : path_leg.admin()) {
-      auto admin_map = json::map({});
-      if (!admin.country_code().empty()) {
-        admin_map->emplace("iso_3166_1", admin.country_code());
-        auto country_iso3 = valhalla::baldr::get_iso_3166_1_alpha3(admin.country_code());
-        if (!country_iso3.empty()) {
-          admin_map->emplace("iso_3166_1_alpha3", country_iso3);
-        }
-      }
-      // TODO: iso_3166_2 state code
-      admins->push_back(admin_map);
-    }
-    output_leg->emplace("admins", std::move(admins));
-
-    // Add steps to the leg
-    output_leg->emplace("steps", std::move(steps));
+    writer.end_array();
 
     // Add shape_attributes, if requested
     if (path_leg.has_shape_attributes()) {
-      output_leg->emplace("annotation", serialize_annotations(path_leg));
+      writer("annotation");
+      serialize_annotations(path_leg, writer);
     }
 
     // Add via waypoints to the leg
-    output_leg->emplace("via_waypoints", osrm::intermediate_waypoints(path_leg));
+    writer.start_array("via_waypoints");
+    osrm::intermediate_waypoints(path_leg, writer);
+    writer.end_array();
 
     // Add incidents to the leg
-    serializeIncidents(path_leg.incidents(), *output_leg);
+    serializeIncidents(path_leg.incidents(), writer);
 
     // Add closures
-    serializeClosures(path_leg, *output_leg);
+    serializeClosures(path_leg, writer);
 
     // Keep the leg
-    output_legs->emplace_back(std::move(output_leg));
+    writer.end_object();
     leg++;
     leg_index++;
   }
-  return output_legs;
+  writer.end_array();
 }
 
 std::vector<std::vector<std::string>>
@@ -2106,29 +2102,34 @@ namespace osrm_serializers {
 std::string serialize(valhalla::Api& api) {
   auto& options = *api.mutable_options();
   AttributesController controller(options);
-  auto json = json::map({});
+
+  // build up the json object, reserve 4k bytes
+  rapidjson::writer_wrapper_t writer(4096);
+  writer.start_object();
+  writer.set_precision(tyr::kDefaultPrecision);
 
   // If here then the route succeeded. Set status code to OK and serialize waypoints (locations).
-  std::string status("Ok");
-  json->emplace("code", status);
+  writer("code", "Ok");
   switch (options.action()) {
     case valhalla::Options::trace_route:
-      json->emplace("tracepoints", osrm::waypoints(options.shape(), true));
+      writer.start_array("tracepoints");
+      osrm::waypoints(options.shape(), writer, true);
+      writer.end_array();
       break;
     case valhalla::Options::route:
-      json->emplace("waypoints", osrm::waypoints(api.trip()));
+      writer.start_array("waypoints");
+      osrm::waypoints(api.trip(), writer);
+      writer.end_array();
       break;
     case valhalla::Options::optimized_route:
-      json->emplace("waypoints", waypoints(*options.mutable_locations()));
+      writer.start_array("waypoints");
+      waypoints(*options.mutable_locations(), writer);
+      writer.end_array();
       break;
     default:
       throw std::runtime_error("Unknown route serialization action");
   }
 
-  // Add each route
-  auto routes = json::array({});
-  routes->reserve(api.trip().routes_size());
-
   // OSRM is always using metric for non narrative stuff
   bool imperial = options.units() == Options::miles;
 
@@ -2139,50 +2140,49 @@ std::string serialize(valhalla::Api& api) {
   std::vector<std::vector<std::string>> route_leg_summaries =
       summarize_route_legs(api.directions().routes());
 
+  // Routes are called matchings in osrm map matching mode
+  writer.start_array(options.action() == valhalla::Options::trace_route ? "matchings" : "routes");
+
   // For each route...
   for (int i = 0; i < api.trip().routes_size(); ++i) {
-    // Create a route to add to the array
-    auto route = json::map({});
-    route->reserve(10); // some of the things are conditional so we take a swag here
+    writer.start_object();
 
     if (options.action() == Options::trace_route) {
       // NOTE(mookerji): confidence value here is a placeholder for future implementation.
-      route->emplace("confidence", json::fixed_t{1, 1});
+      writer.set_precision(1);
+      writer("confidence", 1.0);
+      writer.set_precision(tyr::kDefaultPrecision);
     }
     // Add linear references, if applicable
-    route_references(route, api.trip().routes(i), options);
+    openlr(api, i, writer);
 
     // Concatenated route geometry
-    route_geometry(route, api.directions().routes(i), options);
+    route_geometry(api.directions().routes(i), options, writer);
 
     // Other route summary information
-    route_summary(route, api, imperial, i);
+    route_summary(api, imperial, i, writer);
 
     // Serialize route legs
-    route->emplace("legs", serialize_legs(api.directions().routes(i).legs(), route_leg_summaries[i],
-                                          *api.mutable_trip()->mutable_routes(i)->mutable_legs(),
-                                          imperial, options, controller));
+    serialize_legs(api.directions().routes(i).legs(), route_leg_summaries[i],
+                   *api.mutable_trip()->mutable_routes(i)->mutable_legs(), imperial, options,
+                   controller, writer);
 
     // Add voice instructions if the user requested them
     if (options.voice_instructions()) {
-      route->emplace("voiceLocale", options.language());
+      writer("voiceLocale", options.language());
     }
 
-    routes->emplace_back(std::move(route));
+    writer.end_object();
   }
-
-  // Routes are called matchings in osrm map matching mode
-  json->emplace(options.action() == valhalla::Options::trace_route ? "matchings" : "routes",
-                std::move(routes));
+  writer.end_array();
 
   // get serialized warnings
   if (api.info().warnings_size() >= 1) {
-    json->emplace("warnings", serializeWarnings(api));
+    serializeWarnings(api, writer);
   }
 
-  std::stringstream ss;
-  ss << *json;
-  return ss.str();
+  writer.end_object();
+  return writer.get_buffer();
 }
 
 } // namespace osrm_serializers
@@ -2206,7 +2206,7 @@ TEST(RouteSerializerOsrm, testserializeIncidents) {
 
   rapidjson::Document serialized_to_json;
   {
-    auto intersection_doc = json::Jmap();
+    rapidjson::writer_wrapper_t writer;
     auto leg = TripLeg();
     // Sets up the incident
     auto incidents = leg.mutable_incidents();
@@ -2239,12 +2239,12 @@ TEST(RouteSerializerOsrm, testserializeIncidents) {
     *incident->mutable_metadata() = meta;
 
     // Finally call the function under test to serialize to json
-    serializeIncidents(*incidents, intersection_doc);
+    writer.start_object();
+    serializeIncidents(*incidents, writer);
+    writer.end_object();
 
     // Lastly, convert to rapidjson
-    std::stringstream ss;
-    ss << intersection_doc;
-    serialized_to_json.Parse(ss.str().c_str());
+    serialized_to_json.Parse(writer.get_buffer());
   }
 
   rapidjson::Document expected_json;
@@ -2291,7 +2291,7 @@ TEST(RouteSerializerOsrm, testserializeIncidentsMultipleIncidentsSingleEdge) {
 
   rapidjson::Document serialized_to_json;
   {
-    auto intersection_doc = json::Jmap();
+    rapidjson::writer_wrapper_t writer;
     auto leg = TripLeg();
     // Sets up the incident
     auto* incidents = leg.mutable_incidents();
@@ -2330,12 +2330,12 @@ TEST(RouteSerializerOsrm, testserializeIncidentsMultipleIncidentsSingleEdge) {
     }
 
     // Finally call the function under test to serialize to json
-    serializeIncidents(*incidents, intersection_doc);
+    writer.start_object();
+    serializeIncidents(*incidents, writer);
+    writer.end_object();
 
     // Lastly, convert to rapidjson
-    std::stringstream ss;
-    ss << intersection_doc;
-    serialized_to_json.Parse(ss.str().c_str());
+    serialized_to_json.Parse(writer.get_buffer());
   }
 
   rapidjson::Document expected_json;
@@ -2378,16 +2378,16 @@ TEST(RouteSerializerOsrm, testserializeIncidentsNothingToAdd) {
 
   rapidjson::Document serialized_to_json;
   {
-    auto intersection_doc = json::Jmap();
+    rapidjson::writer_wrapper_t writer;
     auto leg = TripLeg();
 
     // Finally call the function under test to serialize to json
-    serializeIncidents(leg.incidents(), intersection_doc);
+    writer.start_object();
+    serializeIncidents(leg.incidents(), writer);
+    writer.end_object();
 
     // Lastly, convert to rapidjson
-    std::stringstream ss;
-    ss << intersection_doc;
-    serialized_to_json.Parse(ss.str().c_str());
+    serialized_to_json.Parse(writer.get_buffer());
   }
 
   rapidjson::Document expected_json;
@@ -2403,12 +2403,9 @@ TEST(RouteSerializerOsrm, testserializeAnnotationsEmpty) {
   rapidjson::Document serialized_to_json;
   {
     auto leg = TripLeg();
-    json::MapPtr annotations = serialize_annotations(leg);
-
-    std::stringstream ss;
-    ss << *annotations;
-    serialized_to_json.Parse(ss.str().c_str());
-    std::cout << *annotations << std::endl;
+    rapidjson::writer_wrapper_t writer;
+    serialize_annotations(leg, writer);
+    serialized_to_json.Parse(writer.get_buffer());
   }
   rapidjson::Document expected_json;
   { expected_json.Parse(R"({})"); }
@@ -2423,11 +2420,10 @@ TEST(RouteSerializerOsrm, testserializeAnnotations) {
     leg.mutable_shape_attributes()->add_time(1);
     leg.mutable_shape_attributes()->add_length(2);
     leg.mutable_shape_attributes()->add_speed(3);
-    auto annotations = serialize_annotations(leg);
-
-    std::stringstream ss;
-    ss << *annotations;
-    serialized_to_json.Parse(ss.str().c_str());
+    rapidjson::writer_wrapper_t writer;
+    writer.set_precision(kDefaultPrecision);
+    serialize_annotations(leg, writer);
+    serialized_to_json.Parse(writer.get_buffer());
   }
   rapidjson::Document expected_json;
   {
@@ -2449,11 +2445,10 @@ TEST(RouteSerializerOsrm, testserializeAnnotationsSpeedLimits) {
     leg.mutable_shape_attributes()->add_speed_limit(30);
     leg.mutable_shape_attributes()->add_speed_limit(255);
     leg.mutable_shape_attributes()->add_speed_limit(0);
-    auto annotations = serialize_annotations(leg);
-
-    std::stringstream ss;
-    ss << *annotations;
-    serialized_to_json.Parse(ss.str().c_str());
+    rapidjson::writer_wrapper_t writer;
+    writer.set_precision(kDefaultPrecision);
+    serialize_annotations(leg, writer);
+    serialized_to_json.Parse(writer.get_buffer());
   }
   rapidjson::Document expected_json;
   {
@@ -2471,18 +2466,18 @@ TEST(RouteSerializerOsrm, testserializeAnnotationsSpeedLimits) {
 }
 
 TEST(RouteSerializerOsrm, testlaneIndications) {
-  json::ArrayPtr indications_1 = lane_indications(true, kTurnLaneReverse | kTurnLaneSharpLeft);
-  json::ArrayPtr indications_2 =
-      lane_indications(true, kTurnLaneThrough | kTurnLaneRight | kTurnLaneSharpRight);
-
-  ASSERT_EQ(indications_1->size(), 2);
-  ASSERT_STREQ(boost::get<std::string>(indications_1->at(0)).c_str(), "uturn");
-  ASSERT_STREQ(boost::get<std::string>(indications_1->at(1)).c_str(), "sharp left");
-
-  ASSERT_EQ(indications_2->size(), 3);
-  ASSERT_STREQ(boost::get<std::string>(indications_2->at(0)).c_str(), "straight");
-  ASSERT_STREQ(boost::get<std::string>(indications_2->at(1)).c_str(), "right");
-  ASSERT_STREQ(boost::get<std::string>(indications_2->at(2)).c_str(), "sharp right");
+  rapidjson::writer_wrapper_t writer;
+  writer.start_array();
+  writer.start_array();
+  lane_indications(true, kTurnLaneReverse | kTurnLaneSharpLeft, writer);
+  writer.end_array();
+  writer.start_array();
+  lane_indications(true, kTurnLaneThrough | kTurnLaneRight | kTurnLaneSharpRight, writer);
+  writer.end_array();
+  writer.end_array();
+
+  EXPECT_STREQ(writer.get_buffer(),
+               R"([["uturn","sharp left"],["straight","right","sharp right"]])");
 }
 
 } // namespace
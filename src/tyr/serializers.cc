@@ -14,6 +14,7 @@
 #include <boost/algorithm/string/replace.hpp>
 
 #include <cstdint>
+#include <map>
 #include <stdexcept>
 #include <string>
 #include <vector>
@@ -127,25 +128,33 @@ std::string serializeStatus(Api& request) {
     rapidjson::SetValueByPointer(status_doc, "/bbox", bbox_doc, alloc);
   }
 
-  return rapidjson::to_string(status_doc);
-}
-
-void route_references(json::MapPtr& route_json, const TripRoute& route, const Options& options) {
-  const bool linear_reference =
-      options.linear_references() &&
-      (options.action() == Options::trace_route || options.action() == Options::route);
-  if (!linear_reference) {
-    return;
-  }
-  json::ArrayPtr references = json::array({});
-  for (const TripLeg& leg : route.legs()) {
-    auto edge_references = openlr_edges(leg);
-    references->reserve(references->size() + edge_references.size());
-    for (const std::string& openlr : edge_references) {
-      references->emplace_back(openlr);
+  if (request.status().stage_latencies_size() || request.status().counters_size()) {
+    rapidjson::Value stages(rapidjson::kObjectType);
+    for (const auto& latency : request.status().stage_latencies()) {
+      rapidjson::Value stage(rapidjson::kObjectType);
+      stage.AddMember("count", rapidjson::Value().SetUint64(latency.count()), alloc);
+      stage.AddMember("mean_ms", rapidjson::Value().SetDouble(latency.mean_ms()), alloc);
+      stage.AddMember("p50_ms", rapidjson::Value().SetDouble(latency.p50_ms()), alloc);
+      stage.AddMember("p90_ms", rapidjson::Value().SetDouble(latency.p90_ms()), alloc);
+      stage.AddMember("p99_ms", rapidjson::Value().SetDouble(latency.p99_ms()), alloc);
+      stage.AddMember("max_ms", rapidjson::Value().SetDouble(latency.max_ms()), alloc);
+      stages.AddMember(rapidjson::Value().SetString(latency.stage(), alloc), stage, alloc);
+    }
+    // the map has no order of its own
+    rapidjson::Value counters(rapidjson::kObjectType);
+    const std::map<std::string, uint64_t> sorted(request.status().counters().begin(),
+                                                 request.status().counters().end());
+    for (const auto& counter : sorted) {
+      counters.AddMember(rapidjson::Value().SetString(counter.first, alloc),
+                         rapidjson::Value().SetUint64(counter.second), alloc);
     }
+    rapidjson::Value metrics(rapidjson::kObjectType);
+    metrics.AddMember("stages", stages, alloc);
+    metrics.AddMember("counters", counters, alloc);
+    status_doc.AddMember("metrics", metrics, alloc);
   }
-  route_json->emplace("linear_references", references);
+
+  return rapidjson::to_string(status_doc);
 }
 
 void openlr(const valhalla::Api& api, int route_index, rapidjson::writer_wrapper_t& writer) {
@@ -174,14 +183,6 @@ void serializeWarnings(const valhalla::Api& api, rapidjson::writer_wrapper_t& wr
   writer.end_array();
 }
 
-json::ArrayPtr serializeWarnings(const valhalla::Api& api) {
-  auto warnings = json::array({});
-  for (const auto& warning : api.info().warnings()) {
-    warnings->emplace_back(json::map({{"code", warning.code()}, {"text", warning.description()}}));
-  }
-  return warnings;
-}
-
 std::string serializePbf(Api& request) {
   // if they dont want to select the parts just pick the obvious thing they would want based on action
   PbfFieldSelector selection = request.options().pbf_field_selector();
@@ -253,19 +254,6 @@ std::string serializePbf(Api& request) {
 }
 
 // Generate leg shape in geojson format.
-baldr::json::MapPtr geojson_shape(const std::vector<midgard::PointLL>& shape) {
-  auto geojson = baldr::json::map({});
-  auto coords = baldr::json::array({});
-  coords->reserve(shape.size());
-  for (const auto& p : shape) {
-    coords->emplace_back(
-        baldr::json::array({baldr::json::fixed_t{p.lng(), 6}, baldr::json::fixed_t{p.lat(), 6}}));
-  }
-  geojson->emplace("type", std::string("LineString"));
-  geojson->emplace("coordinates", coords);
-  return geojson;
-}
-
 void geojson_shape(const std::vector<midgard::PointLL>& shape, rapidjson::writer_wrapper_t& writer) {
   writer("type", "LineString");
   writer.start_array("coordinates");
@@ -286,60 +274,6 @@ namespace osrm {
 
 // Serialize a location (waypoint) in OSRM compatible format. Waypoint format is described here:
 //     http://project-osrm.org/docs/v5.5.1/api/#waypoint-object
-valhalla::baldr::json::MapPtr
-waypoint(const valhalla::Location& location, bool is_tracepoint, bool is_optimized) {
-  // Create a waypoint to add to the array
-  auto waypoint = json::map({});
-
-  // Output location as a lon,lat array. Note this is the projected
-  // lon,lat on the nearest road.
-  auto loc = json::array({});
-  loc->emplace_back(json::fixed_t{location.correlation().edges(0).ll().lng(), 6});
-  loc->emplace_back(json::fixed_t{location.correlation().edges(0).ll().lat(), 6});
-  waypoint->emplace("location", loc);
-
-  // Add street name.
-  std::string name =
-      location.correlation().edges_size() && location.correlation().edges(0).names_size()
-          ? location.correlation().edges(0).names(0)
-          : "";
-  waypoint->emplace("name", name);
-
-  // Add distance in meters from the input location to the nearest
-  // point on the road used in the route
-  // TODO: since distance was normalized in thor - need to recalculate here
-  //       in the future we shall have store separately from score
-  waypoint->emplace("distance",
-                    json::fixed_t{to_ll(location.ll())
-                                      .Distance(to_ll(location.correlation().edges(0).ll())),
-                                  3});
-
-  // If the location was used for a tracepoint we trigger extra serialization
-  if (is_tracepoint) {
-    waypoint->emplace("alternatives_count",
-                      static_cast<uint64_t>(location.correlation().edges_size() - 1));
-    if (location.correlation().waypoint_index() == numeric_limits<uint32_t>::max()) {
-      // when tracepoint is neither a break nor leg's starting/ending
-      // point (shape_index is uint32_t max), we assign null to its waypoint_index
-      waypoint->emplace("waypoint_index", static_cast<std::nullptr_t>(nullptr));
-    } else {
-      waypoint->emplace("waypoint_index",
-                        static_cast<uint64_t>(location.correlation().waypoint_index()));
-    }
-    waypoint->emplace("matchings_index", static_cast<uint64_t>(location.correlation().route_index()));
-  }
-
-  // If the location was used for optimized route we add trips_index and waypoint
-  // index (index of the waypoint in the trip)
-  if (is_optimized) {
-    int trips_index = 0; // TODO
-    waypoint->emplace("trips_index", static_cast<uint64_t>(trips_index));
-    waypoint->emplace("waypoint_index",
-                      static_cast<uint64_t>(location.correlation().waypoint_index()));
-  }
-
-  return waypoint;
-}
 void waypoint(const valhalla::Location& location,
               rapidjson::writer_wrapper_t& writer,
               bool is_tracepoint,
@@ -392,19 +326,6 @@ void waypoint(const valhalla::Location& location,
 
 // Serialize locations (called waypoints in OSRM). Waypoints are described here:
 //     http://project-osrm.org/docs/v5.5.1/api/#waypoint-object
-json::ArrayPtr waypoints(const google::protobuf::RepeatedPtrField<valhalla::Location>& locations,
-                         bool is_tracepoint) {
-  auto waypoints = json::array({});
-  for (const auto& location : locations) {
-    if (location.correlation().edges().size() == 0) {
-      waypoints->emplace_back(static_cast<std::nullptr_t>(nullptr));
-    } else {
-      waypoints->emplace_back(waypoint(location, is_tracepoint));
-    }
-  }
-  return waypoints;
-}
-
 void waypoints(const google::protobuf::RepeatedPtrField<valhalla::Location>& locations,
                rapidjson::writer_wrapper_t& writer,
                bool is_tracepoint) {
@@ -417,19 +338,19 @@ void waypoints(const google::protobuf::RepeatedPtrField<valhalla::Location>& loc
   }
 }
 
-json::ArrayPtr waypoints(const valhalla::Trip& trip) {
-  auto waypoints = json::array({});
+void waypoints(const valhalla::Trip& trip, rapidjson::writer_wrapper_t& writer) {
   // For multi-route the same waypoints are used for all routes.
+  bool first = true;
   for (const auto& leg : trip.routes(0).legs()) {
     for (int i = 0; i < leg.location_size(); ++i) {
       // we skip the first location of legs > 0 because that would duplicate waypoints
-      if (i == 0 && !waypoints->empty()) {
+      if (i == 0 && !first) {
         continue;
       }
-      waypoints->emplace_back(waypoint(leg.location(i), false));
+      waypoint(leg.location(i), writer);
+      first = false;
     }
   }
-  return waypoints;
 }
 
 /*
@@ -439,24 +360,18 @@ json::ArrayPtr waypoints(const valhalla::Trip& trip) {
  * Then we serialize the via_waypoints object.
  *
  */
-json::ArrayPtr intermediate_waypoints(const valhalla::TripLeg& leg) {
-  // Create a vector of indexes based on the number of locations.
-  auto via_waypoints = json::array({});
+void intermediate_waypoints(const valhalla::TripLeg& leg, rapidjson::writer_wrapper_t& writer) {
   // only loop thru the locations that are not origin or destinations
   for (const auto& loc : leg.location()) {
     // Only create via_waypoints object if the locations are via or through types
     if (loc.type() == valhalla::Location::kVia || loc.type() == valhalla::Location::kThrough) {
-      auto via_waypoint = json::map({});
-      via_waypoint->emplace("geometry_index",
-                            static_cast<uint64_t>(loc.correlation().leg_shape_index()));
-      via_waypoint->emplace("distance_from_start",
-                            json::fixed_t{loc.correlation().distance_from_leg_origin(), 3});
-      via_waypoint->emplace("waypoint_index",
-                            static_cast<uint64_t>(loc.correlation().original_index()));
-      via_waypoints->emplace_back(via_waypoint);
+      writer.start_object();
+      writer("geometry_index", static_cast<uint64_t>(loc.correlation().leg_shape_index()));
+      writer("distance_from_start", loc.correlation().distance_from_leg_origin());
+      writer("waypoint_index", static_cast<uint64_t>(loc.correlation().original_index()));
+      writer.end_object();
     }
   }
-  return via_waypoints;
 }
 
 void serializeIncidentProperties(rapidjson::writer_wrapper_t& writer,
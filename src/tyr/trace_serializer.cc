@@ -1,6 +1,7 @@
 #include "baldr/attributes_controller.h"
 #include "baldr/graphconstants.h"
 #include "baldr/rapidjson_utils.h"
+#include "midgard/metrics.h"
 #include "odin/enhancedtrippath.h"
 #include "proto_conversions.h"
 #include "tyr/serializers.h"
@@ -692,6 +693,7 @@ std::string serializeTraceAttributes(
     Api& request,
     const AttributesController& controller,
     std::vector<std::tuple<float, float, std::vector<meili::MatchResult>>>& map_match_results) {
+  midgard::metrics::stage_timer_t timer(midgard::metrics::stage_t::serialize);
 
   // todo: These properties should be filled *before* this function is called and then used instead
   // of `map_match_results`.
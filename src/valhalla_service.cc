@@ -1,5 +1,8 @@
 #include <cxxopts.hpp>
 
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
@@ -20,6 +23,7 @@ using namespace prime_server;
 #include "odin/worker.h"
 #include "thor/worker.h"
 #include "tyr/actor.h"
+#include "tyr/http_frontend.h"
 
 int main(int argc, char** argv) {
   const auto program = std::filesystem::path(__FILE__).stem().string();
@@ -171,9 +175,8 @@ int main(int argc, char** argv) {
   }
 
 #ifdef ENABLE_SERVICES
-  // gracefully shutdown when asked via SIGTERM
-  prime_server::quiesce(config.get<unsigned int>("httpd.service.drain_seconds", 28),
-                        config.get<unsigned int>("httpd.service.shutdown_seconds", 1));
+  const auto drain_seconds = config.get<unsigned int>("httpd.service.drain_seconds", 28);
+  const auto shutdown_seconds = config.get<unsigned int>("httpd.service.shutdown_seconds", 1);
 
   // grab the endpoints
   std::string listen = config.get<std::string>("httpd.service.listen");
@@ -201,14 +204,40 @@ int main(int argc, char** argv) {
   auto worker_concurrency =
       pos_args.size() < 2 ? std::thread::hardware_concurrency() : std::stoul(pos_args[1]);
 
+  // or answer the requests in process without the pipeline
+  if (config.get<bool>("httpd.event_loop.enabled", false)) {
+    // SIGTERM is taken by a thread of its own rather than a handler so that it can drain the
+    // frontend, the threads of the frontend inherit the mask so they never get it
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+    valhalla::tyr::http_frontend_t frontend(config, worker_concurrency);
+    std::thread([&frontend, signals, drain_seconds, shutdown_seconds]() {
+      int signal;
+      sigwait(&signals, &signal);
+      frontend.drain(std::chrono::seconds(drain_seconds));
+      // like prime_server the process goes away if the workers won't quit in time
+      std::this_thread::sleep_for(std::chrono::seconds(drain_seconds + shutdown_seconds));
+      std::_Exit(EXIT_FAILURE);
+    }).detach();
+    frontend.serve();
+    return 0;
+  }
+
+  // gracefully shutdown when asked via SIGTERM
+  prime_server::quiesce(drain_seconds, shutdown_seconds);
+
   uint32_t request_timeout = config.get<uint32_t>("httpd.service.timeout_seconds");
+  size_t max_request_size =
+      config.get<size_t>("httpd.service.max_request_size", DEFAULT_MAX_REQUEST_SIZE);
 
   // setup the cluster within this process
   zmq::context_t context;
   std::thread server_thread =
       std::thread(std::bind(&http_server_t::serve,
                             http_server_t(context, listen, loki_proxy + "_in", loopback, interrupt,
-                                          true, DEFAULT_MAX_REQUEST_SIZE, request_timeout)));
+                                          true, max_request_size, request_timeout)));
 
   // loki layer
   std::thread loki_proxy_thread(
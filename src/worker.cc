@@ -7,6 +7,7 @@
 #include "exceptions.h"
 #include "midgard/encoded.h"
 #include "midgard/logging.h"
+#include "midgard/metrics.h"
 #include "midgard/util.h"
 #include "odin/util.h"
 #include "proto_conversions.h"
@@ -18,6 +19,9 @@
 #include <cpp-statsd-client/StatsdClient.hpp>
 
 #include <sstream>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
 
 using namespace valhalla;
 #ifdef ENABLE_SERVICES
@@ -95,14 +99,574 @@ bool is_format_supported(Options::Action action, Options::Format format) {
   }
 }
 
-rapidjson::Document from_string(const std::string& json, const valhalla_exception_t& e) {
+// The members of a json location which parse_location applies itself, because what they do
+// depends on the rest of the location and the request
+struct json_location_t {
+  boost::optional<Location::Type> type;
+  boost::optional<double> time;
+  float waiting = 0.f;
+};
+
+// The members of a json location and of its search_filter which are parsed into protobuf
+enum class location_member_t : uint8_t {
+  kUnknown,
+  kLat,
+  kLon,
+  kType,
+  kName,
+  kStreet,
+  kDateTime,
+  kHeading,
+  kHeadingTolerance,
+  kPreferredLayer,
+  kNodeSnapTolerance,
+  kMinimumReachability,
+  kRadius,
+  kAccuracy,
+  kTime,
+  kRankCandidates,
+  kPreferredSide,
+  kDisplayLat,
+  kDisplayLon,
+  kSearchCutoff,
+  kStreetSideTolerance,
+  kStreetSideMaxDistance,
+  kStreetSideCutoff,
+  kWaiting,
+  kSearchFilter,
+  kMinRoadClass,
+  kMaxRoadClass,
+  kExcludeTunnel,
+  kExcludeBridge,
+  kExcludeToll,
+  kExcludeRamp,
+  kExcludeFerry,
+  kLevel,
+  kExcludeClosures,
+};
+
+location_member_t to_location_member(std::string_view key, bool search_filter) {
+  static const std::unordered_map<std::string_view, location_member_t> location_members{
+      {"lat", location_member_t::kLat},
+      {"lon", location_member_t::kLon},
+      {"type", location_member_t::kType},
+      {"name", location_member_t::kName},
+      {"street", location_member_t::kStreet},
+      {"date_time", location_member_t::kDateTime},
+      {"heading", location_member_t::kHeading},
+      {"heading_tolerance", location_member_t::kHeadingTolerance},
+      {"preferred_layer", location_member_t::kPreferredLayer},
+      {"node_snap_tolerance", location_member_t::kNodeSnapTolerance},
+      {"minimum_reachability", location_member_t::kMinimumReachability},
+      {"radius", location_member_t::kRadius},
+      {"accuracy", location_member_t::kAccuracy},
+      {"time", location_member_t::kTime},
+      {"rank_candidates", location_member_t::kRankCandidates},
+      {"preferred_side", location_member_t::kPreferredSide},
+      {"display_lat", location_member_t::kDisplayLat},
+      {"display_lon", location_member_t::kDisplayLon},
+      {"search_cutoff", location_member_t::kSearchCutoff},
+      {"street_side_tolerance", location_member_t::kStreetSideTolerance},
+      {"street_side_max_distance", location_member_t::kStreetSideMaxDistance},
+      {"street_side_cutoff", location_member_t::kStreetSideCutoff},
+      {"waiting", location_member_t::kWaiting},
+      {"search_filter", location_member_t::kSearchFilter},
+  };
+  static const std::unordered_map<std::string_view, location_member_t> search_filter_members{
+      {"min_road_class", location_member_t::kMinRoadClass},
+      {"max_road_class", location_member_t::kMaxRoadClass},
+      {"exclude_tunnel", location_member_t::kExcludeTunnel},
+      {"exclude_bridge", location_member_t::kExcludeBridge},
+      {"exclude_toll", location_member_t::kExcludeToll},
+      {"exclude_ramp", location_member_t::kExcludeRamp},
+      {"exclude_ferry", location_member_t::kExcludeFerry},
+      {"level", location_member_t::kLevel},
+      {"exclude_closures", location_member_t::kExcludeClosures},
+  };
+  const auto& members = search_filter ? search_filter_members : location_members;
+  auto found = members.find(key);
+  return found == members.cend() ? location_member_t::kUnknown : found->second;
+}
+
+/**
+ * Parses a member of a json location, or of its search_filter, into the location. Values are
+ * converted the way rapidjson::get_optional converts them and the ones it can't convert are
+ * ignored, as if the member wasn't there
+ *
+ * @param location  the location to fill in
+ * @param json      the members of the location which parse_location applies
+ * @param member    which member it is
+ * @param value     the value of the member
+ */
+void parse_location_member(valhalla::Location& location,
+                           json_location_t& json,
+                           location_member_t member,
+                           const rapidjson::Value& value) {
+  using rapidjson::get_optional;
+  switch (member) {
+    case location_member_t::kLat:
+      if (auto lat = get_optional<double>(value))
+        location.mutable_ll()->set_lat(*lat);
+      break;
+    case location_member_t::kLon:
+      if (auto lon = get_optional<double>(value))
+        location.mutable_ll()->set_lng(*lon);
+      break;
+    case location_member_t::kType:
+      if (auto type_str = get_optional<std::string>(value)) {
+        Location::Type type = Location::kBreak;
+        Location_Type_Enum_Parse(*type_str, &type);
+        json.type = type;
+      }
+      break;
+    case location_member_t::kName:
+      if (value.IsString())
+        location.set_name(value.GetString(), value.GetStringLength());
+      break;
+    case location_member_t::kStreet:
+      if (value.IsString())
+        location.set_street(value.GetString(), value.GetStringLength());
+      break;
+    case location_member_t::kDateTime:
+      if (value.IsString())
+        location.set_date_time(value.GetString(), value.GetStringLength());
+      break;
+    case location_member_t::kHeading:
+      if (auto heading = get_optional<int>(value))
+        location.set_heading(*heading);
+      break;
+    case location_member_t::kHeadingTolerance:
+      if (auto heading_tolerance = get_optional<int>(value))
+        location.set_heading_tolerance(*heading_tolerance);
+      break;
+    case location_member_t::kPreferredLayer:
+      if (auto preferred_layer = get_optional<int>(value))
+        location.set_preferred_layer(*preferred_layer);
+      break;
+    case location_member_t::kNodeSnapTolerance:
+      if (auto node_snap_tolerance = get_optional<float>(value))
+        location.set_node_snap_tolerance(*node_snap_tolerance);
+      break;
+    case location_member_t::kMinimumReachability:
+      if (auto minimum_reachability = get_optional<unsigned int>(value))
+        location.set_minimum_reachability(*minimum_reachability);
+      break;
+    case location_member_t::kRadius:
+      if (auto radius = get_optional<unsigned int>(value))
+        location.set_radius(*radius);
+      break;
+    case location_member_t::kAccuracy:
+      if (auto accuracy = get_optional<unsigned int>(value))
+        location.set_accuracy(*accuracy);
+      break;
+    case location_member_t::kTime:
+      json.time = get_optional<double>(value);
+      break;
+    case location_member_t::kRankCandidates:
+      if (auto rank_candidates = get_optional<bool>(value))
+        location.set_skip_ranking_candidates(!*rank_candidates);
+      break;
+    case location_member_t::kPreferredSide:
+      if (auto preferred_side = get_optional<std::string>(value)) {
+        valhalla::Location::PreferredSide side;
+        if (PreferredSide_Enum_Parse(*preferred_side, &side))
+          location.set_preferred_side(side);
+      }
+      break;
+    case location_member_t::kDisplayLat:
+      if (auto lat = get_optional<double>(value))
+        location.mutable_display_ll()->set_lat(*lat);
+      break;
+    case location_member_t::kDisplayLon:
+      if (auto lon = get_optional<double>(value))
+        location.mutable_display_ll()->set_lng(*lon);
+      break;
+    case location_member_t::kSearchCutoff:
+      if (auto search_cutoff = get_optional<unsigned int>(value))
+        location.set_search_cutoff(*search_cutoff);
+      break;
+    case location_member_t::kStreetSideTolerance:
+      if (auto street_side_tolerance = get_optional<unsigned int>(value))
+        location.set_street_side_tolerance(*street_side_tolerance);
+      break;
+    case location_member_t::kStreetSideMaxDistance:
+      if (auto street_side_max_distance = get_optional<unsigned int>(value))
+        location.set_street_side_max_distance(*street_side_max_distance);
+      break;
+    case location_member_t::kStreetSideCutoff:
+      if (auto street_side_cutoff = get_optional<std::string>(value)) {
+        valhalla::RoadClass cutoff_street_side;
+        if (RoadClass_Enum_Parse(*street_side_cutoff, &cutoff_street_side))
+          location.set_street_side_cutoff(cutoff_street_side);
+      }
+      break;
+    case location_member_t::kWaiting:
+      if (auto waiting = get_optional<float>(value))
+        json.waiting = *waiting;
+      break;
+    // whatever the search_filter is its members get their defaults
+    case location_member_t::kSearchFilter: {
+      auto* search_filter = location.mutable_search_filter();
+      search_filter->set_min_road_class(valhalla::kServiceOther);
+      search_filter->set_max_road_class(valhalla::kMotorway);
+      search_filter->set_exclude_tunnel(false);
+      search_filter->set_exclude_bridge(false);
+      search_filter->set_exclude_toll(false);
+      search_filter->set_exclude_ramp(false);
+      search_filter->set_exclude_ferry(false);
+      search_filter->set_level(baldr::kMaxLevel);
+      break;
+    }
+    case location_member_t::kMinRoadClass:
+      if (auto min_road_class = get_optional<std::string>(value)) {
+        valhalla::RoadClass min_rc;
+        if (RoadClass_Enum_Parse(*min_road_class, &min_rc))
+          location.mutable_search_filter()->set_min_road_class(min_rc);
+      }
+      break;
+    case location_member_t::kMaxRoadClass:
+      if (auto max_road_class = get_optional<std::string>(value)) {
+        valhalla::RoadClass max_rc;
+        if (RoadClass_Enum_Parse(*max_road_class, &max_rc))
+          location.mutable_search_filter()->set_max_road_class(max_rc);
+      }
+      break;
+    case location_member_t::kExcludeTunnel:
+      if (auto exclude = get_optional<bool>(value))
+        location.mutable_search_filter()->set_exclude_tunnel(*exclude);
+      break;
+    case location_member_t::kExcludeBridge:
+      if (auto exclude = get_optional<bool>(value))
+        location.mutable_search_filter()->set_exclude_bridge(*exclude);
+      break;
+    case location_member_t::kExcludeToll:
+      if (auto exclude = get_optional<bool>(value))
+        location.mutable_search_filter()->set_exclude_toll(*exclude);
+      break;
+    case location_member_t::kExcludeRamp:
+      if (auto exclude = get_optional<bool>(value))
+        location.mutable_search_filter()->set_exclude_ramp(*exclude);
+      break;
+    case location_member_t::kExcludeFerry:
+      if (auto exclude = get_optional<bool>(value))
+        location.mutable_search_filter()->set_exclude_ferry(*exclude);
+      break;
+    case location_member_t::kLevel:
+      if (auto level = get_optional<float>(value))
+        location.mutable_search_filter()->set_level(*level);
+      break;
+    case location_member_t::kExcludeClosures:
+      if (auto exclude = get_optional<bool>(value))
+        location.mutable_search_filter()->set_exclude_closures(*exclude);
+      break;
+    case location_member_t::kUnknown:
+      break;
+  }
+}
+
+// The locations of a member of the request, exclude and avoid locations share theirs
+google::protobuf::RepeatedPtrField<valhalla::Location>* locations_of(Options& options,
+                                                                     std::string_view node) {
+  if (node == "locations") {
+    return options.mutable_locations();
+  } else if (node == "shape") {
+    return options.mutable_shape();
+  } else if (node == "trace") {
+    return options.mutable_trace();
+  } else if (node == "sources") {
+    return options.mutable_sources();
+  } else if (node == "targets") {
+    return options.mutable_targets();
+  } else if (node == "exclude_locations" || node == "avoid_locations") {
+    return options.mutable_exclude_locations();
+  }
+  return nullptr;
+}
+
+/**
+ * The location arrays and the encoded_polyline of a json request. They are what makes the bodies
+ * of large matrix and map matching requests large, so rather than going to the document they are
+ * parsed straight into protobuf while the request is read. They are kept on the arena of the
+ * request so that handing them over to its options is a swap
+ */
+struct json_locations_t {
+  explicit json_locations_t(google::protobuf::Arena* arena)
+      : options(google::protobuf::Arena::Create<Options>(arena)) {
+  }
+  ~json_locations_t() {
+    if (!options->GetArena())
+      delete options;
+  }
+  json_locations_t(const json_locations_t&) = delete;
+  json_locations_t& operator=(const json_locations_t&) = delete;
+
+  // whether anything was taken out of the request
+  bool empty() const {
+    return members.empty() && !options->has_encoded_polyline_case();
+  }
+
+  // the parsed locations and encoded_polyline
+  Options* options;
+  // the members parse_location applies by location array
+  std::unordered_map<std::string, std::vector<json_location_t>> members;
+};
+
+/**
+ * Sits between the reader and the document of a json request and takes the location arrays and
+ * the encoded_polyline out of the stream, everything else is passed on to the document. Only the
+ * first occurrence of a member is taken, that is the one a lookup in the document would find
+ */
+template <typename handler_t> class json_locations_handler_t {
+public:
+  using Ch = char;
+
+  json_locations_handler_t(handler_t& document, json_locations_t& json)
+      : document_(document), json_(json) {
+  }
+
+  bool Null() {
+    return Consume(rapidjson::Value()) || (Flush() && document_.Null());
+  }
+  bool Bool(bool b) {
+    return Consume(rapidjson::Value(b)) || (Flush() && document_.Bool(b));
+  }
+  bool Int(int i) {
+    return Consume(rapidjson::Value(i)) || (Flush() && document_.Int(i));
+  }
+  bool Uint(unsigned u) {
+    return Consume(rapidjson::Value(u)) || (Flush() && document_.Uint(u));
+  }
+  bool Int64(int64_t i) {
+    return Consume(rapidjson::Value(i)) || (Flush() && document_.Int64(i));
+  }
+  bool Uint64(uint64_t u) {
+    return Consume(rapidjson::Value(u)) || (Flush() && document_.Uint64(u));
+  }
+  bool Double(double d) {
+    return Consume(rapidjson::Value(d)) || (Flush() && document_.Double(d));
+  }
+  // the document keeps raw numbers as strings so we do the same
+  bool RawNumber(const Ch* str, rapidjson::SizeType length, bool copy) {
+    return Consume(rapidjson::Value(rapidjson::StringRef(str, length))) ||
+           (Flush() && document_.RawNumber(str, length, copy));
+  }
+  bool String(const Ch* str, rapidjson::SizeType length, bool copy) {
+    return Consume(rapidjson::Value(rapidjson::StringRef(str, length))) ||
+           (Flush() && document_.String(str, length, copy));
+  }
+
+  bool StartObject() {
+    if (skip_ || locations_)
+      return Nested(true);
+    ++depth_;
+    return Flush() && document_.StartObject();
+  }
+  bool Key(const Ch* str, rapidjson::SizeType length, bool copy) {
+    if (skip_)
+      return true;
+    // the members of a location
+    if (locations_) {
+      location_member_t& member = level_ == 1 ? member_ : search_filter_member_;
+      member = to_location_member({str, length}, level_ == 2);
+      auto& seen = level_ == 1 ? seen_ : search_filter_seen_;
+      const uint64_t bit = uint64_t(1) << static_cast<uint8_t>(member);
+      if (seen & bit)
+        member = location_member_t::kUnknown;
+      seen |= bit;
+      return true;
+    }
+    // the members of the request we want
+    if (depth_ == 1) {
+      std::string_view key(str, length);
+      if ((key == "encoded_polyline" || locations_of(*json_.options, key)) &&
+          taken_.emplace(key).second) {
+        pending_ = key;
+        return true;
+      }
+      ++root_members_;
+    }
+    return document_.Key(str, length, copy);
+  }
+  bool EndObject(rapidjson::SizeType count) {
+    if (skip_ || locations_)
+      return EndNested();
+    // the request is missing the members we took out of it
+    return document_.EndObject(--depth_ == 0 ? root_members_ : count);
+  }
+
+  bool StartArray() {
+    if (skip_ || locations_)
+      return Nested(false);
+    // its a location array we want
+    if (!pending_.empty() && pending_ != "encoded_polyline") {
+      Start();
+      return true;
+    }
+    ++depth_;
+    return Flush() && document_.StartArray();
+  }
+  bool EndArray(rapidjson::SizeType count) {
+    if (skip_ || locations_)
+      return EndNested();
+    --depth_;
+    return document_.EndArray(count);
+  }
+
+protected:
+  // Take the value if its part of a location array or the encoded_polyline
+  bool Consume(const rapidjson::Value& value) {
+    if (skip_)
+      return true;
+    if (locations_) {
+      // anything but an object makes a location without members
+      if (level_ == 0)
+        Add();
+      else
+        parse_location_member(*location_, members_of_->back(),
+                              level_ == 1 ? member_ : search_filter_member_, value);
+      return true;
+    }
+    if (pending_ == "encoded_polyline" && value.IsString()) {
+      json_.options->set_encoded_polyline(value.GetString(), value.GetStringLength());
+      pending_.clear();
+      return true;
+    }
+    return false;
+  }
+
+  // Pass on the member we held back because its value isn't one we want
+  bool Flush() {
+    if (pending_.empty())
+      return true;
+    ++root_members_;
+    bool ok = document_.Key(pending_.c_str(), static_cast<rapidjson::SizeType>(pending_.size()),
+                            true);
+    pending_.clear();
+    return ok;
+  }
+
+  // Start parsing the location array of the pending member
+  void Start() {
+    // avoid_locations takes precedence over exclude_locations
+    if (pending_ == "exclude_locations" && json_.members.count("avoid_locations")) {
+      skip_ = 1;
+    } else {
+      locations_ = locations_of(*json_.options, pending_);
+      if (pending_ == "avoid_locations") {
+        locations_->Clear();
+        json_.members.erase("exclude_locations");
+      }
+      members_of_ = &json_.members[pending_];
+      level_ = 0;
+    }
+    pending_.clear();
+  }
+
+  // Add a location to the array we are parsing
+  void Add() {
+    location_ = locations_->Add();
+    members_of_->emplace_back();
+    seen_ = 0;
+  }
+
+  // An object or array starts inside of a location array
+  bool Nested(bool object) {
+    if (skip_) {
+      ++skip_;
+      return true;
+    }
+    switch (level_) {
+      // a location
+      case 0:
+        Add();
+        if (object) {
+          level_ = 1;
+          return true;
+        }
+        break;
+      // the value of a member of a location
+      case 1:
+        if (member_ == location_member_t::kSearchFilter) {
+          parse_location_member(*location_, members_of_->back(), member_, rapidjson::Value());
+          if (object) {
+            search_filter_seen_ = 0;
+            level_ = 2;
+            return true;
+          }
+        }
+        break;
+      default:
+        break;
+    }
+    // nothing in here is of any use
+    skip_ = 1;
+    return true;
+  }
+
+  // An object or array ends inside of a location array
+  bool EndNested() {
+    if (skip_) {
+      --skip_;
+    } else if (level_ == 0) {
+      locations_ = nullptr;
+    } else {
+      --level_;
+    }
+    return true;
+  }
+
+  handler_t& document_;
+  json_locations_t& json_;
+  // how deep we are in the document and how many members its root has
+  size_t depth_ = 0;
+  rapidjson::SizeType root_members_ = 0;
+  // the members of the request we took or may take
+  std::unordered_set<std::string> taken_;
+  std::string pending_;
+  // the location array we are in, if any, and how deep we are in it
+  google::protobuf::RepeatedPtrField<valhalla::Location>* locations_ = nullptr;
+  std::vector<json_location_t>* members_of_ = nullptr;
+  valhalla::Location* location_ = nullptr;
+  size_t level_ = 0;
+  // the member whose value comes next and the members we already saw
+  location_member_t member_ = location_member_t::kUnknown;
+  location_member_t search_filter_member_ = location_member_t::kUnknown;
+  uint64_t seen_ = 0;
+  uint64_t search_filter_seen_ = 0;
+  // how deep we are in something we are skipping
+  size_t skip_ = 0;
+};
+
+/**
+ * Parses a json request into a document and its location arrays and encoded_polyline into
+ * protobuf, see json_locations_handler_t
+ *
+ * @param json       the request
+ * @param doc        the document to parse the request into
+ * @param locations  the locations of the request
+ * @return false if the json couldn't be parsed
+ */
+bool parse_json(const char* json, rapidjson::Document& doc, json_locations_t& locations) {
+  rapidjson::ParseResult result;
+  auto generator = [&](auto& document) {
+    json_locations_handler_t<std::decay_t<decltype(document)>> handler(document, locations);
+    rapidjson::StringStream stream(json);
+    rapidjson::Reader reader;
+    result = reader.Parse(stream, handler);
+    return !result.IsError();
+  };
+  doc.Populate(generator);
+  return !result.IsError();
+}
+
+rapidjson::Document
+from_string(const std::string& json, json_locations_t& locations, const valhalla_exception_t& e) {
   rapidjson::Document d;
   if (json.empty()) {
     d.SetObject();
     return d;
   }
-  d.Parse(json.c_str());
-  if (d.HasParseError()) {
+  if (!parse_json(json.c_str(), d, locations)) {
     throw e;
   }
   return d;
@@ -185,170 +749,48 @@ void parse_ring(ring_pbf_t* ring, const rapidjson::Value& coord_array) {
 }
 
 void parse_location(valhalla::Location* location,
-                    const rapidjson::Value& r_loc,
+                    const json_location_t& json,
                     Api& request,
                     const boost::optional<bool>& ignore_closures,
                     bool is_last_loc) {
-  auto lat = rapidjson::get_optional<double>(r_loc, "/lat");
-  if (location->has_ll() && location->ll().has_lat_case()) {
-    lat = location->ll().lat();
-  }
-  if (!lat) {
+  if (!location->has_ll() || !location->ll().has_lat_case()) {
     throw std::runtime_error{"lat is missing"};
   };
-
-  if (*lat < -90.0 || *lat > 90.0) {
+  auto lat = location->ll().lat();
+  if (lat < -90.0 || lat > 90.0) {
     throw std::runtime_error("Latitude must be in the range [-90, 90] degrees");
   }
 
-  auto lon = rapidjson::get_optional<double>(r_loc, "/lon");
-  if (location->has_ll() && location->ll().has_lng_case()) {
-    lon = location->ll().lng();
-  }
-  if (!lon) {
+  if (!location->ll().has_lng_case()) {
     throw std::runtime_error{"lon is missing"};
   };
-
-  lon = midgard::circular_range_clamp<double>(*lon, -180, 180);
-  location->mutable_ll()->set_lat(*lat);
-  location->mutable_ll()->set_lng(*lon);
+  location->mutable_ll()->set_lng(
+      midgard::circular_range_clamp<double>(location->ll().lng(), -180, 180));
 
   // trace attributes does not support legs or breaks at discontinuities
-  auto stop_type_json = rapidjson::get_optional<std::string>(r_loc, "/type");
   if (request.options().action() == Options::trace_attributes) {
     location->set_type(valhalla::Location::kVia);
   } // other actions let you specify whatever type of stop you want
-  else if (stop_type_json) {
-    Location::Type type = Location::kBreak;
-    Location_Type_Enum_Parse(*stop_type_json, &type);
-    location->set_type(type);
+  else if (json.type) {
+    location->set_type(*json.type);
   } // and if you didnt set it it defaulted to break which is not the default for trace_route
   else if (request.options().action() == Options::trace_route && !location->has_time_case()) {
     location->set_type(valhalla::Location::kVia);
   }
 
-  auto name = rapidjson::get_optional<std::string>(r_loc, "/name");
-  if (name) {
-    location->set_name(*name);
-  }
-  auto street = rapidjson::get_optional<std::string>(r_loc, "/street");
-  if (street) {
-    location->set_street(*street);
-  }
-  auto date_time = rapidjson::get_optional<std::string>(r_loc, "/date_time");
-  if (date_time) {
-    location->set_date_time(*date_time);
-  }
-  auto heading = rapidjson::get_optional<int>(r_loc, "/heading");
-  if (heading) {
-    location->set_heading(*heading);
-  }
-  auto heading_tolerance = rapidjson::get_optional<int>(r_loc, "/heading_tolerance");
-  if (heading_tolerance) {
-    location->set_heading_tolerance(*heading_tolerance);
-  }
-  auto preferred_layer = rapidjson::get_optional<int>(r_loc, "/preferred_layer");
-  if (preferred_layer) {
-    location->set_preferred_layer(*preferred_layer);
-  }
-  auto node_snap_tolerance = rapidjson::get_optional<float>(r_loc, "/node_snap_tolerance");
-  if (node_snap_tolerance) {
-    location->set_node_snap_tolerance(*node_snap_tolerance);
-  }
-  auto minimum_reachability = rapidjson::get_optional<unsigned int>(r_loc, "/minimum_reachability");
-  if (minimum_reachability) {
-    location->set_minimum_reachability(*minimum_reachability);
-  }
-  auto radius = rapidjson::get_optional<unsigned int>(r_loc, "/radius");
-  if (radius) {
-    location->set_radius(*radius);
-  }
-  auto accuracy = rapidjson::get_optional<unsigned int>(r_loc, "/accuracy");
-  if (accuracy) {
-    location->set_accuracy(*accuracy);
-  }
-  auto time =
-      rapidjson::get<double>(r_loc, "/time", location->has_time_case() ? location->time() : -1);
-  location->set_time(time);
-  auto rank_candidates =
-      rapidjson::get<bool>(r_loc, "/rank_candidates", !location->skip_ranking_candidates());
-  location->set_skip_ranking_candidates(!rank_candidates);
-  auto preferred_side = rapidjson::get_optional<std::string>(r_loc, "/preferred_side");
-  valhalla::Location::PreferredSide side;
-  if (preferred_side && PreferredSide_Enum_Parse(*preferred_side, &side)) {
-    location->set_preferred_side(side);
-  }
-  lat = rapidjson::get_optional<double>(r_loc, "/display_lat");
-  if (location->has_display_ll() && location->display_ll().has_lat_case())
-    lat = location->display_ll().lat();
-  lon = rapidjson::get_optional<double>(r_loc, "/display_lon");
-  if (location->has_display_ll() && location->display_ll().has_lng_case())
-    lon = location->display_ll().lng();
-  if (lat && lon && *lat >= -90.0 && *lat <= 90.0) {
-    lon = midgard::circular_range_clamp<double>(*lon, -180, 180);
-    location->mutable_display_ll()->set_lat(*lat);
-    location->mutable_display_ll()->set_lng(*lon);
+  location->set_time(json.time ? *json.time : (location->has_time_case() ? location->time() : -1));
+  if (location->has_display_ll() && location->display_ll().has_lat_case() &&
+      location->display_ll().has_lng_case() && location->display_ll().lat() >= -90.0 &&
+      location->display_ll().lat() <= 90.0) {
+    location->mutable_display_ll()->set_lng(
+        midgard::circular_range_clamp<double>(location->display_ll().lng(), -180, 180));
   } else
     location->clear_display_ll();
-  auto search_cutoff = rapidjson::get_optional<unsigned int>(r_loc, "/search_cutoff");
-  if (search_cutoff) {
-    location->set_search_cutoff(*search_cutoff);
-  }
-  auto street_side_tolerance = rapidjson::get_optional<unsigned int>(r_loc, "/street_side_tolerance");
-  if (street_side_tolerance) {
-    location->set_street_side_tolerance(*street_side_tolerance);
-  }
-  auto street_side_max_distance =
-      rapidjson::get_optional<unsigned int>(r_loc, "/street_side_max_distance");
-  if (street_side_max_distance) {
-    location->set_street_side_max_distance(*street_side_max_distance);
-  }
-  auto street_side_cutoff = rapidjson::get_optional<std::string>(r_loc, "/street_side_cutoff");
-  if (street_side_cutoff) {
-    valhalla::RoadClass cutoff_street_side;
-    if (RoadClass_Enum_Parse(*street_side_cutoff, &cutoff_street_side)) {
-      location->set_street_side_cutoff(cutoff_street_side);
-    }
-  }
 
+  // json search filters were given their defaults while parsing, the only thing left to do is to
+  // make sure that the ones of pbf are valid
   boost::optional<bool> exclude_closures;
-  // is it json?
-  auto search_filter = rapidjson::get_child_optional(r_loc, "/search_filter");
-  if (search_filter) {
-    // search_filter.min_road_class
-    auto min_road_class =
-        rapidjson::get<std::string>(*search_filter, "/min_road_class", "service_other");
-    valhalla::RoadClass min_rc;
-    if (RoadClass_Enum_Parse(min_road_class, &min_rc)) {
-      location->mutable_search_filter()->set_min_road_class(min_rc);
-    }
-    // search_filter.max_road_class
-    auto max_road_class = rapidjson::get<std::string>(*search_filter, "/max_road_class", "motorway");
-    valhalla::RoadClass max_rc;
-    if (RoadClass_Enum_Parse(max_road_class, &max_rc)) {
-      location->mutable_search_filter()->set_max_road_class(max_rc);
-    }
-    // search_filter.exclude_tunnel
-    location->mutable_search_filter()->set_exclude_tunnel(
-        rapidjson::get<bool>(*search_filter, "/exclude_tunnel", false));
-    // search_filter.exclude_bridge
-    location->mutable_search_filter()->set_exclude_bridge(
-        rapidjson::get<bool>(*search_filter, "/exclude_bridge", false));
-    // search_filter.exclude_toll
-    location->mutable_search_filter()->set_exclude_toll(
-        rapidjson::get<bool>(*search_filter, "/exclude_toll", false));
-    // search_filter.exclude_ramp
-    location->mutable_search_filter()->set_exclude_ramp(
-        rapidjson::get<bool>(*search_filter, "/exclude_ramp", false));
-    // search_filter.exclude_ferry
-    location->mutable_search_filter()->set_exclude_ferry(
-        rapidjson::get<bool>(*search_filter, "/exclude_ferry", false));
-    location->mutable_search_filter()->set_level(
-        rapidjson::get<float>(*search_filter, "/level", baldr::kMaxLevel));
-    // search_filter.exclude_closures
-    exclude_closures = rapidjson::get_optional<bool>(*search_filter, "/exclude_closures");
-  } // or is it pbf
-  else if (location->has_search_filter()) {
+  if (location->has_search_filter()) {
     if (location->search_filter().has_min_road_class_case() &&
         !RoadClass_IsValid(location->search_filter().min_road_class()))
       location->mutable_search_filter()->clear_min_road_class();
@@ -376,7 +818,7 @@ void parse_location(valhalla::Location* location,
   if (!location->search_filter().has_level_case())
     location->mutable_search_filter()->set_level(baldr::kMaxLevel);
 
-  float waiting_secs = rapidjson::get<float>(r_loc, "/waiting", 0.f);
+  float waiting_secs = json.waiting;
   switch (location->type()) {
     case Location_Type_kBreak:
     case Location_Type_kBreakThrough:
@@ -398,6 +840,7 @@ void parse_location(valhalla::Location* location,
  * Parses the locations and sets some defaults
  *
  * @param doc                       The JSON body
+ * @param json                      The locations parsed out of the JSON body
  * @param options                   The request options to be filled in
  * @param node                      The type of locations passed
  * @param location_parse_error_code The code raised if this method throws
@@ -405,6 +848,7 @@ void parse_location(valhalla::Location* location,
  * @param had_date_time             Gets set to true if any location had a date_time string
  */
 void parse_locations(const rapidjson::Document& doc,
+                     json_locations_t& json,
                      Api& request,
                      const std::string& node,
                      unsigned location_parse_error_code,
@@ -412,48 +856,37 @@ void parse_locations(const rapidjson::Document& doc,
                      bool& had_date_time) {
   auto& options = *request.mutable_options();
 
-  google::protobuf::RepeatedPtrField<valhalla::Location>* locations = nullptr;
-  if (node == "locations") {
-    locations = options.mutable_locations();
-  } else if (node == "shape") {
-    locations = options.mutable_shape();
-  } else if (node == "trace") {
-    locations = options.mutable_trace();
-  } else if (node == "sources") {
-    locations = options.mutable_sources();
-  } else if (node == "targets") {
-    locations = options.mutable_targets();
-  } else if (node == "exclude_locations" || node == "avoid_locations") {
-    locations = options.mutable_exclude_locations();
-  } else {
+  auto* locations = locations_of(options, node);
+  if (!locations) {
     return;
   }
 
   bool filter_closures = true;
   bool loc_had_time = false;
   try {
-    // should we parse json?
-    auto request_locations =
-        rapidjson::get_optional<rapidjson::Value::ConstArray>(doc, std::string("/" + node).c_str());
-    if (request_locations) {
-      int last_loc_idx = static_cast<int>(request_locations->Size()) - 1;
-      for (const auto& r_loc : *request_locations) {
-        auto* loc = locations->Add();
-        auto loc_idx = locations->size() - 1;
-        loc->mutable_correlation()->set_original_index(loc_idx);
-        parse_location(loc, r_loc, request, ignore_closures, loc_idx == last_loc_idx);
-        loc_had_time = loc_had_time || !loc->date_time().empty();
-        // turn off filtering closures when any locations search filter allows closures
-        filter_closures = filter_closures && loc->search_filter().exclude_closures();
-      }
-    } // maybe its deserialized pbf
-    else if (!locations->empty()) {
+    // if its json we take over the locations that were parsed along with it, otherwise its
+    // deserialized pbf and the locations are already there
+    static const json_location_t no_members;
+    const std::vector<json_location_t>* members = nullptr;
+    auto parsed = json.members.find(node);
+    if (parsed != json.members.cend()) {
+      locations->Swap(locations_of(*json.options, node));
+      members = &parsed->second;
+    } // only the query string puts location arrays in the document and strings aren't locations
+    else if (auto listed = rapidjson::get_optional<rapidjson::Value::ConstArray>(
+                 doc, std::string("/" + node).c_str());
+             listed && !listed->Empty()) {
+      throw std::runtime_error{"lat is missing"};
+    }
+
+    if (!locations->empty()) {
       uint32_t i = 0;
       uint32_t locs_amount = locations->size() - 1;
       for (auto& loc : *locations) {
         bool is_last_edge = i == locs_amount;
+        const auto& loc_members = members ? (*members)[i] : no_members;
         loc.mutable_correlation()->set_original_index(i++);
-        parse_location(&loc, {}, request, ignore_closures, is_last_edge);
+        parse_location(&loc, loc_members, request, ignore_closures, is_last_edge);
         loc_had_time = loc_had_time || !loc.date_time().empty();
         // turn off filtering closures when any locations search filter allows closures
         filter_closures = filter_closures && loc.search_filter().exclude_closures();
@@ -622,13 +1055,14 @@ void parse_line(const rapidjson::Value& json_feat, valhalla::LinearFeatureCost*
  * function will still validate it and set the defaults, but if json is provided it will
  * override anything this is in the options object
  * @param doc      the rapidjson request doc
+ * @param json     the locations and encoded_polyline parsed out of the json
  * @param action   which request action will be performed
  * @param options  the options to fill out or validate if they are already filled out
  */
-void from_json(rapidjson::Document& doc, Options::Action action, Api& api) {
+void from_json(rapidjson::Document& doc, json_locations_t& json, Options::Action action, Api& api) {
   // if its a pbf request we want to keep the options and clear the rest
   bool pbf = false;
-  if (api.has_options() && doc.ObjectEmpty()) {
+  if (api.has_options() && doc.ObjectEmpty() && json.empty()) {
     api.clear_trip();
     api.clear_directions();
     api.clear_status();
@@ -931,8 +1365,10 @@ void from_json(rapidjson::Document& doc, Options::Action action, Api& api) {
   bool had_date_time = false;
 
   // parse map matching location input and encoded_polyline for height actions
-  auto encoded_polyline = rapidjson::get_optional<std::string>(doc, "/encoded_polyline");
-  if (encoded_polyline) {
+  if (json.options->has_encoded_polyline_case()) {
+    options.mutable_encoded_polyline()->swap(*json.options->mutable_encoded_polyline());
+  } else if (auto encoded_polyline =
+                 rapidjson::get_optional<std::string>(doc, "/encoded_polyline")) {
     options.set_encoded_polyline(*encoded_polyline);
   }
   if (options.has_encoded_polyline_case()) {
@@ -945,10 +1381,13 @@ void from_json(rapidjson::Document& doc, Options::Action action, Api& api) {
       precision = options.shape_format() == valhalla::polyline5 ? 1e-5 : 1e-6;
     }
 
+    // decode straight into the shape
     options.mutable_shape()->Clear();
-    auto decoded =
-        midgard::decode<std::vector<midgard::PointLL>>(options.encoded_polyline(), precision);
-    for (const auto& ll : decoded) {
+    const auto& encoded = options.encoded_polyline();
+    midgard::Shape5Decoder<midgard::PointLL> decoder(encoded.c_str(), encoded.size(), precision);
+    options.mutable_shape()->Reserve(static_cast<int>(encoded.size() / 4));
+    while (!decoder.empty()) {
+      const auto ll = decoder.pop();
       auto* sll = options.mutable_shape()->Add();
       sll->mutable_ll()->set_lat(ll.lat());
       sll->mutable_ll()->set_lng(ll.lng());
@@ -965,11 +1404,11 @@ void from_json(rapidjson::Document& doc, Options::Action action, Api& api) {
     add_date_to_locations(options, *options.mutable_shape(), "shape");
   } // fall back from encoded polyline to array of locations
   else {
-    parse_locations(doc, api, "shape", 134, ignore_closures, had_date_time);
+    parse_locations(doc, json, api, "shape", 134, ignore_closures, had_date_time);
 
     // if no shape then try 'trace'
     if (options.shape().size() == 0) {
-      parse_locations(doc, api, "trace", 135, ignore_closures, had_date_time);
+      parse_locations(doc, json, api, "trace", 135, ignore_closures, had_date_time);
     }
   }
 
@@ -1050,13 +1489,13 @@ void from_json(rapidjson::Document& doc, Options::Action action, Api& api) {
   parse_recostings(doc, "/recostings", options, warnings);
 
   // get the locations in there
-  parse_locations(doc, api, "locations", 130, ignore_closures, had_date_time);
+  parse_locations(doc, json, api, "locations", 130, ignore_closures, had_date_time);
 
   // get the sources in there
-  parse_locations(doc, api, "sources", 131, ignore_closures, had_date_time);
+  parse_locations(doc, json, api, "sources", 131, ignore_closures, had_date_time);
 
   // get the targets in there
-  parse_locations(doc, api, "targets", 132, ignore_closures, had_date_time);
+  parse_locations(doc, json, api, "targets", 132, ignore_closures, had_date_time);
 
   // if not a time dependent route/mapmatch disable time dependent edge speed/flow data sources
   if (options.date_time_type() == Options::no_time && !had_date_time &&
@@ -1070,10 +1509,10 @@ void from_json(rapidjson::Document& doc, Options::Action action, Api& api) {
 
   // get the avoids in there
   // TODO: remove "avoid_locations/polygons" after some while
-  if (doc.HasMember("avoid_locations"))
-    parse_locations(doc, api, "avoid_locations", 133, ignore_closures, had_date_time);
+  if (doc.HasMember("avoid_locations") || json.members.count("avoid_locations"))
+    parse_locations(doc, json, api, "avoid_locations", 133, ignore_closures, had_date_time);
   else
-    parse_locations(doc, api, "exclude_locations", 133, ignore_closures, had_date_time);
+    parse_locations(doc, json, api, "exclude_locations", 133, ignore_closures, had_date_time);
 
   // Get the matrix_loctions option and set if sources or targets size is one
   // (option is only supported with one to many or many to one matrix requests)
@@ -1381,8 +1820,9 @@ std::string serialize_error(const valhalla_exception_t& exception, Api& request)
 
 void ParseApi(const std::string& request, Options::Action action, valhalla::Api& api) {
   // maybe parse some json
-  auto document = from_string(request, valhalla_exception_t{100});
-  from_json(document, action, api);
+  json_locations_t json(api.GetArena());
+  auto document = from_string(request, json, valhalla_exception_t{100});
+  from_json(document, json, action, api);
 }
 
 hierarchy_limits_config_t
@@ -1513,6 +1953,8 @@ bool check_hierarchy_limits(std::vector<HierarchyLimits>& hierarchy_limits,
 
 #ifdef ENABLE_SERVICES
 void ParseApi(const http_request_t& request, valhalla::Api& api) {
+  midgard::metrics::stage_timer_t timer(midgard::metrics::stage_t::parse);
+
   // block all but get and post
   if (request.method != method_t::POST && request.method != method_t::GET) {
     throw valhalla_exception_t{101};
@@ -1536,26 +1978,29 @@ void ParseApi(const http_request_t& request, valhalla::Api& api) {
     // validate the options
     rapidjson::Document dummy;
     dummy.SetObject();
-    from_json(dummy, action, api);
+    json_locations_t no_locations(api.GetArena());
+    from_json(dummy, no_locations, action, api);
     return;
   }
 
   // parse the json input
   rapidjson::Document document;
+  json_locations_t locations(api.GetArena());
   auto& allocator = document.GetAllocator();
   const auto& json = request.query.find("json");
+  bool parsed = true;
   if (json != request.query.end() && json->second.size() && json->second.front().size()) {
-    document.Parse(json->second.front().c_str());
+    parsed = parse_json(json->second.front().c_str(), document, locations);
   } // no json parameter, check the body
   else if (!request.body.empty()) {
-    document.Parse(request.body.c_str());
+    parsed = parse_json(request.body.c_str(), document, locations);
   } // no json at all
   else {
     document.SetObject();
   }
 
   // if parsing failed
-  if (document.HasParseError()) {
+  if (!parsed) {
     throw valhalla_exception_t{100};
   };
 
@@ -1581,7 +2026,7 @@ void ParseApi(const http_request_t& request, valhalla::Api& api) {
   }
 
   // parse out the options
-  from_json(document, action, api);
+  from_json(document, locations, action, api);
 }
 
 const headers_t::value_type CORS{"Access-Control-Allow-Origin", "*"};
@@ -1601,6 +2046,16 @@ worker_t::result_t serialize_error(const valhalla_exception_t& exception,
   return result;
 }
 
+worker_t::result_t serialize_metrics(http_request_info_t& request_info) {
+  worker_t::result_t result{false, std::list<std::string>(), ""};
+  http_response_t response(200, "OK",
+                           midgard::metrics::to_prometheus(midgard::metrics::snapshot()),
+                           headers_t{CORS, worker::PROMETHEUS_MIME});
+  response.from_info(request_info);
+  result.messages.emplace_back(response.to_string());
+  return result;
+}
+
 worker_t::result_t
 to_response(const std::string& data,
             http_request_info_t& request_info,
@@ -1662,7 +2117,37 @@ struct statsd_client_t : public Statsd::StatsdClient {
   std::vector<std::string> tags;
 };
 
-service_worker_t::service_worker_t(const boost::property_tree::ptree& conf) : interrupt(nullptr) {
+request_arena_t::request_arena_t(const boost::property_tree::ptree& config)
+    : block_size_(config.get<size_t>("httpd.service.arena_bytes", 1024 * 1024)) {
+}
+
+Api& request_arena_t::request() {
+  // the first block is only taken once there is a request to put into it
+  if (!arena_) {
+    google::protobuf::ArenaOptions options;
+    if (block_size_) {
+      block_.reset(new char[block_size_]);
+      options.initial_block = block_.get();
+      options.initial_block_size = block_size_;
+    }
+    arena_ = std::make_unique<google::protobuf::Arena>(options);
+  }
+  return *google::protobuf::Arena::Create<Api>(arena_.get());
+}
+
+void request_arena_t::reset() {
+  // the first block is kept, anything beyond it goes back to the heap
+  if (arena_) {
+    arena_->Reset();
+  }
+}
+
+uint64_t request_arena_t::allocated() const {
+  return arena_ ? arena_->SpaceAllocated() : 0;
+}
+
+service_worker_t::service_worker_t(const boost::property_tree::ptree& conf)
+    : interrupt(nullptr), arena(conf) {
   if (conf.count("statsd")) {
     statsd_client = std::make_unique<statsd_client_t>(conf);
   }
@@ -1673,7 +2158,19 @@ void service_worker_t::set_interrupt(const std::function<void()>* interrupt_func
   interrupt = interrupt_function;
 }
 void service_worker_t::cleanup() {
+  // how much the requests since the last cleanup took and whether they outgrew the first block
+  const auto allocated = arena.allocated();
+  if (allocated > arena.block_size()) {
+    LOG_DEBUG(std::to_string(allocated) + " bytes of requests outgrew the " +
+              std::to_string(arena.block_size()) + " byte arena block");
+  }
+  arena.reset();
+
   if (statsd_client) {
+    if (allocated) {
+      statsd_client->gauge("none.info." + service_name() + ".arena_kb",
+                           static_cast<unsigned int>(allocated / 1024), 1.f, statsd_client->tags);
+    }
     // sends metrics to statsd server over udp
     statsd_client->flush();
   }
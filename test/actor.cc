@@ -1,3 +1,4 @@
+#include "exceptions.h"
 #include "tyr/actor.h"
 #include "test.h"
 
@@ -56,6 +57,10 @@ TEST(Actor, Basic) {
   actor.cleanup();
   auto status = test::json_to_pt(status_json);
   ASSERT_NE(status_json.find("Polygon"), std::string::npos);
+  // the stages of the routes above were timed
+  EXPECT_GE(status.get<uint64_t>("metrics.stages.path.count"), 2);
+  EXPECT_GE(status.get<uint64_t>("metrics.stages.narrative.count"), 2);
+  EXPECT_GT(status.get<uint64_t>("metrics.counters.tile_cache_misses"), 0);
 
   // TODO: test the rest of them
 }
@@ -78,6 +83,40 @@ TEST(Actor, TraceAttributes) {
   EXPECT_THROW(actor.trace_attributes(request, &interrupt), test_exception_t);
 }
 
+TEST(Actor, Budget) {
+  // the budget is only charged for the edges the matrix settles, a short one is done long before
+  // it checks the budget for the first time
+  const auto short_conf =
+      test::make_config(VALHALLA_SOURCE_DIR "test/traffic_matcher_tiles",
+                        {{"service_limits.budget.max_settled_edges", "1"}});
+  tyr::actor_t short_actor(short_conf);
+  EXPECT_FALSE(short_actor
+                   .matrix(R"({"sources":[{"lat":40.546115,"lon":-76.385076}],
+        "targets":[{"lat":40.544232,"lon":-76.385752}],"costing":"auto"})")
+                   .empty());
+
+  // across utrecht the searches settle more than that
+  const std::string request = R"({"sources":[{"lat":52.106337,"lon":5.101728},
+        {"lat":52.111276,"lon":5.089717},{"lat":52.103105,"lon":5.081005},
+        {"lat":52.103948,"lon":5.06813}],"targets":[{"lat":52.106126,"lon":5.101497},
+        {"lat":52.100469,"lon":5.087099},{"lat":52.103105,"lon":5.081005},
+        {"lat":52.094273,"lon":5.075254}],"costing":"auto"})";
+  const auto spent_conf = test::make_config(VALHALLA_BUILD_DIR "test/data/utrecht_tiles",
+                                            {{"service_limits.budget.max_settled_edges", "1"}});
+  tyr::actor_t spent(spent_conf);
+  try {
+    spent.matrix(request);
+    FAIL() << "Expected the budget to be spent";
+  } catch (const valhalla_exception_t& e) { EXPECT_EQ(e.code, 447); }
+
+  // and with enough of a budget the same request goes through
+  const auto enough_conf =
+      test::make_config(VALHALLA_BUILD_DIR "test/data/utrecht_tiles",
+                        {{"service_limits.budget.max_settled_edges", "10000000"}});
+  tyr::actor_t enough(enough_conf);
+  EXPECT_FALSE(enough.matrix(request).empty());
+}
+
 TEST(Actor, Tile) {
   const auto utrecht_conf = test::make_config(VALHALLA_BUILD_DIR "test/data/utrecht_tiles");
   tyr::actor_t actor(utrecht_conf);
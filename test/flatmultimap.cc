@@ -0,0 +1,85 @@
+#include "mjolnir/flatmultimap.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+using namespace valhalla::mjolnir;
+
+namespace {
+
+struct Value {
+  uint32_t a;
+  uint8_t b;
+};
+
+TEST(FlatMultiMap, EqualRange) {
+  FlatMultiMap<Value> map;
+  map.insert({7, {1, 1}});
+  map.emplace(3, {2, 2});
+  map.insert({7, {3, 3}});
+  map.insert({5, {4, 4}});
+  EXPECT_THROW(map.equal_range(7), std::logic_error) << "lookups need the map to be sorted";
+
+  map.sort();
+  EXPECT_EQ(map.size(), 4);
+
+  // the values of a key keep the order in which they were added
+  auto range = map.equal_range(7);
+  ASSERT_EQ(range.second - range.first, 2);
+  EXPECT_EQ(range.first->second.a, 1);
+  EXPECT_EQ((range.first + 1)->second.a, 3);
+
+  EXPECT_EQ(map.find(5)->second.a, 4);
+  EXPECT_EQ(map.find(4), map.end());
+  range = map.equal_range(8);
+  EXPECT_EQ(range.first, map.end());
+  EXPECT_EQ(range.second, map.end());
+}
+
+TEST(FlatMultiMap, WriteAndMap) {
+  const std::string file_name = VALHALLA_BUILD_DIR "test/data/flatmultimap.bin";
+  FlatMultiMap<Value> written;
+  for (uint64_t key = 100; key > 0; --key) {
+    written.emplace(key % 10, {static_cast<uint32_t>(key), static_cast<uint8_t>(key % 3)});
+  }
+  ASSERT_TRUE(written.write(file_name));
+
+  FlatMultiMap<Value> mapped;
+  ASSERT_TRUE(mapped.map(file_name));
+  ASSERT_EQ(mapped.size(), written.size());
+  for (uint64_t key = 0; key < 10; ++key) {
+    const auto range = mapped.equal_range(key);
+    ASSERT_EQ(range.second - range.first, 10);
+    for (auto it = range.first; it != range.second; ++it) {
+      EXPECT_EQ(it->first, key);
+      EXPECT_EQ(it->second.a % 10, key);
+    }
+  }
+
+  // adding to a mapped map copies it, the copies of the map still see the file
+  FlatMultiMap<Value> copy = mapped;
+  mapped.emplace(3, {1000, 0});
+  mapped.sort();
+  EXPECT_EQ(mapped.equal_range(3).second - mapped.equal_range(3).first, 11);
+  EXPECT_EQ(copy.equal_range(3).second - copy.equal_range(3).first, 10);
+
+  // an empty map is an empty file
+  const std::string empty_file_name = file_name + ".empty";
+  FlatMultiMap<Value> empty;
+  ASSERT_TRUE(empty.write(empty_file_name));
+  ASSERT_TRUE(copy.map(empty_file_name));
+  EXPECT_TRUE(copy.empty());
+  EXPECT_EQ(copy.find(3), copy.end());
+  std::filesystem::remove(file_name);
+  std::filesystem::remove(empty_file_name);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -763,6 +763,51 @@ TEST(GraphParser, TestImportBssNode) {
   CleanUp();
 }
 
+TEST(GraphParser, TestParallelSameAsSerial) {
+  boost::property_tree::ptree conf;
+  rapidjson::read_json(config_file, conf);
+
+  // more than one file, so every pass starts over on ids which are only sorted within a file
+  const std::vector<std::string> input_files = {VALHALLA_SOURCE_DIR "test/data/baltimore.osm.pbf",
+                                                VALHALLA_SOURCE_DIR "test/data/nyc.osm.pbf"};
+  const auto parse = [&](size_t concurrency, const std::string& suffix) {
+    conf.put("mjolnir.concurrency", concurrency);
+    auto osmdata = PBFGraphParser::ParseWays(conf.get_child("mjolnir"), input_files,
+                                             ways_file + suffix, way_nodes_file + suffix,
+                                             access_file + suffix);
+    PBFGraphParser::ParseRelations(conf.get_child("mjolnir"), input_files,
+                                   from_restriction_file + suffix, to_restriction_file + suffix,
+                                   osmdata);
+    PBFGraphParser::ParseNodes(conf.get_child("mjolnir"), input_files, way_nodes_file + suffix,
+                               bss_nodes_file + suffix, linguistic_node_file + suffix, osmdata);
+    return osmdata;
+  };
+
+  // a single Lua worker against seven, one core is left for the reader thread
+  auto serial = parse(1, ".serial");
+  auto parallel = parse(8, ".parallel");
+
+  EXPECT_EQ(serial.osm_way_count, parallel.osm_way_count);
+  EXPECT_EQ(serial.osm_way_node_count, parallel.osm_way_node_count);
+  EXPECT_EQ(serial.osm_node_count, parallel.osm_node_count);
+  EXPECT_EQ(serial.node_count, parallel.node_count);
+  EXPECT_EQ(serial.edge_count, parallel.edge_count);
+  EXPECT_EQ(serial.restrictions.size(), parallel.restrictions.size());
+
+  const auto read = [](const std::string& file) {
+    std::ifstream in(file, std::ios::binary);
+    return std::string((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+  };
+  for (const auto& file : {ways_file, way_nodes_file, access_file, from_restriction_file,
+                           to_restriction_file, linguistic_node_file}) {
+    EXPECT_EQ(read(file + ".serial"), read(file + ".parallel")) << file << " differs";
+    std::filesystem::remove(file + ".serial");
+    std::filesystem::remove(file + ".parallel");
+  }
+  std::filesystem::remove(bss_nodes_file + ".serial");
+  std::filesystem::remove(bss_nodes_file + ".parallel");
+}
+
 } // namespace
 
 class GraphParserEnv : public ::testing::Environment {
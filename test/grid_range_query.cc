@@ -18,6 +18,8 @@ TEST(GridRangeQuery, TestAddLineSegment) {
   meili::GridRangeQuery<int, midgard::PointLL> grid(bbox, 1.f, 1.f);
 
   grid.AddLineSegment(0, LineSegment({2.5, 3.5}, {10, 3.5}));
+  EXPECT_TRUE(grid.GetItemsInSquare(2, 3).empty()) << "items should only show up once compacted";
+  grid.Compact();
   const auto& items23 = grid.GetItemsInSquare(2, 3);
   EXPECT_EQ(items23.size(), 1) << "should be added to Cell(2, 3)";
 
@@ -28,15 +30,20 @@ TEST(GridRangeQuery, TestAddLineSegment) {
   EXPECT_TRUE(items88.empty()) << "nothing should be added to Cell(8, 8)";
 
   grid.AddLineSegment(1, LineSegment({10, 3.5}, {2.5, 3.5}));
+  grid.Compact();
   const auto& items33 = grid.GetItemsInSquare(2, 3);
   EXPECT_EQ(items33.size(), 2) << "2 items should be added to Cell(2, 3)";
+  EXPECT_EQ(items33[0], 0) << "items should keep the order they were added in";
+  EXPECT_EQ(items33[1], 1) << "items should keep the order they were added in";
 
   grid.AddLineSegment(0, LineSegment({-10, -10}, {110, 110}));
+  grid.Compact();
   const auto& items50 = grid.GetItemsInSquare(50, 50);
   EXPECT_EQ(items50.size(), 1) << "should be added to Cell(50, 50)";
 
   const auto& old_item00_size = grid.GetItemsInSquare(0, 0).size();
   grid.AddLineSegment(0, LineSegment({0.5, 0.5}, {0.5, 0.5}));
+  grid.Compact();
   EXPECT_EQ(grid.GetItemsInSquare(0, 0).size(), old_item00_size + 1)
       << "empty segment should be added";
 
@@ -55,6 +62,8 @@ TEST(GridRangeQuery, TestQuery) {
   meili::GridRangeQuery<int, midgard::PointLL> grid(bbox, 1.f, 1.f);
 
   grid.AddLineSegment(0, LineSegment({2.5, 3.5}, {10, 3.5}));
+  grid.AddLineSegment(1, LineSegment({2.5, 50.5}, {2.5, 50.5}));
+  grid.Compact();
 
   auto items = grid.Query(BoundingBox(2, 2, 5, 5));
   EXPECT_EQ(items.size(), 1 && items.find(0) != items.end()) << "query should get item 0";
@@ -65,6 +74,9 @@ TEST(GridRangeQuery, TestQuery) {
   items = grid.Query(BoundingBox(2, 3, 2.5, 3.5));
   EXPECT_EQ(items.size(), 1);
   EXPECT_NE(items.find(0), items.end()) << "query should get item 0";
+
+  items = grid.Query(BoundingBox(0, 0, 100, 100));
+  EXPECT_EQ(items.size(), 2) << "query should get both items";
 }
 
 } // namespace
@@ -0,0 +1,153 @@
+#include "gurka.h"
+#include "mjolnir/util.h"
+
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <iomanip>
+
+using namespace valhalla;
+using namespace valhalla::baldr;
+
+namespace {
+
+const std::string ascii_map = R"(
+    A----B----C----D
+    |         |
+    E----F----G----H
+         |
+         I----J)";
+
+const gurka::nodes nodes = {{"A", {{"osm_id", "1"}}}, {"B", {{"osm_id", "2"}}},
+                            {"C", {{"osm_id", "3"}}}, {"D", {{"osm_id", "4"}}},
+                            {"E", {{"osm_id", "5"}}}, {"F", {{"osm_id", "6"}}},
+                            {"G", {{"osm_id", "7"}}}, {"H", {{"osm_id", "8"}}},
+                            {"I", {{"osm_id", "9"}}}, {"J", {{"osm_id", "10"}}}};
+
+const gurka::ways ways = {{"ABCD", {{"highway", "primary"}, {"osm_id", "101"}}},
+                          {"EFGH", {{"highway", "secondary"}, {"osm_id", "102"}}},
+                          {"AE", {{"highway", "residential"}, {"osm_id", "103"}}},
+                          {"CG", {{"highway", "residential"}, {"osm_id", "104"}}},
+                          {"FIJ", {{"highway", "tertiary"}, {"osm_id", "105"}}}};
+
+// EFGH is upgraded, FIJ is removed and IJ is added
+const gurka::ways changed_ways = {{"ABCD", {{"highway", "primary"}, {"osm_id", "101"}}},
+                                  {"EFGH", {{"highway", "primary"}, {"osm_id", "102"}}},
+                                  {"AE", {{"highway", "residential"}, {"osm_id", "103"}}},
+                                  {"CG", {{"highway", "residential"}, {"osm_id", "104"}}},
+                                  {"FI", {{"highway", "tertiary"}, {"osm_id", "106"}}}};
+
+const std::string changes = R"(<?xml version="1.0" encoding="UTF-8"?>
+<osmChange version="0.6" generator="gurka">
+  <modify>
+    <way id="102" version="2">
+      <nd ref="5"/><nd ref="6"/><nd ref="7"/><nd ref="8"/>
+      <tag k="highway" v="primary"/>
+    </way>
+  </modify>
+  <create>
+    <way id="106" version="1">
+      <nd ref="6"/><nd ref="9"/>
+      <tag k="highway" v="tertiary"/>
+    </way>
+  </create>
+  <delete>
+    <way id="105" version="2"/>
+    <node id="10" version="2"/>
+  </delete>
+</osmChange>
+)";
+
+// every tile updated from the changes has to be the same as the one built from scratch
+void expect_same_tiles(const gurka::map& incremental_map, const gurka::map& full_map) {
+  GraphReader incremental_reader(incremental_map.config.get_child("mjolnir"));
+  GraphReader full_reader(full_map.config.get_child("mjolnir"));
+  const auto tiles = full_reader.GetTileSet();
+  ASSERT_EQ(incremental_reader.GetTileSet(), tiles);
+
+  const auto raw_tile = [](const graph_tile_ptr& tile) {
+    const GraphTileHeader* header = tile->header();
+    return std::string(reinterpret_cast<const char*>(header) + sizeof(*header),
+                       header->end_offset() - sizeof(*header));
+  };
+  std::unordered_set<uint64_t> checksums;
+  for (const auto& tile_id : tiles) {
+    auto incremental_tile = incremental_reader.GetGraphTile(tile_id);
+    auto full_tile = full_reader.GetGraphTile(tile_id);
+    EXPECT_EQ(raw_tile(incremental_tile), raw_tile(full_tile))
+        << "Tile " << GraphTile::FileSuffix(tile_id) << " differs";
+    checksums.insert(incremental_tile->header()->checksum());
+  }
+
+  // tiles which were not rebuilt still get the checksum of the changed input
+  EXPECT_EQ(checksums.size(), 1);
+}
+
+} // namespace
+
+// updating tiles from an OSM change file has to give the same tiles as building them from scratch
+TEST(IncrementalBuild, SameAsFullBuild) {
+  const auto layout = gurka::detail::map_to_coordinates(ascii_map, 100000);
+  const std::string workdir = "test/data/gurka_incremental_build";
+
+  // a full build which keeps its enhanced local tiles around
+  auto incremental_map =
+      gurka::buildtiles(layout, ways, nodes, {}, workdir + "/incremental",
+                        {{"mjolnir.incremental_dir", workdir + "/incremental/local"}});
+
+  // apply the changes to the input and update the tiles from them
+  const std::string pbf = workdir + "/incremental/changed.pbf";
+  const std::string osc = workdir + "/incremental/changes.osc";
+  gurka::detail::build_pbf(layout, changed_ways, nodes, {}, pbf);
+  std::ofstream(osc) << changes;
+  ASSERT_TRUE(mjolnir::build_tile_set(incremental_map.config, {pbf},
+                                      mjolnir::BuildStage::kInitialize,
+                                      mjolnir::BuildStage::kValidate, {osc}));
+
+  // and from scratch
+  auto full_map = gurka::buildtiles(layout, changed_ways, nodes, {}, workdir + "/full");
+
+  expect_same_tiles(incremental_map, full_map);
+
+  // the new way can be routed on
+  auto result = gurka::do_action(valhalla::Options::route, incremental_map, {"E", "I"}, "auto");
+  gurka::assert::raw::expect_path(result, {"EFGH", "FI"});
+}
+
+// a node which only moves changes the ways using it, in the tiles it moves from and to
+TEST(IncrementalBuild, MovedNode) {
+  const auto layout = gurka::detail::map_to_coordinates(ascii_map, 100000);
+  const std::string workdir = "test/data/gurka_incremental_build_moved_node";
+
+  auto incremental_map =
+      gurka::buildtiles(layout, ways, nodes, {}, workdir + "/incremental",
+                        {{"mjolnir.incremental_dir", workdir + "/incremental/local"}});
+
+  // J moves to the far side of D, none of the ways change
+  auto moved_layout = layout;
+  moved_layout["J"] = {layout.at("D").lng() + 1.5, layout.at("D").lat() + 1.5};
+  const std::string pbf = workdir + "/incremental/changed.pbf";
+  const std::string osc = workdir + "/incremental/changes.osc";
+  gurka::detail::build_pbf(moved_layout, ways, nodes, {}, pbf);
+  std::ofstream change(osc);
+  change << std::fixed << std::setprecision(7) << R"(<?xml version="1.0" encoding="UTF-8"?>
+<osmChange version="0.6" generator="gurka">
+  <modify>
+    <node id="10" version="2" lat=")"
+         << moved_layout["J"].lat() << R"(" lon=")" << moved_layout["J"].lng() << R"("/>
+  </modify>
+</osmChange>
+)";
+  change.close();
+  ASSERT_TRUE(mjolnir::build_tile_set(incremental_map.config, {pbf},
+                                      mjolnir::BuildStage::kInitialize,
+                                      mjolnir::BuildStage::kValidate, {osc}));
+
+  auto full_map = gurka::buildtiles(moved_layout, ways, nodes, {}, workdir + "/full");
+  expect_same_tiles(incremental_map, full_map);
+
+  // the way follows the node
+  incremental_map.nodes = moved_layout;
+  auto result = gurka::do_action(valhalla::Options::route, incremental_map, {"I", "J"}, "auto");
+  gurka::assert::raw::expect_path(result, {"FIJ"});
+}
@@ -4,6 +4,8 @@
 #include <boost/format.hpp>
 #include <gtest/gtest.h>
 
+#include <set>
+
 using namespace valhalla;
 
 TEST(Standalone, OsrmSerializerShape) {
@@ -1183,3 +1185,111 @@ TEST_F(Rotary, EndOnRotary) {
   EXPECT_STREQ(primary_0["type"].GetString(), "rotary");
   ASSERT_TRUE(primary_0.HasMember("degrees"));
 }
+
+TEST(Standalone, MultiLegStepsDocument) {
+  const std::string ascii_map = R"(
+    A------B------C
+           |      |
+           D------E
+  )";
+
+  const gurka::ways ways = {
+      {"AB", {{"highway", "primary"}, {"name", "Ash Street"}}},
+      {"BC", {{"highway", "primary"}, {"name", "Ash Street"}}},
+      {"BD", {{"highway", "residential"}, {"name", "Birch Lane"}}},
+      {"DE", {{"highway", "residential"}, {"name", "Cedar Lane"}, {"ref", "C1"}}},
+      {"EC", {{"highway", "residential"}, {"name", "Elm Lane"}}},
+  };
+  const auto layout = gurka::detail::map_to_coordinates(ascii_map, 50, {0, 0});
+  auto map = gurka::buildtiles(layout, ways, {}, {}, "test/data/osrm_serializer_multi_leg");
+
+  const std::string request =
+      (boost::format(
+           R"({"locations":[{"lat":%s,"lon":%s},{"lat":%s,"lon":%s},{"lat":%s,"lon":%s}],)"
+           R"("costing":"auto","banner_instructions":true,"voice_instructions":true,)"
+           R"("filters":{"action":"include","attributes":["shape_attributes.time",)"
+           R"("shape_attributes.length","shape_attributes.speed"]}})") %
+       std::to_string(map.nodes.at("A").lat()) % std::to_string(map.nodes.at("A").lng()) %
+       std::to_string(map.nodes.at("D").lat()) % std::to_string(map.nodes.at("D").lng()) %
+       std::to_string(map.nodes.at("C").lat()) % std::to_string(map.nodes.at("C").lng()))
+          .str();
+  auto result = gurka::do_action(valhalla::Options::route, map, request);
+  auto json = gurka::convert_to_json(result, Options::Format::Options_Format_osrm);
+
+  // the members of each object have to be the ones the baldr::json based serializer wrote for it,
+  // the streamed document may only differ in member order and number formatting
+  const auto check_members = [](const rapidjson::Value& object,
+                                const std::set<std::string>& required,
+                                const std::set<std::string>& optional) {
+    ASSERT_TRUE(object.IsObject());
+    std::set<std::string> members;
+    for (const auto& member : object.GetObject()) {
+      const std::string name = member.name.GetString();
+      EXPECT_TRUE(required.count(name) || optional.count(name)) << name;
+      EXPECT_TRUE(members.insert(name).second) << name << " is written twice";
+    }
+    for (const auto& name : required) {
+      EXPECT_TRUE(members.count(name)) << name << " is missing";
+    }
+  };
+
+  check_members(json, {"code", "waypoints", "routes"}, {});
+  EXPECT_STREQ(json["code"].GetString(), "Ok");
+  EXPECT_EQ(json["waypoints"].Size(), 3);
+  ASSERT_EQ(json["routes"].Size(), 1);
+
+  const auto& route = json["routes"][0];
+  check_members(route, {"distance", "duration", "weight", "weight_name", "geometry", "legs",
+                        "voiceLocale"},
+                {});
+  ASSERT_EQ(route["legs"].Size(), 2);
+
+  double route_distance = 0;
+  for (const auto& leg : route["legs"].GetArray()) {
+    check_members(leg, {"summary", "distance", "duration", "weight", "admins", "steps",
+                        "annotation", "via_waypoints"},
+                  {"incidents", "closures"});
+    route_distance += leg["distance"].GetDouble();
+
+    const auto& annotation = leg["annotation"];
+    check_members(annotation, {"duration", "distance", "speed"}, {});
+    EXPECT_EQ(annotation["duration"].Size(), annotation["distance"].Size());
+    EXPECT_EQ(annotation["speed"].Size(), annotation["distance"].Size());
+    double annotated_distance = 0;
+    for (const auto& distance : annotation["distance"].GetArray()) {
+      annotated_distance += distance.GetDouble();
+    }
+    EXPECT_NEAR(annotated_distance, leg["distance"].GetDouble(), 1.0);
+
+    // the banner and voice instructions of a step are those of the maneuver that follows it, the
+    // arrival has none
+    const auto& steps = leg["steps"];
+    ASSERT_GT(steps.Size(), 1);
+    double step_distance = 0;
+    for (rapidjson::SizeType i = 0; i < steps.Size(); ++i) {
+      const auto& step = steps[i];
+      check_members(step, {"mode", "driving_side", "distance", "duration", "weight", "name",
+                           "maneuver", "intersections", "geometry", "bannerInstructions",
+                           "voiceInstructions"},
+                    {"ref", "pronunciation", "speedLimitSign", "speedLimitUnit", "rotary_name",
+                     "destinations", "exits", "junction_name", "guidance_views"});
+      check_members(step["maneuver"],
+                    {"location", "bearing_before", "bearing_after", "type", "instruction"},
+                    {"modifier", "exit"});
+      step_distance += step["distance"].GetDouble();
+
+      const bool arrival = i + 1 == steps.Size();
+      EXPECT_EQ(step["bannerInstructions"].Empty(), arrival);
+      EXPECT_EQ(step["voiceInstructions"].Empty(), arrival);
+      for (const auto& banner : step["bannerInstructions"].GetArray()) {
+        check_members(banner, {"distanceAlongGeometry", "primary"}, {"secondary", "sub"});
+      }
+      for (const auto& voice : step["voiceInstructions"].GetArray()) {
+        check_members(voice, {"distanceAlongGeometry", "announcement", "ssmlAnnouncement"}, {});
+      }
+    }
+    EXPECT_STREQ(steps[steps.Size() - 1]["maneuver"]["type"].GetString(), "arrive");
+    EXPECT_NEAR(step_distance, leg["distance"].GetDouble(), 1.0);
+  }
+  EXPECT_NEAR(route_distance, route["distance"].GetDouble(), 1.0);
+}
@@ -116,15 +116,26 @@ uint64_t get_pbf_md5(std::string pbf_path) {
 // 1. build tiles with the same input twice
 // 2. check that the same tile sets are generated
 struct ReproducibleBuild : ::testing::Test {
-  void BuildTiles(const std::string& ascii_map, const gurka::ways& ways, const double gridsize) {
-    const auto build_tiles = [&](const std::string& dir) -> std::pair<gurka::map, std::string> {
+  // optionally the two builds can use a different number of threads and the second one can use
+  // other options on top
+  void BuildTiles(const std::string& ascii_map,
+                  const gurka::ways& ways,
+                  const double gridsize,
+                  const std::pair<std::string, std::string>& concurrency = {},
+                  const std::unordered_map<std::string, std::string>& second_options = {}) {
+    const auto build_tiles = [&](const std::string& dir, const std::string& threads,
+                                 std::unordered_map<std::string, std::string> options)
+        -> std::pair<gurka::map, std::string> {
       const gurka::nodelayout layout = gurka::detail::map_to_coordinates(ascii_map, gridsize);
       const std::string workdir = "test/data/gurka_reproduce_tile_build/" + dir;
-      return std::make_pair(gurka::buildtiles(layout, ways, {}, {}, workdir, {}),
+      if (!threads.empty()) {
+        options["mjolnir.concurrency"] = threads;
+      }
+      return std::make_pair(gurka::buildtiles(layout, ways, {}, {}, workdir, options),
                             workdir + "/map.pbf");
     };
-    const auto [first_map, first_pbf] = build_tiles("1");
-    const auto [second_map, second_pbf] = build_tiles("2");
+    const auto [first_map, first_pbf] = build_tiles("1", concurrency.first, {});
+    const auto [second_map, second_pbf] = build_tiles("2", concurrency.second, second_options);
     // the checksums will differ when the PBFs weren't produced in the same second due to OSM header
     const auto first_pbf_md5 = get_pbf_md5(first_pbf);
     const auto second_pbf_md5 = get_pbf_md5(second_pbf);
@@ -193,3 +204,53 @@ TEST_F(ReproducibleBuild, BigGridSize) {
                             {"EH", {{"highway", "path"}}}};
   BuildTiles(ascii_map, ways, 100000);
 }
+
+TEST_F(ReproducibleBuild, DifferentConcurrency) {
+  const std::string ascii_map = R"(
+    A----B----C
+    |    |    |
+    D----E----F
+    |    |    |
+    G----H----I)";
+
+  // a mix of levels spread over many tiles so that they are built by different threads
+  const gurka::ways ways = {{"ABC", {{"highway", "motorway"}}},
+                            {"DEF", {{"highway", "primary"}}},
+                            {"GHI", {{"highway", "residential"}}},
+                            {"ADG", {{"highway", "trunk"}}},
+                            {"BEH", {{"highway", "tertiary"}}},
+                            {"CFI", {{"highway", "secondary"}}}};
+  BuildTiles(ascii_map, ways, 100000, {"1", "4"});
+}
+
+TEST_F(ReproducibleBuild, ShortcutsAcrossTilesWithDifferentConcurrency) {
+  const std::string ascii_map = R"(
+    A--B--C--D--E--F--G
+             |
+             H--I--J)";
+
+  // long contractable chains spanning many tiles, so that shortcuts cross tiles which are
+  // formed by different threads
+  const gurka::ways ways = {{"ABCD", {{"highway", "motorway"}, {"oneway", "no"}}},
+                            {"DEFG", {{"highway", "motorway"}, {"oneway", "no"}}},
+                            {"DHIJ", {{"highway", "trunk"}, {"oneway", "no"}}}};
+  BuildTiles(ascii_map, ways, 100000, {"1", "4"});
+}
+
+TEST_F(ReproducibleBuild, MemoryBudget) {
+  const std::string ascii_map = R"(
+    A----B----C
+    |    |    |
+    D----E----F
+    |    |    |
+    G----H----I)";
+
+  // a budget smaller than any tile builds every tile in a batch of its own
+  const gurka::ways ways = {{"ABC", {{"highway", "motorway"}}},
+                            {"DEF", {{"highway", "primary"}}},
+                            {"GHI", {{"highway", "residential"}}},
+                            {"ADG", {{"highway", "trunk"}}},
+                            {"BEH", {{"highway", "tertiary"}}},
+                            {"CFI", {{"highway", "secondary"}}}};
+  BuildTiles(ascii_map, ways, 100000, {"4", "4"}, {{"mjolnir.max_memory", "1"}});
+}
@@ -0,0 +1,113 @@
+#include "gurka.h"
+#include "mjolnir/util.h"
+
+#include <gtest/gtest.h>
+
+#include <filesystem>
+
+using namespace valhalla;
+using namespace valhalla::baldr;
+
+namespace {
+
+const std::string ascii_map = R"(
+    A----B----C
+    |         |
+    D----E----F)";
+
+const gurka::ways ways = {{"ABC", {{"highway", "primary"}}},
+                          {"DEF", {{"highway", "secondary"}}},
+                          {"AD", {{"highway", "residential"}}},
+                          {"CF", {{"highway", "residential"}}}};
+
+} // namespace
+
+TEST(ResumeBuild, ResumesAfterLastCompletedStage) {
+  const auto layout = gurka::detail::map_to_coordinates(ascii_map, 100);
+  const std::string workdir = "test/data/gurka_resume_build";
+  auto map = gurka::buildtiles(layout, ways, {}, {}, workdir);
+  const std::string pbf = workdir + "/map.pbf";
+
+  // everything up to validating the tiles completed
+  ASSERT_EQ(mjolnir::resume_stage(map.config, {pbf}), mjolnir::BuildStage::kCleanup);
+
+  // a build interrupted while enhancing the tiles picks up there
+  ASSERT_TRUE(mjolnir::build_tile_set(map.config, {pbf}, mjolnir::BuildStage::kInitialize,
+                                      mjolnir::BuildStage::kBuild));
+  ASSERT_EQ(mjolnir::resume_stage(map.config, {pbf}), mjolnir::BuildStage::kEnhance);
+
+  // unless the interrupted stage already rewrote some of the tiles
+  const auto tile_id = TileHierarchy::GetGraphId(layout.at("A"), 2);
+  const auto tile = std::filesystem::path(workdir) / GraphTile::FileSuffix(tile_id);
+  std::filesystem::last_write_time(tile, std::filesystem::last_write_time(tile) +
+                                             std::chrono::seconds(1));
+  ASSERT_EQ(mjolnir::resume_stage(map.config, {pbf}), mjolnir::BuildStage::kBuild);
+
+  // resuming gives working tiles
+  ASSERT_TRUE(mjolnir::build_tile_set(map.config, {pbf}, mjolnir::BuildStage::kBuild,
+                                      mjolnir::BuildStage::kValidate));
+  ASSERT_EQ(mjolnir::resume_stage(map.config, {pbf}), mjolnir::BuildStage::kCleanup);
+  auto result = gurka::do_action(valhalla::Options::route, map, {"A", "F"}, "auto");
+  gurka::assert::raw::expect_path(result, {"ABC", "CF"});
+
+  // there is nothing left to do once the temporary files are gone
+  ASSERT_TRUE(mjolnir::build_tile_set(map.config, {pbf}, mjolnir::BuildStage::kCleanup,
+                                      mjolnir::BuildStage::kCleanup));
+  ASSERT_FALSE(mjolnir::resume_stage(map.config, {pbf}));
+}
+
+// elevation is added before the complex restrictions although it comes after them in BuildStage
+TEST(ResumeBuild, FollowsTheOrderTheStagesRunIn) {
+  const auto layout = gurka::detail::map_to_coordinates(ascii_map, 100);
+  const std::string workdir = "test/data/gurka_resume_build_order";
+  auto map = gurka::buildtiles(layout, ways, {}, {}, workdir);
+  const std::string pbf = workdir + "/map.pbf";
+
+  // a build interrupted after adding elevation still has to add the restrictions
+  ASSERT_TRUE(mjolnir::build_tile_set(map.config, {pbf}, mjolnir::BuildStage::kInitialize,
+                                      mjolnir::BuildStage::kElevation));
+  ASSERT_EQ(mjolnir::resume_stage(map.config, {pbf}), mjolnir::BuildStage::kRestrictions);
+
+  // and one interrupted after adding the restrictions does not add elevation again
+  ASSERT_TRUE(mjolnir::build_tile_set(map.config, {pbf}, mjolnir::BuildStage::kRestrictions,
+                                      mjolnir::BuildStage::kRestrictions));
+  ASSERT_EQ(mjolnir::resume_stage(map.config, {pbf}), mjolnir::BuildStage::kValidate);
+
+  ASSERT_TRUE(mjolnir::build_tile_set(map.config, {pbf}, mjolnir::BuildStage::kValidate,
+                                      mjolnir::BuildStage::kValidate));
+  ASSERT_EQ(mjolnir::resume_stage(map.config, {pbf}), mjolnir::BuildStage::kCleanup);
+  auto result = gurka::do_action(valhalla::Options::route, map, {"A", "F"}, "auto");
+  gurka::assert::raw::expect_path(result, {"ABC", "CF"});
+}
+
+TEST(ResumeBuild, SkipsDisabledStages) {
+  const auto layout = gurka::detail::map_to_coordinates(ascii_map, 100);
+  const std::string workdir = "test/data/gurka_resume_build_disabled";
+  auto map = gurka::buildtiles(layout, ways, {}, {}, workdir, {{"mjolnir.hierarchy", "false"}});
+  const std::string pbf = workdir + "/map.pbf";
+
+  ASSERT_TRUE(mjolnir::build_tile_set(map.config, {pbf}, mjolnir::BuildStage::kInitialize,
+                                      mjolnir::BuildStage::kBss));
+  ASSERT_EQ(mjolnir::resume_stage(map.config, {pbf}), mjolnir::BuildStage::kElevation);
+
+  map.config.put("mjolnir.hierarchy", true);
+  map.config.put("mjolnir.shortcuts", false);
+  ASSERT_TRUE(mjolnir::build_tile_set(map.config, {pbf}, mjolnir::BuildStage::kHierarchy,
+                                      mjolnir::BuildStage::kHierarchy));
+  ASSERT_EQ(mjolnir::resume_stage(map.config, {pbf}), mjolnir::BuildStage::kElevation);
+}
+
+TEST(ResumeBuild, StartsOverForOtherInput) {
+  const auto layout = gurka::detail::map_to_coordinates(ascii_map, 100);
+  const std::string workdir = "test/data/gurka_resume_build_other_input";
+  auto map = gurka::buildtiles(layout, ways, {}, {}, workdir);
+
+  const std::string pbf = workdir + "/other.pbf";
+  gurka::detail::build_pbf(layout, {{"ABC", {{"highway", "primary"}}}}, {}, {}, pbf);
+  ASSERT_EQ(mjolnir::resume_stage(map.config, {pbf}), mjolnir::BuildStage::kInitialize);
+
+  // as does a tile directory without a manifest
+  std::filesystem::remove(std::filesystem::path(workdir) / "build_manifest.json");
+  ASSERT_EQ(mjolnir::resume_stage(map.config, {workdir + "/map.pbf"}),
+            mjolnir::BuildStage::kInitialize);
+}
@@ -0,0 +1,155 @@
+#include "test.h"
+#include "tyr/http_frontend.h"
+
+#include <boost/property_tree/ptree.hpp>
+#include <prime_server/http_protocol.hpp>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <regex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace valhalla;
+using namespace prime_server;
+
+namespace {
+
+boost::property_tree::ptree make_config(size_t max_queued) {
+  std::filesystem::path run_dir{VALHALLA_BUILD_DIR "test"};
+  run_dir.append("http_frontend_tmp");
+  std::filesystem::create_directories(run_dir);
+  return test::make_config(run_dir.string(),
+                           {{"httpd.event_loop.max_queued", std::to_string(max_queued)}});
+}
+
+// sends all of the bytes at once and returns the status codes of the responses in the order they
+// came back, the server hangs up after the last one
+std::vector<int> pipeline(const boost::property_tree::ptree& config, const std::string& bytes) {
+  const auto path = config.get<std::string>("httpd.service.listen").substr(6);
+  sockaddr_un address{};
+  address.sun_family = AF_UNIX;
+  std::memcpy(address.sun_path, path.c_str(), path.size());
+  const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  EXPECT_EQ(connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)), 0);
+
+  EXPECT_EQ(send(fd, bytes.data(), bytes.size(), 0), static_cast<ssize_t>(bytes.size()));
+
+  std::string received;
+  char buffer[4096];
+  for (ssize_t size; (size = recv(fd, buffer, sizeof(buffer), 0)) > 0;) {
+    received.append(buffer, size);
+  }
+  close(fd);
+
+  std::vector<int> codes;
+  const std::regex status("HTTP/1\\.1 ([0-9]{3}) ");
+  for (std::sregex_iterator i(received.begin(), received.end(), status), end; i != end; ++i) {
+    codes.push_back(std::stoi((*i)[1]));
+  }
+  return codes;
+}
+
+std::vector<int> pipeline(const boost::property_tree::ptree& config,
+                          const std::vector<http_request_t>& requests) {
+  std::string bytes;
+  for (const auto& request : requests) {
+    bytes += request.to_string();
+  }
+  return pipeline(config, bytes);
+}
+
+const headers_t kClose{{"Connection", "close"}};
+
+TEST(HttpFrontend, pipelined_in_order) {
+  const auto config = make_config(1024);
+  tyr::http_frontend_t frontend(config, 2);
+  std::thread server(&tyr::http_frontend_t::serve, &frontend);
+
+  // the responses come back in the order of the requests no matter which worker is done first
+  const auto codes = pipeline(config, {http_request_t(GET, "/route"), http_request_t(GET, "/nope"),
+                                       http_request_t(PUT, "/route"),
+                                       http_request_t(GET, "/route", "", {}, kClose),
+                                       // never read since the one before closes the connection
+                                       http_request_t(GET, "/nope")});
+  EXPECT_EQ(codes, (std::vector<int>{400, 404, 405, 400}));
+
+  frontend.stop();
+  server.join();
+}
+
+TEST(HttpFrontend, answered_before_bad_request) {
+  const auto config = make_config(1024);
+  tyr::http_frontend_t frontend(config, 1);
+  std::thread server(&tyr::http_frontend_t::serve, &frontend);
+
+  // the requests read along with one that doesn't parse are answered before it is turned away
+  const auto codes =
+      pipeline(config, http_request_t(GET, "/nope").to_string() +
+                           http_request_t(GET, "/route").to_string() + "NOPE / HTTP/1.1\r\n\r\n");
+  ASSERT_EQ(codes.size(), 3);
+  EXPECT_EQ(codes[0], 404);
+  EXPECT_EQ(codes[1], 400);
+  EXPECT_GE(codes[2], 400);
+
+  frontend.stop();
+  server.join();
+}
+
+TEST(HttpFrontend, busy) {
+  // nothing may wait for a worker so everything is turned away
+  const auto config = make_config(0);
+  tyr::http_frontend_t frontend(config, 1);
+  std::thread server(&tyr::http_frontend_t::serve, &frontend);
+
+  const auto codes = pipeline(config, {http_request_t(GET, "/route"),
+                                       http_request_t(GET, "/route", "", {}, kClose)});
+  EXPECT_EQ(codes, (std::vector<int>{503, 503}));
+
+  frontend.stop();
+  server.join();
+}
+
+TEST(HttpFrontend, metrics) {
+  const auto config = make_config(1024);
+  tyr::http_frontend_t frontend(config, 1);
+  std::thread server(&tyr::http_frontend_t::serve, &frontend);
+
+  // not an action but answered all the same
+  const auto codes = pipeline(config, {http_request_t(GET, "/metrics", "", {}, kClose)});
+  EXPECT_EQ(codes, (std::vector<int>{200}));
+
+  frontend.stop();
+  server.join();
+}
+
+TEST(HttpFrontend, pipeline_hops) {
+  EXPECT_EQ(tyr::httpd_worker_t::pipeline_hops(Options::route), 2);
+  EXPECT_EQ(tyr::httpd_worker_t::pipeline_hops(Options::sources_to_targets), 1);
+  EXPECT_EQ(tyr::httpd_worker_t::pipeline_hops(Options::locate), 0);
+}
+
+TEST(HttpFrontend, drain) {
+  const auto config = make_config(1024);
+  tyr::http_frontend_t frontend(config, 1);
+  std::thread server(&tyr::http_frontend_t::serve, &frontend);
+
+  // nothing is left to answer so serve returns long before the time is up
+  const auto start = std::chrono::steady_clock::now();
+  frontend.drain(std::chrono::seconds(30));
+  server.join();
+  EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(10));
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
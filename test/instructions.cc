@@ -1,4 +1,5 @@
 #include "baldr/rapidjson_utils.h"
+#include "exceptions.h"
 #include "odin/directionsbuilder.h"
 #include "odin/markup_formatter.h"
 #include "proto/api.pb.h"
@@ -583,6 +584,136 @@ TEST(Instructions, validate_obvious_maneuver_instructions) {
                     "Continue for a half mile.");
 }
 
+TEST(Instructions, directions_content) {
+  using valhalla::Options;
+  using valhalla::odin::DirectionsContent;
+
+  // the valhalla json has everything but the lanes unless asked for
+  Options options;
+  auto content = DirectionsContent::FromOptions(options);
+  EXPECT_TRUE(content.maneuvers && content.instructions && content.verbal_instructions);
+  EXPECT_FALSE(content.turn_lanes);
+  EXPECT_EQ(content.level(), "verbal");
+
+  // osrm only speaks when asked to
+  options.set_format(Options::osrm);
+  content = DirectionsContent::FromOptions(options);
+  EXPECT_TRUE(content.instructions && content.turn_lanes);
+  EXPECT_FALSE(content.verbal_instructions);
+  options.set_voice_instructions(true);
+  EXPECT_TRUE(DirectionsContent::FromOptions(options).verbal_instructions);
+
+  // the directions type cuts it short regardless of the format
+  options.set_directions_type(valhalla::DirectionsType::maneuvers);
+  EXPECT_EQ(DirectionsContent::FromOptions(options).level(), "maneuvers");
+  options.set_directions_type(valhalla::DirectionsType::none);
+  EXPECT_EQ(DirectionsContent::FromOptions(options).level(), "none");
+  options.set_directions_type(valhalla::DirectionsType::instructions);
+
+  // gpx has none of it
+  options.set_format(Options::gpx);
+  EXPECT_EQ(DirectionsContent::FromOptions(options).level(), "none");
+
+  // pbf has the narrative with the directions and the lanes with the trip
+  options.set_format(Options::pbf);
+  EXPECT_EQ(DirectionsContent::FromOptions(options).level(), "verbal");
+  options.mutable_pbf_field_selector()->set_trip(true);
+  content = DirectionsContent::FromOptions(options);
+  EXPECT_EQ(content.level(), "maneuvers");
+  EXPECT_TRUE(content.turn_lanes);
+  options.mutable_pbf_field_selector()->set_trip(false);
+  options.mutable_pbf_field_selector()->set_options(true);
+  EXPECT_EQ(DirectionsContent::FromOptions(options).level(), "none");
+}
+
+TEST(Instructions, text_instructions_only) {
+  std::string path_bytes = test::load_binary_file(
+      VALHALLA_SOURCE_DIR "test/pinpoints/instructions/ramp_take_toward_driving_side_right.pbf");
+  ASSERT_NE(path_bytes.size(), 0);
+  valhalla::Api full, text;
+  ASSERT_TRUE(full.ParseFromString(path_bytes));
+  ASSERT_TRUE(text.ParseFromString(path_bytes));
+
+  valhalla::odin::DirectionsBuilder().Build(full, valhalla::odin::MarkupFormatter());
+  valhalla::odin::DirectionsContent content;
+  content.verbal_instructions = false;
+  valhalla::odin::DirectionsBuilder().Build(text, valhalla::odin::MarkupFormatter(), content);
+
+  // the same text without any of the verbal instructions
+  const auto& full_leg = full.directions().routes(0).legs(0);
+  const auto& text_leg = text.directions().routes(0).legs(0);
+  ASSERT_EQ(text_leg.maneuver_size(), full_leg.maneuver_size());
+  for (int i = 0; i < text_leg.maneuver_size(); ++i) {
+    const auto& maneuver = text_leg.maneuver(i);
+    EXPECT_EQ(maneuver.text_instruction(), full_leg.maneuver(i).text_instruction());
+    EXPECT_FALSE(maneuver.text_instruction().empty());
+    EXPECT_TRUE(maneuver.verbal_succinct_transition_instruction().empty());
+    EXPECT_TRUE(maneuver.verbal_transition_alert_instruction().empty());
+    EXPECT_TRUE(maneuver.verbal_pre_transition_instruction().empty());
+    EXPECT_TRUE(maneuver.verbal_post_transition_instruction().empty());
+  }
+  EXPECT_FALSE(full_leg.maneuver(1).verbal_pre_transition_instruction().empty());
+}
+
+TEST(Instructions, concurrent_legs) {
+  // a route with the legs of several trips, and an alternate with them in reverse
+  valhalla::Api sequential;
+  auto& route = *sequential.mutable_trip()->mutable_routes()->Add();
+  for (const auto* file : {"ramp_take_toward_driving_side_right.pbf", "multi_cue_imminent_turn.pbf",
+                           "turn_left_at.pbf", "roundabout_guide_sign_1.pbf"}) {
+    valhalla::Api api;
+    ASSERT_TRUE(api.ParseFromString(test::load_binary_file(
+        std::string(VALHALLA_SOURCE_DIR "test/pinpoints/instructions/") + file)));
+    sequential.mutable_options()->CopyFrom(api.options());
+    route.mutable_legs()->Add()->CopyFrom(api.trip().routes(0).legs(0));
+  }
+  auto& alternate = *sequential.mutable_trip()->mutable_routes()->Add();
+  for (int i = route.legs_size() - 1; i >= 0; --i) {
+    alternate.mutable_legs()->Add()->CopyFrom(route.legs(i));
+  }
+  valhalla::Api concurrent = sequential;
+
+  valhalla::odin::DirectionsThreads threads(2);
+  valhalla::odin::DirectionsBuilder().Build(sequential, valhalla::odin::MarkupFormatter());
+  valhalla::odin::DirectionsBuilder().Build(concurrent, valhalla::odin::MarkupFormatter(), {},
+                                            &threads);
+
+  // the legs keep their order
+  ASSERT_EQ(concurrent.directions().routes_size(), 2);
+  ASSERT_EQ(concurrent.directions().routes(0).legs_size(), 4);
+  ASSERT_EQ(concurrent.directions().routes(1).legs_size(), 4);
+  EXPECT_EQ(concurrent.directions().SerializeAsString(),
+            sequential.directions().SerializeAsString());
+  EXPECT_EQ(concurrent.trip().SerializeAsString(), sequential.trip().SerializeAsString());
+
+  // a broken leg fails the whole build with the error of the first broken leg, as it does when the
+  // legs are built in turn. the threads are reused for every build
+  sequential.clear_directions();
+  sequential.mutable_trip()->mutable_routes(0)->mutable_legs(3)->clear_node();
+  sequential.mutable_trip()->mutable_routes(1)->mutable_legs(2)->mutable_node(0)->clear_edge();
+  concurrent.clear_directions();
+  concurrent.mutable_trip()->CopyFrom(sequential.trip());
+  std::string sequential_error, concurrent_error;
+  try {
+    valhalla::odin::DirectionsBuilder().Build(sequential, valhalla::odin::MarkupFormatter());
+  } catch (const std::exception& e) { sequential_error = e.what(); }
+  for (int i = 0; i < 10; ++i) {
+    concurrent.clear_directions();
+    EXPECT_THROW(
+        {
+          try {
+            valhalla::odin::DirectionsBuilder().Build(concurrent, valhalla::odin::MarkupFormatter(),
+                                                      {}, &threads);
+          } catch (const std::exception& e) {
+            concurrent_error = e.what();
+            throw;
+          }
+        },
+        valhalla::valhalla_exception_t);
+    EXPECT_EQ(concurrent_error, sequential_error);
+  }
+}
+
 } // namespace
 
 int main(int argc, char* argv[]) {
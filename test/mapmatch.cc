@@ -1,5 +1,6 @@
 #include "baldr/json.h"
 #include "loki/worker.h"
+#include "meili/candidate_search.h"
 #include "midgard/encoded.h"
 #include "midgard/logging.h"
 #include "midgard/util.h"
@@ -10,8 +11,12 @@
 #include "worker.h"
 
 #include <algorithm>
+#include <functional>
 #include <iostream>
+#include <mutex>
 #include <random>
+#include <thread>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -1516,6 +1521,89 @@ TEST(Mapmatch, openlr_parameter_falsy_native_api) {
     EXPECT_THROW(response.get_child("trip.linear_references"), std::runtime_error);
   }
 }
+
+TEST(Mapmatch, concurrent_independent_traces) {
+  // three pieces of trace which are too far apart to ever be connected with this breakage distance
+  const std::vector<std::string> requests = {
+      R"({"costing":"auto","shape_match":"map_snap","shape":[
+          {"lon":5.08531221,"lat":52.0938563},{"lon":5.0865867,"lat":52.0930211},
+          {"lat":52.09110,"lon":5.09806},{"lat":52.09050,"lon":5.09769},
+          {"lat":52.09098,"lon":5.09679},
+          {"lat":52.1003455,"lon":5.1194303},{"lat":52.1003954,"lon":5.1190220}]})",
+      R"({"costing":"auto","shape_match":"map_snap","shape":[
+          {"lat":52.1011859,"lon":5.1209135},{"lat":52.1009284,"lon":5.1204603},
+          {"lon":5.08531221,"lat":52.0938563},{"lon":5.0865867,"lat":52.0930211}]})",
+      R"({"costing":"auto","shape_match":"map_snap","alternates":2,"shape":[
+          {"lat":52.09110,"lon":5.09806},{"lat":52.09050,"lon":5.09769},
+          {"lat":52.09098,"lon":5.09679},
+          {"lat":52.1003455,"lon":5.1194303},{"lat":52.1003954,"lon":5.1190220}]})",
+  };
+
+  auto sequential_conf = conf;
+  sequential_conf.put("meili.default.breakage_distance", 500);
+  auto concurrent_conf = sequential_conf;
+  concurrent_conf.put("meili.concurrency", 3);
+  tyr::actor_t sequential(sequential_conf, true), concurrent(concurrent_conf, true);
+
+  // the concurrent search has to find exactly the same matches as the sequential one. the workers
+  // check the interrupt too so seeing it called off this thread means the trace was split
+  const auto main_thread = std::this_thread::get_id();
+  for (const auto& request : requests) {
+    std::mutex lock;
+    std::unordered_set<std::thread::id> threads;
+    const std::function<void()> interrupt = [&]() {
+      std::lock_guard<std::mutex> guard(lock);
+      threads.insert(std::this_thread::get_id());
+    };
+    EXPECT_EQ(concurrent.trace_attributes(request, &interrupt),
+              sequential.trace_attributes(request));
+    EXPECT_TRUE(std::any_of(threads.begin(), threads.end(),
+                            [&](const auto& id) { return id != main_thread; }));
+  }
+
+  // and the workers stop when the request is given up on, map matching reports that as a 444
+  const std::function<void()> interrupt = [&]() {
+    if (std::this_thread::get_id() != main_thread) {
+      throw std::runtime_error("interrupted");
+    }
+  };
+  EXPECT_THROW(concurrent.trace_attributes(requests.front(), &interrupt), valhalla_exception_t);
+}
+
+TEST(Mapmatch, candidate_grid_cache_limits) {
+  baldr::GraphReader reader(conf.get_child("mjolnir"));
+  const auto cell_size = baldr::TileHierarchy::levels().back().tiles.TileSize() / 500;
+
+  // three points in different bins of the same tile
+  const PointLL a(5.09, 52.09), b(5.13, 52.09), c(5.17, 52.09);
+
+  // keep at most two grids
+  meili::CandidateGridQuery query(reader, cell_size, cell_size, 2);
+  const auto edges = query.RangeQuery(ExpandMeters(a, 50));
+  EXPECT_FALSE(edges.empty());
+  query.RangeQuery(ExpandMeters(b, 50));
+  query.RangeQuery(ExpandMeters(c, 50));
+  EXPECT_EQ(query.size(), 2);
+
+  // a was the least recently used so it has to be rebuilt, after that it is cached again
+  EXPECT_EQ(query.RangeQuery(ExpandMeters(a, 50)), edges);
+  EXPECT_EQ(query.RangeQuery(ExpandMeters(a, 50)), edges);
+  const auto& stats = query.cache_stats();
+  EXPECT_EQ(stats.hits, 1);
+  EXPECT_EQ(stats.misses, 4);
+  EXPECT_EQ(stats.evictions, 2);
+  EXPECT_EQ(stats.grids, 2);
+  EXPECT_GT(stats.memory, 0);
+
+  // a memory limit below a single grid still keeps the last one
+  meili::CandidateGridQuery tiny_query(reader, cell_size, cell_size,
+                                       std::numeric_limits<size_t>::max(), 1);
+  tiny_query.RangeQuery(ExpandMeters(a, 50));
+  EXPECT_EQ(tiny_query.RangeQuery(ExpandMeters(b, 50)), query.RangeQuery(ExpandMeters(b, 50)));
+  EXPECT_EQ(tiny_query.size(), 1);
+  EXPECT_EQ(tiny_query.cache_stats().evictions, 1);
+}
+
 } // namespace
 
 int main(int argc, char* argv[]) {
@@ -13,6 +13,7 @@ const auto fake_config = test::json_to_pt(R"({
     "mode": "auto",
     "grid": {
       "cache_size": 100500,
+      "cache_memory": 1048576,
       "size": 100
     },
     "default": {
@@ -40,6 +41,7 @@ TEST(MapmatchConfig, check_read_all_params) {
   EXPECT_EQ(candidate_search.max_search_radius_meters, 500.f);
   EXPECT_EQ(candidate_search.grid_size, 100);
   EXPECT_EQ(candidate_search.cache_size, 100500);
+  EXPECT_EQ(candidate_search.cache_memory, 1048576);
 
   // check transition params
   const auto& transition = config.transition_cost;
@@ -0,0 +1,94 @@
+#include "test.h"
+#include "midgard/metrics.h"
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace valhalla::midgard::metrics;
+
+namespace {
+
+TEST(Metrics, buckets) {
+  // every value falls in the bucket whose bounds it is between
+  for (uint64_t value : {0ull, 1ull, 7ull, 8ull, 9ull, 15ull, 16ull, 17ull, 1000ull, 1ull << 30}) {
+    const auto bucket = histogram_t::bucket(value);
+    EXPECT_LE(histogram_t::lower_bound(bucket), value);
+    EXPECT_GE(histogram_t::upper_bound(bucket), value);
+  }
+
+  // and the buckets line up without gaps
+  for (size_t bucket = 1; bucket < histogram_t::kBuckets; ++bucket) {
+    EXPECT_EQ(histogram_t::lower_bound(bucket), histogram_t::upper_bound(bucket - 1) + 1);
+  }
+
+  // no bucket is wider than an eighth of where it starts
+  EXPECT_EQ(histogram_t::bucket(1000), histogram_t::bucket(1007));
+  EXPECT_NE(histogram_t::bucket(1000), histogram_t::bucket(1024));
+  EXPECT_EQ(histogram_t::bucket(uint64_t(1) << 50), histogram_t::kBuckets - 1);
+}
+
+TEST(Metrics, quantiles) {
+  histogram_t histogram;
+  for (uint64_t value = 1; value <= 1000; ++value) {
+    ++histogram.buckets[histogram_t::bucket(value)];
+    ++histogram.count;
+    histogram.max = value;
+  }
+  EXPECT_NEAR(histogram.quantile(0.5), 500, 500 / 8);
+  EXPECT_NEAR(histogram.quantile(0.99), 990, 990 / 8);
+  EXPECT_EQ(histogram.quantile(1), 1000);
+  EXPECT_EQ(histogram.below(512), 511);
+  EXPECT_EQ(histogram_t{}.quantile(0.5), 0);
+}
+
+TEST(Metrics, threads) {
+  const auto before = snapshot();
+
+  // each thread records into its own shard which is folded into the total of the threads that are
+  // gone when it exits, the snapshot sums them
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i) {
+    threads.emplace_back([]() {
+      local_counter_t hits(counter_t::tile_cache_hits);
+      for (int j = 0; j < 1000; ++j) {
+        record(stage_t::path, std::chrono::microseconds(j));
+        count(counter_t::labels_settled, 2);
+        ++hits;
+      }
+      stage_timer_t timer(stage_t::narrative);
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  const auto after = snapshot();
+  const auto& path = after.stages[static_cast<size_t>(stage_t::path)];
+  EXPECT_EQ(path.count - before.stages[static_cast<size_t>(stage_t::path)].count, 4000);
+  EXPECT_GE(path.max, 999);
+  EXPECT_EQ(after.stages[static_cast<size_t>(stage_t::narrative)].count -
+                before.stages[static_cast<size_t>(stage_t::narrative)].count,
+            4);
+  EXPECT_EQ(after.counters[static_cast<size_t>(counter_t::labels_settled)] -
+                before.counters[static_cast<size_t>(counter_t::labels_settled)],
+            8000);
+  EXPECT_EQ(after.counters[static_cast<size_t>(counter_t::tile_cache_hits)] -
+                before.counters[static_cast<size_t>(counter_t::tile_cache_hits)],
+            4000);
+
+  const auto text = to_prometheus(after);
+  EXPECT_NE(text.find("# TYPE valhalla_stage_latency_seconds histogram\n"), std::string::npos);
+  EXPECT_NE(text.find("valhalla_stage_latency_seconds_bucket{stage=\"path\",le=\"+Inf\"} " +
+                      std::to_string(path.count) + "\n"),
+            std::string::npos);
+  EXPECT_NE(text.find("valhalla_labels_settled_total "), std::string::npos);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -5,6 +5,7 @@
 #include <gtest/gtest.h>
 
 #include <map>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
@@ -1339,6 +1340,41 @@ TEST(NarrativeDictionary, test_en_US_approach_verbal_alert) {
   validate(us_customary_lengths, kExpectedUsCustomaryLengths);
 }
 
+TEST(NarrativeDictionary, test_en_US_start_templates) {
+  std::shared_ptr<NarrativeDictionary> dictionary = GetNarrativeDictionary("en-US");
+
+  // every phrase is compiled, keys that are not in the locale are missing
+  for (const auto& phrase : kExpectedStartPhrases) {
+    const auto& phrase_template = dictionary->start_subset.at(std::stoul(phrase.first));
+    validate(phrase_template.phrase(), phrase.second);
+  }
+  EXPECT_THROW(dictionary->start_subset.at(3), std::out_of_range);
+  EXPECT_THROW(dictionary->start_subset.at(200), std::out_of_range);
+
+  // "2": "Head <CARDINAL_DIRECTION> on <BEGIN_STREET_NAMES>. Continue on <STREET_NAMES>."
+  validate(dictionary->start_subset.at(2).Format({{"<CARDINAL_DIRECTION>", "north"},
+                                                  {"<STREET_NAMES>", "Main Street"},
+                                                  {"<BEGIN_STREET_NAMES>", "1st Avenue"}}),
+           "Head north on 1st Avenue. Continue on Main Street.");
+}
+
+TEST(NarrativeDictionary, test_phrase_template) {
+  // tags without a value are kept, as is anything that only looks like a tag
+  PhraseTemplate phrase("<LENGTH> <<CARDINAL_DIRECTION> <ORDINAL VALUE> <> <lower> <TIME");
+  validate(phrase.Format({{"<LENGTH>", "1 km"}, {"<CARDINAL_DIRECTION>", "north"}}),
+           "1 km <north <ORDINAL VALUE> <> <lower> <TIME");
+  validate(phrase.Format({}), phrase.phrase());
+
+  // values are not searched for tags
+  validate(PhraseTemplate("<STREET_NAMES><LENGTH>")
+               .Format({{"<STREET_NAMES>", "<LENGTH>"}, {"<LENGTH>", "1 km"}}),
+           "<LENGTH>1 km");
+
+  EXPECT_TRUE(PhraseTemplate("").loaded());
+  EXPECT_EQ(PhraseTemplate("").Format({{"<LENGTH>", "1 km"}}), "");
+  EXPECT_FALSE(PhraseTemplate().loaded());
+}
+
 } // namespace
 
 int main(int argc, char* argv[]) {
@@ -1684,6 +1684,86 @@ TEST(ParseRequest, test_show_locations) {
   test_show_locations_parsing(false);
 }
 
+TEST(ParseRequest, test_locations) {
+  Api request = get_request(
+      R"({"costing":"auto","locations":[{"lat":52.5,"lon":373.4,"name":"start","heading":"90",
+          "radius":12.7,"rank_candidates":false,"display_lat":52.6,"display_lon":13.5,"waiting":30},
+          {"lat":52.4,"lon":13.3,"type":"via","time":10,"waiting":30,"search_filter":{
+          "max_road_class":"primary","exclude_tunnel":true,"exclude_closures":false}},
+          {"lat":52.3,"lat":0,"lon":13.2,"street":"Unter den Linden","waiting":30}]})",
+      Options::route);
+  const auto& locations = request.options().locations();
+  ASSERT_EQ(locations.size(), 3);
+
+  const auto& first = locations.Get(0);
+  EXPECT_EQ(first.ll().lat(), 52.5);
+  EXPECT_NEAR(first.ll().lng(), 13.4, 1e-9);
+  EXPECT_EQ(first.name(), "start");
+  EXPECT_EQ(first.heading(), 90);
+  EXPECT_EQ(first.radius(), 12);
+  EXPECT_TRUE(first.skip_ranking_candidates());
+  EXPECT_EQ(first.display_ll().lat(), 52.6);
+  EXPECT_EQ(first.time(), -1);
+  EXPECT_EQ(first.waiting_secs(), 0);
+  EXPECT_EQ(first.search_filter().min_road_class(), valhalla::kServiceOther);
+  EXPECT_TRUE(first.search_filter().exclude_closures());
+
+  const auto& second = locations.Get(1);
+  EXPECT_EQ(second.type(), Location::kVia);
+  EXPECT_EQ(second.time(), 10);
+  EXPECT_EQ(second.correlation().original_index(), 1);
+  EXPECT_EQ(second.search_filter().max_road_class(), valhalla::kPrimary);
+  EXPECT_TRUE(second.search_filter().exclude_tunnel());
+  EXPECT_FALSE(second.search_filter().exclude_closures());
+  EXPECT_EQ(request.info().warnings_size(), 1);
+
+  // the first of duplicate members counts
+  const auto& last = locations.Get(2);
+  EXPECT_EQ(last.ll().lat(), 52.3);
+  EXPECT_EQ(last.street(), "Unter den Linden");
+  EXPECT_EQ(last.type(), Location::kBreak);
+  EXPECT_EQ(last.waiting_secs(), 0);
+}
+
+TEST(ParseRequest, test_exclude_locations) {
+  // avoid_locations takes precedence over exclude_locations no matter the order
+  for (const auto* request_str :
+       {R"({"exclude_locations":[{"lat":1,"lon":1}],"avoid_locations":[{"lat":2,"lon":2}]})",
+        R"({"avoid_locations":[{"lat":2,"lon":2}],"exclude_locations":[{"lat":1,"lon":1}]})"}) {
+    Api request = get_request(request_str, Options::route);
+    ASSERT_EQ(request.options().exclude_locations_size(), 1);
+    EXPECT_EQ(request.options().exclude_locations(0).ll().lat(), 2);
+  }
+}
+
+TEST(ParseRequest, test_encoded_polyline) {
+  Api request = get_request(R"({"encoded_polyline":"_izlhA~rlgdF_{geC~ywl@_kwzCn`{nI"})",
+                            Options::trace_route);
+  const auto& shape = request.options().shape();
+  ASSERT_EQ(shape.size(), 3);
+  EXPECT_NEAR(shape.Get(0).ll().lat(), 38.5, 1e-6);
+  EXPECT_NEAR(shape.Get(0).ll().lng(), -120.2, 1e-6);
+  EXPECT_EQ(shape.Get(0).type(), Location::kBreak);
+  EXPECT_EQ(shape.Get(1).type(), Location::kVia);
+  EXPECT_EQ(shape.Get(2).type(), Location::kBreak);
+}
+
+TEST(ParseRequest, test_location_errors) {
+  auto code = [](const std::string& request_str) -> unsigned {
+    try {
+      get_request(request_str, Options::sources_to_targets);
+    } catch (const valhalla_exception_t& e) { return e.code; }
+    return 0;
+  };
+  EXPECT_EQ(code(R"({"sources":[{"lat":1,"lon":1}],"targets":[{"lon":1}]})"), 132);
+  EXPECT_EQ(code(R"({"sources":[{"lat":100,"lon":1}]})"), 131);
+  EXPECT_EQ(code(R"({"sources":[[1,1]]})"), 131);
+  EXPECT_EQ(code(R"({"sources":[{"lat":1,"lon":1,"search_filter":{"exclude_closures":true}}],
+      "costing":"auto","costing_options":{"auto":{"ignore_closures":true}}})"),
+            143);
+  EXPECT_EQ(code(R"({"sources":[{"lat":1,"lon":1}])"), 100);
+}
+
 TEST(ParseRequest, test_shape_match) {
   test_shape_match_parsing(ShapeMatch::map_snap, Options::trace_route);
   test_shape_match_parsing(ShapeMatch::map_snap, Options::trace_attributes);
@@ -0,0 +1,201 @@
+#include "test.h"
+#include "tyr/response_cache.h"
+
+#include <boost/property_tree/ptree.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace valhalla;
+using valhalla::tyr::response_cache_t;
+
+namespace {
+
+boost::property_tree::ptree
+make_config(size_t max_bytes, unsigned int ttl = 60, float coalesce_seconds = 5) {
+  boost::property_tree::ptree config;
+  config.put("httpd.cache.max_bytes", max_bytes);
+  config.put("httpd.cache.ttl_seconds", ttl);
+  config.put("httpd.cache.coalesce_seconds", coalesce_seconds);
+  config.put("mjolnir.tile_dir", "test/data/no_such_tiles");
+  return config;
+}
+
+response_cache_t::response_t make_response(const std::string& text) {
+  return std::make_shared<const std::string>(text);
+}
+
+TEST(ResponseCache, caches) {
+  response_cache_t cache(make_config(1024));
+  Options options;
+  options.set_action(Options::route);
+  EXPECT_TRUE(cache.caches(options));
+  options.set_action(Options::status);
+  EXPECT_FALSE(cache.caches(options));
+
+  // off without a size
+  response_cache_t off(make_config(0));
+  options.set_action(Options::route);
+  EXPECT_FALSE(off.caches(options));
+}
+
+TEST(ResponseCache, canonical_key) {
+  response_cache_t cache(make_config(1024));
+  Options a, b;
+  a.set_action(Options::route);
+  b.set_action(Options::route);
+  (*a.mutable_costings())[Costing::auto_].set_name("auto");
+  (*a.mutable_costings())[Costing::bicycle].set_name("bicycle");
+  (*b.mutable_costings())[Costing::bicycle].set_name("bicycle");
+  (*b.mutable_costings())[Costing::auto_].set_name("auto");
+  EXPECT_EQ(cache.key(a), cache.key(b));
+
+  b.set_units(Options::miles);
+  EXPECT_NE(cache.key(a), cache.key(b));
+
+  EXPECT_FALSE(cache.time_dependent(a));
+  a.set_date_time_type(Options::depart_at);
+  EXPECT_TRUE(cache.time_dependent(a));
+}
+
+TEST(ResponseCache, hit_and_evict) {
+  // room for two entries of 10 bytes each
+  response_cache_t cache(make_config(20));
+  int answered = 0;
+  auto answer = [&answered]() {
+    ++answered;
+    return make_response("12345");
+  };
+
+  EXPECT_EQ(cache.get("abcde", false, answer).second, response_cache_t::outcome_t::miss);
+  EXPECT_EQ(cache.get("abcde", false, answer).second, response_cache_t::outcome_t::hit);
+  EXPECT_EQ(*cache.get("abcde", false, answer).first, "12345");
+  EXPECT_EQ(cache.get("fghij", false, answer).second, response_cache_t::outcome_t::miss);
+  EXPECT_EQ(cache.size(), 20);
+  EXPECT_EQ(answered, 2);
+
+  // the least recently used goes first
+  cache.get("abcde", false, answer);
+  cache.get("klmno", false, answer);
+  EXPECT_EQ(cache.size(), 20);
+  EXPECT_EQ(cache.get("abcde", false, answer).second, response_cache_t::outcome_t::hit);
+  EXPECT_EQ(cache.get("fghij", false, answer).second, response_cache_t::outcome_t::miss);
+
+  // too big to keep at all
+  EXPECT_EQ(cache.get("x", false, []() { return make_response(std::string(100, 'x')); }).second,
+            response_cache_t::outcome_t::miss);
+  EXPECT_EQ(cache.get("x", false, answer).second, response_cache_t::outcome_t::miss);
+}
+
+TEST(ResponseCache, expires) {
+  response_cache_t cache(make_config(1024, 0));
+  auto answer = []() { return make_response("12345"); };
+  cache.get("abcde", true, answer);
+  EXPECT_EQ(cache.get("abcde", true, answer).second, response_cache_t::outcome_t::miss);
+  // only the time dependent ones expire
+  cache.get("fghij", false, answer);
+  EXPECT_EQ(cache.get("fghij", false, answer).second, response_cache_t::outcome_t::hit);
+}
+
+TEST(ResponseCache, single_flight) {
+  response_cache_t cache(make_config(1024));
+  std::atomic<int> answered{0};
+  std::atomic<bool> release{false};
+  auto slow = [&]() {
+    ++answered;
+    while (!release) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return make_response("12345");
+  };
+
+  // the first one answers while the others wait on it
+  std::thread first([&]() {
+    EXPECT_EQ(cache.get("abcde", false, slow).second, response_cache_t::outcome_t::miss);
+  });
+  while (answered == 0) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  std::vector<std::thread> others;
+  for (int i = 0; i < 4; ++i) {
+    others.emplace_back([&]() {
+      auto found = cache.get("abcde", false, slow);
+      EXPECT_EQ(*found.first, "12345");
+      EXPECT_NE(found.second, response_cache_t::outcome_t::miss);
+    });
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  release = true;
+  first.join();
+  for (auto& other : others) {
+    other.join();
+  }
+  EXPECT_EQ(answered, 1);
+}
+
+TEST(ResponseCache, failure_is_not_shared) {
+  response_cache_t cache(make_config(1024));
+  std::atomic<bool> waiting{false};
+  std::thread first([&]() {
+    EXPECT_THROW(cache.get("abcde", false,
+                           [&]() -> response_cache_t::response_t {
+                             while (!waiting) {
+                               std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                             }
+                             std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                             throw std::runtime_error("failed");
+                           }),
+                 std::runtime_error);
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  waiting = true;
+  // either waits for the first one to fail or comes after it, both times it answers itself
+  EXPECT_EQ(*cache.get("abcde", false, []() { return make_response("12345"); }).first, "12345");
+  first.join();
+  EXPECT_EQ(cache.get("abcde", false, []() { return make_response("other"); }).second,
+            response_cache_t::outcome_t::hit);
+}
+
+TEST(ResponseCache, waiting_is_bounded) {
+  response_cache_t cache(make_config(1024, 60, 0.05f));
+  std::atomic<bool> answering{false}, release{false};
+  std::thread first([&]() {
+    cache.get("abcde", false, [&]() {
+      answering = true;
+      while (!release) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      }
+      return make_response("first");
+    });
+  });
+  while (!answering) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+
+  // the caller gives up while waiting
+  const std::function<void()> interrupt = []() { throw std::runtime_error("interrupted"); };
+  EXPECT_THROW(cache.get("abcde", false, []() { return make_response("never"); }, &interrupt),
+               std::runtime_error);
+
+  // the first one takes too long so it is answered again
+  const auto found = cache.get("abcde", false, []() { return make_response("second"); });
+  EXPECT_EQ(*found.first, "second");
+  EXPECT_EQ(found.second, response_cache_t::outcome_t::miss);
+
+  release = true;
+  first.join();
+  EXPECT_EQ(cache.get("abcde", false, []() { return make_response("other"); }).second,
+            response_cache_t::outcome_t::hit);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -3,6 +3,10 @@
 #include <gtest/gtest.h>
 
 #include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
 
 using namespace valhalla::midgard;
 
@@ -71,6 +75,85 @@ TEST(Sequence, Iterator) {
   EXPECT_EQ(i.position(), 0) << "Pre-decrement operator wasn't right";
 }
 
+TEST(Sequence, ParallelSort) {
+  // lots of duplicates so that the order of equal elements shows
+  const size_t count = 100000;
+  std::mt19937 generator(17);
+  std::uniform_int_distribution<uint64_t> ids(0, 999);
+  std::vector<std::string> file_names{"serial.nd", "parallel.nd", "more_parallel.nd"};
+  {
+    std::vector<std::unique_ptr<sequence<osm_node>>> sequences;
+    for (const auto& file_name : file_names) {
+      sequences.emplace_back(new sequence<osm_node>(file_name, true));
+    }
+    for (uint32_t i = 0; i < count; ++i) {
+      const osm_node node{ids(generator), 0.f, 0.f, i};
+      for (auto& sequence : sequences) {
+        sequence->push_back(node);
+      }
+    }
+  }
+
+  // sort in chunks so that they need merging, with different numbers of threads
+  auto less_than = [](const osm_node& a, const osm_node& b) { return a.id < b.id; };
+  const std::vector<unsigned int> concurrencies{1, 4, 7};
+  for (size_t i = 0; i < file_names.size(); ++i) {
+    sequence<osm_node> sequence(file_names[i], false);
+    sequence.sort(less_than, 3001, concurrencies[i]);
+    EXPECT_EQ(sequence.size(), count);
+  }
+
+  // they must all be sorted and exactly the same
+  sequence<osm_node> serial(file_names[0], false);
+  for (size_t i = 1; i < file_names.size(); ++i) {
+    sequence<osm_node> parallel(file_names[i], false);
+    ASSERT_EQ(parallel.size(), serial.size());
+    for (size_t j = 0; j < serial.size(); ++j) {
+      const osm_node a = *serial[j];
+      const osm_node b = *parallel[j];
+      ASSERT_EQ(a.id, b.id) << "Found wrong node at: " + std::to_string(j);
+      ASSERT_EQ(a.attributes, b.attributes) << "Equal nodes in different order at: " +
+                                                   std::to_string(j);
+      if (j > 0) {
+        ASSERT_LE((*serial[j - 1]).id, a.id) << "Not sorted at: " + std::to_string(j);
+      }
+    }
+  }
+}
+
+TEST(Sequence, StableSort) {
+  // few distinct keys so that every sub-range is full of equal ones
+  const size_t count = 20000;
+  std::mt19937 generator(23);
+  std::uniform_int_distribution<uint64_t> ids(0, 9);
+  const std::vector<std::pair<size_t, unsigned int>> runs{{0, 1}, {977, 1}, {977, 8}, {64, 5}};
+  for (const auto& [buffer_size, concurrency] : runs) {
+    // the same keys for every run
+    generator.seed(23);
+    {
+      sequence<osm_node> sequence("stable.nd", true);
+      for (uint32_t i = 0; i < count; ++i) {
+        sequence.push_back({ids(generator), 0.f, 0.f, i});
+      }
+    }
+
+    sequence<osm_node> sequence("stable.nd", false);
+    sequence.sort([](const osm_node& a, const osm_node& b) { return a.id < b.id; }, buffer_size,
+                  concurrency);
+    ASSERT_EQ(sequence.size(), count);
+
+    // equal keys must keep the order they were written in no matter how the sort was split up
+    for (size_t j = 1; j < count; ++j) {
+      const osm_node a = *sequence[j - 1];
+      const osm_node b = *sequence[j];
+      ASSERT_TRUE(a.id < b.id || (a.id == b.id && a.attributes < b.attributes))
+          << "Not stable at " + std::to_string(j) + " with a buffer_size of " +
+                 std::to_string(buffer_size) + " and " + std::to_string(concurrency) +
+                 " threads";
+    }
+  }
+}
+
 } // namespace
 
 int main(int argc, char* argv[]) {
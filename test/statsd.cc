@@ -53,6 +53,17 @@ public:
     service_worker_t::enqueue_statistics(request);
     service_worker_t::cleanup();
   }
+  void narrate(size_t locations) {
+    // the request lives on the arena until cleanup
+    Api& request = arena.request();
+    for (size_t i = 0; i < locations; ++i) {
+      auto* location = request.mutable_options()->add_locations();
+      location->mutable_ll()->set_lat(52.5);
+      location->mutable_ll()->set_lng(13.4);
+      location->set_name("somewhere along the way");
+    }
+    service_worker_t::cleanup();
+  }
   std::string service_name() const override {
     return "test";
   }
@@ -95,3 +106,24 @@ TEST(statsd, errors_and_warnings) {
         << "Could not find key " << expected[i] << " in stat " << messages[i];
   }
 }
+
+TEST(statsd, arena) {
+  // start up a mock statsd server
+  Statsd::StatsdServer mock_server;
+  std::vector<std::string> messages;
+  std::thread server(mock, std::ref(mock_server), std::ref(messages));
+
+  // a worker whose requests outgrow the first block of its arena
+  boost::property_tree::ptree config;
+  config.put("statsd.host", "localhost");
+  config.put("httpd.service.arena_bytes", 1024);
+  test_worker_t worker(config);
+  worker.narrate(1000);
+  worker.stop_server();
+  server.join();
+
+  // the size of the arena is reported when the worker is cleaned up
+  ASSERT_FALSE(messages.empty());
+  EXPECT_NE(messages.front().find("none.info.test.arena_kb"), std::string::npos)
+      << messages.front();
+}
@@ -384,6 +384,7 @@ boost::property_tree::ptree make_config(const std::string& path_prefix,
         "max_exclude_polygons_length": 10000,
         "min_linear_cost_factor": 1,
         "max_linear_cost_edges": 50000,
+        "budget": {"max_settled_edges": 0, "max_tiles_loaded": 0, "max_seconds": 0},
         "max_radius": 200,
         "max_reachability": 100,
         "max_timedep_distance": 500000,
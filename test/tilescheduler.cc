@@ -0,0 +1,88 @@
+#include "mjolnir/tilescheduler.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+using namespace valhalla::mjolnir;
+using valhalla::baldr::GraphId;
+
+namespace {
+
+std::vector<std::pair<GraphId, uint64_t>> make_tiles(size_t count) {
+  std::vector<std::pair<GraphId, uint64_t>> tiles;
+  for (uint32_t i = 0; i < count; ++i) {
+    tiles.emplace_back(GraphId(i, 2, 0), i % 7);
+  }
+  return tiles;
+}
+
+TEST(TileScheduler, LargestFirst) {
+  TileScheduler scheduler("test", {{GraphId(1, 2, 0), 10},
+                                   {GraphId(2, 2, 0), 300},
+                                   {GraphId(3, 2, 0), 20},
+                                   {GraphId(4, 2, 0), 300}},
+                          1);
+  std::vector<GraphId> order;
+  GraphId tile;
+  while (scheduler.Next(0, tile)) {
+    order.push_back(tile);
+  }
+  // ties are broken by id
+  EXPECT_EQ(order, (std::vector<GraphId>{GraphId(2, 2, 0), GraphId(4, 2, 0), GraphId(3, 2, 0),
+                                         GraphId(1, 2, 0)}));
+}
+
+TEST(TileScheduler, Steals) {
+  // the first thread gets half of the tiles but never asks for them
+  TileScheduler scheduler("test", make_tiles(10), 2);
+  std::vector<GraphId> taken;
+  GraphId tile;
+  while (scheduler.Next(1, tile)) {
+    taken.push_back(tile);
+  }
+  EXPECT_EQ(taken.size(), 10);
+  EXPECT_FALSE(scheduler.Next(0, tile));
+}
+
+TEST(TileScheduler, EveryTileOnce) {
+  const auto tiles = make_tiles(1000);
+  TileScheduler scheduler("test", tiles, 8);
+  ASSERT_EQ(scheduler.concurrency(), 8);
+
+  std::mutex lock;
+  std::vector<GraphId> taken;
+  scheduler.Run([&](size_t worker) {
+    GraphId tile;
+    while (scheduler.Next(worker, tile)) {
+      std::lock_guard<std::mutex> guard(lock);
+      taken.push_back(tile);
+    }
+  });
+
+  std::sort(taken.begin(), taken.end());
+  ASSERT_EQ(taken.size(), tiles.size());
+  for (size_t i = 0; i < tiles.size(); ++i) {
+    EXPECT_EQ(taken[i], tiles[i].first);
+  }
+}
+
+TEST(TileScheduler, Rethrows) {
+  TileScheduler scheduler("test", make_tiles(100), 4);
+  EXPECT_THROW(scheduler.Run([&](size_t worker) {
+    GraphId tile;
+    while (scheduler.Next(worker, tile)) {
+      if (tile.tileid() == 42) {
+        throw std::runtime_error("bad tile");
+      }
+    }
+  }),
+               std::runtime_error);
+}
+
+} // namespace
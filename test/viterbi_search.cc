@@ -1,5 +1,4 @@
 #include "meili/viterbi_search.h"
-#include "meili/topk_search.h"
 
 #include <gtest/gtest.h>
 
@@ -9,7 +8,7 @@
 #include <iostream>
 #include <random>
 
-// Viterbi and topK search tests
+// Viterbi and k best Viterbi search tests
 
 using namespace valhalla::meili;
 
@@ -428,80 +427,78 @@ float total_cost(const std::vector<Column>& columns, const std::vector<StateId>&
   return cost;
 }
 
-void test_viterbisearch_brute_force(const std::vector<Column>& columns, IViterbiSearch& vs) {
+void test_kbest_viterbi_search(const std::vector<Column>& columns, uint32_t k) {
+  KBestViterbiSearch ks(k);
+  ks.set_emission_cost_model(EmissionCostModel(columns));
+  ks.set_transition_cost_model(TransitionCostModel(columns));
+  AddColumns(ks, columns);
   const auto& pcs = sort_all_paths(columns);
   if (columns.empty()) {
     EXPECT_EQ(pcs, std::vector<PathWithCost>{PathWithCost({}, 0.0)})
         << "expect empty set from empty columns";
+    EXPECT_FALSE(ks.SearchWinner(0).IsValid()) << "there is no winner without columns";
+    EXPECT_TRUE(ks.SearchPath(0, 0).empty()) << "there is no path without columns";
+    EXPECT_EQ(ks.PathCost(0, 0), -1.f);
     return;
   }
-
-  TopKSearch ts(vs);
-  AddColumns(vs, columns);
   const StateId::Time time = columns.size() - 1;
 
-  for (const auto& pc : pcs) {
-    const auto c = total_cost(columns, pc.path());
-    validate_path(columns, pc.path());
-
-    std::vector<StateId> vs_path, original_state_ids;
-    std::copy(vs.SearchPathVS(time), vs.PathEnd(), std::back_inserter(vs_path));
-    for (auto s_itr = vs_path.rbegin(); s_itr != vs_path.rend(); ++s_itr)
-      original_state_ids.push_back(ts.GetOrigin(*s_itr, *s_itr));
-    validate_path(columns, original_state_ids);
-
-    // std::cout << "top total cost     : " << c << std::endl;
-    // std::cout << "top brute force    : " << pc.cost() << std::endl;
-    // std::cout << "top viterbi search : " << total_cost(columns, vs_path) << std::endl;
-    // std::cout << std::endl;
-
-    EXPECT_EQ(c, pc.cost()) << "total cost by brute force mush be correct";
-    EXPECT_EQ(c, total_cost(columns, original_state_ids)) << "Wrong total cost by viterbisearch";
+  // one forward pass gives the same k best paths as ranking all of them
+  std::vector<std::vector<StateId>> paths;
+  for (uint32_t rank = 0; rank < k; ++rank) {
+    const auto path = ks.SearchPath(time, rank);
+    if (pcs.size() <= rank) {
+      EXPECT_TRUE(path.empty()) << "there should be no more paths";
+      EXPECT_EQ(ks.PathCost(time, rank), -1.f);
+      continue;
+    }
+    validate_path(columns, path);
+    EXPECT_EQ(total_cost(columns, path), pcs[rank].cost()) << "path " << rank << " is not optimal";
+    EXPECT_EQ(ks.PathCost(time, rank), pcs[rank].cost()) << "wrong cost of path " << rank;
+    EXPECT_EQ(std::find(paths.begin(), paths.end(), path), paths.end()) << "paths must be unique";
+    paths.push_back(path);
+  }
+  EXPECT_TRUE(ks.SearchPath(time, k).empty()) << "only k paths are known";
 
-    ts.RemovePath(vs_path);
-    vs.ClearSearch();
+  // the best one agrees with the viterbi search
+  const auto winner = ks.SearchWinner(time);
+  if (!pcs.empty()) {
+    EXPECT_EQ(winner, paths.front().back());
+    EXPECT_EQ(ks.AccumulatedCost(winner), pcs.front().cost());
   }
 }
 
-TEST(ViterbiSearch, TestTopKSearch) {
-
-  {
-    ViterbiSearch vs;
+TEST(ViterbiSearch, TestKBestViterbiSearch) {
+  for (uint32_t k = 1; k <= 5; ++k) {
     const auto& columns = generate_columns(
         // transition costs
         std::uniform_int_distribution<int>(1, 10),
         // emission costs
         std::uniform_int_distribution<int>(1, 10),
-        generate_column_counts(3,
+        generate_column_counts(4,
                                // column sizes
-                               std::uniform_int_distribution<size_t>(4, 5)));
-
-    vs.set_emission_cost_model(EmissionCostModel(columns));
-    vs.set_transition_cost_model(TransitionCostModel(columns));
-
-    test_viterbisearch_brute_force(columns, vs);
-  }
+                               std::uniform_int_distribution<size_t>(1, 5)));
+    test_kbest_viterbi_search(columns, k);
 
-  {
-    ViterbiSearch vs;
-    const auto& columns = generate_columns(
+    const auto& single_column = generate_columns(
         // transition costs
         std::uniform_int_distribution<int>(1, 10),
         // emission costs
         std::uniform_int_distribution<int>(1, 10),
         generate_column_counts(1,
                                // column sizes
-                               std::uniform_int_distribution<size_t>(1, 10)));
-
-    vs.set_emission_cost_model(EmissionCostModel(columns));
-    vs.set_transition_cost_model(TransitionCostModel(columns));
+                               std::uniform_int_distribution<size_t>(1, 3)));
+    test_kbest_viterbi_search(single_column, k);
 
-    test_viterbisearch_brute_force(columns, vs);
-  }
+    // a column without states breaks every path through it
+    const auto& broken_columns = generate_columns(
+        // transition costs
+        std::uniform_int_distribution<int>(1, 10),
+        // emission costs
+        std::uniform_int_distribution<int>(1, 10), {3, 0, 3});
+    test_kbest_viterbi_search(broken_columns, k);
 
-  {
-    ViterbiSearch vs;
-    const auto& columns = generate_columns(
+    const auto& empty_column = generate_columns(
         // transition costs
         std::uniform_int_distribution<int>(1, 10),
         // emission costs
@@ -509,16 +506,9 @@ TEST(ViterbiSearch, TestTopKSearch) {
         generate_column_counts(1,
                                // column sizes
                                std::uniform_int_distribution<size_t>(0, 0)));
+    test_kbest_viterbi_search(empty_column, k);
 
-    vs.set_emission_cost_model(EmissionCostModel(columns));
-    vs.set_transition_cost_model(TransitionCostModel(columns));
-
-    test_viterbisearch_brute_force(columns, vs);
-  }
-
-  {
-    ViterbiSearch vs;
-    const auto& columns = generate_columns(
+    const auto& no_columns = generate_columns(
         // transition costs
         std::uniform_int_distribution<int>(1, 10),
         // emission costs
@@ -526,11 +516,7 @@ TEST(ViterbiSearch, TestTopKSearch) {
         generate_column_counts(0,
                                // column sizes
                                std::uniform_int_distribution<size_t>(10, 10)));
-
-    vs.set_emission_cost_model(EmissionCostModel(columns));
-    vs.set_transition_cost_model(TransitionCostModel(columns));
-
-    test_viterbisearch_brute_force(columns, vs);
+    test_kbest_viterbi_search(no_columns, k);
   }
 }
 
@@ -9,6 +9,7 @@
 
 #include <boost/property_tree/ptree_fwd.hpp>
 
+#include <atomic>
 #include <cstdint>
 #include <memory>
 #include <mutex>
@@ -539,6 +540,15 @@ public:
     return cache_->OverCommitted();
   }
 
+  /**
+   * Returns how many times a tile wasn't in the cache and had to be loaded, so the difference
+   * from before tells how many tiles some work loaded
+   * @return the number of tiles loaded so far
+   */
+  uint64_t TilesLoaded() const {
+    return tiles_loaded_.load(std::memory_order_relaxed);
+  }
+
   /**
    * Convenience method to get an opposing directed edge.
    * @param  edgeid  Graph Id of the directed edge.
@@ -1005,6 +1015,8 @@ protected:
   std::unordered_set<GraphId> _404s;
 
   std::unique_ptr<TileCache> cache_;
+  // the tiles that weren't in the cache, readers may be shared between threads
+  std::atomic<uint64_t> tiles_loaded_{0};
 
   bool enable_incidents_;
 
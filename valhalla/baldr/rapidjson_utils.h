@@ -53,15 +53,10 @@ inline std::string to_string(const rapidjson::Value& value, int decimal_places =
 // if you dont want an arithmetic type dont try any lexical casting
 template <typename T, typename V>
 inline typename std::enable_if<!std::is_arithmetic<T>::value, boost::optional<T>>::type
-get_optional(V&& v, const char* source) {
-  // if we dont have this key bail
-  auto* ptr = rapidjson::Pointer{source}.Get(std::forward<V>(v));
-  if (!ptr) {
-    return boost::none;
-  }
+get_optional(V&& v) {
   // if its the exact right type give it back
-  if (ptr->template Is<T>()) {
-    return ptr->template Get<T>();
+  if (v.template Is<T>()) {
+    return v.template Get<T>();
   }
   // give up
   return boost::none;
@@ -70,46 +65,52 @@ get_optional(V&& v, const char* source) {
 // if you do want an arithmetic type dont try lexical casting as a last resort
 template <typename T, typename V>
 inline typename std::enable_if<std::is_arithmetic<T>::value, boost::optional<T>>::type
-get_optional(V&& v, const char* source) {
-  // if we dont have this key bail
-  auto* ptr = rapidjson::Pointer{source}.Get(std::forward<V>(v));
-  if (!ptr) {
-    return boost::none;
-  }
+get_optional(V&& v) {
   // if its the exact right type give it back
-  if (ptr->template Is<T>()) {
-    return ptr->template Get<T>();
+  if (v.template Is<T>()) {
+    return v.template Get<T>();
   }
   // try to convert from a string
-  if (ptr->IsString()) {
+  if (v.IsString()) {
     try {
-      return boost::lexical_cast<T>(ptr->template Get<std::string>());
+      return boost::lexical_cast<T>(v.template Get<std::string>());
     } catch (...) {}
   }
   // numbers are strict in rapidjson but we don't want that strictness because it aborts the program
   // (wtf?)
-  if (ptr->IsBool()) {
-    return static_cast<T>(ptr->GetBool());
+  if (v.IsBool()) {
+    return static_cast<T>(v.GetBool());
   }
-  if (ptr->IsInt()) {
-    return static_cast<T>(ptr->GetInt());
+  if (v.IsInt()) {
+    return static_cast<T>(v.GetInt());
   }
-  if (ptr->IsUint()) {
-    return static_cast<T>(ptr->GetUint());
+  if (v.IsUint()) {
+    return static_cast<T>(v.GetUint());
   }
-  if (ptr->IsInt64()) {
-    return static_cast<T>(ptr->GetInt64());
+  if (v.IsInt64()) {
+    return static_cast<T>(v.GetInt64());
   }
-  if (ptr->IsUint64()) {
-    return static_cast<T>(ptr->GetUint64());
+  if (v.IsUint64()) {
+    return static_cast<T>(v.GetUint64());
   }
-  if (ptr->IsDouble()) {
-    return static_cast<T>(ptr->GetDouble());
+  if (v.IsDouble()) {
+    return static_cast<T>(v.GetDouble());
   }
   // give up
   return boost::none;
 }
 
+// the same conversions as above for the value at the path, if there is one
+template <typename T, typename V>
+inline boost::optional<T> get_optional(V&& v, const char* source) {
+  // if we dont have this key bail
+  auto* ptr = rapidjson::Pointer{source}.Get(std::forward<V>(v));
+  if (!ptr) {
+    return boost::none;
+  }
+  return get_optional<T>(*ptr);
+}
+
 template <typename T, typename V> inline T get(V&& v, const char* source, const T& t) {
   auto value = get_optional<T>(v, source);
   if (!value) {
@@ -115,7 +115,6 @@ protected:
   float max_distance_disable_hierarchy_culling;
 
   // for /tile requests
-  size_t candidate_query_cache_size_;
   meili::CandidateGridQuery candidate_query_;
   ZoomConfig min_zoom_road_class_;
   std::string mvt_cache_dir_;
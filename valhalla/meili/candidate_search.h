@@ -11,10 +11,31 @@
 #include <valhalla/sif/dynamiccost.h>
 
 #include <cmath>
+#include <cstdint>
+#include <limits>
+#include <list>
+#include <memory>
 
 namespace valhalla {
 namespace meili {
 
+// Default number of bytes the grids of a CandidateGridQuery may take
+constexpr size_t kDefaultGridCacheMemory = 256 * 1024 * 1024;
+
+// How well the grids of a CandidateGridQuery are reused
+struct GridCacheStats {
+  uint64_t hits = 0;      // grid lookups served from the cache
+  uint64_t misses = 0;    // grids that had to be built
+  uint64_t evictions = 0; // grids dropped to stay within the limits
+  size_t grids = 0;       // grids currently in the cache
+  size_t memory = 0;      // bytes taken by the cached grids
+
+  float hit_rate() const {
+    const auto lookups = hits + misses;
+    return lookups ? static_cast<float>(hits) / lookups : 0.f;
+  }
+};
+
 class CandidateQuery {
 public:
   virtual ~CandidateQuery() = default;
@@ -29,7 +50,18 @@ class CandidateGridQuery final : public CandidateQuery {
 public:
   using grid_t = GridRangeQuery<baldr::GraphId, midgard::PointLL>;
 
-  CandidateGridQuery(baldr::GraphReader& reader, float cell_width, float cell_height);
+  /**
+   * @param reader            graph reader used to index the bins
+   * @param cell_width        width of the grid cells
+   * @param cell_height       height of the grid cells
+   * @param max_cache_size    maximum number of grids to keep
+   * @param max_cache_memory  maximum number of bytes the kept grids may take
+   */
+  CandidateGridQuery(baldr::GraphReader& reader,
+                     float cell_width,
+                     float cell_height,
+                     size_t max_cache_size = std::numeric_limits<size_t>::max(),
+                     size_t max_cache_memory = kDefaultGridCacheMemory);
 
   ~CandidateGridQuery() override;
 
@@ -55,12 +87,19 @@ public:
                                            edgeids.end(), costing);
   }
 
-  std::unordered_map<baldr::GraphId, grid_t>::size_type size() const {
+  size_t size() const {
     return grid_cache_.size();
   }
 
   void Clear() {
     grid_cache_.clear();
+    lru_.clear();
+    stats_.grids = 0;
+    stats_.memory = 0;
+  }
+
+  const GridCacheStats& cache_stats() const {
+    return stats_;
   }
 
   std::unordered_set<baldr::GraphId> RangeQuery(const midgard::AABB2<midgard::PointLL>& range) const;
@@ -72,13 +111,30 @@ private:
                         const midgard::Tiles<midgard::PointLL>& tiles,
                         const midgard::Tiles<midgard::PointLL>& bins) const;
 
+  // Drop the least recently used grids until the cache is within its limits. The most recently
+  // used grid is always kept
+  void Evict() const;
+
+  struct CachedGrid {
+    // Grids are not modified once built so they can be handed out read-only
+    std::shared_ptr<const grid_t> grid;
+    std::list<int32_t>::iterator lru;
+    size_t memory;
+  };
+
   uint32_t bin_level_;
 
   float cell_width_;
   float cell_height_;
 
-  // Grid cache - cached per "bin" within a graph tile
-  mutable std::unordered_map<int32_t, grid_t> grid_cache_;
+  size_t max_cache_size_;
+  size_t max_cache_memory_;
+
+  // Grid cache - cached per "bin" within a graph tile. The bins are ordered from the most to the
+  // least recently used
+  mutable std::unordered_map<int32_t, CachedGrid> grid_cache_;
+  mutable std::list<int32_t> lru_;
+  mutable GridCacheStats stats_;
 
   baldr::GraphReader& reader_;
 };
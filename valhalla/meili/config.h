@@ -2,6 +2,8 @@
 
 #include <boost/property_tree/ptree_fwd.hpp>
 
+#include <cstdint>
+
 namespace valhalla {
 namespace meili {
 
@@ -21,7 +23,10 @@ struct Config {
     // maximum allowed difference (meters) between GPS point and corresponding route point
     float max_search_radius_meters = 200.f;
 
+    // maximum number of candidate grids to keep in the cache
     size_t cache_size = 100240;
+    // maximum number of bytes the cached candidate grids may take
+    size_t cache_memory = 268435456;
     size_t grid_size = 500;
 
     void Read(const boost::property_tree::ptree& params);
@@ -70,6 +75,10 @@ struct Config {
   TransitionCost transition_cost{};
   EmissionCost emission_cost{};
   Routing routing{};
+
+  // number of threads used to match the independent parts of a trace (consecutive measurements
+  // which are too far apart to ever be connected) concurrently; 1 matches everything sequentially
+  uint32_t concurrency = 1;
 };
 
 } // namespace meili
@@ -6,34 +6,32 @@
 #include <valhalla/midgard/aabb2.h>
 #include <valhalla/midgard/linesegment2.h>
 
+#include <algorithm>
+#include <cstdint>
+#include <span>
 #include <stdexcept>
 #include <string>
 #include <tuple>
-#include <unordered_map>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
 namespace valhalla {
 namespace meili {
 
+/**
+ * A grid of squares over a bounding box which indexes the items whose line segments cross the
+ * squares. Items are stored in one flat array sorted by square, so a grid only takes memory for
+ * the squares that have items. Added line segments become visible to queries once the grid is
+ * compacted, after which the grid can be shared read-only.
+ */
 template <typename item_t, typename coord_t> class GridRangeQuery {
 public:
   GridRangeQuery(const midgard::AABB2<coord_t>& bbox, float square_width, float square_height)
       : bbox_(bbox), square_width_(square_width), square_height_(square_height),
         ncols_(ceil((bbox.maxx() - bbox.minx()) / square_width)),
         nrows_(ceil((bbox.maxy() - bbox.miny()) / square_height)),
-        grid_(bbox.minx(), bbox.miny(), square_width, square_height, ncols_, nrows_),
-#ifdef GRID_USE_VECTOR
-        items_()
-#else
-        items_(), empty_item_()
-#endif
-  {
-#ifdef GRID_USE_VECTOR
-    items_.resize(ncols_ * nrows_);
-#else
-    items_.reserve((ncols_ + nrows_) / 2);
-#endif
+        grid_(bbox.minx(), bbox.miny(), square_width, square_height, ncols_, nrows_) {
   }
 
   const midgard::AABB2<coord_t>& bbox() const {
@@ -56,28 +54,19 @@ public:
     return square_height_;
   }
 
-  const std::vector<item_t>& GetItemsInSquare(int col, int row) const {
-    if (!(0 <= col && col < ncols_ && 0 <= row && row < nrows_)) {
-      throw std::runtime_error("SQUARE(" + std::to_string(col) + " " + std::to_string(row) +
-                               ") is out of the grid bounds (" + std::to_string(ncols_) + "x" +
-                               std::to_string(nrows_) + " squares)");
-    }
-
-#ifdef GRID_USE_VECTOR
-    return items_[col + row * ncols_];
-#else
-    const auto it = items_.find(col + row * ncols_);
-    if (it == items_.end()) {
-      return empty_item_;
-    } else {
-      return it->second;
+  std::span<const item_t> GetItemsInSquare(int col, int row) const {
+    const auto square = SquareIndex(col, row);
+    const auto it = std::lower_bound(squares_.begin(), squares_.end(), square);
+    if (it == squares_.end() || *it != square) {
+      return {};
     }
-#endif
+    const auto i = it - squares_.begin();
+    return {items_.data() + offsets_[i], items_.data() + offsets_[i + 1]};
   }
 
   void AddLineSegment(const item_t& item, const coord_t& origin, const coord_t& dest) {
     for (const auto& square : grid_.Traverse(origin, dest)) {
-      ItemsInSquare(square.first, square.second).push_back(item);
+      pending_.emplace_back(SquareIndex(square.first, square.second), item);
     }
   }
 
@@ -86,6 +75,43 @@ public:
     AddLineSegment(item, segment.a(), segment.b());
   }
 
+  // Move the items added since the last call into the flat layout. Within a square the items
+  // keep the order in which they were added
+  void Compact() {
+    if (pending_.empty()) {
+      return;
+    }
+
+    std::vector<std::pair<uint32_t, item_t>> entries;
+    entries.reserve(items_.size() + pending_.size());
+    for (size_t i = 0; i < squares_.size(); ++i) {
+      for (auto j = offsets_[i]; j < offsets_[i + 1]; ++j) {
+        entries.emplace_back(squares_[i], items_[j]);
+      }
+    }
+    entries.insert(entries.end(), pending_.begin(), pending_.end());
+    std::stable_sort(entries.begin(), entries.end(),
+                     [](const auto& a, const auto& b) { return a.first < b.first; });
+
+    squares_.clear();
+    offsets_.clear();
+    items_.clear();
+    items_.reserve(entries.size());
+    for (const auto& entry : entries) {
+      if (squares_.empty() || squares_.back() != entry.first) {
+        squares_.push_back(entry.first);
+        offsets_.push_back(items_.size());
+      }
+      items_.push_back(entry.second);
+    }
+    offsets_.push_back(items_.size());
+
+    squares_.shrink_to_fit();
+    offsets_.shrink_to_fit();
+    pending_.clear();
+    pending_.shrink_to_fit();
+  }
+
   // Query all items that intersects with the range
   std::unordered_set<item_t> Query(const midgard::AABB2<coord_t>& range) const {
     int mincol, minrow, maxcol, maxrow;
@@ -100,25 +126,34 @@ public:
 
     std::unordered_set<item_t> items;
 
+    // The squares of a row are contiguous in the flat layout
     for (int row = minrow; row <= maxrow; ++row) {
-      for (int col = mincol; col <= maxcol; ++col) {
-        const auto& squared_items = GetItemsInSquare(col, row);
-        items.insert(squared_items.begin(), squared_items.end());
+      const auto last = SquareIndex(maxcol, row);
+      auto it = std::lower_bound(squares_.begin(), squares_.end(), SquareIndex(mincol, row));
+      for (; it != squares_.end() && *it <= last; ++it) {
+        const auto i = it - squares_.begin();
+        items.insert(items_.begin() + offsets_[i], items_.begin() + offsets_[i + 1]);
       }
     }
 
     return items;
   }
 
+  // Approximate number of bytes used by the grid
+  size_t memory_size() const {
+    return sizeof(*this) + squares_.capacity() * sizeof(uint32_t) +
+           offsets_.capacity() * sizeof(uint32_t) + items_.capacity() * sizeof(item_t) +
+           pending_.capacity() * sizeof(std::pair<uint32_t, item_t>);
+  }
+
 private:
-  std::vector<item_t>& ItemsInSquare(int col, int row) {
+  uint32_t SquareIndex(int col, int row) const {
     if (!(0 <= col && col < ncols_ && 0 <= row && row < nrows_)) {
       throw std::runtime_error("SQUARE(" + std::to_string(col) + " " + std::to_string(row) +
                                ") is out of the grid bounds (" + std::to_string(ncols_) + "x" +
                                std::to_string(nrows_) + " squares)");
     }
-
-    return items_[col + row * ncols_];
+    return col + row * ncols_;
   }
 
   midgard::AABB2<coord_t> bbox_;
@@ -126,14 +161,14 @@ private:
   int ncols_, nrows_;
   GridTraversal<coord_t> grid_;
 
-// Using vector to represent the grid would be faster than using
-// unordered map but it consumes (much) more memory as well
-#ifdef GRID_USE_VECTOR
-  std::vector<std::vector<item_t>> items_;
-#else
-  std::unordered_map<unsigned, std::vector<item_t>> items_;
-  const std::vector<item_t> empty_item_;
-#endif
+  // Sorted indices of the squares which have items. The items of squares_[i] are
+  // items_[offsets_[i]] up to items_[offsets_[i + 1]]
+  std::vector<uint32_t> squares_;
+  std::vector<uint32_t> offsets_;
+  std::vector<item_t> items_;
+
+  // Items added since the last compaction along with their square index
+  std::vector<std::pair<uint32_t, item_t>> pending_;
 };
 
 } // namespace meili
@@ -9,10 +9,12 @@
 #include <valhalla/meili/match_result.h>
 #include <valhalla/meili/measurement.h>
 #include <valhalla/meili/state.h>
-#include <valhalla/meili/topk_search.h>
 #include <valhalla/meili/transition_cost_model.h>
 #include <valhalla/midgard/pointll.h>
 
+#include <memory>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 
 namespace valhalla {
@@ -25,7 +27,8 @@ public:
              baldr::GraphReader& graphreader,
              CandidateQuery& candidatequery,
              const sif::mode_costing_t& mode_costing,
-             sif::TravelMode travelmode);
+             sif::TravelMode travelmode,
+             const std::vector<std::shared_ptr<baldr::GraphReader>>& worker_graphreaders = {});
 
   ~MapMatcher();
 
@@ -73,6 +76,9 @@ public:
   void set_interrupt(const std::function<void()>* interrupt_callback) {
     interrupt_ = interrupt_callback;
     graphreader_.SetInterrupt(interrupt_);
+    for (auto& worker_graphreader : worker_graphreaders_) {
+      worker_graphreader->SetInterrupt(interrupt_);
+    }
   }
 
   std::unordered_map<StateId::Time, std::vector<Measurement>>
@@ -84,6 +90,30 @@ private:
   void RemoveRedundancies(const std::vector<StateId>& result,
                           const std::vector<MatchResult>& results);
 
+  bool IsRemoved(const StateId& stateid) const {
+    return removed_states_.find(stateid) != removed_states_.cend();
+  }
+
+  /**
+   * Splits the columns of the state container into independent traces. Two consecutive columns
+   * are independent if their measurements are so far apart that no route between any of their
+   * candidates can be shorter than the breakage distance, so there will be a discontinuity
+   * between them no matter which candidates win.
+   * @return  the [begin, end) column ranges of each independent trace, in order
+   */
+  std::vector<std::pair<StateId::Time, StateId::Time>> FindIndependentTraces() const;
+
+  /**
+   * Runs the viterbi search on each independent trace concurrently, one graph reader per thread,
+   * and stitches the winning states back together exactly the way the sequential search would
+   * have found them.
+   * @param traces     the column ranges of the independent traces
+   * @param state_ids  the winning states of all columns in reversed order
+   * @return  the accumulated cost of the stitched path
+   */
+  double SearchIndependentTraces(const std::vector<std::pair<StateId::Time, StateId::Time>>& traces,
+                                 std::vector<StateId>& state_ids);
+
   Config config_;
 
   baldr::GraphReader& graphreader_;
@@ -99,13 +129,17 @@ private:
 
   ViterbiSearch vs_;
 
-  TopKSearch ts_;
+  // States which are redundant with the paths found so far, alternates never go through them
+  std::unordered_set<StateId> removed_states_;
 
   StateContainer container_;
 
   EmissionCostModel emission_cost_model_;
 
   TransitionCostModel transition_cost_model_;
+
+  // Readers used by the threads matching independent traces, concurrency is disabled when empty
+  std::vector<std::shared_ptr<baldr::GraphReader>> worker_graphreaders_;
 };
 
 /**
@@ -10,6 +10,9 @@
 
 #include <boost/property_tree/ptree_fwd.hpp>
 
+#include <memory>
+#include <vector>
+
 namespace valhalla {
 namespace meili {
 
@@ -28,6 +31,10 @@ public:
     return *candidatequery_;
   }
 
+  const GridCacheStats& grid_cache_stats() const {
+    return candidatequery_->cache_stats();
+  }
+
   MapMatcher* Create(const Options& options);
 
   MapMatcher* Create(const Costing::Type costing_type) {
@@ -54,6 +61,9 @@ private:
   sif::CostFactory cost_factory_;
 
   std::shared_ptr<CandidateGridQuery> candidatequery_;
+
+  // one reader per matching thread when matching independent parts of traces concurrently
+  std::vector<std::shared_ptr<baldr::GraphReader>> worker_graphreaders_;
 };
 
 } // namespace meili
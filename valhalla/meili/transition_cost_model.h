@@ -5,7 +5,6 @@
 #include <valhalla/meili/config.h>
 #include <valhalla/meili/measurement.h>
 #include <valhalla/meili/state.h>
-#include <valhalla/meili/topk_search.h>
 #include <valhalla/meili/viterbi_search.h>
 #include <valhalla/sif/dynamiccost.h>
 
@@ -16,7 +15,6 @@ class TransitionCostModel {
 public:
   TransitionCostModel(baldr::GraphReader& graphreader,
                       const IViterbiSearch& vs,
-                      const TopKSearch& ts,
                       const StateContainer& container,
                       const sif::mode_costing_t& mode_costing,
                       const sif::TravelMode travelmode,
@@ -28,7 +26,6 @@ public:
 
   TransitionCostModel(baldr::GraphReader& graphreader,
                       const IViterbiSearch& vs,
-                      const TopKSearch& ts,
                       const StateContainer& container,
                       const sif::mode_costing_t& mode_costing,
                       const sif::TravelMode travelmode,
@@ -68,8 +65,6 @@ private:
 
   const IViterbiSearch& vs_;
 
-  const TopKSearch& ts_;
-
   const StateContainer& container_;
 
   const sif::mode_costing_t& mode_costing_;
@@ -5,6 +5,8 @@
 #include <valhalla/meili/priority_queue.h>
 #include <valhalla/meili/stateid.h>
 
+#include <cstdint>
+#include <functional>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
@@ -181,6 +183,71 @@ private:
   SPQueue<StateLabel> queue_;
   StateId::Time earliest_time_{0};
 };
+
+/**
+ * Finds the k best paths through the states in a single forward pass. Instead of the one best label
+ * of the Viterbi algorithm every state keeps the labels of its k best paths, each of which knows
+ * the label of the predecessor it extends (the list Viterbi algorithm). The best k labels of a
+ * column are then exactly the k best paths ending at it, so alternatives need no new search.
+ *
+ * Unlike ViterbiSearch paths never break: a state is only reachable through states with valid
+ * emission costs joined by valid transition costs.
+ */
+class KBestViterbiSearch : public IViterbiSearch {
+public:
+  explicit KBestViterbiSearch(uint32_t k);
+  ~KBestViterbiSearch();
+
+  void Clear() override;
+  void ClearSearch() override;
+  bool AddStateId(const StateId& stateid) override;
+  bool RemoveStateId(const StateId& stateid) override;
+  StateId SearchWinner(StateId::Time time) override;
+  StateId Predecessor(const StateId& stateid) const override;
+  double AccumulatedCost(const StateId& stateid) const override;
+
+  uint32_t k() const {
+    return k_;
+  }
+
+  /**
+   * Get the states of a path ending at the given time, in order from the first state.
+   *
+   * @param time   the time of the last state of the path
+   * @param rank   which path, 0 being the best one. Must be less than k
+   * @return the states of the path, empty if there are not that many paths
+   */
+  std::vector<StateId> SearchPath(StateId::Time time, uint32_t rank);
+
+  /**
+   * Get the accumulated cost of a path found by SearchPath, -1 if there is no such path.
+   */
+  double PathCost(StateId::Time time, uint32_t rank);
+
+private:
+  static constexpr uint32_t kNoPredecessor = std::numeric_limits<uint32_t>::max();
+
+  struct Label {
+    double costsofar;
+    // Where the label came from in the previous column, invalid for labels starting a path
+    uint32_t predecessor;
+    uint32_t predecessor_rank;
+  };
+
+  // The position of a label in its column: the index of its state and its rank at the state
+  using LabelRef = std::pair<uint32_t, uint32_t>;
+
+  // Compute the labels of the columns up to the target time
+  void ForwardTo(StateId::Time target);
+  // Get the labels of a column in order of their costs
+  const std::vector<LabelRef>& RankedLabels(StateId::Time time);
+  const Label* GetLabel(const StateId& stateid) const;
+
+  uint32_t k_;
+  // The best k labels of each state in order of their costs, by time and index in the column
+  std::vector<std::vector<std::vector<Label>>> labels_by_time_;
+  std::vector<std::vector<LabelRef>> ranked_labels_by_time_;
+};
 } // namespace meili
 } // namespace valhalla
 #endif // MMP_VITERBI_SEARCH_H_
@@ -0,0 +1,157 @@
+#ifndef VALHALLA_MIDGARD_METRICS_H_
+#define VALHALLA_MIDGARD_METRICS_H_
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace valhalla {
+namespace midgard {
+
+// Latencies and counters of the whole process, kept locally so they can be pulled rather than
+// pushed like the statsd stats. Every thread records into its own shard of plain relaxed atomics
+// which only it writes to, so recording never takes a lock or contends with other threads, and a
+// snapshot sums the shards of all the threads. When a thread exits its shard is folded into a total
+// of the threads that are gone, the counts only ever go up.
+namespace metrics {
+
+// the stages of a request whose latencies are tracked, some run within others like the reach
+// within the search
+enum class stage_t : uint8_t {
+  parse,
+  search,
+  reach,
+  path,
+  trip_leg,
+  maneuvers,
+  narrative,
+  serialize,
+};
+constexpr size_t kStageCount = static_cast<size_t>(stage_t::serialize) + 1;
+
+enum class counter_t : uint8_t {
+  tile_cache_hits,
+  tile_cache_misses,
+  labels_settled,
+};
+constexpr size_t kCounterCount = static_cast<size_t>(counter_t::labels_settled) + 1;
+
+const std::string& to_string(stage_t stage);
+const std::string& to_string(counter_t counter);
+
+/**
+ * Latencies in microseconds in log linear buckets, like an HDR histogram with 3 significant bits.
+ * Values below 8 have a bucket each and every power of two above is split in 8 buckets, so a
+ * bucket is never wider than an eighth of its lower bound.
+ */
+struct histogram_t {
+  static constexpr uint32_t kSubBits = 3;
+  static constexpr uint32_t kSubBuckets = 1 << kSubBits;
+  // values are clamped to under 2^40us, about 12 days
+  static constexpr uint32_t kMaxBits = 40;
+  static constexpr size_t kBuckets = (kMaxBits - kSubBits + 1) * kSubBuckets;
+
+  static size_t bucket(uint64_t value);
+  static uint64_t lower_bound(size_t bucket);
+  static uint64_t upper_bound(size_t bucket);
+
+  /**
+   * @param q  the quantile, between 0 and 1
+   * @return the upper bound of the bucket the quantile falls in, at most the max, 0 if empty
+   */
+  uint64_t quantile(double q) const;
+
+  /**
+   * @param bound  a power of two, those are always the lower bound of a bucket
+   * @return the number of values below the bound
+   */
+  uint64_t below(uint64_t bound) const;
+
+  uint64_t count = 0;
+  uint64_t sum = 0;
+  uint64_t max = 0;
+  std::array<uint64_t, kBuckets> buckets{};
+};
+
+// All of the latencies and counters at one point in time
+struct snapshot_t {
+  std::array<histogram_t, kStageCount> stages;
+  std::array<uint64_t, kCounterCount> counters{};
+};
+
+/**
+ * Records how long a stage took on this thread
+ * @param stage    the stage
+ * @param elapsed  how long it took
+ */
+void record(stage_t stage, std::chrono::steady_clock::duration elapsed);
+
+/**
+ * Adds to a counter on this thread
+ * @param counter  the counter
+ * @param n        how much to add
+ */
+void count(counter_t counter, uint64_t n = 1);
+
+/**
+ * @return the sum of what all of the threads recorded so far
+ */
+snapshot_t snapshot();
+
+/**
+ * @return the latencies and counters in the prometheus text format
+ */
+std::string to_prometheus(const snapshot_t& snapshot);
+
+/**
+ * Records the time from construction to destruction as the latency of a stage, put one at the top
+ * of the scope that is the stage
+ */
+class stage_timer_t {
+public:
+  explicit stage_timer_t(stage_t stage) : stage_(stage), start_(std::chrono::steady_clock::now()) {
+  }
+  ~stage_timer_t() {
+    record(stage_, std::chrono::steady_clock::now() - start_);
+  }
+  stage_timer_t(const stage_timer_t&) = delete;
+  stage_timer_t& operator=(const stage_timer_t&) = delete;
+
+protected:
+  stage_t stage_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+/**
+ * Adds up a counter locally and adds it to the counter on this thread once on destruction, put one
+ * at the top of the scope that would otherwise count in a hot loop
+ */
+class local_counter_t {
+public:
+  explicit local_counter_t(counter_t counter) : counter_(counter), n_(0) {
+  }
+  ~local_counter_t() {
+    if (n_) {
+      count(counter_, n_);
+    }
+  }
+  local_counter_t(const local_counter_t&) = delete;
+  local_counter_t& operator=(const local_counter_t&) = delete;
+
+  local_counter_t& operator++() {
+    ++n_;
+    return *this;
+  }
+
+protected:
+  counter_t counter_;
+  uint64_t n_;
+};
+
+} // namespace metrics
+} // namespace midgard
+} // namespace valhalla
+
+#endif // VALHALLA_MIDGARD_METRICS_H_
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <algorithm>
+#include <atomic>
 #include <cerrno>
 #include <cmath>
 #include <cstdint>
@@ -13,6 +14,7 @@
 #include <queue>
 #include <stdexcept>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -256,6 +258,9 @@ template <class T> class sequence {
 public:
   // static_assert(std::is_pod<T>::value, "sequence requires POD types for now");
   static const size_t npos = -1;
+  // how many elements sort holds in memory at a time, split between its threads unless it is told
+  // how long its sorted sub-ranges are
+  static constexpr size_t sort_buffer_size = 1024 * 1024 * 512 / sizeof(T);
 
   using value_type = T;
 
@@ -318,14 +323,24 @@ public:
     return npos;
   }
 
-  // sort the file based on the predicate, and outputs to output_seq
+  // sort the file based on the predicate
   //
-  // Strategy is to first sort sub-ranges of length buffer_size in place.
-  // These should all fit in memory. Then, merge the sub-ranges into the
-  // output sequence via priority queue.
+  // Strategy is to first stable sort sub-ranges of length buffer_size in place, up to concurrency
+  // of them at a time. Without a buffer_size the sub-ranges are sort_buffer_size / concurrency
+  // long. These should all fit in memory, along with the as large scratch buffer of the stable
+  // sort. Then, merge the sub-ranges into a temporary file which is split into one part per thread
+  // at splitters sampled from the sub-ranges. Each thread merges its part of every sub-range via
+  // priority queue. Equal elements keep the order of their sub-ranges and the sub-ranges keep the
+  // order of the file, so the result is that of a stable sort of the whole file whatever the
+  // concurrency or the buffer_size
   void sort(const std::function<bool(const T&, const T&)>& predicate,
-            size_t buffer_size = 1024 * 1024 * 512 / sizeof(T)) {
+            size_t buffer_size = 0,
+            unsigned int concurrency = 1) {
     flush();
+    concurrency = std::max(1u, concurrency);
+    if (buffer_size == 0) {
+      buffer_size = std::max<size_t>(1, sort_buffer_size / concurrency);
+    }
     // if no elements we are done
     if (memmap.size() == 0) {
       return;
@@ -333,42 +348,110 @@ public:
 
     // If there wont be any merging we may as well take the simple approach
     if (buffer_size > memmap.size() + write_buffer.size()) {
-      std::sort(static_cast<T*>(memmap), static_cast<T*>(memmap) + memmap.size(), predicate);
+      std::stable_sort(static_cast<T*>(memmap), static_cast<T*>(memmap) + memmap.size(),
+                       predicate);
       return;
     }
 
+    // Sort the subsections
+    T* data = static_cast<T*>(memmap);
+    const size_t count = memmap.size();
+    const size_t chunk_count = (count + buffer_size - 1) / buffer_size;
+    const auto chunk_begin = [buffer_size](size_t chunk) { return chunk * buffer_size; };
+    const auto chunk_end = [buffer_size, count](size_t chunk) {
+      return std::min(count, (chunk + 1) * buffer_size);
+    };
+    parallel_for(chunk_count, concurrency, [&](size_t chunk) {
+      std::stable_sort(data + chunk_begin(chunk), data + chunk_end(chunk), predicate);
+    });
+
+    // Split the output into parts which can be merged independently. Elements are ordered by
+    // value, then sub-range, then position so that every element has exactly one place to go
+    const size_t part_count = std::min<size_t>(concurrency, count);
+    std::vector<std::vector<size_t>> bounds(part_count + 1, std::vector<size_t>(chunk_count));
+    for (size_t chunk = 0; chunk < chunk_count; ++chunk) {
+      bounds.front()[chunk] = chunk_begin(chunk);
+      bounds.back()[chunk] = chunk_end(chunk);
+    }
+    if (part_count > 1) {
+      // Take evenly spaced samples of every sub-range and use their quantiles as splitters
+      std::vector<std::pair<size_t, size_t>> samples;
+      const size_t samples_per_chunk = part_count * 16;
+      for (size_t chunk = 0; chunk < chunk_count; ++chunk) {
+        const size_t size = chunk_end(chunk) - chunk_begin(chunk);
+        const size_t step = std::max<size_t>(1, size / samples_per_chunk);
+        for (size_t i = step / 2; i < size; i += step) {
+          samples.emplace_back(chunk, chunk_begin(chunk) + i);
+        }
+      }
+      const auto before = [&predicate, data](const std::pair<size_t, size_t>& a,
+                                             const std::pair<size_t, size_t>& b) {
+        if (predicate(data[a.second], data[b.second])) {
+          return true;
+        }
+        return !predicate(data[b.second], data[a.second]) && a < b;
+      };
+      std::sort(samples.begin(), samples.end(), before);
+
+      for (size_t part = 1; part < part_count; ++part) {
+        const auto& [splitter_chunk, splitter] = samples[part * samples.size() / part_count];
+        const T& value = data[splitter];
+        for (size_t chunk = 0; chunk < chunk_count; ++chunk) {
+          auto* first = data + chunk_begin(chunk);
+          auto* last = data + chunk_end(chunk);
+          if (chunk < splitter_chunk) {
+            bounds[part][chunk] = std::upper_bound(first, last, value, predicate) - data;
+          } else if (chunk > splitter_chunk) {
+            bounds[part][chunk] = std::lower_bound(first, last, value, predicate) - data;
+          } else {
+            bounds[part][chunk] = splitter;
+          }
+        }
+      }
+    }
+
     auto tmp_path = std::filesystem::path(file_name).replace_filename(
         std::filesystem::path(file_name).filename().string() + ".tmp");
     {
-      // we need a temporary sequence to merge the sorted subsections into
-      sequence<T> output_seq(tmp_path.string(), true);
+      // we need a temporary file to merge the sorted subsections into
+      mem_map<T> output;
+      output.create(tmp_path.string(), count, POSIX_MADV_SEQUENTIAL);
+
+      // Perform the merge of each part
+      parallel_for(part_count, concurrency, [&](size_t part) {
+        size_t out = 0;
+        for (size_t chunk = 0; chunk < chunk_count; ++chunk) {
+          out += bounds[part][chunk] - chunk_begin(chunk);
+        }
 
-      // Comparator needs to be inverted for pq to provide constant time *smallest* lookup
-      // Pq keeps track of element and its index.
-      auto cmp = [&predicate](const std::pair<T, size_t>& a, std::pair<T, size_t>& b) {
-        return predicate(b.first, a.first);
-      };
-      std::priority_queue<std::pair<T, size_t>, std::vector<std::pair<T, size_t>>, decltype(cmp)> pq(
-          cmp);
-
-      // Sort the subsections
-      for (size_t i = 0; i < memmap.size(); i += buffer_size) {
-        std::sort(static_cast<T*>(memmap) + i,
-                  static_cast<T*>(memmap) + std::min(memmap.size(), i + buffer_size), predicate);
-        pq.emplace(*at(i), i);
-      }
+        // Comparator needs to be inverted for pq to provide constant time *smallest* lookup
+        // Pq keeps track of the index of the element and of its sub-range
+        auto cmp = [&predicate, data](const std::pair<size_t, size_t>& a,
+                                      const std::pair<size_t, size_t>& b) {
+          if (predicate(data[b.first], data[a.first])) {
+            return true;
+          }
+          return !predicate(data[a.first], data[b.first]) && b.second < a.second;
+        };
+        std::priority_queue<std::pair<size_t, size_t>, std::vector<std::pair<size_t, size_t>>,
+                            decltype(cmp)>
+            pq(cmp);
+        for (size_t chunk = 0; chunk < chunk_count; ++chunk) {
+          if (bounds[part][chunk] < bounds[part + 1][chunk]) {
+            pq.emplace(bounds[part][chunk], chunk);
+          }
+        }
 
-      // Perform the merge
-      while (!pq.empty()) {
-        auto tmp = pq.top();
-        pq.pop();
-        output_seq.push_back(tmp.first);
-        size_t new_idx = tmp.second + 1;
-        if (new_idx % buffer_size != 0 && new_idx < memmap.size()) {
-          pq.emplace(*at(new_idx), new_idx);
+        T* output_data = output.get();
+        while (!pq.empty()) {
+          auto [idx, chunk] = pq.top();
+          pq.pop();
+          output_data[out++] = data[idx];
+          if (++idx < bounds[part + 1][chunk]) {
+            pq.emplace(idx, chunk);
+          }
         }
-      }
-      output_seq.flush();
+      });
     }
 
     // Forget about this file for a second so we can swap in the temp file
@@ -580,6 +663,26 @@ public:
   }
 
 protected:
+  // run work(i) for every i below count on up to concurrency threads
+  static void parallel_for(size_t count,
+                           unsigned int concurrency,
+                           const std::function<void(size_t)>& work) {
+    std::atomic<size_t> next(0);
+    const auto worker = [&next, count, &work]() {
+      for (size_t i = next++; i < count; i = next++) {
+        work(i);
+      }
+    };
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < std::min<size_t>(concurrency, count); ++i) {
+      threads.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  }
+
   std::shared_ptr<std::fstream> file;
   std::string file_name;
   std::vector<T> write_buffer;
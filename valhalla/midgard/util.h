@@ -326,6 +326,10 @@ struct memory_status {
 
   static bool supported();
 
+  // Reset the peak resident set size (VmHWM) so that later readings only cover what happens
+  // from here on. Returns false if the os does not support it
+  static bool reset_peak();
+
   friend std::ostream& operator<<(std::ostream&, const memory_status&);
 };
 std::ostream& operator<<(std::ostream& stream, const memory_status& s);
@@ -0,0 +1,159 @@
+#ifndef VALHALLA_MJOLNIR_FLATMULTIMAP_H
+#define VALHALLA_MJOLNIR_FLATMULTIMAP_H
+
+#include <valhalla/midgard/logging.h>
+#include <valhalla/midgard/sequence.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace valhalla {
+namespace mjolnir {
+
+/**
+ * Multimap from OSM ids to plain values, stored as one flat array sorted by id. Entries are
+ * appended while parsing and become visible to lookups once the map is sorted. A sorted map can
+ * be written to a file as is and that file memory mapped read-only by later stages, so loading
+ * it takes neither a deserialize step nor heap memory.
+ */
+template <typename value_t> class FlatMultiMap {
+  static_assert(std::is_trivially_copyable_v<value_t>,
+                "FlatMultiMap values are written to and mapped from files as is");
+
+public:
+  // An entry of the map, its members mirror those of std::pair so call sites read the same
+  struct value_type {
+    value_type() = default;
+    value_type(const uint64_t key, const value_t& value) : first(key), second(value) {
+    }
+    uint64_t first;
+    value_t second;
+  };
+  using const_iterator = const value_type*;
+
+  /**
+   * Add an entry. Entries added since the last call to sort() can't be looked up until then.
+   * Adding to a mapped map copies it to the heap first.
+   * @param entry  the key and value to add
+   */
+  void insert(const value_type& entry) {
+    if (mapped_) {
+      entries_.assign(mapped_->get(), mapped_->get() + mapped_->size());
+      mapped_.reset();
+    }
+    entries_.push_back(entry);
+    sorted_ = false;
+  }
+
+  void emplace(const uint64_t key, const value_t& value) {
+    insert(value_type(key, value));
+  }
+
+  /**
+   * Sort the entries by key, the entries of a key keep the order in which they were added.
+   */
+  void sort() {
+    if (!sorted_) {
+      std::stable_sort(entries_.begin(), entries_.end(),
+                       [](const value_type& a, const value_type& b) { return a.first < b.first; });
+      sorted_ = true;
+    }
+  }
+
+  /**
+   * Find the entries with the key.
+   * @param key  the OSM id to look up
+   * @return the range of entries with the key, empty and at end() if there are none
+   */
+  std::pair<const_iterator, const_iterator> equal_range(const uint64_t key) const {
+    if (!sorted_) {
+      throw std::logic_error("FlatMultiMap must be sorted before lookups");
+    }
+    auto range = std::equal_range(begin(), end(), value_type(key, {}),
+                                  [](const value_type& a, const value_type& b) {
+                                    return a.first < b.first;
+                                  });
+    return range.first == range.second ? std::make_pair(end(), end()) : range;
+  }
+
+  const_iterator find(const uint64_t key) const {
+    return equal_range(key).first;
+  }
+
+  const_iterator begin() const {
+    return mapped_ ? mapped_->get() : entries_.data();
+  }
+
+  const_iterator end() const {
+    return begin() + size();
+  }
+
+  size_t size() const {
+    return mapped_ ? mapped_->size() : entries_.size();
+  }
+
+  bool empty() const {
+    return size() == 0;
+  }
+
+  /**
+   * Sort the map and write its entries to a file.
+   * @param file_name  the file to create or truncate
+   * @return Returns true if successful, false if an error occurs.
+   */
+  bool write(const std::string& file_name) {
+    sort();
+    std::ofstream file(file_name, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+      LOG_ERROR("FlatMultiMap failed to open output file: " + file_name);
+      return false;
+    }
+    file.write(reinterpret_cast<const char*>(begin()), size() * sizeof(value_type));
+    file.close();
+    return !file.fail();
+  }
+
+  /**
+   * Replace the map with the entries of a file written by write(), mapped read-only.
+   * @param file_name  the file to map
+   * @return Returns true if successful, false if an error occurs.
+   */
+  bool map(const std::string& file_name) {
+    std::error_code ec;
+    const auto file_size = std::filesystem::file_size(file_name, ec);
+    if (ec || file_size % sizeof(value_type)) {
+      LOG_ERROR("FlatMultiMap failed to map input file: " + file_name);
+      return false;
+    }
+
+    entries_ = {};
+    mapped_.reset();
+    sorted_ = true;
+    if (file_size) {
+      auto mapped = std::make_shared<midgard::mem_map<value_type>>();
+      mapped->map_readonly(file_name, file_size / sizeof(value_type), POSIX_MADV_RANDOM);
+      mapped_ = std::move(mapped);
+    }
+    return true;
+  }
+
+private:
+  // Entries on the heap, the ones added since the last call to sort() are at the end
+  std::vector<value_type> entries_;
+  // Entries of a file, shared by the copies of the map since they are never written to
+  std::shared_ptr<const midgard::mem_map<value_type>> mapped_;
+  bool sorted_ = true;
+};
+
+} // namespace mjolnir
+} // namespace valhalla
+
+#endif // VALHALLA_MJOLNIR_FLATMULTIMAP_H
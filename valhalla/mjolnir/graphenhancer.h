@@ -1,10 +1,16 @@
 #ifndef VALHALLA_MJOLNIR_GRAPHENHANCER_H
 #define VALHALLA_MJOLNIR_GRAPHENHANCER_H
 
+#include <valhalla/baldr/graphid.h>
+#include <valhalla/baldr/graphreader.h>
 #include <valhalla/mjolnir/osmdata.h>
 
 #include <boost/property_tree/ptree_fwd.hpp>
 
+#include <string>
+#include <unordered_set>
+#include <vector>
+
 namespace valhalla {
 namespace mjolnir {
 
@@ -18,10 +24,27 @@ public:
    * @param pt          property tree containing the hierarchy configuration
    * @param osmdata     OSM data used to enhance the turn lanes.
    * @param access_file where to store the access tags so they are not in memory
+   * @param tiles       local tiles to enhance, all of them if empty
    */
   static void Enhance(const boost::property_tree::ptree& pt,
                       const OSMData& osmdata,
-                      const std::string& access_file);
+                      const std::string& access_file,
+                      const std::unordered_set<baldr::GraphId>& tiles = {});
+
+  /**
+   * Get the local tiles whose enhanced attributes depend on the given tiles and nodes. Density
+   * is measured within a radius around every node and not thru edges are found by expanding a
+   * bounded number of nodes over minor roads, so changing a tile or a node changes what the
+   * enhancer computes for the tiles within reach of it.
+   * @param reader  graph reader of the local tiles before the change
+   * @param tiles   local tiles whose content changes
+   * @param nodes   local nodes whose edges change
+   * @return the tiles within reach, including the given tiles
+   */
+  static std::unordered_set<baldr::GraphId>
+  GetDependentTiles(baldr::GraphReader& reader,
+                    const std::unordered_set<baldr::GraphId>& tiles,
+                    const std::vector<baldr::GraphId>& nodes);
 };
 
 } // namespace mjolnir
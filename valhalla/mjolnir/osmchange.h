@@ -0,0 +1,54 @@
+#ifndef VALHALLA_MJOLNIR_OSMCHANGE_H
+#define VALHALLA_MJOLNIR_OSMCHANGE_H
+
+#include <valhalla/baldr/graphid.h>
+#include <valhalla/midgard/pointll.h>
+
+#include <cstdint>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace valhalla {
+namespace mjolnir {
+
+/**
+ * The OSM objects touched by one or more OSM change (.osc) files. Used to find the local level
+ * tiles which have to be rebuilt to bring an existing tile set up to date with the changes.
+ */
+struct OSMChange {
+  // Ids of created, modified or deleted ways, including the way members of changed relations
+  std::unordered_set<uint64_t> ways;
+  // Ids of created, modified or deleted nodes
+  std::unordered_set<uint64_t> nodes;
+  // Locations of created or modified nodes
+  std::vector<midgard::PointLL> node_locations;
+
+  /**
+   * Read the changes out of OSM change files.
+   * @param  change_files  OSM change files (.osc)
+   * @return Returns the changed OSM objects.
+   */
+  static OSMChange Read(const std::vector<std::string>& change_files);
+
+  /**
+   * Get the local level tiles which have to be rebuilt for these changes. These are the tiles of
+   * the changed nodes, the tiles the changed ways and the ways using changed nodes run through
+   * before and after the change, the tiles the enhancer looks at when enhancing any of those, and
+   * the tiles with edges ending in any of those, since the ids of their end nodes may change.
+   * @param  tile_dir        Directory of the local level tiles from before the changes
+   * @param  ways_file       Ways parsed from the OSM data with the changes applied
+   * @param  way_nodes_file  Way nodes parsed from the OSM data with the changes applied
+   * @param  concurrency     Number of threads used to scan the tiles from before the changes
+   * @return Returns the ids of the tiles to rebuild.
+   */
+  std::unordered_set<baldr::GraphId> GetAffectedTiles(const std::string& tile_dir,
+                                                      const std::string& ways_file,
+                                                      const std::string& way_nodes_file,
+                                                      unsigned int concurrency) const;
+};
+
+} // namespace mjolnir
+} // namespace valhalla
+
+#endif // VALHALLA_MJOLNIR_OSMCHANGE_H
@@ -2,6 +2,7 @@
 #define VALHALLA_MJOLNIR_OSMDATA_H
 
 #include <valhalla/baldr/conditional_speed_limit.h>
+#include <valhalla/mjolnir/flatmultimap.h>
 #include <valhalla/mjolnir/osmaccessrestriction.h>
 #include <valhalla/mjolnir/osmlinguistic.h>
 #include <valhalla/mjolnir/osmnode.h>
@@ -10,6 +11,7 @@
 
 #include <cstdint>
 #include <string>
+#include <unordered_map>
 #include <unordered_set>
 
 namespace valhalla {
@@ -47,15 +49,15 @@ struct OSMLaneConnectivity {
   uint32_t from_lanes_index; // Index to string in UniqueNames
 };
 
-// Data types used within OSMData
-using RestrictionsMultiMap = std::unordered_multimap<uint64_t, OSMRestriction>;
+// Data types used within OSMData. The multimaps are sorted, flat arrays which later stages
+// memory map from the temporary files instead of loading them
+using RestrictionsMultiMap = FlatMultiMap<OSMRestriction>;
 using ViaSet = std::unordered_set<uint64_t>;
-using AccessRestrictionsMultiMap = std::unordered_multimap<uint64_t, OSMAccessRestriction>;
-using BikeMultiMap = std::unordered_multimap<uint64_t, OSMBike>;
-using OSMLaneConnectivityMultiMap = std::unordered_multimap<uint64_t, OSMLaneConnectivity>;
-using LinguisticMultiMap = std::unordered_multimap<uint64_t, OSMLinguistic>;
-using ConditionalSpeedLimitsMultiMap =
-    std::unordered_multimap<uint64_t, baldr::ConditionalSpeedLimit>;
+using AccessRestrictionsMultiMap = FlatMultiMap<OSMAccessRestriction>;
+using BikeMultiMap = FlatMultiMap<OSMBike>;
+using OSMLaneConnectivityMultiMap = FlatMultiMap<OSMLaneConnectivity>;
+using LinguisticMultiMap = FlatMultiMap<OSMLinguistic>;
+using ConditionalSpeedLimitsMultiMap = FlatMultiMap<baldr::ConditionalSpeedLimit>;
 
 // OSMString map uses the way Id as the key and the name index into UniqueNames as the value
 using OSMStringMap = std::unordered_map<uint64_t, uint32_t>;
@@ -72,11 +74,16 @@ struct OSMData {
   bool write_to_temp_files(const std::string& tile_dir);
 
   /**
-   * Read data from temporary files.
+   * Read data from temporary files. The multimaps are memory mapped read-only from their files.
    * @return Returns true if successful, false if an error occurs.
    */
   bool read_from_temp_files(const std::string& tile_dir);
 
+  /**
+   * Sort the multimaps filled while parsing so that they can be looked up.
+   */
+  void sort_maps();
+
   /**
    * Read data from temporary unique name file.
    * @return Returns true if successful, false if an error occurs.
@@ -0,0 +1,96 @@
+#ifndef VALHALLA_MJOLNIR_TILESCHEDULER_H
+#define VALHALLA_MJOLNIR_TILESCHEDULER_H
+
+#include <valhalla/baldr/graphid.h>
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace valhalla {
+namespace mjolnir {
+
+/**
+ * Hands out the tiles of a multithreaded build stage to its threads. The tiles are ordered by
+ * their estimated cost, largest first, and dealt out to one queue per thread. A thread works
+ * through its own queue from the front and once that is empty steals from the back of the queue
+ * of another thread, so that the expensive tiles start early and no thread idles while others
+ * still have tiles waiting. When the stage is done its utilization and critical path are logged.
+ */
+class TileScheduler {
+public:
+  using clock = std::chrono::steady_clock;
+
+  /**
+   * @param stage        name of the stage for logging
+   * @param tiles        the tiles to work on along with their estimated cost
+   * @param concurrency  the number of threads that will work on the tiles
+   */
+  TileScheduler(std::string stage,
+                std::vector<std::pair<baldr::GraphId, uint64_t>> tiles,
+                unsigned int concurrency);
+
+  /**
+   * Take the next tile for a thread. The time until the thread asks for another tile is counted
+   * as the time the tile took.
+   * @param worker  the index of the thread asking
+   * @param tile    set to the tile to work on
+   * @return false once there are no tiles left
+   */
+  bool Next(size_t worker, baldr::GraphId& tile);
+
+  /**
+   * Run the worker on every thread, passing it the index of its thread, and log the utilization
+   * of the threads once they are done. If any of them fails its exception is rethrown once all of
+   * them are done.
+   * @param worker  the function which takes tiles until there are none left
+   */
+  void Run(const std::function<void(size_t worker)>& worker);
+
+  /**
+   * @return the number of threads
+   */
+  size_t concurrency() const {
+    return workers_.size();
+  }
+
+  /**
+   * The size of a tile in a tile directory, which stands in for the cost of the tiles in the
+   * stages that follow the one which wrote them.
+   * @param tile_dir  the tile directory
+   * @param tile      the tile
+   * @return the size of the tile in bytes, 0 if it doesn't exist
+   */
+  static uint64_t TileSize(const std::string& tile_dir, const baldr::GraphId& tile);
+
+protected:
+  struct Worker {
+    std::mutex lock;
+    std::deque<baldr::GraphId> tiles;
+    // the tile the thread works on and when it took it, if it has one
+    baldr::GraphId current;
+    clock::time_point start;
+    bool working = false;
+    // what the thread did so far
+    clock::duration busy{};
+    clock::duration longest{};
+    baldr::GraphId longest_tile;
+    size_t count = 0;
+  };
+
+  // Count the time of the tile the thread worked on so far
+  void Finish(Worker& worker);
+
+  std::string stage_;
+  std::vector<Worker> workers_;
+};
+
+} // namespace mjolnir
+} // namespace valhalla
+
+#endif // VALHALLA_MJOLNIR_TILESCHEDULER_H
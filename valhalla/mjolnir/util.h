@@ -9,10 +9,12 @@
 
 #include <boost/property_tree/ptree_fwd.hpp>
 
+#include <algorithm>
 #include <array>
 #include <atomic>
 #include <map>
 #include <mutex>
+#include <optional>
 #include <span>
 #include <string>
 #include <unordered_map>
@@ -95,6 +97,23 @@ inline std::string to_string(BuildStage stg) {
   return (i == BuildStageStrings.cend()) ? "null" : i->second;
 }
 
+// The stages in the order build_tile_set() runs them. Elevation is added before the complex
+// restrictions, since adding it drops the complex restrictions a tile already has
+constexpr std::array<BuildStage, 16> kBuildStageOrder =
+    {BuildStage::kInitialize, BuildStage::kParseWays, BuildStage::kParseRelations,
+     BuildStage::kParseNodes, BuildStage::kConstructEdges, BuildStage::kBuild,
+     BuildStage::kEnhance,    BuildStage::kFilter,    BuildStage::kTransit,
+     BuildStage::kBss,        BuildStage::kHierarchy, BuildStage::kShortcuts,
+     BuildStage::kElevation,  BuildStage::kRestrictions, BuildStage::kValidate,
+     BuildStage::kCleanup};
+
+// Position of the stage in the order the stages run in, stages compare by this rather than by
+// their value
+inline size_t build_stage_order(BuildStage stage) {
+  return std::find(kBuildStageOrder.begin(), kBuildStageOrder.end(), stage) -
+         kBuildStageOrder.begin();
+}
+
 // Counters for warnings that fire per-item in hot loops during tile building.
 // Instead of logging each occurrence (which produces millions of lines on planet builds),
 // we accumulate counts and log a summary at the end. Full per-item detail is still
@@ -341,6 +360,9 @@ uint32_t compute_curvature(const std::vector<midgard::PointLL>& shape);
  * @param input_files   Tells what osm pbf files to build the tiles from
  * @param start_stage   Starting stage of the pipeline to run
  * @param end_stage     End stage of the pipeline to run
+ * @param change_files  OSM change files already applied to the input files. If given, only the
+ *                      local tiles affected by the changes are rebuilt on top of the ones kept in
+ *                      mjolnir.incremental_dir, the remaining stages run as usual
  * @param release_osmpbf_memory Free PBF parsing libs after use.  Saves RAM, but makes libprotobuf
  * unusable afterwards.  Set to false if you need to perform protobuf operations after building tiles.
  * @return Returns true if no errors occur, false if an error occurs.
@@ -348,7 +370,8 @@ uint32_t compute_curvature(const std::vector<midgard::PointLL>& shape);
 bool build_tile_set(const boost::property_tree::ptree& config,
                     const std::vector<std::string>& input_files,
                     const BuildStage start_stage = BuildStage::kInitialize,
-                    const BuildStage end_stage = BuildStage::kValidate);
+                    const BuildStage end_stage = BuildStage::kValidate,
+                    const std::vector<std::string>& change_files = {});
 
 // The tile manifest is a JSON-serializable index of tiles to be processed during the build stage of
 // valhalla_build_tiles'. It can be used to distribute shard keys when building tiles with
@@ -382,6 +405,74 @@ struct TileManifest {
 
   static TileManifest ReadFromFile(const std::string& filename);
 };
+
+// The build manifest records the progress of valhalla_build_tiles within a tile directory: a
+// checksum of the input files, the stages which completed along with how long they took and a
+// hash, the size and the last write time of every tile as the last completed stage left it. It is
+// rewritten after every stage, so that an interrupted build can be resumed (see `resume_stage()`)
+// rather than rerun.
+//
+// Example manifest :
+//
+// {
+//   "input_checksum": 1405860392716218131,
+//   "stages": [
+//     {
+//       "stage": "parseways",
+//       "seconds": 42
+//     }
+//   ],
+//   "tiles": [
+//     {
+//       "graphid": {
+//         "value": 5970538,
+//         "id": 0,
+//         "tile_id": 746317,
+//         "level": 2
+//       },
+//       "checksum": 8142317532009134087,
+//       "size": 262144,
+//       "mtime": 1700000000000000000
+//     }
+//   ]
+// }
+struct BuildManifest {
+  struct TileChecksum {
+    // Hash of the contents of the tile
+    uint64_t checksum;
+    uint64_t size;
+    // Last write time of the file. A tile which has the same size and last write time as in the
+    // manifest is not read again to hash its contents
+    int64_t mtime;
+
+    bool operator==(const TileChecksum& other) const = default;
+  };
+
+  uint64_t input_checksum = 0;
+  std::vector<std::pair<BuildStage, uint64_t>> stages;
+  std::map<baldr::GraphId, TileChecksum> tiles;
+
+  std::string ToString() const;
+
+  // Writes a temporary file first, so that the manifest is never left half written
+  void LogToFile(const std::string& filename) const;
+
+  static BuildManifest ReadFromFile(const std::string& filename);
+};
+
+/**
+ * Find the stage an interrupted build of the tile directory has to be resumed from, using the
+ * build manifest written by `build_tile_set()`. The build starts over if there is no manifest or
+ * the input files changed since. If the tiles differ from the ones the last completed stage left,
+ * the stage which was interrupted already rewrote some of them, so they are rebuilt from the
+ * intermediate files. Otherwise the build resumes at the stage which runs after the last completed
+ * one, leaving out the hierarchy and shortcut stages if the config turns them off.
+ * @param config       Used to tell the function where the tiles are built
+ * @param input_files  The osm pbf files the tiles are built from
+ * @return Returns the first stage to run, none if all of the stages completed.
+ */
+std::optional<BuildStage> resume_stage(const boost::property_tree::ptree& config,
+                                       const std::vector<std::string>& input_files);
 } // namespace mjolnir
 } // namespace valhalla
 #endif // VALHALLA_MJOLNIR_UTIL_H_
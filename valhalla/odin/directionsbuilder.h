@@ -6,11 +6,90 @@
 #include <valhalla/odin/markup_formatter.h>
 #include <valhalla/proto/api.pb.h>
 
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
 #include <list>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <vector>
 
 namespace valhalla {
 namespace odin {
 
+/**
+ * The parts of the directions a request gets back, which depend on its output format, its
+ * directions type and the instructions it asks for. Only those parts are built.
+ */
+struct DirectionsContent {
+  // The maneuvers of the legs, without them the legs only get their summary
+  bool maneuvers = true;
+  // The text instructions of the maneuvers
+  bool instructions = true;
+  // The verbal instructions of the maneuvers
+  bool verbal_instructions = true;
+  // The active turn lanes on the edges of the trip
+  bool turn_lanes = true;
+
+  /**
+   * Returns the parts of the directions the serializer of the request writes.
+   *
+   * @param options  the request options
+   */
+  static DirectionsContent FromOptions(const Options& options);
+
+  /**
+   * Returns the most detailed part that is built, one of none, maneuvers, instructions or verbal.
+   */
+  std::string_view level() const;
+};
+
+/**
+ * Threads which build the directions of the legs of a route alongside the calling thread. They
+ * are started once, by the worker which owns them, and wait for the next route in between.
+ * Only one route can be built on them at a time.
+ */
+class DirectionsThreads {
+public:
+  /**
+   * Starts the threads.
+   *
+   * @param count  the number of threads besides the calling one
+   */
+  explicit DirectionsThreads(unsigned int count);
+  ~DirectionsThreads();
+
+  DirectionsThreads(const DirectionsThreads&) = delete;
+  DirectionsThreads& operator=(const DirectionsThreads&) = delete;
+
+  /**
+   * Runs the work on every thread and on the calling thread, returns once all of them are done.
+   * The work must not throw.
+   *
+   * @param work  the work to run
+   */
+  void Run(const std::function<void()>& work);
+
+  /**
+   * Returns the number of threads besides the calling one.
+   */
+  size_t size() const {
+    return threads_.size();
+  }
+
+private:
+  std::vector<std::thread> threads_;
+  std::mutex mutex_;
+  std::condition_variable work_ready_;
+  std::condition_variable work_done_;
+  const std::function<void()>* work_ = nullptr;
+  // counts the runs so that every thread takes part in each run once
+  uint64_t run_ = 0;
+  size_t running_ = 0;
+  bool stop_ = false;
+};
+
 /**
  * Builds the trip directions based on the specified directions options
  * and trip path.
@@ -24,12 +103,34 @@ public:
    * calls PopulateDirectionsLeg to transform the maneuver list into the
    * trip directions.
    *
-   * @param api   the protobuf object containing the request, the path and a place
-   *              to store the resulting directions
+   * @param api      the protobuf object containing the request, the path and a place
+   *                 to store the resulting directions
+   * @param content  the parts of the directions to build, all of them by default
+   * @param threads  threads which build legs of the routes alongside the calling thread, without
+   *                 them the calling thread builds the legs in turn
    */
-  static void Build(Api& api, const MarkupFormatter& markup_formatter);
+  static void Build(Api& api,
+                    const MarkupFormatter& markup_formatter,
+                    const DirectionsContent& content = {},
+                    DirectionsThreads* threads = nullptr);
 
 protected:
+  /**
+   * Builds the directions of one leg, which only touches the leg and its directions so that legs
+   * can be built on different threads.
+   *
+   * @param options          the request options
+   * @param markup_formatter formats the markup of the instructions
+   * @param content          the parts of the directions to build
+   * @param trip_path        the leg of the trip
+   * @param trip_directions  the directions of the leg to fill in
+   */
+  static void BuildLeg(const Options& options,
+                       const MarkupFormatter& markup_formatter,
+                       const DirectionsContent& content,
+                       TripLeg& trip_path,
+                       DirectionsLeg& trip_directions);
+
   /**
    * Update the heading of ~0 length edges.
    *
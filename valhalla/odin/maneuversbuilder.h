@@ -23,8 +23,13 @@ public:
    * @param options The directions options such as: units and
    *                           language.
    * @param trip_path The trip path - list of nodes, edges, attributes and shape.
+   * @param turn_lanes Whether to activate the turn lanes of the trip path edges.
+   * @param verbal Whether to prepare the maneuvers for verbal instructions.
    */
-  ManeuversBuilder(const Options& options, EnhancedTripLeg* trip_path);
+  ManeuversBuilder(const Options& options,
+                   EnhancedTripLeg* trip_path,
+                   bool turn_lanes = true,
+                   bool verbal = true);
 
   std::list<Maneuver> Build();
 
@@ -328,6 +333,8 @@ protected:
 
   const Options& options_;
   EnhancedTripLeg* trip_path_;
+  bool turn_lanes_;
+  bool verbal_;
 };
 
 } // namespace odin
@@ -3,9 +3,13 @@
 
 #include <boost/property_tree/ptree_fwd.hpp>
 
+#include <cstdint>
+#include <initializer_list>
 #include <locale>
 #include <string>
+#include <string_view>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace {
@@ -176,8 +180,56 @@ constexpr auto kLevelTag = "<LEVEL>";
 namespace valhalla {
 namespace odin {
 
+/**
+ * A phrase split into its literal text and the tags in between when the dictionary is loaded, so
+ * that forming an instruction from it takes a single pass over the phrase and a single allocation
+ * instead of a search and a copy of the phrase per tag.
+ */
+class PhraseTemplate {
+public:
+  using tag_values_t = std::initializer_list<std::pair<std::string_view, std::string_view>>;
+
+  PhraseTemplate() = default;
+  explicit PhraseTemplate(std::string phrase);
+
+  /**
+   * Form the phrase with its tags replaced by their values. Tags without a value are kept as they
+   * are and values are not searched for tags themselves.
+   * @param values  the tags, including their angle brackets, and their values
+   * @return the formed phrase
+   */
+  std::string Format(tag_values_t values) const;
+
+  const std::string& phrase() const {
+    return phrase_;
+  }
+
+  // Whether the template holds a phrase, a default constructed one doesn't
+  bool loaded() const {
+    return !pieces_.empty();
+  }
+
+protected:
+  struct Piece {
+    uint32_t offset;
+    uint32_t length;
+    bool tag;
+  };
+
+  std::string phrase_;
+  std::vector<Piece> pieces_;
+};
+
 struct PhraseSet {
   std::unordered_map<std::string, std::string> phrases;
+  // The phrases compiled by Load, indexed by their numeric key
+  std::vector<PhraseTemplate> templates;
+
+  /**
+   * @param phrase_id  the key of the phrase
+   * @return the compiled phrase, throws std::out_of_range if there is no phrase with the key
+   */
+  const PhraseTemplate& at(uint8_t phrase_id) const;
 };
 
 struct StartSubset : PhraseSet {
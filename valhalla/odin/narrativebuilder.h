@@ -30,7 +30,13 @@ public:
   NarrativeBuilder(const NarrativeBuilder&) = default;
   NarrativeBuilder& operator=(const NarrativeBuilder&) = delete;
 
-  void Build(std::list<Maneuver>& maneuvers);
+  /**
+   * Form the instructions of the maneuvers.
+   *
+   * @param maneuvers  the maneuvers to form the instructions of
+   * @param verbal     whether to form the verbal instructions as well, only the text ones if not
+   */
+  void Build(std::list<Maneuver>& maneuvers, bool verbal = true);
 
   // A few of the form instruction methods need to be public to enable updates based on length
 
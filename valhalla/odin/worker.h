@@ -2,10 +2,13 @@
 #define __VALHALLA_ODIN_SERVICE_H__
 
 #include <valhalla/exceptions.h>
+#include <valhalla/odin/directionsbuilder.h>
 #include <valhalla/odin/markup_formatter.h>
 #include <valhalla/proto/api.pb.h>
 #include <valhalla/worker.h>
 
+#include <memory>
+
 namespace valhalla {
 namespace odin {
 
@@ -33,6 +36,9 @@ public:
 
 protected:
   MarkupFormatter markup_formatter_;
+  // the threads which build legs of a route alongside the worker's, if odin.concurrency asks for
+  // more than one. they are shared by all of the requests of the worker
+  std::unique_ptr<DirectionsThreads> directions_threads_;
 
 private:
   std::string service_name() const override {
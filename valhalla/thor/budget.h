@@ -0,0 +1,70 @@
+#ifndef VALHALLA_THOR_BUDGET_H_
+#define VALHALLA_THOR_BUDGET_H_
+
+#include <valhalla/baldr/graphreader.h>
+
+#include <boost/property_tree/ptree_fwd.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+
+namespace valhalla {
+namespace thor {
+
+/**
+ * What a single request may cost the algorithms of thor: the edges they settle, the tiles the graph
+ * reader loads for them and the time since the request started. It is handed to the algorithms as
+ * their interrupt. Their main loops call it once kInterruptIterationsInterval more iterations are
+ * done, the cost matrix once that many more expansions of all of its searches are done, and none
+ * of them calls it before the first of those. Each iteration or expansion settles about one edge,
+ * so every call is charged that many settled edges. Once any of them is spent the request fails
+ * with a 447. Since the iterations are counted rather than timed a request runs out of its edge
+ * budget at the same point every time, the tiles and the time depend on the cache and the load.
+ */
+class budget_t {
+public:
+  /**
+   * @param config  the config, service_limits.budget holds the limits, 0 for none
+   */
+  budget_t(const boost::property_tree::ptree& config);
+
+  budget_t(const budget_t&) = delete;
+  budget_t& operator=(const budget_t&) = delete;
+
+  /**
+   * Starts over for a new request
+   * @param reader     the reader the algorithms load their tiles with
+   * @param interrupt  the interrupt of the request which is called before the budget is checked,
+   *                   may be null
+   */
+  void start(const baldr::GraphReader& reader, const std::function<void()>* interrupt);
+
+  /**
+   * @return the interrupt to give to the algorithms, throws when the request is interrupted or
+   *         the budget is spent
+   */
+  const std::function<void()>* interrupt() const {
+    return &check_;
+  }
+
+protected:
+  // charges the iterations since the last call and throws if the budget is spent
+  void check();
+
+  uint64_t max_settled_edges_;
+  uint64_t max_tiles_loaded_;
+  std::chrono::milliseconds max_time_;
+
+  const baldr::GraphReader* reader_;
+  const std::function<void()>* interrupt_;
+  uint64_t settled_edges_;
+  uint64_t tiles_loaded_;
+  std::chrono::steady_clock::time_point started_;
+  std::function<void()> check_;
+};
+
+} // namespace thor
+} // namespace valhalla
+
+#endif // VALHALLA_THOR_BUDGET_H_
@@ -84,6 +84,15 @@ public:
     expansion_callback_ = expansion_callback;
   }
 
+  /**
+   * Set a callback that will throw when the expansion should be aborted
+   * @param interrupt_callback  the function to periodically call to see if
+   *                            we should abort
+   */
+  void set_interrupt(const std::function<void()>* interrupt_callback) {
+    interrupt_ = interrupt_callback;
+  }
+
 protected:
   /**
    * Compute the best first graph traversal from a list of origin locations
@@ -171,7 +180,8 @@ protected:
   // separately from the other paths
   bool multipath_;
 
-  // TODO: add an interrupt here so that the caller can abort the main loop externally
+  // called every so often from the main loop, throws when the caller wants to abort it
+  const std::function<void()>* interrupt_;
 
   /**
    * Initialization prior to computing the graph expansion
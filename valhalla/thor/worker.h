@@ -10,6 +10,7 @@
 #include <valhalla/proto/trip.pb.h>
 #include <valhalla/sif/costfactory.h>
 #include <valhalla/thor/bidirectional_astar.h>
+#include <valhalla/thor/budget.h>
 #include <valhalla/thor/centroid.h>
 #include <valhalla/thor/costmatrix.h>
 #include <valhalla/thor/isochrone.h>
@@ -143,6 +144,9 @@ protected:
   double min_linear_cost_factor;
   uint64_t max_linear_cost_edges;
 
+  // what the request being worked on may cost, the algorithms get it as their interrupt
+  budget_t budget;
+
 private:
   std::string service_name() const override {
     return "thor";
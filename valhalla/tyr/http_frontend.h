@@ -0,0 +1,215 @@
+#ifndef VALHALLA_TYR_HTTP_FRONTEND_H_
+#define VALHALLA_TYR_HTTP_FRONTEND_H_
+
+#include <valhalla/proto/options.pb.h>
+#include <valhalla/tyr/actor.h>
+#include <valhalla/tyr/response_cache.h>
+#include <valhalla/worker.h>
+
+#include <boost/property_tree/ptree_fwd.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace valhalla {
+namespace tyr {
+
+#ifdef ENABLE_SERVICES
+
+/**
+ * Answers a whole request in a single stage by running loki, thor and odin in turn on one actor,
+ * so the request never leaves the process and is never serialized between the stages.
+ */
+class httpd_worker_t : public service_worker_t {
+public:
+  /**
+   * @param config  the config
+   * @param cache   where responses are cached if not null, may be shared with other workers
+   */
+  httpd_worker_t(const boost::property_tree::ptree& config,
+                 const std::shared_ptr<response_cache_t>& cache = nullptr);
+  virtual ~httpd_worker_t();
+
+  /**
+   * Answers the http request in the first message of the job, the result is always the response.
+   */
+  virtual prime_server::worker_t::result_t work(const std::list<zmq::message_t>& job,
+                                                void* request_info,
+                                                const std::function<void()>& interrupt) override;
+
+  /**
+   * Answers an http request, errors included
+   * @param http_request  the request
+   * @param info          the info of the request, used to form the response
+   * @param interrupt     throws when the request should be aborted
+   * @return the http response as bytes
+   */
+  std::string answer(const prime_server::http_request_t& http_request,
+                     prime_server::http_request_info_t& info,
+                     const std::function<void()>& interrupt);
+
+  /**
+   * The number of times a request would have been serialized and parsed again between the stages
+   * of the ZeroMQ pipeline
+   * @param action  the action of the request
+   */
+  static uint32_t pipeline_hops(Options::Action action);
+
+protected:
+  std::string service_name() const override {
+    return "httpd";
+  }
+
+  actor_t actor_;
+  std::shared_ptr<response_cache_t> cache_;
+  std::unordered_set<Options::Action> actions_;
+  std::string action_str_;
+  // every how many requests the hops the pipeline would have taken are timed, 0 never
+  uint32_t hop_sample_every_;
+  uint64_t answered_;
+};
+
+/**
+ * An http server which answers the requests in process on a pool of httpd workers instead of
+ * handing them through the ZeroMQ pipeline of loki, thor and odin. A single thread runs an epoll
+ * event loop which accepts the connections, reads and parses the requests and writes back the
+ * responses. Connections are kept alive and may pipeline their requests, the responses go back in
+ * the order the requests came in. Requests beyond what the queue of the workers takes are turned
+ * away with a 503 right away, and a connection isn't read from while it has too many requests in
+ * flight.
+ */
+class http_frontend_t {
+public:
+  /**
+   * @param config       the config, httpd.service holds where to listen and the limits of the
+   *                     requests, httpd.event_loop the limits of the queue and connections
+   * @param concurrency  the number of workers
+   */
+  http_frontend_t(const boost::property_tree::ptree& config, unsigned int concurrency);
+  ~http_frontend_t();
+
+  /**
+   * Serves requests until stopped
+   */
+  void serve();
+
+  /**
+   * Makes serve return once the workers are done with the requests they are working on, which
+   * are interrupted, the ones still queued are dropped. May be called from any thread
+   */
+  void stop();
+
+  /**
+   * Stops taking new connections and requests, the ones already read are still answered. Once
+   * they are or the time is up, whichever comes first, serve returns as if stopped. May be called
+   * from any thread
+   * @param seconds  how long to wait for the requests already read
+   */
+  void drain(std::chrono::seconds seconds);
+
+protected:
+  using clock = std::chrono::steady_clock;
+
+  // A request waiting for a worker
+  struct job_t {
+    uint64_t connection;
+    uint64_t sequence;
+    prime_server::http_request_t request;
+    prime_server::http_request_info_t info;
+    clock::time_point deadline;
+  };
+
+  // A response waiting to be written
+  struct answer_t {
+    uint64_t connection;
+    uint64_t sequence;
+    std::string response;
+    bool close;
+  };
+
+  struct connection_t {
+    int fd;
+    // parses the requests out of whatever was read so far
+    prime_server::http_request_t parser;
+    // the bytes of the request the parser is in the middle of are at the end of these, they are
+    // parsed again from scratch when a read doesn't parse
+    std::string received;
+    // sequence of the next request read and of the next response to write
+    uint64_t next_request = 0;
+    uint64_t next_response = 0;
+    // responses that are done but wait for the ones of earlier requests
+    std::map<uint64_t, answer_t> done;
+    std::string out;
+    size_t written = 0;
+    // no more requests are read once one asks to close the connection or the client stops
+    // sending, the connection is closed once the responses to what was read are written
+    bool closing = false;
+    bool hangup = false;
+  };
+
+  void Listen();
+  void Accept();
+  void Read(uint64_t id);
+  void Write(uint64_t id);
+  void Close(uint64_t id);
+  void Answered();
+  void Watch(uint64_t id, const connection_t& connection);
+  std::list<prime_server::http_request_t> Parseable(const char* bytes, size_t size) const;
+  void Enqueue(uint64_t id, connection_t& connection, prime_server::http_request_t&& request);
+  void Respond(connection_t& connection, answer_t&& answer);
+  void Work(httpd_worker_t& worker);
+  void Drain();
+  bool Drained() const;
+
+  std::string listen_;
+  size_t max_queued_;
+  size_t max_pipelined_;
+  size_t max_request_size_;
+  // how long a request may take, none if negative
+  std::chrono::seconds timeout_;
+
+  int listener_;
+  int epoll_;
+  int wakeup_;
+  std::atomic<bool> stopped_;
+  // asked to drain for this long, and until when the loop drains once it started to
+  std::atomic<bool> draining_;
+  std::chrono::seconds drain_seconds_;
+  clock::time_point drain_until_;
+  uint64_t next_connection_;
+  uint32_t next_request_id_;
+  std::unordered_map<uint64_t, connection_t> connections_;
+
+  // the workers and the requests waiting for them
+  std::vector<std::unique_ptr<httpd_worker_t>> workers_;
+  std::vector<std::thread> threads_;
+  std::mutex jobs_lock_;
+  std::condition_variable jobs_ready_;
+  std::deque<job_t> jobs_;
+  // handed to the workers and not answered yet, only touched by the event loop
+  size_t in_flight_;
+
+  // the responses the workers are done with, the event loop picks them up
+  std::mutex answers_lock_;
+  std::vector<answer_t> answers_;
+};
+
+#endif
+
+} // namespace tyr
+} // namespace valhalla
+
+#endif // VALHALLA_TYR_HTTP_FRONTEND_H_
@@ -0,0 +1,120 @@
+#ifndef VALHALLA_TYR_RESPONSE_CACHE_H_
+#define VALHALLA_TYR_RESPONSE_CACHE_H_
+
+#include <valhalla/proto/options.pb.h>
+
+#include <boost/property_tree/ptree_fwd.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+namespace valhalla {
+namespace tyr {
+
+/**
+ * A cache of serialized responses shared by the workers of a service. Requests are keyed by their
+ * parsed options, serialized deterministically, along with the last modification time of the
+ * tileset so that a new tileset starts out with an empty cache. Identical requests that come in
+ * while the first of them is still being answered wait for its response rather than computing
+ * their own. The responses are kept up to a total size in bytes, the least recently used go first,
+ * and those of time dependent requests only for a while since the traffic they were computed
+ * with changes.
+ */
+class response_cache_t {
+public:
+  using clock = std::chrono::steady_clock;
+  using response_t = std::shared_ptr<const std::string>;
+
+  // How a response was found
+  enum class outcome_t { hit, coalesced, miss };
+
+  /**
+   * @param config  the config, httpd.cache holds the size, time to live, the actions to cache and
+   *                how long to wait on identical requests and mjolnir where the tileset is
+   */
+  response_cache_t(const boost::property_tree::ptree& config);
+
+  /**
+   * Whether requests like this one are cached at all
+   * @param options  the parsed options of the request
+   */
+  bool caches(const Options& options) const;
+
+  /**
+   * Returns the key of a request
+   * @param options  the parsed options of the request
+   */
+  std::string key(const Options& options) const;
+
+  /**
+   * Whether the response to a request is only good for a while
+   * @param options  the parsed options of the request
+   */
+  bool time_dependent(const Options& options) const;
+
+  /**
+   * Returns the response to a request from the cache, from an identical request in flight or by
+   * answering it. If answering it throws the exception is passed on and one of the requests
+   * waiting on it answers it instead. A request waits on an identical one for so long only, then
+   * it answers itself.
+   * @param key             the key of the request
+   * @param time_dependent  whether the response expires
+   * @param answer          answers the request
+   * @param interrupt       called every so often while waiting, throws to stop waiting
+   * @return the response and how it was found
+   */
+  std::pair<response_t, outcome_t> get(const std::string& key,
+                                       bool time_dependent,
+                                       const std::function<response_t()>& answer,
+                                       const std::function<void()>* interrupt = nullptr);
+
+  /**
+   * @return the bytes of keys and responses in the cache
+   */
+  size_t size() const;
+
+protected:
+  struct entry_t {
+    response_t response;
+    clock::time_point expires;
+    std::list<const std::string*>::iterator recency;
+  };
+  using entries_t = std::unordered_map<std::string, entry_t>;
+
+  // Adds a response and evicts the least recently used ones until it all fits, if it was answered
+  // as the request in flight that one is done
+  void put(const std::string& key, const response_t& response, bool time_dependent, bool flying);
+
+  // Removes an entry
+  void erase(entries_t::iterator entry);
+
+  size_t max_bytes_;
+  std::chrono::seconds ttl_;
+  // how long to wait on an identical request in flight before answering it again
+  std::chrono::milliseconds coalesce_;
+  std::unordered_set<Options::Action> actions_;
+  std::string tileset_;
+  bool live_traffic_;
+
+  mutable std::mutex lock_;
+  size_t bytes_;
+  // the keys of the entries, most recently used at the front
+  std::list<const std::string*> recency_;
+  entries_t entries_;
+  // the requests being answered, identical ones wait on their response
+  std::unordered_map<std::string, std::shared_future<response_t>> in_flight_;
+};
+
+} // namespace tyr
+} // namespace valhalla
+
+#endif // VALHALLA_TYR_RESPONSE_CACHE_H_
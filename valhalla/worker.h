@@ -6,12 +6,15 @@
 #include <valhalla/sif/dynamiccost.h>
 
 #include <boost/property_tree/ptree_fwd.hpp>
+#include <google/protobuf/arena.h>
 
 #ifdef ENABLE_SERVICES
 #include <prime_server/http_protocol.hpp>
 #include <prime_server/prime_server.hpp>
 #endif
 
+#include <cstdint>
+#include <memory>
 #include <string>
 
 namespace valhalla {
@@ -92,8 +95,18 @@ const content_type PBF_MIME{"Content-type", "application/x-protobuf"};
 const content_type GPX_MIME{"Content-type", "application/gpx+xml;charset=utf-8"};
 const content_type TIFF_MIME("Content-type", "image/tiff");
 const content_type MVT_MIME("Content-type", "application/vnd.mapbox-vector-tile");
+const content_type PROMETHEUS_MIME("Content-type", "text/plain; version=0.0.4; charset=utf-8");
 } // namespace worker
 
+/**
+ * Answers a request for the /metrics route with the latencies of the stages and the counters of
+ * this process in the prometheus text format
+ *
+ * @param request_info  the info of the request, used to form the response
+ * @return the response
+ */
+prime_server::worker_t::result_t serialize_metrics(prime_server::http_request_info_t& request_info);
+
 prime_server::worker_t::result_t
 to_response(const std::string& data,
             prime_server::http_request_info_t& request_info,
@@ -101,6 +114,49 @@ to_response(const std::string& data,
             const std::vector<std::pair<std::string, std::string>>& additional_headers = {});
 #endif
 
+/**
+ * A protobuf arena for the requests of a worker. A request created on it, along with all of its sub
+ * messages, is freed at once when the arena is reset rather than message by message. The first
+ * block of the arena is taken with the first request and kept across resets so that most requests
+ * don't touch the heap at all.
+ */
+class request_arena_t {
+public:
+  /**
+   * @param config  the config, httpd.service.arena_bytes sets the size of the first block
+   */
+  request_arena_t(const boost::property_tree::ptree& config);
+
+  /**
+   * Creates an empty request which lives until the next reset
+   * @return the request
+   */
+  Api& request();
+
+  /**
+   * Frees all of the requests created since the last reset
+   */
+  void reset();
+
+  /**
+   * @return the number of bytes the arena took for the requests since the last reset, the part
+   *         beyond the first block was allocated on the heap
+   */
+  uint64_t allocated() const;
+
+  /**
+   * @return the size of the first block
+   */
+  size_t block_size() const {
+    return block_size_;
+  }
+
+protected:
+  size_t block_size_;
+  std::unique_ptr<char[]> block_;
+  std::unique_ptr<google::protobuf::Arena> arena_;
+};
+
 struct statsd_client_t;
 class service_worker_t {
 public:
@@ -128,7 +184,8 @@ public:
 
   /**
    * After forwarding the completed work on, this is called to reset any internal state, deallocate
-   * any memory to stay within limits or purge any staged metrics
+   * any memory to stay within limits or purge any staged metrics. This frees the requests created
+   * on the arena of the worker.
    */
   virtual void cleanup();
 
@@ -167,6 +224,8 @@ protected:
 
   const std::function<void()>* interrupt;
   std::unique_ptr<statsd_client_t> statsd_client;
+  // the request being worked on lives here until cleanup
+  request_arena_t arena;
 };
 } // namespace valhalla
 